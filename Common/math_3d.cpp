@@ -28,6 +28,14 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
+#if defined(__AVX__)
+#define OGLDEV_FRUSTUM_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define OGLDEV_FRUSTUM_SSE
+#include <emmintrin.h>
+#endif
+
 
 Vector4f& Vector4f::Normalize()
 {
@@ -652,6 +660,166 @@ bool IsPointInsideViewFrustum(const Vector3f& p, const Matrix4f& VP)
 }
 
 
+void FrustumCulling::Update(const Matrix4f& ViewProj)
+{
+    Vector4f l, r, b, t, n, f;
+    ViewProj.CalcClipPlanes(l, r, b, t, n, f);
+
+    // The inside of the right, top and far planes is negative so we flip
+    // them in order to have all the normals point into the frustum
+    m_planes[0] = l;
+    m_planes[1] = r * -1.0f;
+    m_planes[2] = b;
+    m_planes[3] = t * -1.0f;
+    m_planes[4] = n;
+    m_planes[5] = f * -1.0f;
+
+    // Normalize so that the sphere test can compare against the radius
+    for (int i = 0; i < NUM_PLANES; i++) {
+        Vector4f& Plane = m_planes[i];
+        float Len = sqrtf(Plane.x * Plane.x + Plane.y * Plane.y + Plane.z * Plane.z);
+
+        if (Len > 0.0f) {
+            Plane = Plane * (1.0f / Len);
+        }
+    }
+}
+
+
+//
+// The box test only needs the corner which is the farthest along the normal of each plane.
+// Since the planes are the same for all the boxes we can select the arrays of that corner
+// once per call and then test the boxes in groups of 8 (AVX) or 4 (SSE) with the same
+// arithmetic as the scalar version.
+//
+struct PlaneCorner {
+    float a, b, c, d;
+    const float* pX;
+    const float* pY;
+    const float* pZ;
+};
+
+
+static int ClassifyAABBRange(const PlaneCorner* pPlanes, int NumPlanes, int Start, int End, unsigned char* pVisible)
+{
+    int NumVisible = 0;
+
+    for (int i = Start; i < End; i++) {
+        unsigned char Visible = 1;
+
+        for (int p = 0; p < NumPlanes; p++) {
+            const PlaneCorner& Plane = pPlanes[p];
+
+            float Dist = Plane.a * Plane.pX[i] + Plane.b * Plane.pY[i] + Plane.c * Plane.pZ[i] + Plane.d;
+
+            if (Dist < 0.0f) {
+                Visible = 0;
+                break;
+            }
+        }
+
+        pVisible[i] = Visible;
+        NumVisible += Visible;
+    }
+
+    return NumVisible;
+}
+
+
+static void InitPlaneCorners(const Vector4f* pPlanes, int NumPlanes, const AABBArray& Boxes, PlaneCorner* pCorners)
+{
+    for (int p = 0; p < NumPlanes; p++) {
+        const Vector4f& Plane = pPlanes[p];
+        PlaneCorner& Corner = pCorners[p];
+
+        Corner.a = Plane.x;
+        Corner.b = Plane.y;
+        Corner.c = Plane.z;
+        Corner.d = Plane.w;
+        Corner.pX = (Plane.x >= 0.0f) ? Boxes.MaxX.data() : Boxes.MinX.data();
+        Corner.pY = (Plane.y >= 0.0f) ? Boxes.MaxY.data() : Boxes.MinY.data();
+        Corner.pZ = (Plane.z >= 0.0f) ? Boxes.MaxZ.data() : Boxes.MinZ.data();
+    }
+}
+
+
+int FrustumCulling::ClassifyAABBsScalar(const AABBArray& Boxes, unsigned char* pVisible) const
+{
+    PlaneCorner Corners[NUM_PLANES];
+    InitPlaneCorners(m_planes, NUM_PLANES, Boxes, Corners);
+
+    return ClassifyAABBRange(Corners, NUM_PLANES, 0, Boxes.Size(), pVisible);
+}
+
+
+int FrustumCulling::ClassifyAABBs(const AABBArray& Boxes, unsigned char* pVisible) const
+{
+    PlaneCorner Corners[NUM_PLANES];
+    InitPlaneCorners(m_planes, NUM_PLANES, Boxes, Corners);
+
+    int Count = Boxes.Size();
+    int NumVisible = 0;
+    int i = 0;
+
+#if defined(OGLDEV_FRUSTUM_AVX)
+    const __m256 Zero = _mm256_setzero_ps();
+
+    for (; i + 8 <= Count; i += 8) {
+        __m256 Outside = _mm256_setzero_ps();
+
+        for (int p = 0; p < NUM_PLANES; p++) {
+            const PlaneCorner& Plane = Corners[p];
+
+            __m256 Dist = _mm256_mul_ps(_mm256_set1_ps(Plane.a), _mm256_loadu_ps(Plane.pX + i));
+            Dist = _mm256_add_ps(Dist, _mm256_mul_ps(_mm256_set1_ps(Plane.b), _mm256_loadu_ps(Plane.pY + i)));
+            Dist = _mm256_add_ps(Dist, _mm256_mul_ps(_mm256_set1_ps(Plane.c), _mm256_loadu_ps(Plane.pZ + i)));
+            Dist = _mm256_add_ps(Dist, _mm256_set1_ps(Plane.d));
+
+            Outside = _mm256_or_ps(Outside, _mm256_cmp_ps(Dist, Zero, _CMP_LT_OQ));
+        }
+
+        int Mask = _mm256_movemask_ps(Outside);
+
+        for (int j = 0; j < 8; j++) {
+            unsigned char Visible = ((Mask >> j) & 1) ? 0 : 1;
+            pVisible[i + j] = Visible;
+            NumVisible += Visible;
+        }
+    }
+#elif defined(OGLDEV_FRUSTUM_SSE)
+    const __m128 Zero = _mm_setzero_ps();
+
+    for (; i + 4 <= Count; i += 4) {
+        __m128 Outside = _mm_setzero_ps();
+
+        for (int p = 0; p < NUM_PLANES; p++) {
+            const PlaneCorner& Plane = Corners[p];
+
+            __m128 Dist = _mm_mul_ps(_mm_set1_ps(Plane.a), _mm_loadu_ps(Plane.pX + i));
+            Dist = _mm_add_ps(Dist, _mm_mul_ps(_mm_set1_ps(Plane.b), _mm_loadu_ps(Plane.pY + i)));
+            Dist = _mm_add_ps(Dist, _mm_mul_ps(_mm_set1_ps(Plane.c), _mm_loadu_ps(Plane.pZ + i)));
+            Dist = _mm_add_ps(Dist, _mm_set1_ps(Plane.d));
+
+            Outside = _mm_or_ps(Outside, _mm_cmplt_ps(Dist, Zero));
+        }
+
+        int Mask = _mm_movemask_ps(Outside);
+
+        for (int j = 0; j < 4; j++) {
+            unsigned char Visible = ((Mask >> j) & 1) ? 0 : 1;
+            pVisible[i + j] = Visible;
+            NumVisible += Visible;
+        }
+    }
+#endif
+
+    // The remainder (or everything if there's no SIMD support)
+    NumVisible += ClassifyAABBRange(Corners, NUM_PLANES, i, Count, pVisible);
+
+    return NumVisible;
+}
+
+
 // Copied from https://github.com/opengl-tutorials/ogl/blob/master/common/quaternion_utils.cpp
 glm::quat RotationBetweenVectors(glm::vec3& start, glm::vec3& dest)
 {
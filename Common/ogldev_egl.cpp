@@ -0,0 +1,95 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "ogldev_util.h"
+#include "ogldev_egl.h"
+
+
+static EGLDisplay get_display()
+{
+    EGLDisplay Display = EGL_NO_DISPLAY;
+
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+    Display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+#endif
+
+    if (Display == EGL_NO_DISPLAY) {
+        Display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    return Display;
+}
+
+
+void egl_init_headless(int major_ver, int minor_ver)
+{
+    EGLDisplay Display = get_display();
+
+    EGLint Major, Minor;
+
+    if ((Display == EGL_NO_DISPLAY) || !eglInitialize(Display, &Major, &Minor)) {
+        OGLDEV_ERROR0("Error initializing EGL");
+        exit(1);
+    }
+
+    printf("EGL %d.%d initialized\n", Major, Minor);
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        OGLDEV_ERROR0("EGL doesn't support OpenGL");
+        exit(1);
+    }
+
+    EGLint ContextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major_ver,
+        EGL_CONTEXT_MINOR_VERSION, minor_ver,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    // No config and no surface - everything is rendered into FBOs and buffers
+    EGLContext Context = eglCreateContext(Display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, ContextAttribs);
+
+    if (Context == EGL_NO_CONTEXT) {
+        OGLDEV_ERROR("Error creating an OpenGL %d.%d core context (EGL error 0x%x)", major_ver, minor_ver, eglGetError());
+        exit(1);
+    }
+
+    if (!eglMakeCurrent(Display, EGL_NO_SURFACE, EGL_NO_SURFACE, Context)) {
+        OGLDEV_ERROR("Error making the context current (EGL error 0x%x)", eglGetError());
+        exit(1);
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum res = glewInit();
+
+    // GLEW which was built for GLX also tries to load the GLX extensions and fails without an X display
+    if ((res != GLEW_OK) && (res != GLEW_ERROR_NO_GLX_DISPLAY)) {
+        OGLDEV_ERROR0((const char*)glewGetErrorString(res));
+        exit(1);
+    }
+
+    printf("GL version: %s\n", glGetString(GL_VERSION));
+    printf("GL renderer: %s\n", glGetString(GL_RENDERER));
+}
@@ -0,0 +1,208 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <math.h>
+
+#include "ogldev_thread_pool.h"
+#include "ogldev_normal_baker.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define NORMAL_BAKER_SSE
+#include <emmintrin.h>
+#endif
+
+#define NORMAL_BAKER_ROWS_PER_BATCH 16
+
+
+// The slopes along X and Z are the derivatives of the height (already multiplied by the height scale)
+static inline void StoreNormal(float SlopeX, float SlopeZ, Vector3f* pNormal, Vector3f* pTangent)
+{
+    float InvLen = 1.0f / sqrtf(SlopeX * SlopeX + 1.0f + SlopeZ * SlopeZ);
+    *pNormal = Vector3f(-SlopeX * InvLen, InvLen, -SlopeZ * InvLen);
+
+    if (pTangent) {
+        float InvLenT = 1.0f / sqrtf(1.0f + SlopeX * SlopeX);
+        *pTangent = Vector3f(InvLenT, SlopeX * InvLenT, 0.0f);
+    }
+}
+
+
+static void BakeRow(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                    int z, Vector3f* pNormals, Vector3f* pTangents)
+{
+    int Up = (z > 0) ? z - 1 : z;
+    int Down = (z < Depth - 1) ? z + 1 : z;
+
+    const float* pRow = &pHeights[z * Width];
+    const float* pRowUp = &pHeights[Up * Width];
+    const float* pRowDown = &pHeights[Down * Width];
+
+    Vector3f* pRowNormals = &pNormals[z * Width];
+    Vector3f* pRowTangents = pTangents ? &pTangents[z * Width] : NULL;
+
+    float DistZ = (float)(Down - Up) * WorldScale;
+    float FactorZ = (DistZ > 0.0f) ? HeightScale / DistZ : 0.0f;
+
+    // Central differences in the interior of the row
+    float FactorX = HeightScale / (2.0f * WorldScale);
+
+    int x = 1;
+
+#ifdef NORMAL_BAKER_SSE
+    __m128 FactorX4 = _mm_set1_ps(FactorX);
+    __m128 FactorZ4 = _mm_set1_ps(FactorZ);
+    __m128 One = _mm_set1_ps(1.0f);
+
+    for ( ; x + 4 <= Width - 1; x += 4) {
+        __m128 SlopeX = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pRow + x + 1), _mm_loadu_ps(pRow + x - 1)), FactorX4);
+        __m128 SlopeZ = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pRowDown + x), _mm_loadu_ps(pRowUp + x)), FactorZ4);
+
+        __m128 SlopeX2 = _mm_mul_ps(SlopeX, SlopeX);
+        __m128 LenSq = _mm_add_ps(_mm_add_ps(SlopeX2, One), _mm_mul_ps(SlopeZ, SlopeZ));
+        __m128 InvLen = _mm_div_ps(One, _mm_sqrt_ps(LenSq));
+
+        float nx[4], ny[4], nz[4];
+        _mm_storeu_ps(nx, _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), SlopeX), InvLen));
+        _mm_storeu_ps(ny, InvLen);
+        _mm_storeu_ps(nz, _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), SlopeZ), InvLen));
+
+        for (int i = 0; i < 4; i++) {
+            pRowNormals[x + i] = Vector3f(nx[i], ny[i], nz[i]);
+        }
+
+        if (pRowTangents) {
+            __m128 InvLenT = _mm_div_ps(One, _mm_sqrt_ps(_mm_add_ps(One, SlopeX2)));
+
+            float tx[4], ty[4];
+            _mm_storeu_ps(tx, InvLenT);
+            _mm_storeu_ps(ty, _mm_mul_ps(SlopeX, InvLenT));
+
+            for (int i = 0; i < 4; i++) {
+                pRowTangents[x + i] = Vector3f(tx[i], ty[i], 0.0f);
+            }
+        }
+    }
+#endif
+
+    for ( ; x < Width - 1; x++) {
+        float SlopeX = (pRow[x + 1] - pRow[x - 1]) * FactorX;
+        float SlopeZ = (pRowDown[x] - pRowUp[x]) * FactorZ;
+
+        StoreNormal(SlopeX, SlopeZ, &pRowNormals[x], pRowTangents ? &pRowTangents[x] : NULL);
+    }
+
+    // One sided differences on the edges
+    int EdgeX[2] = { 0, Width - 1 };
+    int NumEdges = (Width > 1) ? 2 : 1;
+
+    for (int i = 0; i < NumEdges; i++) {
+        x = EdgeX[i];
+
+        int Left = (x > 0) ? x - 1 : x;
+        int Right = (x < Width - 1) ? x + 1 : x;
+
+        float DistX = (float)(Right - Left) * WorldScale;
+        float SlopeX = (DistX > 0.0f) ? (pRow[Right] - pRow[Left]) * HeightScale / DistX : 0.0f;
+        float SlopeZ = (pRowDown[x] - pRowUp[x]) * FactorZ;
+
+        StoreNormal(SlopeX, SlopeZ, &pRowNormals[x], pRowTangents ? &pRowTangents[x] : NULL);
+    }
+}
+
+
+void BakeHeightFieldNormals(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                            Vector3f* pNormals, Vector3f* pTangents)
+{
+    if ((Width <= 0) || (Depth <= 0)) {
+        return;
+    }
+
+    ThreadPool::GetDefault().ParallelFor(Depth, NORMAL_BAKER_ROWS_PER_BATCH, [&](int Start, int End) {
+        for (int z = Start; z < End; z++) {
+            BakeRow(pHeights, Width, Depth, WorldScale, HeightScale, z, pNormals, pTangents);
+        }
+    });
+}
+
+
+void BakeHeightFieldNormals(const Array2D<float>& Heights, float WorldScale, float HeightScale,
+                            std::vector<Vector3f>& Normals)
+{
+    Normals.resize(Heights.GetSize());
+
+    BakeHeightFieldNormals(Heights.GetBaseAddr(), Heights.GetWidth(), Heights.GetHeight(),
+                           WorldScale, HeightScale, Normals.data());
+}
+
+
+void BakeNormalMap(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                   std::vector<unsigned char>& NormalMap)
+{
+    std::vector<Vector3f> Normals(Width * Depth);
+
+    BakeHeightFieldNormals(pHeights, Width, Depth, WorldScale, HeightScale, Normals.data());
+
+    NormalMap.resize(Width * Depth * 3);
+
+    ThreadPool::GetDefault().ParallelFor(Width * Depth, NORMAL_BAKER_ROWS_PER_BATCH * Width, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            NormalMap[i * 3]     = (unsigned char)((Normals[i].x * 0.5f + 0.5f) * 255.0f + 0.5f);
+            NormalMap[i * 3 + 1] = (unsigned char)((Normals[i].y * 0.5f + 0.5f) * 255.0f + 0.5f);
+            NormalMap[i * 3 + 2] = (unsigned char)((Normals[i].z * 0.5f + 0.5f) * 255.0f + 0.5f);
+        }
+    });
+}
+
+
+void BakeHeightFieldNormalsFromFaces(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                                     Vector3f* pNormals)
+{
+    for (int i = 0; i < Width * Depth; i++) {
+        pNormals[i] = Vector3f(0.0f, 0.0f, 0.0f);
+    }
+
+    // The ring of a 2x2 fan in the order of GeomipGrid::CreateTriangleFan
+    static const int RingX[9] = { 0, 0, 0, 1, 2, 2, 2, 1, 0 };
+    static const int RingZ[9] = { 0, 1, 2, 2, 2, 1, 0, 0, 0 };
+
+    for (int z = 0; z < Depth - 2; z += 2) {
+        for (int x = 0; x < Width - 2; x += 2) {
+            int CenterIndex = (z + 1) * Width + x + 1;
+            Vector3f Center((x + 1) * WorldScale, pHeights[CenterIndex] * HeightScale, (z + 1) * WorldScale);
+
+            for (int i = 0; i < 8; i++) {
+                int Index1 = (z + RingZ[i]) * Width + x + RingX[i];
+                int Index2 = (z + RingZ[i + 1]) * Width + x + RingX[i + 1];
+
+                Vector3f v1((x + RingX[i]) * WorldScale, pHeights[Index1] * HeightScale, (z + RingZ[i]) * WorldScale);
+                Vector3f v2((x + RingX[i + 1]) * WorldScale, pHeights[Index2] * HeightScale, (z + RingZ[i + 1]) * WorldScale);
+
+                Vector3f Normal = (v1 - Center).Cross(v2 - Center);
+                Normal.Normalize();
+
+                pNormals[CenterIndex] += Normal;
+                pNormals[Index1] += Normal;
+                pNormals[Index2] += Normal;
+            }
+        }
+    }
+
+    for (int i = 0; i < Width * Depth; i++) {
+        pNormals[i].Normalize();
+    }
+}
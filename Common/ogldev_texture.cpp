@@ -80,11 +80,23 @@ void Texture::Load(int Width, int Height, int BPP, const void* pData)
         } else {
             NOT_IMPLEMENTED;
         }
+    } else if (m_config.m_numChannels == 3) {
+        if (!m_config.m_isFloat) {
+            pImageData = pData;
+            m_imageBPP = 3;     // GL_RGB8
+        } else {
+            NOT_IMPLEMENTED;
+        }
     } else {
         NOT_IMPLEMENTED;
     }
 
+    // The rows of tightly packed RGB8 data are not 4 byte aligned unless the width is a multiple of 4
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
     LoadInternal(pImageData, false);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 bool Texture::Load(bool IsSRGB)
@@ -343,12 +355,17 @@ void Texture::Update(const void* pImageData)
 
     if ((m_config.m_numChannels == 1) && (m_config.m_isFloat)) {
         glTextureSubImage2D(m_textureObj, 0, 0, 0, m_imageWidth, m_imageHeight, GL_RED, GL_FLOAT, pImageData);
-        if (m_config.m_genMipmaps) {
-            glGenerateTextureMipmap(m_textureObj);
-        }
+    } else if ((m_config.m_numChannels == 3) && (!m_config.m_isFloat)) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTextureSubImage2D(m_textureObj, 0, 0, 0, m_imageWidth, m_imageHeight, GL_RGB, GL_UNSIGNED_BYTE, pImageData);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     } else {
         NOT_IMPLEMENTED;
-    }    
+    }
+
+    if (m_config.m_genMipmaps) {
+        glGenerateTextureMipmap(m_textureObj);
+    }
 }
 
 
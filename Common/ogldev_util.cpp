@@ -23,6 +23,7 @@
 #include <Windows.h>
 #else
 #include <sys/time.h>
+#include <sys/mman.h>
 #endif
 
 #ifndef VULKAN
@@ -201,6 +202,143 @@ void WriteBinaryFile(const char* pFilename, const void* pData, int size)
 #endif
 
 
+#ifdef _WIN32
+bool MemoryMappedFile::Open(const char* pFilename)
+{
+    Close();
+
+    HANDLE hFile = CreateFileA(pFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER FileSize;
+
+    if (!GetFileSizeEx(hFile, &FileSize) || (FileSize.QuadPart == 0)) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (!hMapping) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    const void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!pData) {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    m_hFile = hFile;
+    m_hMapping = hMapping;
+    m_pData = (const char*)pData;
+    m_size = (size_t)FileSize.QuadPart;
+
+    return true;
+}
+
+
+void MemoryMappedFile::Close()
+{
+    if (m_pData) {
+        UnmapViewOfFile(m_pData);
+        CloseHandle((HANDLE)m_hMapping);
+        CloseHandle((HANDLE)m_hFile);
+        m_pData = NULL;
+        m_hMapping = NULL;
+        m_hFile = NULL;
+        m_size = 0;
+    }
+}
+
+
+void MemoryMappedFile::Evict(size_t Offset, size_t Size) const
+{
+    assert(Offset + Size <= m_size);
+
+    // Unlocking pages which are not locked removes them from the working set
+    VirtualUnlock((void*)(m_pData + Offset), Size);
+}
+
+#else
+
+bool MemoryMappedFile::Open(const char* pFilename)
+{
+    Close();
+
+    int fd = open(pFilename, O_RDONLY);
+
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat stat_buf;
+
+    if (fstat(fd, &stat_buf) || (stat_buf.st_size == 0)) {
+        close(fd);
+        return false;
+    }
+
+    void* pData = mmap(NULL, stat_buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+
+    if (pData == MAP_FAILED) {
+        return false;
+    }
+
+    m_pData = (const char*)pData;
+    m_size = stat_buf.st_size;
+
+    return true;
+}
+
+
+void MemoryMappedFile::Close()
+{
+    if (m_pData) {
+        munmap((void*)m_pData, m_size);
+        m_pData = NULL;
+        m_size = 0;
+    }
+}
+
+
+void MemoryMappedFile::Evict(size_t Offset, size_t Size) const
+{
+    assert(Offset + Size <= m_size);
+
+    // madvise requires a page aligned address
+    size_t PageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t Start = Offset & ~(PageSize - 1);
+
+    madvise((void*)(m_pData + Start), Offset + Size - Start, MADV_DONTNEED);
+}
+#endif
+
+
+u64 HashBuffer(const void* pData, size_t Size, u64 Seed)
+{
+    const unsigned char* p = (const unsigned char*)pData;
+
+    u64 Hash = Seed;
+
+    for (size_t i = 0; i < Size; i++) {
+        Hash ^= p[i];
+        Hash *= 0x100000001b3ULL;
+    }
+
+    return Hash;
+}
+
+
 void OgldevError(const char* pFileName, uint line, const char* format, ...)
 {
     char msg[1000];
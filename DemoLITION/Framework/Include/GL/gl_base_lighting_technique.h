@@ -22,6 +22,8 @@
 #include "ogldev_math_3d.h"
 #include "Int/core_material.h"
 #include "Int/core_model.h"
+#include "Int/core_light_clusters.h"
+#include "Int/core_shadow_cascades.h"
 
 class BaseLightingTechnique : public Technique
 {
@@ -43,6 +45,7 @@ public:
     virtual void ControlCubemapping(bool Enable) {}
     virtual void SetCubeMipmapLevel(int Level) {}
     virtual void SetProjectionMatrix(const Matrix4f& m) {}
+    virtual void SetShadowCascades(int NumCascades, const Matrix4f& CameraView, const ShadowCascades& Cascades) {} // zero disables the cascades
 
     void SetWVP(const Matrix4f& WVP);
     void SetWorldMatrix(const Matrix4f& WVP);
@@ -55,6 +58,8 @@ public:
     void ControlIndirectRender(bool IsRenderIndirect);
     void ControlPVP(bool IsPVP);
     void SetNumLights(int NumLights);
+    void SetLightClusters(int NumGlobalLights, const Matrix4f& View, const LightClusters& Clusters,
+                          int WindowWidth, int WindowHeight);
     void SetRenderMode(RENDER_MODE mode);
 
 protected:
@@ -74,6 +79,10 @@ private:
     GLuint IsPVPLoc = INVALID_UNIFORM_LOCATION;
     GLuint VPLoc = INVALID_UNIFORM_LOCATION;
     GLuint NumLightsLoc = INVALID_UNIFORM_LOCATION;
+    GLuint NumGlobalLightsLoc = INVALID_UNIFORM_LOCATION;
+    GLuint ClusterViewLoc = INVALID_UNIFORM_LOCATION;
+    GLuint ClusterTileScaleLoc = INVALID_UNIFORM_LOCATION;
+    GLuint ClusterDepthParamsLoc = INVALID_UNIFORM_LOCATION;
     DEF_LOC(gRenderMode);
 };
 
@@ -22,6 +22,7 @@
 #include <string>
 
 #include "ogldev_math_3d.h"
+#include "Int/core_mesh.h"
 
 struct BasicMeshEntry {
     uint NumIndices = 0;
@@ -31,5 +32,23 @@ struct BasicMeshEntry {
     uint ValidFaces = 0;
     int MaterialIndex = -1;
     Matrix4f Transformation;
+    AABB Bounds;            // in the local space of the mesh (before Transformation)
     std::string Name;
+
+    // The simplified versions of the mesh (see CoreModel::GenerateLods). LOD 0 is the full
+    // mesh. The offsets are relative to BaseIndex and the errors are the max distance from
+    // the full mesh in its local space.
+    uint LodCount = 1;
+    uint LodOffsets[MAX_LOD_COUNT + 1] = { 0 };
+    float LodErrors[MAX_LOD_COUNT] = { 0.0f };
+
+    uint GetLodFirstIndex(uint Lod) const
+    {
+        return (Lod < LodCount) ? BaseIndex + LodOffsets[Lod] : BaseIndex;
+    }
+
+    uint GetLodIndicesCount(uint Lod) const
+    {
+        return ((Lod > 0) && (Lod < LodCount)) ? LodOffsets[Lod + 1] - LodOffsets[Lod] : NumIndices;
+    }
 };
@@ -0,0 +1,132 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "Int/core_light_clusters.h"
+#include "GL/gl_light_clustering_technique.h"
+
+
+enum LIGHT_TYPE {
+    LIGHT_TYPE_DIR,
+    LIGHT_TYPE_POINT,
+    LIGHT_TYPE_SPOT
+};
+
+
+struct LightSource {
+    // Offset 0
+    glm::vec3 Color;                // ALL                12 bytes
+    LIGHT_TYPE LightType;           // ALL                4 bytes
+
+    // Offset 16
+    glm::vec3 Direction;            // Dir and spot       12 bytes
+    float AmbientIntensity;         // ALL                4 bytes
+
+    // Offset 32
+    glm::vec3 WorldPos;             // spot and point     12 bytes
+    float DiffuseIntensity;         // ALL                4 bytes
+
+    // Offset 48
+    float Atten_Constant;           // Spot and point     4 bytes
+    float Atten_Linear;             // Spot and point     4 bytes
+    float Atten_Exp;                // Spot and point     4 bytes
+    float Cutoff;                   // spot               4 bytes
+
+    // Offset 64
+    int ShadowMapIndex;             // point              4 bytes (the cube map in the shadow cube map array, -1 for none)
+    int Padding[3];                 //                    12 bytes
+};
+
+
+static_assert(sizeof(LightSource) == 80, "LightSource struct must be 80 bytes");
+
+//
+// The light sources of the forward lighting shaders and their assignment to clusters.
+//
+// The lights are stored in an SSBO so there is no limit on their number. The first
+// lights are global (directional lights and lights without a range) and are applied
+// to all the pixels. The rest are assigned to the clusters of the view (see LightClusters)
+// and every pixel only goes over the lights of its own cluster.
+//
+// The assignment runs in a compute shader (light_clustering.cs) or on the CPU using
+// LightClusters::Assign() which is also used to validate the shader.
+//
+class ClusteredLighting
+{
+public:
+
+    ClusteredLighting() {}
+
+    ~ClusteredLighting();
+
+    void Init();
+
+    bool IsInitialized() const { return m_isInitialized; }
+
+    // Uploads the lights and assigns them to the clusters. The first NumGlobalLights lights
+    // are global and Spheres contains the world space position and radius of each of the
+    // others. The current program is restored when the assignment is done.
+    void Update(const Matrix4f& View, 
+                const Matrix4f& Projection, 
+                float zNear, 
+                float zFar,
+                const std::vector<LightSource>& Lights, 
+                int NumGlobalLights,
+                const std::vector<Vector4f>& Spheres,
+                bool UseGPU);
+
+    // Binds the lights and the clusters for the lighting shaders
+    void Bind();
+
+    int GetNumLights() const { return m_numLights; }
+
+    int GetNumGlobalLights() const { return m_numGlobalLights; }
+
+    const LightClusters& GetClusters() const { return m_clusters; }
+
+    const Matrix4f& GetView() const { return m_view; }
+
+    // Reads back the clusters of the last Update() (slow - for testing only)
+    void ReadClusters(std::vector<uint>& Counts, std::vector<uint>& Indices);
+
+private:
+
+    void ReserveLights(int NumLights);
+
+    LightClusteringTechnique m_clusteringTech;
+    LightClusters m_clusters;
+    bool m_isInitialized = false;
+
+    GLuint m_lightsBuffer = 0;
+    GLuint m_spheresBuffer = 0;
+    GLuint m_boxesBuffer = 0;
+    GLuint m_clustersBuffer = 0;        // the number of lights in each cluster followed by their indices
+    int m_capacity = 0;                 // in lights
+
+    int m_numLights = 0;
+    int m_numGlobalLights = 0;
+    Matrix4f m_view;
+
+    // CPU assignment
+    std::vector<uint> m_counts;
+    std::vector<uint> m_indices;
+};
@@ -56,6 +56,8 @@
 #define CLEARCOAT_NORMAL_TEXTURE_UNIT_INDEX         17
 #define PROJECTED_TEXTURE_UNIT                      GL_TEXTURE18
 #define PROJECTED_TEXTURE_UNIT_INDEX                18
+#define SHADOW_CASCADES_TEXTURE_UNIT                GL_TEXTURE19
+#define SHADOW_CASCADES_TEXTURE_UNIT_INDEX          19
 
 #define DEPTH_TEXTURE_UNIT                          SHADOW_TEXTURE_UNIT
 #define DEPTH_TEXTURE_UNIT_INDEX                    SHADOW_TEXTURE_UNIT_INDEX
\ No newline at end of file
@@ -45,10 +45,12 @@ public:
     virtual void ControlCubemapping(bool IsEnabled);
     virtual void SetCubeMipmapLevel(int Level);
     virtual void SetProjectionMatrix(const Matrix4f& m);
+    virtual void SetShadowCascades(int NumCascades, const Matrix4f& CameraView, const ShadowCascades& Cascades);
 
     void SetTextureUnit(unsigned int TextureUnit);
     void SetShadowMapTextureUnit(unsigned int TextureUnit);
     void SetShadowCubeMapTextureUnit(unsigned int TextureUnit);
+    void SetShadowCascadesTextureUnit(unsigned int TextureUnit);
     void SetShadowMapSize(unsigned int Width, unsigned int Height);
     void SetShadowMapFilterSize(unsigned int Size);
     void SetShadowMapOffsetTextureUnit(unsigned int TextureUnit);
@@ -116,6 +118,12 @@ private:
     DEF_LOC(gCubeMipmapLevel);
     DEF_LOC(gProjectedTexture);
     DEF_LOC(gProjectionMatrix);
+    DEF_LOC(gShadowCascades);
+    DEF_LOC(gNumShadowCascades);
+    DEF_LOC(gShadowCascadeView);
+    DEF_LOC(gShadowCascadeVP);
+    DEF_LOC(gShadowCascadeSplits);
+    DEF_LOC(gShadowCascadeTexelSizes);
 
     struct {
         GLuint AmbientColor = INVALID_UNIFORM_LOCATION;
@@ -19,11 +19,10 @@
 #pragma once 
 
 #include "ogldev_basic_glfw_camera.h"
-#include "ogldev_shadow_mapping_technique_point_light.h"
-#include "ogldev_shadow_cube_map_fbo.h"
 #include "ogldev_framebuffer.h"
 #include "demolition_rendering_system.h"
 #include "Int/core_model.h"
+#include "Int/core_render_list_culler.h"
 #include "gl_forward_lighting.h"
 #include "gl_forward_skinning.h"
 #include "gl_shadow_mapping_technique.h"
@@ -39,13 +38,20 @@
 #include "GL/gl_normal_technique.h"
 #include "GL/gl_buffer.h"
 #include "GL/gl_tone_map_technique.h"
-#include "GL/gl_hdr_technique.h"
+#include "GL/gl_hdr_luminance.h"
+#include "GL/gl_timer_query.h"
 #include "GL/gl_geometry_technique.h"
 #include "GL/gl_ssgi_technique.h"
 #include "GL/gl_bright_filter_technique.h"
 #include "GL/gl_blur_filter1_technique.h"
 #include "GL/gl_blur_filter2_technique.h"
 #include "GL/gl_terrain_technique.h"
+#include "GL/gl_scene_indirect_render.h"
+#include "GL/gl_clustered_lighting.h"
+#include "GL/gl_shadow_cube_map_technique.h"
+#include "GL/gl_shadow_cube_map_array.h"
+#include "GL/gl_shadow_map_array.h"
+#include "Int/core_shadow_cascades.h"
 
 
 enum RENDER_PASS {
@@ -71,38 +77,6 @@ enum LIGHTING_TECHNIQUE {
 };
 
 
-enum LIGHT_TYPE {
-    LIGHT_TYPE_DIR,
-    LIGHT_TYPE_POINT,
-    LIGHT_TYPE_SPOT
-};
-
-
-struct LightSource {
-    // Offset 0
-    glm::vec3 Color;                // ALL                12 bytes
-    LIGHT_TYPE LightType;           // ALL                4 bytes
-
-    // Offset 16
-    glm::vec3 Direction;            // Dir and spot       12 bytes
-    float AmbientIntensity;         // ALL                4 bytes
-
-    // Offset 32
-    glm::vec3 WorldPos;             // spot and point     12 bytes
-    float DiffuseIntensity;         // ALL                4 bytes
-
-    // Offset 48
-    float Atten_Constant;           // Spot and point     4 bytes
-    float Atten_Linear;             // Spot and point     4 bytes
-    float Atten_Exp;                // Spot and point     4 bytes
-    float Cutoff;                   // spot               4 bytes
-};
-
-
-static_assert(sizeof(LightSource) == 64, "LightSource struct must be 64 bytes");
-
-#define MAX_NUM_LIGHTS 4
-
 class RenderingSystemGL;
 
 class ForwardRenderer : public DemolitionRenderCallbacks {
@@ -149,19 +123,22 @@ private:
     void SavePickedObject(GLScene* pScene, int ObjectIndex);
     void PrePass(GLScene* pScene);
     void ShadowMapPass(GLScene* pScene);
-    void ShadowMapPassPoint(const std::list<CoreSceneObject*>& RenderList, const std::vector<PointLight>& PointLights);
-    void ShadowMapPassDirAndSpot(const std::list<CoreSceneObject*>& RenderList);
+    void ShadowMapPassPoint(GLScene* pScene);
+    void ShadowMapPassCascades(GLScene* pScene);
+    void RenderCubeMapObjects(const std::vector<CoreSceneObject*>& Objects, const std::vector<uint>& FaceMasks, PointShadowStats& Stats);
+    void ShadowMapPassDirAndSpot(const Matrix4f& LightVP);
     void PostProcessPass(GLScene* pScene);
     void NormalPass(GLScene* pScene);
     void LightingPass(GLScene* pScene, double TotalRuntime);
     void LightingPassFBOSetup(GLScene* pScene);
-    void HDRPassGPU(float& AvgLogLum, float& Exposure);
-    void HDRPassCPU(float& AvgLogLum, float& Exposure);
+    void HDRPassGPU(GLScene* pScene);
+    void HDRPassCPU(GLScene* pScene);
     void UpdateLightSources(GLScene* pScene);
+    void UpdateLightClusters(GLScene* pScene);
     void SetupLightSourcesArray(GLScene* pScene);
     void SSAOPass(GLScene* pScene);
     void SSAOCombinePass();
-    void ToneMappingPass(GLScene* pScene, float AverageLuminance, float Exposure);
+    void ToneMappingPass(GLScene* pScene);
     void GBufferPass(GLScene* pScene);
     void BrightPass(GLScene* pScene, float AverageLuminance);
     void BlurFilter1Pass(GLScene* pScene);
@@ -169,7 +146,14 @@ private:
     void SSGIPass(GLScene* pScene);
     void FullScreenQuadBlit(GLScene* pScene);
     void BindShadowMaps();
+    void CullRenderList(GLScene* pScene);
+
+    void PrepareMeshLod(GLScene* pScene);
+    void CullShadowView(SceneConfig* pConfig, const Matrix4f& LightVP);
     void RenderObjectList(GLScene* pScene, double TotalRuntime);
+    void RenderObjectListSceneIndirect(GLScene* pScene, double TotalRuntime);
+    bool IsSceneIndirectLightingSupported(CoreSceneObject* pSceneObject) const;
+    void UpdateBonePalettes(GLScene* pScene, double TotalRuntime);
     void RenderWithForwardLighting(GLScene* pScene, CoreSceneObject* pSceneObject, double TotalRuntime);
     void StartRenderWithForwardLighting(GLScene* pScene, CoreSceneObject* pSceneObject, double TotalRuntime);
     void RenderInfiniteGrid(GLScene* pScene);
@@ -186,7 +170,8 @@ private:
     void SetWorldMatrix_CB_PickingPass(const Matrix4f& World);
     void SetWorldMatrix_CB_NormalPass(const Matrix4f& World);	
     void SetWorldMatrix_CB_GBufferPass(const Matrix4f& World);
-    void RenderEntireRenderList(const std::list<CoreSceneObject*>& RenderList);
+    void RenderEntireRenderList(const std::vector<CoreSceneObject*>& RenderList, const Matrix4f& ViewProj);
+    const Matrix4f* GetGPUCullingVP(const Matrix4f& ViewProj) const;
     Matrix4f GetViewProjectionMatrix();
     void RenderSingleObject(CoreSceneObject* pSceneObject);
     void SetRenderToDefaultFB();
@@ -208,16 +193,54 @@ private:
 	Framebuffer m_brightFilterFBO[2];
     GLBuffer m_ssaoParams;
     Texture m_ssaoRotTexture;
-    GLBuffer m_lightParams;
     std::vector<LightSource> m_lightSources;
+    std::vector<Vector4f> m_lightSpheres;     // the lights after the global ones
+    std::vector<LightSource> m_clusteredLightSources;
+    int m_numGlobalLights = 0;
+    ClusteredLighting m_clusteredLighting;
     std::vector<float> m_hdrData;
-    GLBuffer m_luminanceBuffer;
+    HDRLuminance m_hdrLuminance;
+
+    // The bone palettes of all the animated objects in the render list
+    std::vector<Matrix4f> m_bonePalette;
+    std::map<const CoreSceneObject*, int> m_boneBase;   // first bone of each object in the palette
+    GLuint m_bonePaletteBuffer = 0;
+    size_t m_bonePaletteBufferSize = 0;
+
+    // Culling
+    RenderListCuller m_culler;
+    std::vector<CoreSceneObject*> m_cameraVisibleList;
+    std::vector<CoreSceneObject*> m_shadowVisibleList;
+
+    // Scene wide indirect render (UseSceneIndirectRender)
+    SceneIndirectRender m_sceneIndirectRender;
+    std::vector<CoreSceneObject*> m_sceneNotRenderedList;  // objects left for the per object path
+    CullingStats m_cameraCullingStats;
+    CullingStats m_shadowCullingStats;
+
+    // Mesh LOD (SceneConfig::ControlMeshLod). All the passes use the LODs of the main camera.
+    struct {
+        bool Enabled = false;
+        Vector3f CameraPos;
+        float ProjScale = 0.0f;
+        float MaxPixelError = 1.0f;
+        MeshLodStats Stats;
+        std::vector<uint> Lods;     // scratch space for the current object
+    } m_meshLod;
+
+    GLTimerQuery m_shadowPassTimer;
+    GLTimerQuery m_lightingPassTimer;
 
     // Shadow stuff
     Framebuffer m_shadowMapFBO;
-    ShadowCubeMapFBO m_shadowCubeMapFBO;
+    ShadowCascades m_shadowCascades;         // the first directional light
+    ShadowMapArray m_cascadeShadowMaps;
+    Matrix4f m_curLightVP;                   // the current cascade
+    int m_frameIndex = 0;
+    ShadowCubeMapArray m_shadowCubeMaps;     // the first point lights (see GetNumPointLightShadows)
+    std::vector<uint> m_shadowFaceMasks;     // the cube map faces of each object in m_shadowVisibleList
+    PointShadowStats m_pointShadowStats;
     Matrix4f m_lightPersProjMatrix;
-    Matrix4f m_lightOrthoProjMatrix;
     Matrix4f m_lightViewMatrix;
 
     LIGHTING_TECHNIQUE m_curLightingTechId = UNDEFINED_TECHNIQUE;
@@ -226,7 +249,7 @@ private:
     ForwardSkinningTechnique m_skinningTech;
     NormalTechnique m_normalTech;
     ShadowMappingTechnique m_shadowMapTech;
-    ShadowMappingPointLightTechnique m_shadowMapPointLightTech;
+    ShadowCubeMapTechnique m_shadowCubeMapTech;
     PickingTechnique m_pickingTech;
     PBRForwardLightingTechnique m_pbrLightingTech;
     PBRSkinningTechnique m_pbrSkinnedTech;
@@ -237,15 +260,14 @@ private:
     SSAOCombineTechnique m_ssaoCombineTech;
     ToneMapTechnique m_toneMapTech;
     ToneMapTechnique m_toneMapTechWithBloom;
-    HDRTechnique m_hdrTech;
     GeometryTechnique m_geometryTech;
     SSGITechnique m_ssgiTech;
     BlurFilter1Technique m_blurFilter1Tech;
     BlurFilter2Technique m_blurFilter2Tech;
     TerrainTechnique m_terrainTech;
+    TerrainClipmapTechnique m_terrainClipmapTech;
 
-    int m_hdrNumGroupsX = 0;
-    int m_hdrNumGroupsY = 0;
+    float m_deltaTime = 0.0f;       // of the current frame in seconds
 
     InfiniteGrid m_infiniteGrid;
 
@@ -31,10 +31,11 @@ public:
 
     virtual bool Init();
 
-    void SetBoneTransform(uint Index, const Matrix4f& Transform);
+    // Index of the first bone of the current object in the bone palette SSBO
+    void SetBoneBase(int BoneBase);
 
 private:
-    GLuint m_boneLocation[MAX_BONES];
+    GLuint m_boneBaseLoc = INVALID_UNIFORM_LOCATION;
 };
 
 
@@ -46,9 +47,10 @@ public:
 
     virtual bool Init();
 
-    void SetBoneTransform(uint Index, const Matrix4f& Transform);
+    // Index of the first bone of the current object in the bone palette SSBO
+    void SetBoneBase(int BoneBase);
 
 private:
-    GLuint m_boneLocation[MAX_BONES];
+    GLuint m_boneBaseLoc = INVALID_UNIFORM_LOCATION;
 };
 
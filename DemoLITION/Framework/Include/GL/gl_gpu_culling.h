@@ -0,0 +1,87 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "GL/gl_indirect_render.h"
+#include "GL/gl_gpu_culling_technique.h"
+
+//
+// Frustum culling of indirect draws on the GPU.
+//
+// Cull() tests the world space box of every draw against the frustum in a compute
+// shader (gpu_culling.cs) and compacts the commands and the per object data of the
+// visible draws into buffers owned by this class. Draw() submits them with
+// glMultiDrawElementsIndirectCount so the number of visible draws never goes
+// back to the CPU.
+//
+// CullReference() is the CPU version of the shader which is used to validate it.
+//
+class GPUCulling
+{
+public:
+
+    GPUCulling() {}
+
+    ~GPUCulling();
+
+    void Init();
+
+    bool IsInitialized() const { return m_isInitialized; }
+
+    // The per object data, draw commands and mesh bounds of NumDraws draws are
+    // taken from Buffer at the given offsets (each one aligned for SSBO binding).
+    // The current program is restored when the culling is done.
+    void Cull(const Matrix4f& ViewProj, GLuint Buffer, 
+              size_t DataOffset, size_t CmdsOffset, size_t BoundsOffset, int NumDraws);
+
+    // Draws the visible draws of the last Cull(). The geometry and the materials
+    // must already be bound.
+    void Draw();
+
+    // Reads back the visible draws of the last Cull() (slow - for testing only).
+    // The BaseInstance of each command is the index of the draw in the input.
+    void ReadVisibleDraws(std::vector<IndirectRender::DrawElementsIndirectCommand>& Cmds,
+                          std::vector<IndirectRender::PerObjectData>& Data);
+
+    // The indices of the draws which Cull() is expected to keep. Draws whose distance
+    // from one of the planes is within Tolerance may go either way on the GPU so they
+    // are returned in Borderline instead.
+    static void CullReference(const Matrix4f& ViewProj, 
+                              const IndirectRender::PerObjectData* pData, 
+                              const IndirectRender::MeshBounds* pBounds, 
+                              int NumDraws,
+                              float Tolerance,
+                              std::vector<int>& VisibleDraws,
+                              std::vector<int>& BorderlineDraws);
+
+private:
+
+    void ReserveOutput(int NumDraws);
+
+    GPUCullingTechnique m_cullingTech;
+    bool m_isInitialized = false;
+
+    GLuint m_visibleCmdsBuffer = 0;     // the number of visible draws followed by their commands
+    GLuint m_visibleDataBuffer = 0;
+    int m_capacity = 0;                 // in draws
+    int m_numDraws = 0;                 // input of the last Cull()
+};
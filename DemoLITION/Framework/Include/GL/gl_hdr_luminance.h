@@ -0,0 +1,99 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "GL/gl_hdr_technique.h"
+#include "GL/gl_hdr_adapt_technique.h"
+
+
+// Must match LuminanceSSBO in hdr_adapt.cs and the tone mapping shaders
+struct HDRLuminanceState {
+    float AverageLuminance = 0.0f;  // of the current frame
+    float AdaptedLuminance = 0.0f;
+    float Exposure = 0.0f;
+    uint IsValid = 0;               // zero until the first update
+};
+
+static_assert(sizeof(HDRLuminanceState) == 16, "HDRLuminanceState struct must be 16 bytes");
+
+//
+// The average luminance of the HDR buffer and the exposure of the tone mapping.
+//
+// Update() reduces the log luminance of the HDR buffer in two compute passes (16x16
+// tiles in hdr.cs and then all the tiles in hdr_adapt.cs) and adapts the luminance
+// of the previous frame towards the new average. The results stay in a GPU buffer
+// which is read by the tone mapping shaders so the frame never waits for them.
+//
+// The CPU reads a copy of the results when the GPU is done with it (a few frames
+// later) without blocking. UpdateFromCPU() uploads an average which was calculated
+// on the CPU instead and is used to validate the compute shaders.
+//
+class HDRLuminance
+{
+public:
+
+    HDRLuminance() {}
+
+    ~HDRLuminance();
+
+    void Init(int Width, int Height);
+
+    // The HDR buffer must be bound to texture unit 0. A zero rate means no adaptation.
+    void Update(float DeltaTime, float AdaptationRate);
+
+    void UpdateFromCPU(float AverageLuminance, float DeltaTime, float AdaptationRate);
+
+    // Binds the results for the tone mapping shaders
+    void Bind();
+
+    // The results of an earlier frame (doesn't block)
+    const HDRLuminanceState& GetLastState();
+
+    // Waits for the results of the last Update() (slow - for testing only)
+    void ReadState(HDRLuminanceState& State);
+
+    // The CPU reference of hdr.cs and hdr_adapt.cs. The average is accumulated in double precision.
+    static float CalcAverageLuminance(const float* pRGB, int NumPixels);
+
+    static float CalcAdaptedLuminance(float PrevAdapted, float AverageLuminance, float DeltaTime, float AdaptationRate);
+
+private:
+
+    void StartReadback();
+
+    HDRTechnique m_tileTech;
+    HDRAdaptTechnique m_adaptTech;
+
+    int m_numPixels = 0;
+    int m_numGroupsX = 0;
+    int m_numGroupsY = 0;
+
+    GLuint m_tilesBuffer = 0;
+    GLuint m_stateBuffer = 0;
+    GLuint m_readbackBuffer = 0;        // persistently mapped
+    HDRLuminanceState* m_pReadback = NULL;
+    GLsync m_readbackFence = 0;
+    HDRLuminanceState m_lastState;
+
+    HDRLuminanceState m_cpuState;       // see UpdateFromCPU
+};
@@ -20,6 +20,7 @@
 #pragma once
 
 #include <vector>
+#include <map>
 
 #include "ogldev_math_3d.h"
 #include "Int/core_material.h"
@@ -28,6 +29,44 @@
 class IndirectRender {
 
 public:
+
+    struct DrawElementsIndirectCommand {
+        unsigned int  Count = 0;
+        unsigned int  InstanceCount = 0;
+        unsigned int  FirstIndex = 0;
+        int           BaseVertex = 0;
+        unsigned int  BaseInstance = 0;
+    };
+
+    // MaterialIndex.x - index in the materials SSBO
+    // MaterialIndex.y - object index for picking (scene object id + 1)
+    // MaterialIndex.z - draw (mesh) index for picking
+    struct PerObjectData {
+        Matrix4f WorldMatrix;
+        Matrix4f NormalMatrix;
+        glm::ivec4 MaterialIndex = glm::ivec4(0);
+    };
+
+    // The local space box of a mesh for the GPU culling (see GPUCulling).
+    // Min.w is zero if the bounds are unknown and the mesh is always visible.
+    struct MeshBounds {
+        Vector4f Min = Vector4f(0.0f);
+        Vector4f Max = Vector4f(0.0f);
+    };
+
+    struct MaterialColorIndirect {
+        Vector4f AmbientColor;
+        Vector4f DiffuseColor;
+        Vector4f SpecularColor;
+    };
+
+    struct MaterialIndirect {
+        MaterialColorIndirect Color;
+        GLuint64 DiffuseMap;
+        GLuint64 NormalMap;
+    };
+
+    static void ConvertMaterials(const std::vector<CoreMaterial>& Materials, std::vector<MaterialIndirect>& MaterialsIndirect);
     
     IndirectRender() {}
 
@@ -35,44 +74,65 @@ public:
 
     void Init(const std::vector<BasicMeshEntry>& Meshes, const std::vector<CoreMaterial>& Materials);
 
-    void Render(const Matrix4f& ObjectMatrix);
+    // ObjectId identifies the scene object so that its per object data can be reused
+    // in the following passes and frames as long as its matrix doesn't change
+    void Render(const Matrix4f& ObjectMatrix, int ObjectId);
 
     void RefreshMaterials(const std::vector<CoreMaterial>& Materials);
 
+    //
+    // Scene indirect render - the geometry and materials of the model were added to
+    // the scene geometry (see GLSceneGeometry) at the following offsets
+    //
+    void SetSceneBase(int BaseVertex, int BaseIndex, int BaseMaterial);
+
+    int GetNumDraws() const { return (int)m_meshes.size(); }
+
+    // Writes GetNumDraws() commands and per object data for a single scene object.
+    // The mesh bounds are written only if pBounds is not NULL.
+    void WriteSceneDraws(const Matrix4f& ObjectMatrix, int ObjectId, 
+                         DrawElementsIndirectCommand* pCmds, PerObjectData* pData, MeshBounds* pBounds);
+
 private:
 
     void InitMeshes(const std::vector<BasicMeshEntry>& Meshes);
 
     void InitDrawCmdsBuffer(const std::vector<BasicMeshEntry>& Meshes);
 
-    void AllocPerObjectBuffer(const std::vector<BasicMeshEntry>& Meshes);
+    void UpdatePerObjectData(const Matrix4f& ObjectMatrix, int ObjectId);
 
-    void UpdatePerObjectData(const Matrix4f& ObjectMatrix);
+    const std::vector<PerObjectData>& GetPerObjectData(const Matrix4f& ObjectMatrix, int ObjectId);
+
+    void CalcPerObjectData(const Matrix4f& ObjectMatrix, int ObjectId, std::vector<PerObjectData>& Data);
 
     void PrepareIndirectRenderMaterials(const std::vector<CoreMaterial>& Materials);
 
-    struct MaterialColorIndirect {
-        Vector4f AmbientColor;
-        Vector4f DiffuseColor;
-        Vector4f SpecularColor;
-    };
-
-    struct MaterialIndirect {
-        MaterialColorIndirect Color;
-        GLuint64 DiffuseMap;
-        GLuint64 NormalMap;
-    };
+    void EvictObjectCache(int Frame);
 
     std::vector<MaterialIndirect> m_materials;
+    std::vector<DrawElementsIndirectCommand> m_drawCmds;
 
     GLuint m_drawCmdBuffer = 0;
-    GLuint m_perObjectBuffer = 0;
     GLuint m_materialsBuffer = 0;
 
     struct Mesh {
         Matrix4f m_transformation;
         int m_materialIndex = 0;
+        MeshBounds m_bounds;
     };
 
     std::vector<Mesh> m_meshes;
+
+    int m_sceneBaseVertex = 0;
+    int m_sceneBaseIndex = 0;
+    int m_sceneBaseMaterial = 0;
+
+    struct ObjectCache {
+        Matrix4f ObjectMatrix;
+        std::vector<PerObjectData> Data;
+        int LastFrame = 0;      // the last frame which rendered the object
+    };
+
+    std::map<int, ObjectCache> m_objectCache;
+    int m_lastEvictionFrame = 0;
 };
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include "technique.h"
+#include "ogldev_math_3d.h"
+
+class LightClusteringTechnique : public Technique
+{
+public:
+
+    LightClusteringTechnique();
+
+    virtual bool Init();
+
+    void SetNumLights(uint NumLights);
+
+    void SetFirstLight(uint FirstLight);
+
+    void SetView(const Matrix4f& View);
+
+private:
+
+    GLuint m_numLightsLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_firstLightLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_viewLoc = INVALID_UNIFORM_LOCATION;
+};
@@ -34,7 +34,8 @@ public:
 
     bool LoadMesh(const std::string& Filename);
 
-    void Render(DemolitionRenderCallbacks* pRenderCallbacks);
+    // pLods is the LOD of every mesh (see SelectLods) or NULL for the full meshes
+    void Render(DemolitionRenderCallbacks* pRenderCallbacks, const uint* pLods = NULL);
 
     void Render(uint DrawIndex, uint PrimID);
 
@@ -52,7 +53,12 @@ public:
 
     virtual void DestroyTexture(Texture* pTexture);
 
-    void RenderIndirect(const Matrix4f& ObjectMatrix);
+    void RenderIndirect(const Matrix4f& ObjectMatrix, int ObjectId);
+
+    // True if the geometry was added to GLSceneGeometry (UseSceneIndirectRender)
+    bool IsInSceneGeometry() const { return m_sceneBaseVertex >= 0; }
+
+    IndirectRender& GetIndirectRender() { return m_indirectRender; }
 
     Texture* GetNormalMap() const { return m_pNormalMap; }
 
@@ -84,7 +90,7 @@ private:
     template<typename VertexType>
     void PopulateBuffersDSA(vector<VertexType>& Vertices);
 
-    void RenderMesh(int MeshIndex, DemolitionRenderCallbacks* pRenderCallbacks = NULL);
+    void RenderMesh(int MeshIndex, DemolitionRenderCallbacks* pRenderCallbacks = NULL, uint Lod = 0);
 
     void BindTextures(int MaterialIndex);
 
@@ -97,6 +103,10 @@ private:
 
     IndirectRender m_indirectRender;
 
+    int m_sceneBaseVertex = -1;
+    int m_sceneBaseIndex = 0;
+    int m_sceneBaseMaterial = 0;
+
     Texture* m_pNormalMap = NULL;
     Texture* m_pHeightMap = NULL;
     Texture* m_pAOMap = NULL;
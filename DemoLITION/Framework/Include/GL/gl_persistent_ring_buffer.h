@@ -0,0 +1,85 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+
+//
+// A persistently mapped buffer which is split into one region per frame in flight.
+// The CPU writes the data of the current frame directly into the mapping while
+// the GPU is still reading the regions of the previous frames. A fence at the end
+// of each frame protects its region from being overwritten before the GPU is done.
+//
+// BeginFrame() and EndFrame() must bracket all the allocations of a frame.
+//
+class PersistentRingBuffer
+{
+public:
+
+    PersistentRingBuffer() {}
+
+    ~PersistentRingBuffer() {}
+
+    // The per object data of IndirectRender (shared by all the models)
+    static PersistentRingBuffer& GetPerObjectRing();
+
+    // Waits until the GPU has finished with the region of the new frame
+    void BeginFrame();
+
+    // Fences the region of the current frame and moves to the next one
+    void EndFrame();
+
+    // Returns a pointer where Size bytes can be written. Offset is the location of the
+    // data in the buffer (for BindRange). The region grows if the frame runs out of space.
+    void* Alloc(size_t Size, size_t& Offset);
+
+    void BindRange(GLenum Target, GLuint Index, size_t Offset, size_t Size);
+
+    // Rounds Size up to the alignment of the allocations. Used to split a single
+    // allocation into parts which can be bound separately (another Alloc() may
+    // reallocate the buffer and invalidate the pointers of the current frame).
+    size_t GetAlignedSize(size_t Size);
+
+    GLuint GetBuffer() const { return m_buffer; }
+
+    // The number of frames which were completed by EndFrame()
+    int GetFrameIndex() const { return m_frameIndex; }
+
+private:
+
+    PersistentRingBuffer(const PersistentRingBuffer&) = delete;
+    PersistentRingBuffer& operator=(const PersistentRingBuffer&) = delete;
+
+    void InitAlignment();
+
+    void CreateBuffer(size_t RegionSize);
+
+    void WaitForRegion(int Region);
+
+    static const int NUM_FRAMES = 3;
+
+    GLuint m_buffer = 0;
+    unsigned char* m_pMapping = NULL;
+    size_t m_regionSize = 0;
+    size_t m_alignment = 0;
+    int m_curRegion = 0;
+    size_t m_curOffset = 0;      // inside the current region
+    GLsync m_fences[NUM_FRAMES] = {};
+    int m_frameIndex = 0;
+};
@@ -36,9 +36,18 @@ public:
 
     void DrawStartCB(uint DrawIndex);
 
+    void SetVP(const Matrix4f& VP);
+
+    void ControlIndirectRender(bool IsIndirectRender);
+
+    void ControlPVP(bool IsPVP);
+
 private:
 
     GLuint m_WVPLocation;
+    GLuint m_VPLocation;
+    GLuint m_isIndirectRenderLocation;
+    GLuint m_isPVPLocation;
     GLuint m_drawIndexLocation;
     GLuint m_objectIndexLocation;
 };
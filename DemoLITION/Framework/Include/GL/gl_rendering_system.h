@@ -27,19 +27,7 @@
 #include "Int/core_rendering_system.h"
 #include "gl_forward_renderer.h"
 #include "GL/gl_scene.h"
-
-class TerrainGrid
-{
-public:
-    TerrainGrid(u32 IndexCount) : m_indexCount(IndexCount) {}
-
-    void Render();
-
-    GLuint m_vao = 0;
-    GLuint m_vbo = 0;
-    GLuint m_ibo = 0;
-    u32 m_indexCount = 0;
-};
+#include "GL/gl_terrain_clipmap.h"
 
 
 class RenderingSystemGL : public CoreRenderingSystem
@@ -75,6 +63,8 @@ class RenderingSystemGL : public CoreRenderingSystem
 
     virtual void* CreateTerrainGrid(int Width, int Height);
 
+    virtual void* CreateTerrainClipmap(int Width, int Height);
+
     virtual int GetTextureAPIHandle(int TextureHandle);
 
     BaseTexture* GetTexture(int TextureHandle);
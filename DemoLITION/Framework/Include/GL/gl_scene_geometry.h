@@ -0,0 +1,74 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "ogldev_types.h"
+#include "GL/gl_indirect_render.h"
+
+//
+// The vertices, indices and materials of all the static models in a single set
+// of buffers so that the entire scene can be drawn with a single multi draw
+// indirect call (see SceneIndirectRender). Used when UseSceneIndirectRender is enabled.
+//
+class GLSceneGeometry
+{
+public:
+
+    static GLSceneGeometry& Get();
+
+    // All the vertices must have the same layout. Returns the base vertex of the new vertices.
+    int AddVertices(const void* pVertices, int NumVertices, int VertexSize);
+
+    // Returns the base index of the new indices
+    int AddIndices(const std::vector<uint>& Indices);
+
+    // Returns the index of the first material in the materials SSBO
+    int AddMaterials(const std::vector<CoreMaterial>& Materials);
+
+    void UpdateMaterials(int BaseMaterial, const std::vector<CoreMaterial>& Materials);
+
+    // Binds the VAO (for the index buffer), the vertices SSBO and the materials SSBO
+    void Bind();
+
+private:
+
+    GLSceneGeometry() {}
+
+    GLSceneGeometry(const GLSceneGeometry&) = delete;
+    GLSceneGeometry& operator=(const GLSceneGeometry&) = delete;
+
+    void AddData(GLuint& Buffer, size_t& Capacity, size_t& Size, const void* pData, size_t DataSize);
+
+    GLuint m_VAO = 0;
+    GLuint m_vertexBuffer = 0;
+    GLuint m_indexBuffer = 0;
+    GLuint m_materialsBuffer = 0;
+
+    size_t m_vertexBufferCapacity = 0;     // in bytes
+    size_t m_vertexBufferSize = 0;
+    size_t m_indexBufferCapacity = 0;
+    size_t m_indexBufferSize = 0;
+    int m_vertexSize = 0;
+
+    std::vector<IndirectRender::MaterialIndirect> m_materials;
+    size_t m_materialsBufferCapacity = 0;  // in bytes
+};
@@ -0,0 +1,57 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "Int/core_scene.h"
+#include "GL/gl_gpu_culling.h"
+
+//
+// Draws a list of scene objects with a single glMultiDrawElementsIndirect call.
+// The draw commands and per object data of all the meshes of all the objects
+// are written to the persistent ring buffer and the geometry is taken from
+// GLSceneGeometry. Objects whose models are not part of the scene geometry
+// (skinned models, models loaded from a .mesh file, etc) are returned to the
+// caller to be rendered one by one.
+//
+// When a culling view projection is given the meshes are culled on the GPU
+// (see GPUCulling) and the CPU doesn't touch their visibility.
+//
+class SceneIndirectRender
+{
+public:
+
+    SceneIndirectRender() {}
+
+    static bool IsSupported(const CoreSceneObject* pSceneObject);
+
+    // GlobalRotation is applied after the object matrix (same as ForwardRenderer::RenderSingleObject).
+    // pCullingVP is the view projection of the current pass for the GPU culling (NULL for no culling).
+    void Render(const std::vector<CoreSceneObject*>& Objects, 
+                const Matrix4f& GlobalRotation, 
+                const Matrix4f* pCullingVP,
+                std::vector<CoreSceneObject*>& NotRendered);
+
+private:
+
+    std::vector<CoreSceneObject*> m_objects;
+    GPUCulling m_gpuCulling;
+};
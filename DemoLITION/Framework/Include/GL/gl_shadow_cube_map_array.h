@@ -0,0 +1,63 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <GL/glew.h>
+
+//
+// The shadow cube maps of several point lights. Every cube map stores the
+// distance from its light (R32F) and all of them are the layers of a single
+// cube map array which is sampled by the lighting shaders.
+//
+// The cube maps are rendered one at a time using a layered framebuffer.
+// The color attachment is a cube map view of the layers of the current light
+// and the depth buffer is a single cube map which is shared by all the lights.
+//
+class ShadowCubeMapArray
+{
+public:
+
+    ShadowCubeMapArray() {}
+
+    ~ShadowCubeMapArray();
+
+    bool Init(int Size, int NumCubeMaps);
+
+    int GetNumCubeMaps() const { return (int)m_views.size(); }
+
+    int GetSize() const { return m_size; }
+
+    // Attaches all the faces of the cube map as layers and sets the viewport
+    void BindForWriting(int CubeMapIndex);
+
+    // Clears the cube map which is bound for writing
+    void Clear();
+
+    void BindForReading(GLenum TextureUnit);
+
+private:
+
+    int m_size = 0;
+    GLuint m_fbo = 0;
+    GLuint m_cubeMapArray = 0;
+    std::vector<GLuint> m_views;    // one cube map view per light
+    GLuint m_depth = 0;
+};
@@ -0,0 +1,54 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "technique.h"
+#include "ogldev_math_3d.h"
+
+#define ALL_CUBE_MAP_FACES 0x3F
+
+//
+// Renders the distance from a point light into all the faces of a cube map
+// in a single pass. A geometry shader (shadow_cube_map.gs) replicates every
+// triangle to the faces in the face mask of the current object.
+//
+class ShadowCubeMapTechnique : public Technique
+{
+ public:
+
+    ShadowCubeMapTechnique();
+
+    virtual bool Init();
+
+    void SetWorld(const Matrix4f& World);
+    void SetFaceVPs(const Matrix4f* pFaceVPs);     // NUM_CUBE_MAP_FACES matrices
+    void SetFaceMask(uint FaceMask);                // bit i is GL_TEXTURE_CUBE_MAP_POSITIVE_X + i
+    void SetLightWorldPos(const Vector3f& Pos);
+    void ControlIndirectRender(bool IsIndirectRender);
+    void ControlPVP(bool IsPVP);
+
+ private:
+
+    GLuint m_worldLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_faceVPLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_faceMaskLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_lightWorldPosLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_isIndirectRenderLoc = INVALID_UNIFORM_LOCATION;
+    GLuint m_isPVPLoc = INVALID_UNIFORM_LOCATION;
+};
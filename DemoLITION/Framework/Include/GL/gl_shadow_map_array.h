@@ -0,0 +1,52 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+
+//
+// The depth maps of the shadow cascades of a directional light. Every cascade
+// is a layer of a single 2D array texture which is sampled by the lighting shaders.
+//
+class ShadowMapArray
+{
+public:
+
+    ShadowMapArray() {}
+
+    ~ShadowMapArray();
+
+    bool Init(int Size, int NumLayers);
+
+    int GetNumLayers() const { return m_numLayers; }
+
+    int GetSize() const { return m_size; }
+
+    // Attaches the layer to the depth buffer and sets the viewport
+    void BindForWriting(int Layer);
+
+    void BindForReading(GLenum TextureUnit);
+
+private:
+
+    int m_size = 0;
+    int m_numLayers = 0;
+    GLuint m_fbo = 0;
+    GLuint m_depthArray = 0;
+};
@@ -23,3 +23,20 @@
 #define SSBO_INDEX_VERTICES        0
 #define SSBO_INDEX_PER_OBJ_DATA    1
 #define SSBO_INDEX_MATERIALS       2
+#define SSBO_INDEX_BONES           4   // 3 is used by the environment maps in pbr_forward_lighting.fs
+
+// GPU culling (gpu_culling.cs). The input per object data uses SSBO_INDEX_PER_OBJ_DATA.
+#define SSBO_INDEX_CULLING_DRAW_CMDS      5
+#define SSBO_INDEX_CULLING_BOUNDS         6
+#define SSBO_INDEX_CULLING_VISIBLE_CMDS   7
+#define SSBO_INDEX_CULLING_VISIBLE_DATA   8
+
+// Clustered lighting (light_clustering.cs and the forward lighting shaders)
+#define SSBO_INDEX_LIGHTS                 9
+#define SSBO_INDEX_LIGHT_CLUSTERS         10  // the number of lights in each cluster followed by their indices
+#define SSBO_INDEX_LIGHT_SPHERES          11
+#define SSBO_INDEX_LIGHT_CLUSTER_BOXES    12
+
+// Average luminance of the HDR buffer (hdr.cs, hdr_adapt.cs and the tone mapping shaders)
+#define SSBO_INDEX_HDR_TILES              13
+#define SSBO_INDEX_HDR_LUMINANCE          14
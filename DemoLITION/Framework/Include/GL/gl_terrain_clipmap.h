@@ -0,0 +1,118 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "GL/gl_terrain_grid.h"
+
+#define MAX_CLIPMAP_LEVELS 16
+#define CLIPMAP_WINDOW_BLOCKS 8     // the width of a level in blocks (must be even)
+
+//
+// Geometry clipmap terrain.
+//
+// The terrain around the camera is covered by nested square levels. Level L is a window
+// of CLIPMAP_WINDOW_BLOCKS x CLIPMAP_WINDOW_BLOCKS blocks whose quads are 2^L height map
+// samples wide, with a hole where the finer level is. Every block is an instance of the
+// same BlockSize x BlockSize quad mesh so the number of triangles depends on the number
+// of levels and not on the size of the height map.
+//
+// Each level is aligned to the blocks of the next one which makes the hole in the next
+// level match it exactly. The heights are sampled in the vertex shader (terrain_clipmap.vs)
+// and the vertices near the outer edge of a level morph into the grid of the next one so
+// the levels meet without cracks.
+//
+// The blocks are selected on the CPU every frame and the ones outside the height map or
+// the view frustum are dropped. All the positions here are in height map samples, centered
+// around the origin like the vertices of CreateTerrainGridVectors().
+//
+class TerrainClipmap : public TerrainGrid
+{
+public:
+
+    // Per instance vertex attribute
+    struct Block {
+        float OriginX = 0.0f;
+        float OriginZ = 0.0f;
+        float Scale = 0.0f;     // the size of a quad in samples
+        float Level = 0.0f;
+    };
+
+    struct Window {
+        float MinX = 0.0f;
+        float MinZ = 0.0f;
+        float MaxX = 0.0f;
+        float MaxZ = 0.0f;
+    };
+
+    TerrainClipmap(int Width, int Height, int BlockSize = 16);
+
+    ~TerrainClipmap();
+
+    virtual bool IsClipmap() const { return true; }
+
+    // Creates the block mesh and the instance buffer
+    void CreateBuffers();
+
+    // Selects the blocks for the camera and uploads them. The camera position and the
+    // view projection matrix are in the space of the terrain (before the horizontal scale).
+    void Update(const Vector3f& CameraPos, const Matrix4f& VP, float HorizontalScale, float MaxHeight);
+
+    // The block selection part of Update (doesn't touch OpenGL). pFrustum is optional.
+    void SelectBlocks(const Vector3f& CameraPos, const FrustumCulling* pFrustum, float HorizontalScale, float MaxHeight);
+
+    // Draws the blocks of the last Update in a single instanced draw
+    virtual void Render();
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetBlockSize() const { return m_blockSize; }
+    int GetNumLevels() const { return m_numLevels; }
+
+    // The levels between these two were active in the last selection (-1 if none)
+    int GetFinestLevel() const { return m_finestLevel; }
+    int GetCoarsestLevel() const { return m_coarsestLevel; }
+
+    const Window& GetLevelWindow(int Level) const { return m_windows[Level]; }
+
+    const std::vector<Block>& GetBlocks() const { return m_blocks; }
+
+    int GetNumTriangles() const { return (int)m_blocks.size() * m_blockSize * m_blockSize * 2; }
+
+private:
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_blockSize = 0;
+    int m_numLevels = 0;
+    float m_mapMinX = 0.0f;
+    float m_mapMinZ = 0.0f;
+    float m_mapMaxX = 0.0f;
+    float m_mapMaxZ = 0.0f;
+
+    int m_finestLevel = -1;
+    int m_coarsestLevel = -1;
+    Window m_windows[MAX_CLIPMAP_LEVELS];
+    std::vector<Block> m_blocks;
+
+    GLuint m_instanceBuffer = 0;
+    int m_numInstances = 0;
+};
@@ -0,0 +1,42 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ogldev_types.h"
+
+// A flat grid of vertices which is displaced by the terrain technique.
+// The full grid is drawn every frame.
+class TerrainGrid
+{
+public:
+    TerrainGrid(u32 IndexCount) : m_indexCount(IndexCount) {}
+
+    virtual ~TerrainGrid() {}
+
+    virtual bool IsClipmap() const { return false; }
+
+    virtual void Render();
+
+    GLuint m_vao = 0;
+    GLuint m_vbo = 0;
+    GLuint m_ibo = 0;
+    u32 m_indexCount = 0;
+};
@@ -21,6 +21,7 @@
 #include "ogldev_math_3d.h"
 #include "ogldev_util.h"
 #include "technique.h"
+#include "GL/gl_terrain_clipmap.h"
 
 
 class TerrainTechnique : public Technique
@@ -40,9 +41,14 @@ public:
     void SetTexTileSizeInWorldUnits(float TexTileSizeInWorldUnits);
     void SetRenderMode(TERRAIN_RENDER_MODE RenderMode);
 
-private:
+    // The X and Z of the baked normals are multiplied by SlopeScale
+    void SetNormalMap(bool Enabled, float SlopeScale = 1.0f);
+
+protected:
     bool InitCommon();
 
+private:
+
     DEF_LOC(gWVP);
     DEF_LOC(gMaxTerrainHeight);
     DEF_LOC(gHorizontalScale);
@@ -52,4 +58,26 @@ private:
     DEF_LOC(gAmbientFactor);
     DEF_LOC(gTexCoordScale);
     DEF_LOC(gRenderMode);
+    DEF_LOC(gUseNormalMap);
+    DEF_LOC(gNormalMapSlopeScale);
+};
+
+
+class TerrainClipmapTechnique : public TerrainTechnique
+{
+public:
+
+    TerrainClipmapTechnique() {}
+
+    virtual bool Init();
+
+    // The map size, the block size and the windows of the active levels
+    void SetClipmap(const TerrainClipmap& Clipmap);
+
+private:
+
+    DEF_LOC(gMapSize);
+    DEF_LOC(gBlockSize);
+    DEF_LOC(gCoarsestLevel);
+    DEF_LOC(gLevelWindow);
 };
@@ -0,0 +1,55 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+
+//
+// Measures the GPU time of the commands between Begin() and End().
+// Each frame uses the next query of a small ring so GetTimeMs() returns the
+// result of an earlier frame without waiting for the GPU. The queries of
+// different timers must not be nested (GL allows a single active GL_TIME_ELAPSED).
+//
+class GLTimerQuery
+{
+public:
+
+    GLTimerQuery() {}
+
+    ~GLTimerQuery();
+
+    void Begin();
+
+    void End();
+
+    // The latest available result in milliseconds (zero until the first one arrives)
+    float GetTimeMs();
+
+private:
+
+    GLTimerQuery(const GLTimerQuery&) = delete;
+    GLTimerQuery& operator=(const GLTimerQuery&) = delete;
+
+    static const int NUM_QUERIES = 4;
+
+    GLuint m_queries[NUM_QUERIES] = {};
+    bool m_pending[NUM_QUERIES] = {};
+    int m_curQuery = 0;
+    float m_lastTimeMs = 0.0f;
+};
@@ -31,14 +31,10 @@ public:
 
     void Render();
 
-    void SetAverageLuminance(float AvgLum);
-
     void SetHDRSampler(unsigned int TextureUnit);
 
     void SetBlurSampler(unsigned int TextureUnit);
 
-    void SetExposure(float Exposure);
-
     void SetToneMapMethod(TONE_MAP_METHOD Method);
 
     void ControlGammaCorrection(bool Enable);
@@ -51,9 +47,7 @@ private:
 
     GLuint m_dummyVAO = -1;
 
-    DEF_LOC(gAvgLum);
     DEF_LOC(gHDRSampler);
-    DEF_LOC(gExposure);
     DEF_LOC(gMethodType);
     DEF_LOC(gEnableGammaCorrection);
     DEF_LOC(gBlurSampler);
@@ -0,0 +1,106 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_math_3d.h"
+
+// Must match forward_lighting.fs, pbr_forward_lighting.fs and light_clustering.cs
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+#define NUM_LIGHT_CLUSTERS (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+// Below this intensity the light is considered out of range
+#define LIGHT_CUTOFF_INTENSITY (1.0f / 256.0f)
+
+//
+// Assignment of lights to the clusters of the view frustum (clustered forward lighting).
+//
+// The frustum is split into LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y screen tiles and
+// LIGHT_CLUSTERS_Z depth slices which are distributed exponentially between the near
+// and the far planes. A light is added to every cluster whose view space box
+// intersects the bounding sphere of the light.
+//
+// Every cluster has a fixed slot of MAX_LIGHTS_PER_CLUSTER light indices which are
+// stored in increasing order so Assign() and the compute shader (light_clustering.cs)
+// produce exactly the same layout. Lights beyond the size of the slot are dropped.
+//
+class LightClusters
+{
+public:
+
+    // View space box of a single cluster (w is not used)
+    struct ClusterBox {
+        Vector4f Min;
+        Vector4f Max;
+    };
+
+    LightClusters() {}
+
+    // Calculates the boxes of the clusters. The view space is right handed (the camera looks
+    // down -Z, like GLMCameraFirstPerson) and Projection must be a symmetric perspective projection.
+    void Init(const Matrix4f& Projection, float zNear, float zFar);
+
+    bool IsInitialized() const { return m_boxes.size() > 0; }
+
+    // Returns true if Init() was called with the same parameters
+    bool IsSameProjection(const Matrix4f& Projection, float zNear, float zFar) const;
+
+    const std::vector<ClusterBox>& GetBoxes() const { return m_boxes; }
+
+    // The depth slice of a view space depth (positive) is floor(log(Depth) * Scale + Bias)
+    float GetDepthScale() const { return m_depthScale; }
+    float GetDepthBias() const { return m_depthBias; }
+
+    // The cluster of a view space position which is inside the frustum
+    int GetClusterIndex(const Vector3f& ViewPos) const;
+
+    // Assigns NumLights lights to the clusters. The xyz of each sphere is the world space
+    // position of the light and w is its radius. The indices which are stored in the clusters
+    // start at FirstLight. Counts gets NUM_LIGHT_CLUSTERS entries and Indices gets 
+    // NUM_LIGHT_CLUSTERS * MAX_LIGHTS_PER_CLUSTER entries (only the first Counts[i] entries
+    // of each slot are valid). Returns the number of lights which were dropped because
+    // their cluster was full.
+    int Assign(const Matrix4f& View,
+               const Vector4f* pSpheres,
+               int NumLights,
+               uint FirstLight,
+               std::vector<uint>& Counts,
+               std::vector<uint>& Indices) const;
+
+    // Same test as IntersectsSphere() in light_clustering.cs
+    static bool IntersectsSphere(const ClusterBox& Box, const Vector3f& ViewCenter, float Radius);
+
+    // The distance at which the attenuation (Constant + Linear * d + Exp * d^2) brings the 
+    // intensity of the light below LIGHT_CUTOFF_INTENSITY. Returns a negative number if
+    // it never does (the light must then be applied to all the pixels).
+    static float CalcLightRadius(float Intensity, float Constant, float Linear, float Exp);
+
+private:
+
+    std::vector<ClusterBox> m_boxes;
+    Matrix4f m_projection;
+    float m_zNear = 0.0f;
+    float m_zFar = 0.0f;
+    float m_depthScale = 0.0f;
+    float m_depthBias = 0.0f;
+};
@@ -12,6 +12,9 @@
 
 #define MAX_LOD_COUNT 8
 
+#define MESH_FILE_MAGIC   0x12345678
+#define MESH_FILE_VERSION 2     // 2 - LOD errors and real bounding boxes
+
 struct Mesh {
     u32 m_lodCount = 1;
     u32 m_baseIndex = 0;
@@ -20,6 +23,7 @@ struct Mesh {
     u32 m_numIndices = 0;
     u32 m_lodOffsets[MAX_LOD_COUNT + 1] = { 0 };
     u32 m_materialID = 0;
+    float m_lodErrors[MAX_LOD_COUNT] = { 0.0f };    // in the local space of the mesh
 
     u32 GetLodIndicesCount(u32 Lod)
     {
@@ -37,7 +41,8 @@ struct Mesh {
 
 
 struct MeshFileHeader {
-    u32 m_magicValue = 0x12345678;
+    u32 m_magicValue = MESH_FILE_MAGIC;
+    u32 m_version = MESH_FILE_VERSION;
     u32 m_meshCount = 0;
     u32 m_numIndices = 0;
     u32 m_indexDataSizeBytes = 0;
@@ -20,6 +20,7 @@
 
 #include <map>
 #include <vector>
+#include <memory>
 
 #include <assimp/Importer.hpp>      // C++ importer interface
 #include <assimp/scene.h>       // Output data structure
@@ -89,6 +90,31 @@ public:
                                   unsigned int EndAnimIndex,
                                   float BlendFactor);
 
+    // The animation state of a single instance of the model for GetBoneTransformsBatch
+    struct AnimationInstance {
+        float AnimationTimeSec = 0.0f;
+        uint StartAnimIndex = 0;
+        uint EndAnimIndex = 0;      // only used when BlendFactor is larger than zero
+        float BlendFactor = 0.0f;   // zero means StartAnimIndex without blending
+    };
+
+    // Evaluates the poses of many instances of the model in one call. The work is spread
+    // across the default thread pool and the NumBones() matrices of instance i are written to
+    // pTransforms[i * NumBones()]. The results are the same as calling GetBoneTransforms (or
+    // GetBoneTransformsBlended if BlendFactor > 0) for every instance.
+    void GetBoneTransformsBatch(const AnimationInstance* pInstances, int NumInstances, Matrix4f* pTransforms);
+
+    // The original versions of the above which walk the Assimp node hierarchy and search
+    // the channels by name on every call. Kept for validating and benchmarking the compiled
+    // animation data which is used by GetBoneTransforms/GetBoneTransformsBlended.
+    void GetBoneTransformsReference(float AnimationTimeSec, vector<Matrix4f>& Transforms, unsigned int AnimationIndex = 0);
+
+    void GetBoneTransformsBlendedReference(float AnimationTimeSec,
+                                           vector<Matrix4f>& Transforms,
+                                           unsigned int StartAnimIndex,
+                                           unsigned int EndAnimIndex,
+                                           float BlendFactor);
+
     const std::vector<DirectionalLight>& GetDirLights() const { return m_dirLights; }
     const std::vector<SpotLight>& GetSpotLights() const { return m_spotLights; }
     const std::vector<PointLight>& GetPointLights() const { return m_pointLights; }
@@ -112,6 +138,18 @@ public:
 
     bool IsAnimated() const;
 
+    // Calculates the world space box which contains all the meshes of the model using the same
+    // transformations as the renderer (ObjectMatrix * mesh transformation * GlobalRotation).
+    // Returns false if the bounds of the model are unknown. Skinned models use the bind pose.
+    bool CalcWorldBounds(const Matrix4f& ObjectMatrix, const Matrix4f& GlobalRotation, AABB& WorldBounds) const;
+
+    // Selects the coarsest LOD of every mesh whose simplification error is projected to less
+    // than MaxPixelError pixels on the screen. ProjScale is the size in pixels of one unit at
+    // a distance of one unit from the camera (half the viewport height times Proj[1][1]).
+    // Lods receives one LOD per mesh and the triangles of the model are added to Stats.
+    void SelectLods(const Matrix4f& ObjectMatrix, const Matrix4f& GlobalRotation, const Vector3f& CameraPos,
+                    float ProjScale, float MaxPixelError, std::vector<uint>& Lods, MeshLodStats& Stats) const;
+
     const CoreMaterial* GetMaterialForMesh(int MeshIndex) const;
 
     virtual void SetColorTexture(int TextureHandle) { assert(0); }
@@ -128,6 +166,12 @@ public:
 
     static void GetVertexSizesInBytes(size_t& VertexSize, size_t& SkinnedVertexSize);
 
+    // The binary model cache is enabled by default. When it is disabled every
+    // load goes through Assimp (used by the model cache benchmark).
+    static void EnableModelCache(bool Enable);
+
+    static std::string GetModelCacheFilename(const std::string& Filename);
+
 protected:
 
     virtual void AllocBuffers() = 0;
@@ -233,11 +277,23 @@ private:
     template<typename VertexType>
     void ReserveSpace(std::vector<VertexType>& Vertices, uint NumVertices, uint NumIndices);
 
+    // Local vertex/index buffers of a single mesh before they are concatenated
     template<typename VertexType>
-    void InitSingleMesh(vector<VertexType>& Vertices, uint MeshIndex, const aiMesh* paiMesh);
+    struct MeshBuffers {
+        std::vector<VertexType> Vertices;
+        std::vector<uint> Indices;
+        Vector3f MinPos = Vector3f(FLT_MAX, FLT_MAX, FLT_MAX);
+        Vector3f MaxPos = Vector3f(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        uint LodCount = 1;
+        uint LodOffsets[MAX_LOD_COUNT + 1] = { 0 };     // LOD 0 is set by GenerateLods
+        float LodErrors[MAX_LOD_COUNT] = { 0.0f };
+    };
 
     template<typename VertexType>
-    void InitSingleMeshOpt(vector<VertexType>& Vertices, uint MeshIndex, const aiMesh* paiMesh);
+    void InitSingleMesh(MeshBuffers<VertexType>& Mesh, const aiMesh* paiMesh);
+
+    template<typename VertexType>
+    void InitSingleMeshOpt(MeshBuffers<VertexType>& Mesh, const aiMesh* paiMesh);
 
     virtual void PopulateBuffersSkinned(vector<SkinnedVertex>& Vertices) = 0;
 
@@ -270,7 +326,10 @@ private:
     void InitAllMeshes(const aiScene* pScene, std::vector<VertexType>& Vertices);
 
     template<typename VertexType>
-    void OptimizeMesh(int MeshIndex, std::vector<uint>& Indices, std::vector<VertexType>& Vertices, std::vector<VertexType>& AllVertices);
+    void OptimizeMesh(std::vector<uint>& Indices, std::vector<VertexType>& Vertices, MeshBuffers<VertexType>& Mesh);
+
+    template<typename VertexType>
+    void GenerateLods(MeshBuffers<VertexType>& Mesh);
 
     void CalculateMeshTransformations(const aiScene* pScene);
     void TraverseNodeHierarchy(Matrix4f ParentTransformation, aiNode* pNode);
@@ -294,7 +353,10 @@ private:
 
     void LoadTexture(const string& Dir, const aiMaterial* pMaterial, int MaterialIndex, aiTextureType AssimpType, int AssimpTexIndex, TEXTURE_TYPE MyType);
     void LoadTextureEmbedded(const aiTexture* paiTexture, int MaterialIndex, TEXTURE_TYPE MyType, bool IsSRGB);
+    void LoadTextureEmbedded(u32 BufferSize, const void* pData, int MaterialIndex, TEXTURE_TYPE MyType, bool IsSRGB);
     void LoadTextureFromFile(const string& dir, const aiString& Path, int MaterialIndex, TEXTURE_TYPE MyType, bool IsSRGB);
+    void LoadTextureFromFile(const string& FullPath, int MaterialIndex, TEXTURE_TYPE MyType, bool IsSRGB);
+    void DecodeAndUploadTextures();
 
     void LoadColors(const aiMaterial* pMaterial, int index);
     void ProcessClearCoat(int index, const aiMaterial* pMaterial, CoreMaterial& material);
@@ -304,6 +366,34 @@ private:
 
     void InitSingleCamera(int Index, const aiScene* pScene);
 
+    /////////////////////////////////////
+    // Binary model cache (core_model_cache.cpp)
+    /////////////////////////////////////
+
+    bool LoadModelCache(const std::string& Filename, uint LoadFlags, bool MeshOptimizer, bool MeshLods);
+
+    void SaveModelCache(const std::string& Filename, uint LoadFlags, bool MeshOptimizer, bool MeshLods);
+
+    void KeepVerticesForCache(const void* pVertices, size_t Size);
+
+    // Where each texture of the materials came from. Used for decoding the textures
+    // in parallel and by the cache to reload them.
+    struct TextureSource {
+        int MaterialIndex = 0;
+        TEXTURE_TYPE Type = TEX_TYPE_BASE;
+        bool IsSRGB = false;
+        std::string FullPath;           // empty for embedded textures
+        const void* pEmbeddedData = NULL;
+        u32 EmbeddedSize = 0;
+    };
+
+    std::vector<TextureSource> m_textureSources;
+    std::vector<char> m_cacheVertices;      // copy of the vertex buffer until the cache is written
+
+    // When loading from the cache this owns the node hierarchy, animations, cameras and lights
+    // (no meshes or materials) and m_pScene points to it instead of the Assimp importer scene
+    std::unique_ptr<aiScene> m_pCachedScene;
+
     const aiScene* m_pScene = NULL;
 
     Matrix4f m_GlobalInverseTransform;
@@ -326,8 +416,9 @@ private:
 	// Skeletal animation stuff
     /////////////////////////////////////
 
-    void LoadMeshBones(vector<SkinnedVertex>& SkinnedVertices, uint MeshIndex, const aiMesh* paiMesh);
-    void LoadSingleBone(vector<SkinnedVertex>& SkinnedVertices, uint MeshIndex, const aiBone* pBone);
+    void AllocMeshBones(const aiMesh* paiMesh);
+    void LoadMeshBones(vector<SkinnedVertex>& SkinnedVertices, const aiMesh* paiMesh);
+    void LoadSingleBone(vector<SkinnedVertex>& SkinnedVertices, const aiBone* pBone);
     int GetBoneId(const aiBone* pBone);
     void CalcInterpolatedScaling(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim);
     void CalcInterpolatedRotation(aiQuaternion& Out, float AnimationTime, const aiNodeAnim* pNodeAnim);
@@ -340,8 +431,9 @@ private:
     void ReadNodeHierarchyBlended(float StartAnimationTimeTicksm, float EndAnimationTimeTicks, const aiNode* pNode, const Matrix4f& ParentTransform,
                                   const aiAnimation& StartAnimation, const aiAnimation& EndAnimation, float BlendFactor);
     void MarkRequiredNodesForBone(const aiBone* pBone);
+    void MarkRequiredNodesForBone(const string& BoneName);
     void InitializeRequiredNodeMap(const aiNode* pNode);
-    float CalcAnimationTimeTicks(float TimeInSeconds, unsigned int AnimationIndex);
+    float CalcAnimationTimeTicks(float TimeInSeconds, unsigned int AnimationIndex) const;
 
     struct LocalTransform {
         aiVector3D Scaling;
@@ -378,5 +470,45 @@ private:
     };
 
     map<string,NodeInfo> m_requiredNodeMap;
+
+    /////////////////////////////////////
+    // Compiled animation data. Built once after loading so that evaluating a pose
+    // doesn't need any string lookups or linear searches.
+    /////////////////////////////////////
+
+    // The required nodes flattened in the traversal order (a parent always comes before its children)
+    struct AnimNode {
+        const aiNode* pNode = NULL;
+        int ParentIndex = -1;       // -1 for the root
+        int BoneIndex = -1;         // -1 if the node is not a bone
+        Matrix4f Transformation;    // used when the node is not animated
+    };
+
+    vector<AnimNode> m_animNodes;
+
+    // The keyframe times of a single channel converted to float for the binary search
+    struct AnimChannel {
+        const aiNodeAnim* pNodeAnim = NULL;
+        vector<float> PositionTimes;
+        vector<float> RotationTimes;
+        vector<float> ScalingTimes;
+    };
+
+    struct CompiledAnimation {
+        vector<int> NodeToChannel;  // one per AnimNode, -1 if the node is not animated
+        vector<AnimChannel> Channels;
+    };
+
+    vector<CompiledAnimation> m_compiledAnimations;
+
+    vector<Matrix4f> m_animNodeTransforms;  // scratch space for the global transformation of each node
+
+    void CompileAnimations();
+    void CompileNodeHierarchy(const aiNode* pNode, int ParentIndex);
+    void CalcLocalTransform(LocalTransform& Transform, float AnimationTimeTicks, const AnimChannel& Channel) const;
+    void CalcInstancePose(const AnimationInstance& Instance, Matrix4f* pNodeTransforms, Matrix4f* pBoneTransforms) const;
+    void CalcPoseTransforms(float StartAnimationTimeTicks, float EndAnimationTimeTicks,
+                            const CompiledAnimation& StartAnimation, const CompiledAnimation* pEndAnimation,
+                            float BlendFactor, Matrix4f* pNodeTransforms, Matrix4f* pBoneTransforms) const;
 };
 
@@ -0,0 +1,80 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <list>
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "Int/core_scene.h"
+
+//
+// CPU culling of the render list.
+//
+// UpdateBounds() calculates the world space box of every object once per frame
+// and then Cull() is called for every view (camera, shadow map, cube map face, etc)
+// to produce the list of objects which need to be submitted for that view.
+//
+class RenderListCuller
+{
+public:
+
+    RenderListCuller() {}
+
+    // Objects for which pIsCulledElsewhere returns true (e.g. they are culled on the GPU)
+    // are treated as objects with unknown bounds and are always visible
+    void UpdateBounds(const std::list<CoreSceneObject*>& RenderList, 
+                      const Matrix4f& GlobalRotation,
+                      bool (*pIsCulledElsewhere)(const CoreSceneObject*) = NULL);
+
+    // Collects the objects which intersect the frustum of ViewProj and are within MaxDistance
+    // from DistanceOrigin (zero means no limit). Objects with unknown bounds are always visible.
+    // The results are added to Stats.
+    void Cull(const Matrix4f& ViewProj, 
+              const Vector3f& DistanceOrigin, 
+              float MaxDistance,
+              std::vector<CoreSceneObject*>& VisibleObjects,
+              CullingStats& Stats) const;
+
+    // Culls against all the faces of a cube map at once (FaceVPs has NUM_CUBE_MAP_FACES
+    // matrices). Bit i of FaceMasks[j] is set if VisibleObjects[j] intersects the frustum
+    // of face i and only objects which intersect at least one face are returned. Every
+    // face is counted as a view in Stats and NumSubmitted is the number of object faces.
+    void CullCube(const Matrix4f* pFaceVPs,
+                  std::vector<CoreSceneObject*>& VisibleObjects,
+                  std::vector<uint>& FaceMasks,
+                  CullingStats& Stats) const;
+
+    // Returns all the objects without culling
+    void GetAllObjects(std::vector<CoreSceneObject*>& Objects, CullingStats& Stats) const;
+
+    // The world space box of all the objects. Returns false if the bounds of
+    // at least one object are unknown.
+    bool GetSceneBounds(AABB& Bounds) const;
+
+private:
+
+    struct ObjectBounds {
+        CoreSceneObject* pObject = NULL;
+        AABB Bounds;
+        bool HasBounds = false;
+    };
+
+    std::vector<ObjectBounds> m_objects;
+};
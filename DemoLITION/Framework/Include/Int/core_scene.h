@@ -134,6 +134,7 @@ private:
     void SSAOGUI();
     void HDRAndToneMappingGUI();
     void TerrainGUI();
+    void CullingGUI();
 
     GLMCameraFirstPerson m_defaultCamera;
     std::vector<CoreSceneObject> m_sceneObjects;
@@ -0,0 +1,95 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "ogldev_math_3d.h"
+#include "demolition_scene.h"
+
+//
+// Cascaded shadow maps of a directional light.
+//
+// The view frustum of the camera is split by distance into slices (see CalcSplits)
+// and every slice gets its own orthographic projection which is fitted tightly
+// around it in light space (the same steps as CalcTightLightProjection, only per
+// slice). The size of the projection depends only on the shape of the slice so it
+// doesn't change when the camera rotates, and its origin is snapped to the texels
+// of the shadow map so the shadows don't shimmer when the camera moves.
+//
+// The cascades can be updated at different rates (see SetUpdateInterval). The
+// lighting shaders use the projection of the last update of every cascade and move
+// on to the next cascade when a pixel is outside of it.
+//
+class ShadowCascades
+{
+public:
+
+    struct Cascade {
+        float SplitNear = 0.0f;         // distance from the camera along the view direction
+        float SplitFar = 0.0f;
+        Matrix4f LightView;
+        Matrix4f LightProjection;
+        Matrix4f LightVP;
+        float TexelSize = 0.0f;         // in world units
+        Vector3f LightDir;              // of the last update
+        int UpdateInterval = 1;         // in frames
+        int LastUpdateFrame = -1;
+    };
+
+    ShadowCascades() {}
+
+    // The default update intervals are 1, 1, 2, 4... frames
+    void Init(int NumCascades, int ShadowMapSize);
+
+    int GetNumCascades() const { return m_numCascades; }
+
+    int GetShadowMapSize() const { return m_shadowMapSize; }
+
+    void SetUpdateInterval(int CascadeIndex, int NumFrames);
+
+    const Cascade& GetCascade(int CascadeIndex) const { return m_cascades[CascadeIndex]; }
+
+    // Practical split scheme: Lambda blends between the uniform (0) and the logarithmic (1)
+    // splits. pSplits receives NumCascades + 1 distances starting with zNear.
+    static void CalcSplits(float zNear, float zFar, int NumCascades, float Lambda, float* pSplits);
+
+    // The cascades with a larger interval are updated on different frames. A cascade is
+    // always updated when its split or the direction of the light have changed.
+    bool NeedsUpdate(int CascadeIndex, int Frame, float SplitNear, float SplitFar, const Vector3f& LightDir) const;
+
+    // Fits the cascade to the slice [SplitNear, SplitFar] of the camera frustum. The view space
+    // of the camera can be either left or right handed (the corners of the frustum are taken
+    // from the inverse of Projection * View). The near plane of the light is moved back to the
+    // casters in CasterBounds (NULL means a fixed distance).
+    void Update(int CascadeIndex,
+                int Frame,
+                const Matrix4f& CameraView,
+                const Matrix4f& CameraProjection,
+                float zNear,
+                float zFar,
+                float SplitNear,
+                float SplitFar,
+                const Vector3f& LightDir,
+                const AABB* pCasterBounds);
+
+private:
+
+    Cascade m_cascades[MAX_SHADOW_CASCADES];
+    int m_numCascades = 0;
+    int m_shadowMapSize = 0;
+};
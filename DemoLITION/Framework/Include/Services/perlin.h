@@ -32,4 +32,19 @@ struct PerlinConfig {
 };
 
 
-void CreatePerlinMap(const PerlinConfig& Config, std::vector<float>& HeightMap);
+class ThreadPool;
+
+// Generates a Config.width x Config.height map normalized to [0,1] by its own min/max.
+// The rows are generated in parallel (by the default pool if pPool is NULL) with a
+// vectorized version of glm::perlin. The result doesn't depend on the number of threads.
+void CreatePerlinMap(const PerlinConfig& Config, std::vector<float>& HeightMap, ThreadPool* pPool = NULL);
+
+// The original serial implementation (for testing)
+void CreatePerlinMapReference(const PerlinConfig& Config, std::vector<float>& HeightMap);
+
+// Generates the Width x Height tile of the infinite map whose first sample is at
+// (StartX, StartY). Config.width and Config.height are ignored. Instead of the min/max
+// of the tile the heights are normalized by the sum of the octave amplitudes (and
+// clamped to [0,1]) so neighboring tiles match at the seams.
+void CreatePerlinTile(const PerlinConfig& Config, int StartX, int StartY, int Width, int Height,
+                      std::vector<float>& Tile, ThreadPool* pPool = NULL);
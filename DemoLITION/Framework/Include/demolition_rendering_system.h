@@ -125,6 +125,10 @@ public:
 
     virtual void* CreateTerrainGrid(int Width, int Height) = 0;
 
+    // Same as CreateTerrainGrid but the terrain is rendered using a geometry clipmap
+    // so the number of triangles doesn't depend on the size of the height map
+    virtual void* CreateTerrainClipmap(int Width, int Height) = 0;
+
     virtual void GetWindowSize(int& Width, int& Height) const = 0;
 
     virtual double GetElapsedTime() const = 0;
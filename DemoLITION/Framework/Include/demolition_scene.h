@@ -29,6 +29,9 @@
 // Nobody needs more than 640k
 #define MAX_NUM_ROTATIONS 8
 
+// Must match forward_lighting.fs
+#define MAX_SHADOW_CASCADES 4
+
 class SceneObject : public Object {
 public:
     // Position
@@ -143,6 +146,42 @@ struct ModelLoadFlags {
 };
 
 
+// Culling results of the objects in the render list (accumulated over all the views of a pass)
+struct CullingStats {
+    int NumViews = 0;
+    int NumTested = 0;
+    int NumSubmitted = 0;
+    int NumFrustumCulled = 0;
+    int NumDistanceCulled = 0;
+};
+
+
+// Triangles of the meshes which were drawn with a LOD (accumulated over all the passes)
+struct MeshLodStats {
+    int NumMeshes = 0;
+    int NumSimplifiedMeshes = 0;
+    long long NumTrianglesFull = 0;       // the triangles of LOD 0
+    long long NumTrianglesRendered = 0;
+};
+
+
+// The shadow cube maps of the point lights in the last frame
+struct PointShadowStats {
+    int NumCubeMaps = 0;
+    int NumSubmissions = 0;     // objects sent to the GPU (one per cube map in the layered path, one per face otherwise)
+    int NumDrawCalls = 0;
+    int NumObjectFaces = 0;     // the faces of the cube maps which the submitted objects are rendered into
+    float CPUTimeMs = 0.0f;     // the CPU time of the entire point light shadow pass
+};
+
+
+// The GPU time of the main render passes, measured with timer queries a few frames behind
+struct RenderPassTimes {
+    float ShadowPassMs = 0.0f;
+    float LightingPassMs = 0.0f;
+};
+
+
 class SceneConfig
 {
 public:
@@ -202,10 +241,15 @@ public:
 
     bool IsBloomEnabled() const { return m_bloom.Enabled; }
 
+    // Updated by the renderer (the values of an earlier frame when the luminance is calculated on the GPU)
     void SetHDRParams(float AverageLuminance, float Exposure) { m_hdrAverageLuminance = AverageLuminance; m_hdrExposure = Exposure; }
 
     void GetHDRParams(float& AverageLuminance, float& Exposure) { AverageLuminance = m_hdrAverageLuminance; Exposure = m_hdrExposure; }
 
+    // How fast the exposure follows changes in the average luminance (per second). Zero means immediately.
+    void SetHDRAdaptationRate(float Rate) { m_hdrAdaptationRate = std::max(Rate, 0.0f); }
+    float GetHDRAdaptationRate() const { return m_hdrAdaptationRate; }
+
     TONE_MAP_METHOD GetToneMapMethod() const { return m_toneMapMethod; }
 
     void SetToneMapMethod(TONE_MAP_METHOD Method) { m_toneMapMethod = Method; }
@@ -244,6 +288,13 @@ public:
     void SetTerrainHeightMap(int Tex) { m_terrain.m_heightMap = Tex; }
     int GetTerrainHeightMap() const { return m_terrain.m_heightMap; }
 
+    // An RGB8 map of the normals (see BakeNormalMap). HeightRatio is the height scale divided
+    // by the world scale of the bake. The normals are adjusted to the current max height and
+    // horizontal scale when they are different.
+    void SetTerrainNormalMap(int Tex, float HeightRatio) { m_terrain.m_normalMap = Tex; m_terrain.m_normalMapHeightRatio = HeightRatio; }
+    int GetTerrainNormalMap() const { return m_terrain.m_normalMap; }
+    float GetTerrainNormalMapHeightRatio() const { return m_terrain.m_normalMapHeightRatio; }
+
     void SetTerrainTexture(int Index, int Tex) {
         if (Index >= 0 && Index < ARRAY_SIZE_IN_ELEMENTS(m_terrain.m_textures)) {
             m_terrain.m_textures[Index] = Tex;
@@ -290,6 +341,73 @@ public:
     void SetTerrainRenderMode(TERRAIN_RENDER_MODE Mode) { m_terrainRenderMode = Mode; }
     TERRAIN_RENDER_MODE GetTerrainRenderMode() const { return m_terrainRenderMode; }
 
+    void ControlCulling(bool Enable) { m_culling.Enabled = Enable; }
+    bool IsCullingEnabled() const { return m_culling.Enabled; }
+
+    // Objects which are farther than this from the camera are not rendered. Zero means no limit.
+    void SetMaxDrawDistance(float Distance) { m_culling.MaxDrawDistance = std::max(Distance, 0.0f); }
+    float GetMaxDrawDistance() const { return m_culling.MaxDrawDistance; }
+
+    // Updated by the renderer every frame
+    void SetCullingStats(const CullingStats& CameraStats, const CullingStats& ShadowStats) 
+    { 
+        m_culling.CameraStats = CameraStats; 
+        m_culling.ShadowStats = ShadowStats; 
+    }
+
+    const CullingStats& GetCameraCullingStats() const { return m_culling.CameraStats; }
+    const CullingStats& GetShadowCullingStats() const { return m_culling.ShadowStats; }
+
+    // The LOD of every mesh is selected per frame from the camera (see CoreModel::SelectLods)
+    void ControlMeshLod(bool Enable) { m_meshLod.Enabled = Enable; }
+    bool IsMeshLodEnabled() const { return m_meshLod.Enabled; }
+
+    // The max screen space error of the selected LOD in pixels
+    void SetMeshLodPixelError(float Error) { m_meshLod.MaxPixelError = std::max(Error, 0.0f); }
+    float GetMeshLodPixelError() const { return m_meshLod.MaxPixelError; }
+
+    // Updated by the renderer every frame
+    void SetRenderPassTimes(const RenderPassTimes& Times) { m_renderPassTimes = Times; }
+    const RenderPassTimes& GetRenderPassTimes() const { return m_renderPassTimes; }
+
+    // Updated by the renderer every frame
+    void SetMeshLodStats(const MeshLodStats& Stats) { m_meshLod.Stats = Stats; }
+    const MeshLodStats& GetMeshLodStats() const { return m_meshLod.Stats; }
+
+    // All the faces of a point light shadow cube map are rendered in a single pass using a geometry
+    // shader. When disabled the faces are rendered one by one (used to compare the two methods).
+    void ControlLayeredPointShadows(bool Enable) { m_layeredPointShadows.Enabled = Enable; }
+    bool IsLayeredPointShadowsEnabled() const { return m_layeredPointShadows.Enabled; }
+
+    // Updated by the renderer every frame
+    void SetPointShadowStats(const PointShadowStats& Stats) { m_layeredPointShadows.Stats = Stats; }
+    const PointShadowStats& GetPointShadowStats() const { return m_layeredPointShadows.Stats; }
+
+    // The shadow of the first directional light is split into cascades by the distance from the camera
+    void SetNumShadowCascades(int NumCascades) { m_shadowCascades.NumCascades = std::min(std::max(NumCascades, 1), MAX_SHADOW_CASCADES); }
+    int GetNumShadowCascades() const { return m_shadowCascades.NumCascades; }
+
+    // Blends between uniform (0) and logarithmic (1) splits
+    void SetShadowCascadeSplitLambda(float Lambda) { m_shadowCascades.SplitLambda = std::min(1.0f, std::max(Lambda, 0.0f)); }
+    float GetShadowCascadeSplitLambda() const { return m_shadowCascades.SplitLambda; }
+
+    // The distance covered by the cascades. Zero means the far plane of the camera.
+    void SetShadowCascadesMaxDistance(float Distance) { m_shadowCascades.MaxDistance = std::max(Distance, 0.0f); }
+    float GetShadowCascadesMaxDistance() const { return m_shadowCascades.MaxDistance; }
+
+    // A cascade is rendered once every NumFrames frames (the defaults are 1, 1, 2, 4)
+    void SetShadowCascadeUpdateInterval(int Cascade, int NumFrames) {
+        if (Cascade >= 0 && Cascade < MAX_SHADOW_CASCADES) {
+            m_shadowCascades.UpdateIntervals[Cascade] = std::max(NumFrames, 1);
+        } else {
+            printf("Error! invalid shadow cascade %d\n", Cascade);
+            assert(0);
+            exit(0);
+        }
+    }
+
+    int GetShadowCascadeUpdateInterval(int Cascade) const { return m_shadowCascades.UpdateIntervals[Cascade]; }
+
     Texture* pBRDF_LUT = NULL;      // TODO: should be in the material - for some reason crashes...
 
 private:
@@ -310,6 +428,7 @@ private:
     bool m_hdrEnabled = false;
     float m_hdrAverageLuminance = 0.0f;
     float m_hdrExposure = 0.0f;
+    float m_hdrAdaptationRate = 1.5f;
     TONE_MAP_METHOD m_toneMapMethod = TONE_MAP_METHOD_REINHARD;
     bool m_enableGamma = false;
     bool m_ssgiEnabled = false;
@@ -327,6 +446,8 @@ private:
     struct {
         void* pGrid = NULL;
         int m_heightMap = -1;
+        int m_normalMap = -1;
+        float m_normalMapHeightRatio = 1.0f;
         int m_textures[4] = {-1, -1, -1, -1};
         float m_maxHeight = 0.0f;
         float m_texTileSizeInWorldUnits = 20.0f;
@@ -337,6 +458,28 @@ private:
         float m_ambientFactor = 0.2f;
     } m_terrain;
     TERRAIN_RENDER_MODE m_terrainRenderMode = TERRAIN_RENDER_MODE_FULL;
+    struct {
+        bool Enabled = true;
+        float MaxDrawDistance = 0.0f;
+        CullingStats CameraStats;
+        CullingStats ShadowStats;
+    } m_culling;
+    RenderPassTimes m_renderPassTimes;
+    struct {
+        bool Enabled = false;
+        float MaxPixelError = 1.0f;
+        MeshLodStats Stats;
+    } m_meshLod;
+    struct {
+        bool Enabled = true;
+        PointShadowStats Stats;
+    } m_layeredPointShadows;
+    struct {
+        int NumCascades = MAX_SHADOW_CASCADES;
+        float SplitLambda = 0.75f;
+        float MaxDistance = 0.0f;
+        int UpdateIntervals[MAX_SHADOW_CASCADES] = { 1, 1, 2, 4 };
+    } m_shadowCascades;
 };
 
 
@@ -34,7 +34,12 @@ out vec4 FragColor;
 
 vec2 TexCoord;
 
-#define MAX_NUM_LIGHTS 4
+// Must match core_light_clusters.h
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+#define NUM_LIGHT_CLUSTERS (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
 
 #define LIGHT_TYPE_DIR   0
 #define LIGHT_TYPE_POINT 1
@@ -56,6 +61,7 @@ struct LightSource {
     float Atten_Linear;            // offset 52
     float Atten_Exp;               // offset 56
     float Cutoff;                  // offset 60
+    int ShadowMapIndex;            // offset 64 - the cube map in gShadowCubeMap (point lights), -1 for none
 };
 
 
@@ -73,8 +79,15 @@ struct Material {
     sampler2D NormalMap;
 };
 
-layout(std140, binding = 1) uniform LightUBO {
-    LightSource Lights[MAX_NUM_LIGHTS];
+// The global lights come first and then the lights which are assigned to the clusters
+layout(std430, binding = 9) readonly buffer LightsSSBO {
+    LightSource Lights[];
+};
+
+// The number of lights in each cluster followed by a slot of MAX_LIGHTS_PER_CLUSTER indices per cluster
+layout(std430, binding = 10) readonly buffer LightClustersSSBO {
+    uint ClusterLightCounts[NUM_LIGHT_CLUSTERS];
+    uint ClusterLightIndices[];
 };
 
 
@@ -84,21 +97,33 @@ layout(std430, binding = 2) readonly buffer Materials {
 
 
 uniform int gNumLights = 0;
+uniform int gNumGlobalLights = 0;
+uniform mat4 gClusterView;
+uniform vec2 gClusterTileScale;     // clusters per pixel
+uniform vec2 gClusterDepthParams;   // the slice is floor(log(depth) * x + y)
 uniform MaterialColor gMaterial;
 uniform bool gHasSampler = false;
 layout(binding = 0) uniform sampler2D gSampler;
 layout(binding = 1) uniform sampler2D gSamplerSpecularExponent;
 layout(binding = 2) uniform sampler2D gShadowMap;        // required only for shadow mapping (spot/directional light)
-layout(binding = 3) uniform samplerCube gShadowCubeMap;  // required only for shadow mapping (point light)
+layout(binding = 3) uniform samplerCubeArray gShadowCubeMap;  // required only for shadow mapping (point lights)
 layout(binding = 4) uniform sampler3D gShadowMapOffsetTexture;
 layout(binding = 5) uniform sampler2D gNormalMap;
 layout(binding = 12) uniform samplerCube gCubemapTexture;
 layout(binding = 18) uniform sampler2D gProjectedTexture;
+layout(binding = 19) uniform sampler2DArray gShadowCascades;  // required only for shadow mapping (directional light)
 uniform bool gHasNormalMap = false;
 uniform bool gHasHeightMap = false;
 uniform int gShadowMapWidth = 0;
 uniform int gShadowMapHeight = 0;
 uniform int gShadowMapFilterSize = 0;
+
+#define MAX_SHADOW_CASCADES 4   // must match demolition_scene.h
+uniform int gNumShadowCascades = 0;
+uniform mat4 gShadowCascadeView;
+uniform mat4 gShadowCascadeVP[MAX_SHADOW_CASCADES];
+uniform float gShadowCascadeSplits[MAX_SHADOW_CASCADES];     // the far distance of every cascade
+uniform float gShadowCascadeTexelSizes[MAX_SHADOW_CASCADES]; // in world units
 uniform float gShadowMapOffsetTextureSize;
 uniform float gShadowMapOffsetFilterSize;
 uniform float gShadowMapRandomRadius = 0.0;
@@ -172,13 +197,19 @@ float CalcRimLightFactor(vec3 PixelToCamera, vec3 Normal)
 }
 
 
-float CalcShadowFactorPointLight(vec3 LightToPixel)
+float CalcShadowFactorPointLight(int Index, vec3 LightToPixel)
 {
+    int CubeMapIndex = Lights[Index].ShadowMapIndex;
+
+    if (CubeMapIndex < 0) {
+        return 1.0;
+    }
+
     float Distance = length(LightToPixel);
 
     LightToPixel.y = -LightToPixel.y;
 
-    float SampledDistance = texture(gShadowCubeMap, LightToPixel).r;
+    float SampledDistance = texture(gShadowCubeMap, vec4(LightToPixel, float(CubeMapIndex))).r;
 
     float bias = 0.015;
 
@@ -323,18 +354,79 @@ float CalcShadowFactorWithRandomSampling(vec3 LightDirection, vec3 Normal)
 }
 
 
-float CalcShadowFactor(vec3 LightDirection, vec3 Normal, bool IsPoint)
+float CalcShadowFactorCascades(int Index, vec3 LightDirection, vec3 Normal)
+{
+    if (Lights[Index].ShadowMapIndex < 0) {
+        return 1.0;
+    }
+
+    float ViewDepth = -(gShadowCascadeView * vec4(WorldPos0, 1.0)).z;
+
+    // The cascades which are updated less often may lag behind the camera so the
+    // next cascade is used when the pixel is outside of the current one
+    for (int i = 0 ; i < gNumShadowCascades ; i++) {
+        if ((ViewDepth > gShadowCascadeSplits[i]) && (i < gNumShadowCascades - 1)) {
+            continue;
+        }
+
+        // Move the position along the normal by the size of the texels to avoid acne
+        float NormalOffset = gShadowCascadeTexelSizes[i] * 1.5;
+        vec4 LightSpacePos = gShadowCascadeVP[i] * vec4(WorldPos0 + Normal * NormalOffset, 1.0);
+        vec3 ShadowCoords = LightSpacePos.xyz / LightSpacePos.w * 0.5 + vec3(0.5);
+
+        if (any(lessThan(ShadowCoords, vec3(0.0))) || any(greaterThan(ShadowCoords, vec3(1.0)))) {
+            continue;
+        }
+
+        float bias = 0.0005;
+
+        if (gShadowMapFilterSize == 0) {
+            float Depth = texture(gShadowCascades, vec3(ShadowCoords.xy, float(i))).x;
+
+            if (Depth + bias < ShadowCoords.z)
+                return 0.05;
+            else
+                return 1.0;
+        }
+
+        vec2 TexelSize = 1.0 / vec2(textureSize(gShadowCascades, 0).xy);
+
+        float ShadowSum = 0.0;
+
+        int HalfFilterSize = gShadowMapFilterSize / 2;
+
+        for (int y = -HalfFilterSize ; y < -HalfFilterSize + gShadowMapFilterSize ; y++) {
+            for (int x = -HalfFilterSize ; x < -HalfFilterSize + gShadowMapFilterSize ; x++) {
+                vec2 Offset = vec2(x, y) * TexelSize;
+                float Depth = texture(gShadowCascades, vec3(ShadowCoords.xy + Offset, float(i))).x;
+
+                if (Depth + bias >= ShadowCoords.z) {
+                    ShadowSum += 1.0;
+                }
+            }
+        }
+
+        return ShadowSum / float(gShadowMapFilterSize * gShadowMapFilterSize);
+    }
+
+    return 1.0;
+}
+
+
+float CalcShadowFactor(int Index, vec3 LightDirection, vec3 Normal, bool IsPoint)
 {
     float ShadowFactor = 1.0;
 
     if (gShadowsEnabled) {
-        if (gShadowMapRandomRadius > 0.0) {
+        if (!IsPoint && (gNumShadowCascades > 0)) {
+            ShadowFactor = CalcShadowFactorCascades(Index, LightDirection, Normal);
+        } else if (gShadowMapRandomRadius > 0.0) {
             ShadowFactor = CalcShadowFactorWithRandomSampling(LightDirection, Normal);        
         } else if (gShadowMapFilterSize > 0){
             ShadowFactor = CalcShadowFactorPCF(LightDirection, Normal);        
         } else {
             if (IsPoint) {
-                ShadowFactor = CalcShadowFactorPointLight(LightDirection);            
+                ShadowFactor = CalcShadowFactorPointLight(Index, LightDirection);            
             } else {
                 ShadowFactor = CalcShadowFactorBasic(LightDirection, Normal);
             }
@@ -405,7 +497,7 @@ vec4 CalcLightInternal(int Index, vec3 LightDirection, vec3 Normal, float Shadow
 
 vec4 CalcDirectionalLight(int Index, vec3 Normal)
 {
-    float ShadowFactor = CalcShadowFactor(Lights[Index].Direction, Normal, false);
+    float ShadowFactor = CalcShadowFactor(Index, Lights[Index].Direction, Normal, false);
     //return vec4(ShadowFactor);
     return CalcLightInternal(Index, Lights[Index].Direction, Normal, ShadowFactor);
 }
@@ -414,7 +506,7 @@ vec4 CalcDirectionalLight(int Index, vec3 Normal)
 vec4 CalcPointLight(int Index, vec3 Normal, bool IsPoint)
 {
     vec3 LightWorldDir = WorldPos0 - Lights[Index].WorldPos;
-    float ShadowFactor = CalcShadowFactor(LightWorldDir, Normal, IsPoint);
+    float ShadowFactor = CalcShadowFactor(Index, LightWorldDir, Normal, IsPoint);
 
     float Distance = length(LightWorldDir);
     LightWorldDir = normalize(LightWorldDir);
@@ -606,24 +698,52 @@ vec3 GetNormal()
 }
 
 
+uint GetClusterIndex()
+{
+    uvec2 Tile = uvec2(gl_FragCoord.xy * gClusterTileScale);
+    Tile = min(Tile, uvec2(LIGHT_CLUSTERS_X - 1, LIGHT_CLUSTERS_Y - 1));
+
+    float ViewDepth = -(gClusterView * vec4(WorldPos0, 1.0)).z;
+    int Slice = int(floor(log(max(ViewDepth, 0.0001)) * gClusterDepthParams.x + gClusterDepthParams.y));
+    Slice = clamp(Slice, 0, LIGHT_CLUSTERS_Z - 1);
+
+    return (uint(Slice) * LIGHT_CLUSTERS_Y + Tile.y) * LIGHT_CLUSTERS_X + Tile.x;
+}
+
+
+vec4 CalcLight(int Index, vec3 Normal)
+{
+    switch (Lights[Index].LightType) {
+
+        case LIGHT_TYPE_DIR:
+            return CalcDirectionalLight(Index, Normal);
+
+        case LIGHT_TYPE_POINT:
+            return CalcPointLight(Index, Normal, true);
+
+        case LIGHT_TYPE_SPOT:
+            return CalcSpotLight(Index, Normal);
+    }
+
+    return vec4(0.0);
+}
+
+
 vec4 GetTotalLight(vec3 Normal)
 {        
     vec4 TotalLight = vec4(0.0);
 
-    for (int i = 0 ; i < gNumLights ; i++) {
-        switch (Lights[i].LightType) {
-
-            case LIGHT_TYPE_DIR:
-                TotalLight += CalcDirectionalLight(i, Normal);
-                break;
+    for (int i = 0 ; i < gNumGlobalLights ; i++) {
+        TotalLight += CalcLight(i, Normal);
+    }
 
-            case LIGHT_TYPE_POINT:
-                TotalLight += CalcPointLight(i, Normal, true);
-                break;
+    if (gNumLights > gNumGlobalLights) {
+        uint Cluster = GetClusterIndex();
+        uint NumClusterLights = ClusterLightCounts[Cluster];
+        uint FirstIndex = Cluster * MAX_LIGHTS_PER_CLUSTER;
 
-            case LIGHT_TYPE_SPOT:
-                TotalLight += CalcSpotLight(i, Normal);
-                break;
+        for (uint i = 0 ; i < NumClusterLights ; i++) {
+            TotalLight += CalcLight(int(ClusterLightIndices[FirstIndex + i]), Normal);
         }
     }
 
@@ -61,10 +61,19 @@ struct PerObjectData {
 };
 
 
-layout(std430, binding = 1) restrict readonly buffer PerObjectSSBO {
+layout(std430, row_major, binding = 1) restrict readonly buffer PerObjectSSBO {
     PerObjectData o[];
 };
 
+
+//
+// The bone palettes of all the animated objects in the frame.
+// The palette of the current object starts at gBoneBase.
+//
+layout(std430, row_major, binding = 4) restrict readonly buffer BonesSSBO {
+    mat4 gBonePalette[];
+};
+
 out vec2 TexCoord0;
 out vec2 TexCoord1;
 out vec3 Normal0;
@@ -76,15 +85,13 @@ out flat int MaterialIndex;
 out vec4 Color0;
 out vec4 ProjectedTexCoord;
 
-const int MAX_BONES = 200;
-
 uniform mat4 gWVP;
 uniform mat4 gVP;
 uniform mat4 gLightWVP;
 uniform mat4 gLightVP;
 uniform mat4 gWorld;
 uniform mat3 gNormalMatrix;
-uniform mat4 gBones[MAX_BONES];
+uniform int gBoneBase = 0;
 uniform bool gIsPVP = false;
 uniform bool gIsIndirectRender = false;
 uniform mat4 gProjectionMatrix;
@@ -196,10 +203,10 @@ void main()
 	    Weights_ = Weights;
     }
 
-    mat4 BoneTransform = gBones[BoneIDs_[0]] * Weights_[0];
-    BoneTransform     += gBones[BoneIDs_[1]] * Weights_[1];
-    BoneTransform     += gBones[BoneIDs_[2]] * Weights_[2];
-    BoneTransform     += gBones[BoneIDs_[3]] * Weights_[3];
+    mat4 BoneTransform = gBonePalette[gBoneBase + BoneIDs_[0]] * Weights_[0];
+    BoneTransform     += gBonePalette[gBoneBase + BoneIDs_[1]] * Weights_[1];
+    BoneTransform     += gBonePalette[gBoneBase + BoneIDs_[2]] * Weights_[2];
+    BoneTransform     += gBonePalette[gBoneBase + BoneIDs_[3]] * Weights_[3];
 
     vec4 Pos4 = vec4(Position_, 1.0);
     vec4 PosL = BoneTransform * Pos4;
@@ -0,0 +1,105 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+struct DrawElementsIndirectCommand {
+    uint Count;
+    uint InstanceCount;
+    uint FirstIndex;
+    int  BaseVertex;
+    uint BaseInstance;
+};
+
+struct PerObjectData {
+    mat4 WorldMatrix;
+    mat4 NormalMatrix;
+    ivec4 MaterialIndex;
+};
+
+// Local space box of the mesh. Min.w is zero if the bounds are unknown.
+struct MeshBounds {
+    vec4 Min;
+    vec4 Max;
+};
+
+layout(std430, row_major, binding = 1) restrict readonly buffer PerObjectSSBO {
+    PerObjectData InData[];
+};
+
+layout(std430, binding = 5) restrict readonly buffer DrawCmdsSSBO {
+    DrawElementsIndirectCommand InCmds[];
+};
+
+layout(std430, binding = 6) restrict readonly buffer BoundsSSBO {
+    MeshBounds Bounds[];
+};
+
+// The number of visible draws is also the parameter of glMultiDrawElementsIndirectCount
+layout(std430, binding = 7) restrict buffer VisibleCmdsSSBO {
+    uint NumVisible;
+    uint Padding[3];
+    DrawElementsIndirectCommand OutCmds[];
+};
+
+layout(std430, row_major, binding = 8) restrict writeonly buffer VisibleDataSSBO {
+    PerObjectData OutData[];
+};
+
+uniform uint gNumDraws;
+uniform vec4 gFrustumPlanes[6];     // normalized, the normals point into the frustum
+
+
+bool IsVisible(uint DrawIndex)
+{
+    MeshBounds b = Bounds[DrawIndex];
+
+    if (b.Min.w == 0.0) {
+        return true;
+    }
+
+    vec3 Center = (b.Min.xyz + b.Max.xyz) * 0.5;
+    vec3 Extent = (b.Max.xyz - b.Min.xyz) * 0.5;
+
+    // World space box of the mesh - transform the center and project the extents on the world axes
+    mat4 World = InData[DrawIndex].WorldMatrix;
+
+    vec3 WorldCenter = (World * vec4(Center, 1.0)).xyz;
+    vec3 WorldExtent = abs(World[0].xyz) * Extent.x +
+                       abs(World[1].xyz) * Extent.y +
+                       abs(World[2].xyz) * Extent.z;
+
+    for (int i = 0; i < 6; i++) {
+        vec4 Plane = gFrustumPlanes[i];
+
+        // Distance of the corner which is the farthest along the normal
+        float Dist = dot(Plane.xyz, WorldCenter) + dot(abs(Plane.xyz), WorldExtent) + Plane.w;
+
+        if (Dist < 0.0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void main()
+{
+    uint DrawIndex = gl_GlobalInvocationID.x;
+
+    if (DrawIndex >= gNumDraws) {
+        return;
+    }
+
+    if (!IsVisible(DrawIndex)) {
+        return;
+    }
+
+    uint Slot = atomicAdd(NumVisible, 1);
+
+    // The vertex shaders use gl_DrawID so the per object data moves with the command.
+    // The base instance keeps the original draw index (it is not used for anything else).
+    OutCmds[Slot] = InCmds[DrawIndex];
+    OutCmds[Slot].BaseInstance = DrawIndex;
+    OutData[Slot] = InData[DrawIndex];
+}
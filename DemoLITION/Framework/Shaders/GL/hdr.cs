@@ -1,10 +1,12 @@
-#version 460
+#version 450
 
-layout(local_size_x = 10, local_size_y = 10) in;
+// First stage of the average luminance - the sum of the log luminance of every 16x16 tile
+
+layout(local_size_x = 16, local_size_y = 16) in;
 
 layout(binding = 0) uniform sampler2D HdrTex;
 
-layout(std430, binding = 1) buffer Result {
+layout(std430, binding = 13) restrict writeonly buffer TileLuminanceSSBO {
     float TileLuminance[]; // One per workgroup
 };
 
@@ -13,25 +15,30 @@ shared float localLum[gl_WorkGroupSize.x * gl_WorkGroupSize.y];
 void main() 
 {
     ivec2 texCoord = ivec2(gl_GlobalInvocationID.xy);
-    vec3 hdr = texelFetch(HdrTex, texCoord, 0).rgb;
 
-    float lum = dot(hdr, vec3(0.2126, 0.7152, 0.0722));
+    // The tiles on the right and top edges are partially outside of the texture
+    float LogLum = 0.0;
+
+    if (all(lessThan(texCoord, textureSize(HdrTex, 0)))) {
+        vec3 hdr = texelFetch(HdrTex, texCoord, 0).rgb;
+        float lum = dot(hdr, vec3(0.2126, 0.7152, 0.0722));
+        LogLum = log(lum + 0.0001);
+    }
 
-    localLum[gl_LocalInvocationIndex] = log(lum + 0.0001);
+    localLum[gl_LocalInvocationIndex] = LogLum;
     
     barrier();
 
-    // Thread 0 reduces tile luminance
-    if (gl_LocalInvocationIndex == 0) {
-
-        float Sum = 0.0;
-        
-        uint Size = gl_WorkGroupSize.x * gl_WorkGroupSize.y;
-        
-        for (uint i = 0; i < Size; ++i) {
-            Sum += localLum[i];
+    // Parallel reduction in shared memory
+    for (uint Stride = gl_WorkGroupSize.x * gl_WorkGroupSize.y / 2; Stride > 0; Stride /= 2) {
+        if (gl_LocalInvocationIndex < Stride) {
+            localLum[gl_LocalInvocationIndex] += localLum[gl_LocalInvocationIndex + Stride];
         }
 
-        TileLuminance[gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x] = Sum;
+        barrier();
+    }
+
+    if (gl_LocalInvocationIndex == 0) {
+        TileLuminance[gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x] = localLum[0];
     }
 }
@@ -0,0 +1,65 @@
+#version 450
+
+// Second stage of the average luminance - reduces the tiles of hdr.cs and adapts
+// the luminance of the previous frame towards the new average. Runs in a single
+// workgroup and the results stay on the GPU for the tone mapping shaders.
+
+#define LOCAL_SIZE 256
+
+layout(local_size_x = LOCAL_SIZE) in;
+
+layout(std430, binding = 13) restrict readonly buffer TileLuminanceSSBO {
+    float TileLuminance[];
+};
+
+// Must match HDRLuminanceState in gl_hdr_luminance.h
+layout(std430, binding = 14) restrict buffer LuminanceSSBO {
+    float AverageLuminance;     // of the current frame
+    float AdaptedLuminance;
+    float Exposure;
+    uint IsValid;               // zero until the first update
+};
+
+uniform uint gNumTiles;
+uniform float gNumPixels;
+uniform float gDeltaTime;
+uniform float gAdaptationRate;  // zero means no adaptation
+
+shared float localSum[LOCAL_SIZE];
+
+void main()
+{
+    float Sum = 0.0;
+
+    for (uint i = gl_LocalInvocationIndex; i < gNumTiles; i += LOCAL_SIZE) {
+        Sum += TileLuminance[i];
+    }
+
+    localSum[gl_LocalInvocationIndex] = Sum;
+
+    barrier();
+
+    for (uint Stride = LOCAL_SIZE / 2; Stride > 0; Stride /= 2) {
+        if (gl_LocalInvocationIndex < Stride) {
+            localSum[gl_LocalInvocationIndex] += localSum[gl_LocalInvocationIndex + Stride];
+        }
+
+        barrier();
+    }
+
+    if (gl_LocalInvocationIndex == 0) {
+        float AvgLum = exp(localSum[0] / gNumPixels);
+
+        float Adapted = AvgLum;
+
+        // Exponential decay towards the new average (see HDRLuminance::CalcAdaptedLuminance)
+        if ((IsValid != 0) && (gAdaptationRate > 0.0)) {
+            Adapted = AdaptedLuminance + (AvgLum - AdaptedLuminance) * (1.0 - exp(-gDeltaTime * gAdaptationRate));
+        }
+
+        AverageLuminance = AvgLum;
+        AdaptedLuminance = Adapted;
+        Exposure = 0.18 / Adapted;
+        IsValid = 1;
+    }
+}
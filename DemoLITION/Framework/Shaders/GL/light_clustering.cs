@@ -0,0 +1,92 @@
+#version 450
+
+layout(local_size_x = 64) in;
+
+// Must match core_light_clusters.h
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+#define NUM_LIGHT_CLUSTERS (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
+
+#define GROUP_SIZE 64
+
+// View space box of a cluster
+struct ClusterBox {
+    vec4 Min;
+    vec4 Max;
+};
+
+// World space position and radius of the lights which are assigned to the clusters
+layout(std430, binding = 11) restrict readonly buffer LightSpheresSSBO {
+    vec4 Spheres[];
+};
+
+layout(std430, binding = 12) restrict readonly buffer ClusterBoxesSSBO {
+    ClusterBox Boxes[];
+};
+
+// The number of lights in each cluster followed by a slot of MAX_LIGHTS_PER_CLUSTER indices per cluster
+layout(std430, binding = 10) restrict writeonly buffer LightClustersSSBO {
+    uint ClusterLightCounts[NUM_LIGHT_CLUSTERS];
+    uint ClusterLightIndices[];
+};
+
+uniform uint gNumLights;
+uniform uint gFirstLight;       // added to the indices of the lights
+uniform mat4 gView;
+
+// The lights are moved to view space once per group
+shared vec4 ViewSpheres[GROUP_SIZE];
+
+
+bool IntersectsSphere(ClusterBox Box, vec4 Sphere)
+{
+    vec3 d = Sphere.xyz - clamp(Sphere.xyz, Box.Min.xyz, Box.Max.xyz);
+
+    return dot(d, d) <= Sphere.w * Sphere.w;
+}
+
+
+void main()
+{
+    uint Cluster = gl_GlobalInvocationID.x;
+    bool IsValid = Cluster < NUM_LIGHT_CLUSTERS;
+
+    ClusterBox Box;
+
+    if (IsValid) {
+        Box = Boxes[Cluster];
+    }
+
+    uint Count = 0;
+
+    // Every invocation must reach the barriers so the invalid ones only help with the loads
+    for (uint Base = 0; Base < gNumLights; Base += GROUP_SIZE) {
+        uint LightIndex = Base + gl_LocalInvocationIndex;
+
+        if (LightIndex < gNumLights) {
+            vec4 Sphere = Spheres[LightIndex];
+            ViewSpheres[gl_LocalInvocationIndex] = vec4((gView * vec4(Sphere.xyz, 1.0)).xyz, Sphere.w);
+        }
+
+        barrier();
+
+        if (IsValid) {
+            uint NumLoaded = min(GROUP_SIZE, gNumLights - Base);
+
+            for (uint i = 0; i < NumLoaded; i++) {
+                if ((Count < MAX_LIGHTS_PER_CLUSTER) && IntersectsSphere(Box, ViewSpheres[i])) {
+                    ClusterLightIndices[Cluster * MAX_LIGHTS_PER_CLUSTER + Count] = gFirstLight + Base + i;
+                    Count++;
+                }
+            }
+        }
+
+        barrier();
+    }
+
+    if (IsValid) {
+        ClusterLightCounts[Cluster] = Count;
+    }
+}
@@ -57,7 +57,7 @@ struct PerObjectData {
 };
 
 
-layout(std430, binding = 1) restrict readonly buffer PerObjectSSBO {
+layout(std430, row_major, binding = 1) restrict readonly buffer PerObjectSSBO {
     PerObjectData o[];
 };
 
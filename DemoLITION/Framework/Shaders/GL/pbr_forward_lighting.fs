@@ -35,7 +35,12 @@ out vec4 out_FragColor;
 
 vec2 TexCoord;
 
-#define MAX_NUM_LIGHTS 4
+// Must match core_light_clusters.h
+#define LIGHT_CLUSTERS_X 16
+#define LIGHT_CLUSTERS_Y 9
+#define LIGHT_CLUSTERS_Z 24
+#define NUM_LIGHT_CLUSTERS (LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
 
 #define LIGHT_TYPE_DIR   0
 #define LIGHT_TYPE_POINT 1
@@ -62,6 +67,7 @@ struct LightSource {
     float Atten_Linear;            // offset 52
     float Atten_Exp;               // offset 56
     float Cutoff;                  // offset 60
+    int ShadowMapIndex;            // offset 64 - the cube map in gShadowCubeMap (point lights), -1 for none
 };
 
 
@@ -105,17 +111,28 @@ struct PBRInfo {
 };
 
 
-layout(std140, binding = 1) uniform LightUBO {
-    LightSource Lights[MAX_NUM_LIGHTS];
+// The global lights come first and then the lights which are assigned to the clusters
+layout(std430, binding = 9) readonly buffer LightsSSBO {
+    LightSource Lights[];
+};
+
+// The number of lights in each cluster followed by a slot of MAX_LIGHTS_PER_CLUSTER indices per cluster
+layout(std430, binding = 10) readonly buffer LightClustersSSBO {
+    uint ClusterLightCounts[NUM_LIGHT_CLUSTERS];
+    uint ClusterLightIndices[];
 };
 
 
 uniform int gNumLights = 0;
+uniform int gNumGlobalLights = 0;
+uniform mat4 gClusterView;
+uniform vec2 gClusterTileScale;     // clusters per pixel
+uniform vec2 gClusterDepthParams;   // the slice is floor(log(depth) * x + y)
 uniform bool gHasSampler = false;
 layout(binding = 0) uniform sampler2D gAlbedo;
 layout(binding = 1) uniform sampler2D gSamplerSpecularExponent;
 layout(binding = 2) uniform sampler2D gShadowMap;        // required only for shadow mapping (spot/directional light)
-layout(binding = 3) uniform samplerCube gShadowCubeMap;  // required only for shadow mapping (point light)
+layout(binding = 3) uniform samplerCubeArray gShadowCubeMap;  // required only for shadow mapping (point lights)
 layout(binding = 4) uniform sampler3D gShadowMapOffsetTexture;
 layout(binding = 5) uniform sampler2D gNormalMap;
 layout(binding = 6) uniform sampler2D gHeightMap;
@@ -659,6 +676,88 @@ vec3 CalcClearCoat(inout PBRInfo pbrInputs, MetallicRoughnessDataGPU mat, InputA
 }
 
 
+vec3 CalcLightContribution(int Index, inout PBRInfo pbrInputs)
+{
+    vec3 lightDir;
+    float attenuation = 1.0;
+    vec3 lightColor = Lights[Index].Color * Lights[Index].DiffuseIntensity;
+
+    if (Lights[Index].LightType == LIGHT_TYPE_DIR) {
+        // Directional light: direction is fixed
+        lightDir = -normalize(Lights[Index].Direction);
+        // No attenuation for directional lights
+    } else if (Lights[Index].LightType == LIGHT_TYPE_POINT) {
+        // Point light: direction from fragment to light
+        vec3 toLight = Lights[Index].WorldPos - WorldPos0;
+        float dist = length(toLight);
+        lightDir = normalize(toLight);
+        // Standard attenuation
+        attenuation = 1.0 / (Lights[Index].Atten_Constant +
+                             Lights[Index].Atten_Linear * dist +
+                             Lights[Index].Atten_Exp * dist * dist);
+    } else {
+        // Spot light: direction from fragment to light
+        vec3 toLight = Lights[Index].WorldPos - WorldPos0;
+        float dist = length(toLight);
+        lightDir = normalize(toLight);
+
+        // Spotlight cone
+        float spotCos = dot(lightDir, -normalize(Lights[Index].Direction));
+        float cutoff = Lights[Index].Cutoff; // Cosine of cutoff angle
+
+        if (spotCos > cutoff) {
+            // Optional: smooth edge (soft falloff)
+            float epsilon = 0.01; // or a user parameter for softness
+            float intensity = clamp((spotCos - cutoff) / epsilon, 0.0, 1.0);
+
+            attenuation = intensity / (Lights[Index].Atten_Constant +
+                                       Lights[Index].Atten_Linear * dist +
+                                       Lights[Index].Atten_Exp * dist * dist);
+        } else {
+            attenuation = 0.0;
+        }        
+    }
+
+    return calculatePBRLightContribution(pbrInputs, lightDir, lightColor) * attenuation;
+}
+
+
+uint GetClusterIndex()
+{
+    uvec2 Tile = uvec2(gl_FragCoord.xy * gClusterTileScale);
+    Tile = min(Tile, uvec2(LIGHT_CLUSTERS_X - 1, LIGHT_CLUSTERS_Y - 1));
+
+    float ViewDepth = -(gClusterView * vec4(WorldPos0, 1.0)).z;
+    int Slice = int(floor(log(max(ViewDepth, 0.0001)) * gClusterDepthParams.x + gClusterDepthParams.y));
+    Slice = clamp(Slice, 0, LIGHT_CLUSTERS_Z - 1);
+
+    return (uint(Slice) * LIGHT_CLUSTERS_Y + Tile.y) * LIGHT_CLUSTERS_X + Tile.x;
+}
+
+
+// The global lights and then the lights of the cluster of the pixel
+vec3 GetTotalLightContribution(inout PBRInfo pbrInputs)
+{
+    vec3 LightContribution = vec3(0.0);
+
+    for (int i = 0; i < gNumGlobalLights; ++i) {
+        LightContribution += CalcLightContribution(i, pbrInputs);
+    }
+
+    if (gNumLights > gNumGlobalLights) {
+        uint Cluster = GetClusterIndex();
+        uint NumClusterLights = ClusterLightCounts[Cluster];
+        uint FirstIndex = Cluster * MAX_LIGHTS_PER_CLUSTER;
+
+        for (uint i = 0; i < NumClusterLights; ++i) {
+            LightContribution += CalcLightContribution(int(ClusterLightIndices[FirstIndex + i]), pbrInputs);
+        }
+    }
+
+    return LightContribution;
+}
+
+
 void main()
 {
     InputAttributes tc;
@@ -703,51 +802,7 @@ void main()
     SpecularColor = mix(SpecularColor, SpecularColor * Occlusion, OcclusionStrength);
 
 
-    vec3 LightContribution = vec3(0.0);//calculatePBRLightContribution(pbrInputs, LightDirection, LightColor);
-
-    for (int i = 0; i < gNumLights; ++i) {
-        vec3 lightDir;
-        float attenuation = 1.0;
-        vec3 lightColor = Lights[i].Color * Lights[i].DiffuseIntensity;
-
-        if (Lights[i].LightType == LIGHT_TYPE_DIR) {
-            // Directional light: direction is fixed
-            lightDir = -normalize(Lights[i].Direction);
-            // No attenuation for directional lights
-        } else if (Lights[i].LightType == LIGHT_TYPE_POINT) {
-            // Point light: direction from fragment to light
-            vec3 toLight = Lights[i].WorldPos - WorldPos0;
-            float dist = length(toLight);
-            lightDir = normalize(toLight);
-            // Standard attenuation
-            attenuation = 1.0 / (Lights[i].Atten_Constant +
-                                 Lights[i].Atten_Linear * dist +
-                                 Lights[i].Atten_Exp * dist * dist);
-        } else {
-            // Spot light: direction from fragment to light
-            vec3 toLight = Lights[i].WorldPos - WorldPos0;
-            float dist = length(toLight);
-            lightDir = normalize(toLight);
-
-            // Spotlight cone
-            float spotCos = dot(lightDir, -normalize(Lights[i].Direction));
-            float cutoff = Lights[i].Cutoff; // Cosine of cutoff angle
-
-            if (spotCos > cutoff) {
-                // Optional: smooth edge (soft falloff)
-                float epsilon = 0.01; // or a user parameter for softness
-                float intensity = clamp((spotCos - cutoff) / epsilon, 0.0, 1.0);
-
-                attenuation = intensity / (Lights[i].Atten_Constant +
-                                           Lights[i].Atten_Linear * dist +
-                                           Lights[i].Atten_Exp * dist * dist);
-            } else {
-                attenuation = 0.0;
-            }        
-        }
-
-        LightContribution += calculatePBRLightContribution(pbrInputs, lightDir, lightColor) * attenuation;
-    }
+    vec3 LightContribution = GetTotalLightContribution(pbrInputs);
 
     vec3 Color = SpecularColor + DiffuseColor + LightContribution + EmissiveColor.rgb;
     Color = Color * (1.0 - pbrInputs.clearCoatFactor * ClearCoatFresnel) + ClearCoatContrib;
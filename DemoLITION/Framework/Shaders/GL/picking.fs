@@ -16,14 +16,22 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#version 330
+#version 460 core
 
 uniform uint gObjectIndex;
 uniform uint gDrawIndex;
 
+flat in uint ObjectIndex;
+flat in uint DrawIndex;
+flat in int IsIndirectRender;
+
 out uvec3 FragColor;
 
 void main()
 {
-   FragColor = uvec3(gObjectIndex, gDrawIndex, gl_PrimitiveID);
+    if (IsIndirectRender == 1) {
+        FragColor = uvec3(ObjectIndex, DrawIndex, gl_PrimitiveID);
+    } else {
+        FragColor = uvec3(gObjectIndex, gDrawIndex, gl_PrimitiveID);
+    }
 }
\ No newline at end of file
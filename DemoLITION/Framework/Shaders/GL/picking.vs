@@ -17,13 +17,80 @@
 */
 
 
-#version 330                                                                        
-                                                                                    
-layout (location = 0) in vec3 Position;                                             
-                                                                                    
-uniform mat4 gWVP;                                                                  
-                                                                                    
-void main()                                                                         
-{                                                                                   
-    gl_Position = gWVP * vec4(Position, 1.0);                                       
-}
\ No newline at end of file
+#version 460 core
+
+//
+// Non PVP input attributes
+//
+layout (location = 0) in vec3 Position;
+
+// 
+// PVP input attributes
+//
+struct Vertex {
+    float Position[3];
+    float inTexCoord0[2];
+    float inTexCoord1[2];
+    float Normal[3];
+    float Tangent[3];
+    float Bitangent[3];
+    float Color[4];
+};
+
+layout(std430, binding = 0) restrict readonly buffer Vertices {
+    Vertex in_Vertices[];
+};
+
+
+struct PerObjectData {
+    mat4 WorldMatrix;
+    mat4 NormalMatrix;
+    ivec4 MaterialIndex;    // y - object index, z - draw index
+};
+
+
+layout(std430, row_major, binding = 1) restrict readonly buffer PerObjectSSBO {
+    PerObjectData o[];
+};
+
+
+uniform mat4 gWVP;
+uniform mat4 gVP;
+uniform bool gIsPVP = false;
+uniform bool gIsIndirectRender = false;
+
+flat out uint ObjectIndex;
+flat out uint DrawIndex;
+flat out int IsIndirectRender;
+
+vec3 GetPosition(int i)
+{
+    return vec3(in_Vertices[i].Position[0], 
+                in_Vertices[i].Position[1], 
+                in_Vertices[i].Position[2]);
+}
+
+void main()
+{
+    vec3 Position_;
+    
+    if (gIsPVP) {
+        Position_ = GetPosition(gl_VertexID);        
+    } else {
+        Position_ = Position;
+    }
+
+    vec4 Pos4 = vec4(Position_, 1.0);
+
+    if (gIsIndirectRender) {
+        gl_Position = gVP * o[gl_DrawID].WorldMatrix * Pos4;
+        ObjectIndex = uint(o[gl_DrawID].MaterialIndex.y);
+        DrawIndex = uint(o[gl_DrawID].MaterialIndex.z);
+        IsIndirectRender = 1;
+    } else {
+        gl_Position = gWVP * Pos4;
+        ObjectIndex = 0;
+        DrawIndex = 0;
+        IsIndirectRender = 0;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#version 460 core
+
+//
+// Renders a triangle into all the faces of the cube map in a single pass.
+// Every invocation handles one face and writes its layer (the faces
+// are in the order of GL_TEXTURE_CUBE_MAP_POSITIVE_X + i).
+//
+layout (triangles, invocations = 6) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+uniform mat4 gFaceVP[6];
+uniform uint gFaceMask = 0x3F;      // the faces which the current object intersects
+
+out vec3 WorldPos;
+
+
+// True if all the vertices are outside the same clip plane
+bool IsOutsideFace(vec4 ClipPos[3])
+{
+    for (int i = 0; i < 3; i++) {
+        if ((ClipPos[0][i] > ClipPos[0].w) && (ClipPos[1][i] > ClipPos[1].w) && (ClipPos[2][i] > ClipPos[2].w)) {
+            return true;
+        }
+
+        if ((ClipPos[0][i] < -ClipPos[0].w) && (ClipPos[1][i] < -ClipPos[1].w) && (ClipPos[2][i] < -ClipPos[2].w)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void main()
+{
+    int Face = gl_InvocationID;
+
+    if ((gFaceMask & (1u << Face)) == 0u) {
+        return;
+    }
+
+    vec4 ClipPos[3];
+
+    for (int i = 0; i < 3; i++) {
+        ClipPos[i] = gFaceVP[Face] * gl_in[i].gl_Position;
+    }
+
+    if (IsOutsideFace(ClipPos)) {
+        return;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        gl_Layer = Face;
+        WorldPos = gl_in[i].gl_Position.xyz;
+        gl_Position = ClipPos[i];
+        EmitVertex();
+    }
+
+    EndPrimitive();
+}
@@ -36,6 +36,7 @@ layout (binding = 1) uniform sampler2D gTexture0; // Sand
 layout (binding = 2) uniform sampler2D gTexture1; // Grass
 layout (binding = 3) uniform sampler2D gTexture2; // Pure Rock (Cliffs)
 layout (binding = 4) uniform sampler2D gTexture3; // Pure Snow (Peaks)
+layout (binding = 5) uniform sampler2D gNormalMap; // Baked on the CPU, RGB = N * 0.5 + 0.5
 
 uniform float gMaxTerrainHeight = 100.0f;
 uniform float gLowHeightPercent = 0.25;
@@ -44,6 +45,8 @@ uniform vec3 gSunlightDir = normalize(vec3(0.0, 1.0, 0.0));
 uniform float gAmbientFactor = 0.2f;
 uniform float gTriplanarScale = 1.0 / 20.0; 
 uniform int gRenderMode = TERRAIN_RENDER_MODE_FULL;
+uniform bool gUseNormalMap = false;
+uniform float gNormalMapSlopeScale = 1.0;
 
 vec4 SampleTriplanar(sampler2D tex, vec3 worldPos, vec3 normal) 
 {
@@ -96,7 +99,15 @@ void main()
     float gLowHeight = gMaxTerrainHeight * gLowHeightPercent;
     float gHighHeight = gMaxTerrainHeight * gHighHeightPercent;
 
-    vec3 N = normalize(Normal);
+    vec3 N;
+
+    if (gUseNormalMap) {
+        // Full resolution normals regardless of the density of the mesh
+        vec3 BakedNormal = texture(gNormalMap, TexCoords).xyz * 2.0 - 1.0;
+        N = normalize(vec3(BakedNormal.x * gNormalMapSlopeScale, BakedNormal.y, BakedNormal.z * gNormalMapSlopeScale));
+    } else {
+        N = normalize(Normal);
+    }
     
     // 2. Clear Slope Mask (N.y is 1.0 when completely flat)
     float IsFlatGround = smoothstep(0.68, 0.85, N.y); 
@@ -0,0 +1,108 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#version 460 core
+
+// Must match gl_terrain_clipmap.h
+#define MAX_CLIPMAP_LEVELS 16
+
+layout (location = 0) in vec2 aPos;       // vertex inside the block in quads
+layout (location = 1) in vec4 aBlock;     // per instance: origin x/z, quad size and level
+
+out vec3 WorldPos;
+out vec2 TexCoords;
+out vec3 Normal;
+out float OrigHeight;
+
+layout (binding = 0) uniform sampler2D gHeightMap; 
+
+uniform mat4 gWVP;
+uniform float gMaxTerrainHeight = 100.0f;
+uniform float gHorizontalScale = 4.0f;
+uniform vec2 gMapSize;                              // in height map samples
+uniform float gBlockSize;                           // in quads
+uniform int gCoarsestLevel;
+uniform vec4 gLevelWindow[MAX_CLIPMAP_LEVELS];      // min x/z, max x/z in samples
+
+
+// Same mapping as CreateTerrainGridVectors
+vec2 CalcTexCoords(vec2 Pos)
+{
+    return (Pos + gMapSize * 0.5) / (gMapSize - 1.0);
+}
+
+
+// The mip level of the height map matches the size of the quads so that
+// vertices which are shared by two levels get exactly the same height
+float SampleHeight(vec2 Pos, float Lod)
+{
+    return textureLod(gHeightMap, CalcTexCoords(Pos), Lod).r;
+}
+
+
+void main()
+{
+    float Scale = aBlock.z;
+    int Level = int(aBlock.w);
+
+    vec2 Pos = aBlock.xy + aPos * Scale;
+
+    // Zero inside the level and one on its outer edge
+    float Morph = 0.0;
+
+    if (Level < gCoarsestLevel) {
+        vec4 Window = gLevelWindow[Level];
+        vec2 DistMin = Pos - Window.xy;
+        vec2 DistMax = Window.zw - Pos;
+        float Dist = min(min(DistMin.x, DistMin.y), min(DistMax.x, DistMax.y));
+        Morph = clamp(1.0 - Dist / (gBlockSize * Scale), 0.0, 1.0);
+    }
+
+    // The block origin is on the grid of the next level so the odd vertices of
+    // the block are the ones which are missing there. On the edge they collapse
+    // into their even neighbours.
+    Pos -= mod(aPos, 2.0) * Scale * Morph;
+
+    vec2 MapMin = -gMapSize * 0.5;
+    Pos = clamp(Pos, MapMin, MapMin + gMapSize - 1.0);
+
+    float Lod = float(Level) + Morph;
+    float Step = exp2(Lod);
+
+    float HeightSample = SampleHeight(Pos, Lod);
+
+    vec3 DisplacedPos;
+    DisplacedPos.x = Pos.x * gHorizontalScale;
+    DisplacedPos.y = HeightSample * gMaxTerrainHeight;
+    DisplacedPos.z = Pos.y * gHorizontalScale;
+
+    float hL = SampleHeight(Pos + vec2(-Step, 0.0), Lod) * gMaxTerrainHeight;
+    float hR = SampleHeight(Pos + vec2( Step, 0.0), Lod) * gMaxTerrainHeight;
+    float hD = SampleHeight(Pos + vec2(0.0, -Step), Lod) * gMaxTerrainHeight;
+    float hU = SampleHeight(Pos + vec2(0.0,  Step), Lod) * gMaxTerrainHeight;
+
+    float StepDist = 2.0 * Step * gHorizontalScale;
+    Normal = normalize(vec3(hL - hR, StepDist, hD - hU));
+
+    WorldPos = DisplacedPos;
+    TexCoords = CalcTexCoords(Pos);
+    OrigHeight = HeightSample;
+    gl_Position = gWVP * vec4(DisplacedPos, 1.0);
+}
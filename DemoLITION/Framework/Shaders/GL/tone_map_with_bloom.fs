@@ -25,8 +25,12 @@ layout(location = 0) out vec4 FragColor;
 layout(binding = 0) uniform sampler2D gHDRSampler;
 layout(binding = 1) uniform sampler2D gBlurSampler;
 
-layout(std430, binding = 1) buffer Result {
-    float Exposure[]; // One per workgroup
+// Calculated by hdr_adapt.cs (see HDRLuminanceState in gl_hdr_luminance.h)
+layout(std430, binding = 14) restrict readonly buffer LuminanceSSBO {
+    float AverageLuminance;     // of the current frame
+    float AdaptedLuminance;
+    float Exposure;
+    uint IsValid;
 };
 
 // Methods of tone mapping
@@ -36,8 +40,6 @@ layout(std430, binding = 1) buffer Result {
 #define WITH_EXPOSURE   3
 
 
-uniform float gAvgLum;
-uniform float gExposure = 0.4457;
 uniform float White = 1.0;
 uniform int gMethodType = 0;
 uniform bool gEnableGammaCorrection = true;
@@ -83,7 +85,7 @@ vec4 with_exposure()
 {             
     vec3 hdrColor = texture(gHDRSampler, TexCoords).rgb;
   
-    float exposure = gExposure;
+    float exposure = Exposure;
 
     const float targetGray = 0.18;
 
@@ -91,7 +93,7 @@ vec4 with_exposure()
     float minLum = 0.01;
     float maxLum = 1.0;
    
-    //float exposure = targetGray / clamp(gAvgLum + bias, minLum, maxLum);
+    //float exposure = targetGray / clamp(AdaptedLuminance + bias, minLum, maxLum);
         
     // Reinhard operator
     vec3 mapped = hdrColor * exposure;
@@ -121,23 +123,6 @@ vec4 toneMapACES()
 }
 
 
-vec4 with_exposure_tiled()
-{                 
-    vec3 hdrColor = texture(gHDRSampler, TexCoords).rgb;
-
-    int x = int(TexCoords.x * 192.0);
-    int y = int(TexCoords.y * 108.0);
-    float Exposure = Exposure[y * 192 + x];
-  
-    // exposure tone mapping
-    vec3 mapped = vec3(1.0) - exp(-hdrColor * Exposure);
-  
-    vec4 ret = vec4(mapped, 1.0);
-
-    return ret;
-}  
-
-
 vec4 new_method()
 {
     // Retrieve high-res color from texture
@@ -151,7 +136,7 @@ vec4 new_method()
     vec3 xyYCol = vec3( xyzCol.x / xyzSum, xyzCol.y / xyzSum, xyzCol.y);
 
     // Apply the tone mapping operation to the luminance (xyYCol.z or xyzCol.y)
-    float L = (gExposure * xyYCol.z) / gAvgLum;
+    float L = (Exposure * xyYCol.z) / AdaptedLuminance;
     L = (L * ( 1 + L / (White * White) )) / ( 1 + L );
 
     // Using the new luminance, convert back to XYZ
@@ -262,7 +247,7 @@ vec4 bruno_opsenica()
     // Yxy.x is Y, the luminance
     vec3 Yxy = convertRGB2Yxy(rgb);
 
-    float lp = Yxy.x / (9.6 * gAvgLum + 0.0001);
+    float lp = Yxy.x / (9.6 * AdaptedLuminance + 0.0001);
 
     // Replace this line with other tone mapping functions
     // Here we applying the curve to the luminance exclusively
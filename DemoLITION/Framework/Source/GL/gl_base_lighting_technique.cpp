@@ -38,6 +38,10 @@ bool BaseLightingTechnique::InitUniforms()
     GET_UNIFORM_AND_CHECK(VPLoc, "gVP");
     GET_UNIFORM_AND_CHECK(LightVPLoc, "gLightVP");
     GET_UNIFORM_AND_CHECK(NumLightsLoc, "gNumLights");
+    GET_UNIFORM_AND_CHECK(NumGlobalLightsLoc, "gNumGlobalLights");
+    GET_UNIFORM_AND_CHECK(ClusterViewLoc, "gClusterView");
+    GET_UNIFORM_AND_CHECK(ClusterTileScaleLoc, "gClusterTileScale");
+    GET_UNIFORM_AND_CHECK(ClusterDepthParamsLoc, "gClusterDepthParams");
 
     GET_UNIFORM(gRenderMode);
 
@@ -112,6 +116,17 @@ void BaseLightingTechnique::SetNumLights(int NumLights)
 }
 
 
+// The fragment shaders find their cluster using gl_FragCoord and the view space depth
+void BaseLightingTechnique::SetLightClusters(int NumGlobalLights, const Matrix4f& View, const LightClusters& Clusters,
+                                             int WindowWidth, int WindowHeight)
+{
+    glUniform1i(NumGlobalLightsLoc, NumGlobalLights);
+    glUniformMatrix4fv(ClusterViewLoc, 1, GL_TRUE, (const GLfloat*)View.m);
+    glUniform2f(ClusterTileScaleLoc, (float)LIGHT_CLUSTERS_X / (float)WindowWidth, (float)LIGHT_CLUSTERS_Y / (float)WindowHeight);
+    glUniform2f(ClusterDepthParamsLoc, Clusters.GetDepthScale(), Clusters.GetDepthBias());
+}
+
+
 void BaseLightingTechnique::SetRenderMode(RENDER_MODE mode)
 {
     glUniform1i(m_gRenderModeLoc, mode);
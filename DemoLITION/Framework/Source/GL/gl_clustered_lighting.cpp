@@ -0,0 +1,182 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "GL/gl_ssbo_db.h"
+#include "GL/gl_clustered_lighting.h"
+
+#define CLUSTERING_GROUP_SIZE 64                                        // local_size_x in light_clustering.cs
+#define CLUSTER_INDICES_OFFSET (NUM_LIGHT_CLUSTERS * sizeof(uint))      // the counts come first
+#define CLUSTERS_BUFFER_SIZE (CLUSTER_INDICES_OFFSET + NUM_LIGHT_CLUSTERS * MAX_LIGHTS_PER_CLUSTER * sizeof(uint))
+
+
+ClusteredLighting::~ClusteredLighting()
+{
+    if (m_lightsBuffer) {
+        glDeleteBuffers(1, &m_lightsBuffer);
+        glDeleteBuffers(1, &m_spheresBuffer);
+    }
+
+    if (m_boxesBuffer) {
+        glDeleteBuffers(1, &m_boxesBuffer);
+    }
+
+    if (m_clustersBuffer) {
+        glDeleteBuffers(1, &m_clustersBuffer);
+    }
+}
+
+
+void ClusteredLighting::Init()
+{
+    if (!m_clusteringTech.Init()) {
+        printf("Error initializing the light clustering technique\n");
+        exit(1);
+    }
+
+    glCreateBuffers(1, &m_boxesBuffer);
+    glNamedBufferStorage(m_boxesBuffer, NUM_LIGHT_CLUSTERS * sizeof(LightClusters::ClusterBox), NULL, GL_DYNAMIC_STORAGE_BIT);
+
+    glCreateBuffers(1, &m_clustersBuffer);
+    glNamedBufferStorage(m_clustersBuffer, CLUSTERS_BUFFER_SIZE, NULL, GL_DYNAMIC_STORAGE_BIT);
+
+    GLuint Zero = 0;
+    glClearNamedBufferSubData(m_clustersBuffer, GL_R32UI, 0, CLUSTER_INDICES_OFFSET, GL_RED_INTEGER, GL_UNSIGNED_INT, &Zero);
+
+    // Makes sure the lights can be bound even before the first update
+    ReserveLights(1);
+
+    m_isInitialized = true;
+}
+
+
+void ClusteredLighting::ReserveLights(int NumLights)
+{
+    if (NumLights <= m_capacity) {
+        return;
+    }
+
+    if (m_lightsBuffer) {
+        glDeleteBuffers(1, &m_lightsBuffer);
+        glDeleteBuffers(1, &m_spheresBuffer);
+    }
+
+    m_capacity = std::max(NumLights, m_capacity * 2);
+
+    glCreateBuffers(1, &m_lightsBuffer);
+    glNamedBufferStorage(m_lightsBuffer, m_capacity * sizeof(LightSource), NULL, GL_DYNAMIC_STORAGE_BIT);
+
+    glCreateBuffers(1, &m_spheresBuffer);
+    glNamedBufferStorage(m_spheresBuffer, m_capacity * sizeof(Vector4f), NULL, GL_DYNAMIC_STORAGE_BIT);
+}
+
+
+void ClusteredLighting::Update(const Matrix4f& View,
+                               const Matrix4f& Projection,
+                               float zNear,
+                               float zFar,
+                               const std::vector<LightSource>& Lights,
+                               int NumGlobalLights,
+                               const std::vector<Vector4f>& Spheres,
+                               bool UseGPU)
+{
+    assert(m_isInitialized);
+    assert(NumGlobalLights + (int)Spheres.size() == (int)Lights.size());
+
+    m_numLights = (int)Lights.size();
+    m_numGlobalLights = NumGlobalLights;
+    m_view = View;
+
+    int NumClusteredLights = (int)Spheres.size();
+
+    if (!m_clusters.IsSameProjection(Projection, zNear, zFar)) {
+        m_clusters.Init(Projection, zNear, zFar);
+        glNamedBufferSubData(m_boxesBuffer, 0, ARRAY_SIZE_IN_BYTES(m_clusters.GetBoxes()), m_clusters.GetBoxes().data());
+    }
+
+    ReserveLights(m_numLights);
+
+    if (m_numLights > 0) {
+        glNamedBufferSubData(m_lightsBuffer, 0, ARRAY_SIZE_IN_BYTES(Lights), Lights.data());
+    }
+
+    if (NumClusteredLights == 0) {
+        GLuint Zero = 0;
+        glClearNamedBufferSubData(m_clustersBuffer, GL_R32UI, 0, CLUSTER_INDICES_OFFSET, GL_RED_INTEGER, GL_UNSIGNED_INT, &Zero);
+        return;
+    }
+
+    if (!UseGPU) {
+        m_clusters.Assign(View, Spheres.data(), NumClusteredLights, NumGlobalLights, m_counts, m_indices);
+        glNamedBufferSubData(m_clustersBuffer, 0, CLUSTER_INDICES_OFFSET, m_counts.data());
+        glNamedBufferSubData(m_clustersBuffer, CLUSTER_INDICES_OFFSET, ARRAY_SIZE_IN_BYTES(m_indices), m_indices.data());
+        return;
+    }
+
+    glNamedBufferSubData(m_spheresBuffer, 0, ARRAY_SIZE_IN_BYTES(Spheres), Spheres.data());
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_LIGHT_SPHERES, m_spheresBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_LIGHT_CLUSTER_BOXES, m_boxesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_LIGHT_CLUSTERS, m_clustersBuffer);
+
+    // We may be in the middle of a pass so its program is restored below
+    GLint CurProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &CurProgram);
+
+    m_clusteringTech.Enable();
+    m_clusteringTech.SetNumLights(NumClusteredLights);
+    m_clusteringTech.SetFirstLight(NumGlobalLights);
+    m_clusteringTech.SetView(View);
+
+    glDispatchCompute((NUM_LIGHT_CLUSTERS + CLUSTERING_GROUP_SIZE - 1) / CLUSTERING_GROUP_SIZE, 1, 1);
+
+    // The clusters are read by the fragment shaders
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(CurProgram);
+}
+
+
+void ClusteredLighting::Bind()
+{
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_LIGHTS, m_lightsBuffer, 0,
+                      std::max(m_numLights, 1) * sizeof(LightSource));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_LIGHT_CLUSTERS, m_clustersBuffer);
+}
+
+
+void ClusteredLighting::ReadClusters(std::vector<uint>& Counts, std::vector<uint>& Indices)
+{
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    Counts.resize(NUM_LIGHT_CLUSTERS);
+    glGetNamedBufferSubData(m_clustersBuffer, 0, CLUSTER_INDICES_OFFSET, Counts.data());
+
+    Indices.resize(NUM_LIGHT_CLUSTERS * MAX_LIGHTS_PER_CLUSTER);
+    glGetNamedBufferSubData(m_clustersBuffer, CLUSTER_INDICES_OFFSET, ARRAY_SIZE_IN_BYTES(Indices), Indices.data());
+
+    for (int i = 0; i < NUM_LIGHT_CLUSTERS; i++) {
+        if (Counts[i] > MAX_LIGHTS_PER_CLUSTER) {
+            printf("%s:%d - invalid number of lights %d in cluster %d\n", __FILE__, __LINE__, Counts[i], i);
+            exit(1);
+        }
+    }
+}
@@ -98,6 +98,12 @@ bool ForwardLightingTechnique::InitUniforms()
     GET_UNIFORM(gCubeMipmapLevel);
     GET_UNIFORM(gProjectedTexture);
     GET_UNIFORM(gProjectionMatrix);
+    GET_UNIFORM(gShadowCascades);
+    GET_UNIFORM(gNumShadowCascades);
+    GET_UNIFORM(gShadowCascadeView);
+    GET_UNIFORM(gShadowCascadeVP);
+    GET_UNIFORM(gShadowCascadeSplits);
+    GET_UNIFORM(gShadowCascadeTexelSizes);
 
     if (samplerLoc == INVALID_UNIFORM_LOCATION ||
         shadowMapLoc == INVALID_UNIFORM_LOCATION ||
@@ -227,6 +233,12 @@ void ForwardLightingTechnique::SetProjectedTextureUnit(unsigned int TextureUnit)
 }
 
 
+void ForwardLightingTechnique::SetShadowCascadesTextureUnit(unsigned int TextureUnit)
+{
+    glUniform1i(m_gShadowCascadesLoc, TextureUnit);
+}
+
+
 void ForwardLightingTechnique::SetMaterial(const CoreMaterial& material)
 {
     glUniform4f(materialLoc.AmbientColor, material.AmbientColor.r, material.AmbientColor.g, material.AmbientColor.b, material.AmbientColor.a);
@@ -437,3 +449,29 @@ void ForwardLightingTechnique::SetProjectionMatrix(const Matrix4f& m)
 {
     glUniformMatrix4fv(m_gProjectionMatrixLoc, 1, GL_TRUE, (const GLfloat*)m.m);
 }
+
+
+void ForwardLightingTechnique::SetShadowCascades(int NumCascades, const Matrix4f& CameraView, const ShadowCascades& Cascades)
+{
+    glUniform1i(m_gNumShadowCascadesLoc, NumCascades);
+
+    if (NumCascades == 0) {
+        return;
+    }
+
+    Matrix4f LightVPs[MAX_SHADOW_CASCADES];
+    float Splits[MAX_SHADOW_CASCADES];
+    float TexelSizes[MAX_SHADOW_CASCADES];
+
+    for (int i = 0; i < NumCascades; i++) {
+        const ShadowCascades::Cascade& c = Cascades.GetCascade(i);
+        LightVPs[i] = c.LightVP;
+        Splits[i] = c.SplitFar;
+        TexelSizes[i] = c.TexelSize;
+    }
+
+    glUniformMatrix4fv(m_gShadowCascadeViewLoc, 1, GL_TRUE, (const GLfloat*)CameraView.m);
+    glUniformMatrix4fv(m_gShadowCascadeVPLoc, NumCascades, GL_TRUE, (const GLfloat*)LightVPs);
+    glUniform1fv(m_gShadowCascadeSplitsLoc, NumCascades, Splits);
+    glUniform1fv(m_gShadowCascadeTexelSizesLoc, NumCascades, TexelSizes);
+}
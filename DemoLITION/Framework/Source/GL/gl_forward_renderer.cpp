@@ -16,22 +16,33 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <chrono>
+
 #include "ogldev_framebuffer.h"
 #include "GL/gl_engine_common.h"
 #include "GL/gl_forward_renderer.h"
 #include "GL/gl_rendering_system.h"
 #include "GL/gl_model.h"
+#include "GL/gl_ssbo_db.h"
+#include "GL/gl_persistent_ring_buffer.h"
 
 
 #define SHADOW_MAP_WIDTH 2048
 #define SHADOW_MAP_HEIGHT 2048
+#define POINT_SHADOW_MAP_SIZE 1024
+#define MAX_POINT_LIGHT_SHADOWS 4
+#define CASCADE_SHADOW_MAP_SIZE 2048
 
 extern bool UsePVP;
 extern bool UseIndirectRender;
+extern bool UseSceneIndirectRender;
+extern bool UseGPUCulling;
 static bool UseBlitForFinalCopy = true;
+static bool UseClusteredLighting = true;       // false means all the lights are global
+static bool UseGPULightClustering = true;
+static bool UseGPULuminance = true;            // false reads back the HDR buffer (used to validate the GPU path)
 
 #define SSAO_UBO_INDEX  0
-#define LIGHT_UBO_INDEX 1
 
 struct CameraDirection
 {
@@ -60,6 +71,32 @@ struct SSAOParamsInternal
 };
 
 
+// The first point lights of the scene get a shadow cube map. The point
+// light shadows are rendered only when there is no directional light.
+static int GetNumPointLightShadows(GLScene* pScene)
+{
+    if (pScene->GetDirLights().size() > 0) {
+        return 0;
+    }
+
+    return std::min((int)pScene->GetPointLights().size(), MAX_POINT_LIGHT_SHADOWS);
+}
+
+
+static int CountCubeMapFaces(uint FaceMask)
+{
+    int NumFaces = 0;
+
+    for (int Face = 0; Face < NUM_CUBE_MAP_FACES; Face++) {
+        if (FaceMask & (1 << Face)) {
+            NumFaces++;
+        }
+    }
+
+    return NumFaces;
+}
+
+
 static bool IsLightingPass(RENDER_PASS RenderPass)
 {
     bool ret = false;
@@ -123,25 +160,12 @@ void ForwardRenderer::InitForwardRenderer(RenderingSystemGL* pRenderingSystemGL)
     m_brightFilterFBO[0].Init(m_windowWidth / 8, m_windowHeight / 8, 3, true, false, false);
     m_brightFilterFBO[1].Init(m_windowWidth / 8, m_windowHeight / 8, 3, true, false, false);
 
-    int Size = m_windowWidth * m_windowHeight;
-    m_hdrData.resize(Size * 3);
-
-    int local_size_x = 10;
-    int local_size_y = 10;
-    
-    m_hdrNumGroupsX = (int)AlignUpToMultiple(m_windowWidth, local_size_x) / local_size_x;
-    m_hdrNumGroupsY = (int)AlignUpToMultiple(m_windowHeight, local_size_y) / local_size_y;
-    
-    int NumTiles = m_hdrNumGroupsX * m_hdrNumGroupsY;
-
-    m_luminanceBuffer.InitBuffer(NumTiles * sizeof(float), NULL, GL_MAP_READ_BIT |
-                                                                 GL_CLIENT_STORAGE_BIT);
+    m_hdrData.resize(m_windowWidth * m_windowHeight * 3);
+    m_hdrLuminance.Init(m_windowWidth, m_windowHeight);
 
     m_ssaoParams.InitBuffer(sizeof(SSAOParamsInternal), NULL, GL_DYNAMIC_STORAGE_BIT);
 
-    m_lightSources.resize(MAX_NUM_LIGHTS);
-
-    m_lightParams.InitBuffer(ARRAY_SIZE_IN_BYTES(m_lightSources), NULL, GL_DYNAMIC_STORAGE_BIT);
+    m_clusteredLighting.Init();
 
     m_ssaoRotTexture.Load("../Content/textures/rot_texture.bmp", false);
 
@@ -170,6 +194,7 @@ void ForwardRenderer::InitTechniques()
     m_lightingTech.SetSpecularExponentTextureUnit(SPECULAR_EXPONENT_UNIT_INDEX);
     m_lightingTech.SetCubeMapTextureUnit(SKYBOX_TEXTURE_UNIT_INDEX);
     m_lightingTech.SetProjectedTextureUnit(PROJECTED_TEXTURE_UNIT_INDEX);
+    m_lightingTech.SetShadowCascadesTextureUnit(SHADOW_CASCADES_TEXTURE_UNIT_INDEX);
 
     if (!m_skinningTech.Init()) {
         printf("Error initializing the skinning technique\n");
@@ -180,6 +205,7 @@ void ForwardRenderer::InitTechniques()
     m_skinningTech.SetTextureUnit(COLOR_TEXTURE_UNIT_INDEX);
     m_skinningTech.SetShadowMapTextureUnit(SHADOW_TEXTURE_UNIT_INDEX);
     m_skinningTech.SetShadowCubeMapTextureUnit(SHADOW_CUBE_MAP_TEXTURE_UNIT_INDEX);
+    m_skinningTech.SetShadowCascadesTextureUnit(SHADOW_CASCADES_TEXTURE_UNIT_INDEX);
     m_skinningTech.SetNormalMapTextureUnit(NORMAL_TEXTURE_UNIT_INDEX);
     m_skinningTech.SetHeightMapTextureUnit(HEIGHT_TEXTURE_UNIT_INDEX);
     m_skinningTech.SetSpecularExponentTextureUnit(SPECULAR_EXPONENT_UNIT_INDEX);
@@ -225,8 +251,8 @@ void ForwardRenderer::InitTechniques()
         exit(1);
     }
 
-    if (!m_shadowMapPointLightTech.Init()) {
-        printf("Error initializing the shadow mapping point light technique\n");
+    if (!m_shadowCubeMapTech.Init()) {
+        printf("Error initializing the shadow cube map technique\n");
         exit(1);
     }
 
@@ -272,11 +298,6 @@ void ForwardRenderer::InitTechniques()
     m_toneMapTechWithBloom.SetHDRSampler(0);
     m_toneMapTechWithBloom.SetBlurSampler(1);
 
-    if (!m_hdrTech.Init()) {
-        printf("Error initializing the HDR technique\n");
-        exit(1);
-    }
-
     if (!m_geometryTech.Init()) {
         printf("Error initializing the geometry technique\n");
         exit(1);
@@ -314,6 +335,11 @@ void ForwardRenderer::InitTechniques()
         printf("Error initializing the heightmap technique\n");
         exit(1);
     }   
+
+    if (!m_terrainClipmapTech.Init()) {
+        printf("Error initializing the terrain clipmap technique\n");
+        exit(1);
+    }
 }
 
 
@@ -325,20 +351,15 @@ void ForwardRenderer::InitShadowMapping()
     PersProjInfo shadowPersProjInfo = { FOV, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, zNear, zFar };
     m_lightPersProjMatrix.InitPersProjTransform(shadowPersProjInfo);
 
-    // Initialize an orthographic projection matrix for the directional light
-    OrthoProjInfo shadowOrthoProjInfo;
-    shadowOrthoProjInfo.l = -20.0f;
-    shadowOrthoProjInfo.r = 20.0f;
-    shadowOrthoProjInfo.t = 20.0f;
-    shadowOrthoProjInfo.b = -20.0f;
-    shadowOrthoProjInfo.n = -20.0f;
-    shadowOrthoProjInfo.f = 20.0f;
-
-    m_lightOrthoProjMatrix.InitOrthoProjTransform(shadowOrthoProjInfo);
-
     m_shadowMapFBO.Init(SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT, 0, false, true, false);
 
-    if (!m_shadowCubeMapFBO.Init(SHADOW_MAP_WIDTH)) {
+    if (!m_shadowCubeMaps.Init(POINT_SHADOW_MAP_SIZE, MAX_POINT_LIGHT_SHADOWS)) {
+        printf("Error initializing the shadow cube maps\n");
+        exit(1);
+    }
+
+    if (!m_cascadeShadowMaps.Init(CASCADE_SHADOW_MAP_SIZE, MAX_SHADOW_CASCADES)) {
+        printf("Error initializing the shadow cascades\n");
         exit(1);
     }
 }
@@ -415,6 +436,8 @@ void ForwardRenderer::Render(void* pWindow, GLScene* pScene, GameCallbacks* pGam
 
     pGameCallbacks->OnFrame(DeltaTime);
 
+    m_deltaTime = (float)DeltaTime;
+
     if (!m_pCurCamera) {
         printf("ForwardRenderer: camera not initialized\n");
         return;
@@ -423,6 +446,15 @@ void ForwardRenderer::Render(void* pWindow, GLScene* pScene, GameCallbacks* pGam
     if (pScene->GetRenderList().size() == 0) {
         HandleEmptyRenderList(pScene);        
     } else {
+        if (UseIndirectRender) {
+            PersistentRingBuffer::GetPerObjectRing().BeginFrame();
+        }
+
+        CullRenderList(pScene);
+
+        PrepareMeshLod(pScene);
+
+        UpdateLightClusters(pScene);
 
         if (pScene->GetConfig()->IsPickingEnabled()) {
             PickingPass(pWindow, pScene);
@@ -432,6 +464,16 @@ void ForwardRenderer::Render(void* pWindow, GLScene* pScene, GameCallbacks* pGam
         }
 
         ExecuteRenderGraph(pScene, TotalRuntime);
+
+        if (UseIndirectRender) {
+            PersistentRingBuffer::GetPerObjectRing().EndFrame();
+        }
+
+        pScene->GetConfig()->SetCullingStats(m_cameraCullingStats, m_shadowCullingStats);
+        pScene->GetConfig()->SetMeshLodStats(m_meshLod.Stats);
+        pScene->GetConfig()->SetPointShadowStats(m_pointShadowStats);
+
+        m_frameIndex++;
     }
 
     pGameCallbacks->OnFrameEnd();
@@ -440,15 +482,77 @@ void ForwardRenderer::Render(void* pWindow, GLScene* pScene, GameCallbacks* pGam
 }
 
 
+//
+// Calculates the world space bounds of all the objects in the render list and
+// prepares the list of objects which are visible to the camera. The shadow views
+// are culled against the same bounds later on in the shadow map pass.
+//
+void ForwardRenderer::CullRenderList(GLScene* pScene)
+{
+    m_cameraCullingStats = CullingStats();
+    m_shadowCullingStats = CullingStats();
+    m_pointShadowStats = PointShadowStats();
+
+    Matrix4f GlobalWorldRotation(m_pCurCamera->GetGlobalWorldRotation());
+
+    // The meshes of the scene indirect render are culled on the GPU in each pass
+    bool (*pIsCulledElsewhere)(const CoreSceneObject*) = NULL;
+
+    if (UseIndirectRender && UseSceneIndirectRender && UseGPUCulling) {
+        pIsCulledElsewhere = SceneIndirectRender::IsSupported;
+    }
+
+    m_culler.UpdateBounds(pScene->GetRenderList(), GlobalWorldRotation, pIsCulledElsewhere);
+
+    SceneConfig* pConfig = pScene->GetConfig();
+
+    if (pConfig->IsCullingEnabled()) {
+        Matrix4f View = m_pCurCamera->GetViewMatrix();
+        Matrix4f Projection = m_pCurCamera->GetProjMatrixGLM();
+        Matrix4f VP = Projection * View;
+
+        glm::vec3 CameraPos = m_pCurCamera->GetPosition();
+        Vector3f ViewPos(CameraPos.x, CameraPos.y, CameraPos.z);
+
+        m_culler.Cull(VP, ViewPos, pConfig->GetMaxDrawDistance(), m_cameraVisibleList, m_cameraCullingStats);
+    } else {
+        m_culler.GetAllObjects(m_cameraVisibleList, m_cameraCullingStats);
+    }
+}
+
+
+// Shadow casters outside the camera frustum may still cast shadows into it
+// so only the frustum of the light is used here (no distance culling)
+void ForwardRenderer::CullShadowView(SceneConfig* pConfig, const Matrix4f& LightVP)
+{
+    if (pConfig->IsCullingEnabled()) {
+        Vector3f Origin(0.0f, 0.0f, 0.0f);
+        float MaxDistance = 0.0f;
+        m_culler.Cull(LightVP, Origin, MaxDistance, m_shadowVisibleList, m_shadowCullingStats);
+    } else {
+        m_culler.GetAllObjects(m_shadowVisibleList, m_shadowCullingStats);
+    }
+}
+
+
 void ForwardRenderer::ExecuteRenderGraph(GLScene* pScene, double TotalRuntime)
 {
     PrePass(pScene);
 
+    m_shadowPassTimer.Begin();
     ShadowMapPass(pScene);
+    m_shadowPassTimer.End();
 
+    m_lightingPassTimer.Begin();
     LightingPass(pScene, TotalRuntime);
+    m_lightingPassTimer.End();
 
     PostProcessPass(pScene);
+
+    RenderPassTimes Times;
+    Times.ShadowPassMs = m_shadowPassTimer.GetTimeMs();
+    Times.LightingPassMs = m_lightingPassTimer.GetTimeMs();
+    pScene->GetConfig()->SetRenderPassTimes(Times);
 };
 
 
@@ -469,12 +573,17 @@ void ForwardRenderer::PostProcessPass(GLScene* pScene)
 	bool IsBloom = pScene->GetConfig()->IsBloomEnabled();
 
     float AverageLuminance = 0.0f;
-    float Exposure = 0.0f;
 
     if (IsHDR) {
-        //HDRPassCPU(AverageLuminance, Exposure);
-        HDRPassGPU(AverageLuminance, Exposure);
-        pScene->GetConfig()->SetHDRParams(AverageLuminance, Exposure);
+        if (UseGPULuminance) {
+            HDRPassGPU(pScene);
+        } else {
+            HDRPassCPU(pScene);
+        }
+
+        const HDRLuminanceState& State = m_hdrLuminance.GetLastState();
+        AverageLuminance = State.AdaptedLuminance;
+        pScene->GetConfig()->SetHDRParams(State.AverageLuminance, State.Exposure);
 
         if (IsBloom) {
             BrightPass(pScene, AverageLuminance);
@@ -494,7 +603,7 @@ void ForwardRenderer::PostProcessPass(GLScene* pScene)
         SSAOPass(pScene);
         SSAOCombinePass();
     } else if (IsHDR) {
-        ToneMappingPass(pScene, AverageLuminance, Exposure);
+        ToneMappingPass(pScene);
 
         /*if (UseBlitForFinalCopy) {
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -527,10 +636,11 @@ void ForwardRenderer::HandleEmptyRenderList(GLScene* pScene)
 void ForwardRenderer::RenderTerrain(SceneConfig* pConfig)
 {
     TerrainGrid* pTerrainGrid = (TerrainGrid*)pConfig->GetTerrainGrid();
-    m_terrainTech.Enable();
+    TerrainTechnique* pTech = pTerrainGrid->IsClipmap() ? &m_terrainClipmapTech : &m_terrainTech;
+    pTech->Enable();
     Matrix4f GlobalWorldRotation(m_pCurCamera->GetGlobalWorldRotation());
     Matrix4f WVP = m_pCurCamera->GetMatrix() * GlobalWorldRotation;
-    m_terrainTech.SetWVP(WVP);
+    pTech->SetWVP(WVP);
     int HeightMap = pConfig->GetTerrainHeightMap();
     if (HeightMap != -1) {
         //m_terrainTech.SetProjectionMatrix(pConfig->GetProjectionMatrix());
@@ -546,14 +656,38 @@ void ForwardRenderer::RenderTerrain(SceneConfig* pConfig)
         }
     }
 
-    m_terrainTech.SetMaxTerrainHeight(pConfig->GetTerrainMaxHeight());
-    m_terrainTech.SetHorizontalScale(pConfig->GetTerrainHorizontalScale());
-    m_terrainTech.SetHeightPercents(pConfig->GetTerrainLowHeightPercent(),
-                                    pConfig->GetTerrainHighHeightPercent());
-    m_terrainTech.SetSunlightDir(pConfig->GetTerrainSunlightDir());
-    m_terrainTech.SetAmbientLightFactor(pConfig->GetTerrainAmbientFactor());
-    m_terrainTech.SetTexTileSizeInWorldUnits(pConfig->GetTerrainTexTileSizeInWorldUnits());
-    m_terrainTech.SetRenderMode(pConfig->GetTerrainRenderMode());
+    pTech->SetMaxTerrainHeight(pConfig->GetTerrainMaxHeight());
+    pTech->SetHorizontalScale(pConfig->GetTerrainHorizontalScale());
+    pTech->SetHeightPercents(pConfig->GetTerrainLowHeightPercent(),
+                             pConfig->GetTerrainHighHeightPercent());
+    pTech->SetSunlightDir(pConfig->GetTerrainSunlightDir());
+    pTech->SetAmbientLightFactor(pConfig->GetTerrainAmbientFactor());
+    pTech->SetTexTileSizeInWorldUnits(pConfig->GetTerrainTexTileSizeInWorldUnits());
+    pTech->SetRenderMode(pConfig->GetTerrainRenderMode());
+
+    int NormalMap = pConfig->GetTerrainNormalMap();
+    if (NormalMap != -1) {
+        Texture* pNormalMap = (Texture*)m_pRenderingSystemGL->GetTexture(NormalMap);
+        pNormalMap->Bind(GL_TEXTURE5);
+
+        // The map was baked with a different ratio of height to world scale
+        float HeightRatio = pConfig->GetTerrainMaxHeight() / pConfig->GetTerrainHorizontalScale();
+        pTech->SetNormalMap(true, HeightRatio / pConfig->GetTerrainNormalMapHeightRatio());
+    } else {
+        pTech->SetNormalMap(false);
+    }
+
+    if (pTerrainGrid->IsClipmap()) {
+        TerrainClipmap* pClipmap = (TerrainClipmap*)pTerrainGrid;
+
+        // The blocks are selected in the space of the terrain
+        Vector4f CameraPos(m_pCurCamera->GetPos(), 1.0f);
+        CameraPos = GlobalWorldRotation.Inverse() * CameraPos;
+
+        pClipmap->Update(CameraPos.to3D(), WVP, pConfig->GetTerrainHorizontalScale(), pConfig->GetTerrainMaxHeight());
+        m_terrainClipmapTech.SetClipmap(*pClipmap);
+    }
+
     pTerrainGrid->Render();
 }
 
@@ -599,20 +733,50 @@ void ForwardRenderer::ApplySceneConfig(GLScene* pScene)
 
 
 void ForwardRenderer::UpdateLightSources(GLScene* pScene)
+{
+    m_pCurLightingTech->SetNumLights(m_clusteredLighting.GetNumLights());
+    m_pCurLightingTech->SetLightClusters(m_clusteredLighting.GetNumGlobalLights(),
+                                         m_clusteredLighting.GetView(),
+                                         m_clusteredLighting.GetClusters(),
+                                         m_windowWidth, m_windowHeight);
+
+    int NumCascades = (m_curRenderPass == RENDER_PASS_LIGHTING_DIR) ? m_shadowCascades.GetNumCascades() : 0;
+    Matrix4f View(m_pCurCamera->GetViewMatrix());
+    m_pCurLightingTech->SetShadowCascades(NumCascades, View, m_shadowCascades);
+}
+
+
+//
+// Uploads the lights of the scene and assigns them to the clusters of the camera.
+// Called once per frame before any of the passes.
+//
+void ForwardRenderer::UpdateLightClusters(GLScene* pScene)
 {
     SetupLightSourcesArray(pScene);
 
-    // TODO: can update only the correct number of lights
-    m_lightParams.Update(m_lightSources.data(), ARRAY_SIZE_IN_BYTES(m_lightSources));
+    const PersProjInfo& ProjInfo = m_pCurCamera->GetPersProjInfo();
+    Matrix4f View(m_pCurCamera->GetViewMatrix());
+    Matrix4f Projection(m_pCurCamera->GetProjMatrixGLM());
+
+    m_clusteredLighting.Update(View, Projection, ProjInfo.zNear, ProjInfo.zFar,
+                               m_lightSources, m_numGlobalLights, m_lightSpheres,
+                               UseGPULightClustering);
 }
 
 
+//
+// The global lights (directional lights and lights which never fade out) are moved
+// to the front of the array and the rest get a bounding sphere for the clusters.
+//
 void ForwardRenderer::SetupLightSourcesArray(GLScene* pScene)
 {
+    int NumLights = (int)(pScene->GetSpotLights().size() + pScene->GetDirLights().size() + pScene->GetPointLights().size());
+
+    m_lightSources.resize(NumLights);
+
     int LightIndex = 0;
 
     for (const SpotLight& l : pScene->GetSpotLights()) {
-        assert(LightIndex < MAX_NUM_LIGHTS);
         m_lightSources[LightIndex].LightType = LIGHT_TYPE_SPOT;
         m_lightSources[LightIndex].AmbientIntensity = l.AmbientIntensity;
         m_lightSources[LightIndex].Atten_Constant = l.Attenuation.Constant;
@@ -624,11 +788,13 @@ void ForwardRenderer::SetupLightSourcesArray(GLScene* pScene)
         Vector3f Dir = l.WorldDirection;
         m_lightSources[LightIndex].Direction = Dir.Normalize().ToGLM();
         m_lightSources[LightIndex].WorldPos = l.WorldPosition.ToGLM();
+        m_lightSources[LightIndex].ShadowMapIndex = -1;
         LightIndex++;
     }
 
+    int DirLightIndex = 0;
+
     for (const DirectionalLight& l : pScene->GetDirLights()) {
-        assert(LightIndex < MAX_NUM_LIGHTS);
         m_lightSources[LightIndex].LightType = LIGHT_TYPE_DIR;
         m_lightSources[LightIndex].AmbientIntensity = l.AmbientIntensity;
         m_lightSources[LightIndex].Atten_Constant = 0.0f;
@@ -640,11 +806,16 @@ void ForwardRenderer::SetupLightSourcesArray(GLScene* pScene)
         Vector3f Dir = l.WorldDirection;
         m_lightSources[LightIndex].Direction = Dir.Normalize().ToGLM();
         m_lightSources[LightIndex].WorldPos = glm::vec3(0.0f);
+        // Only the first directional light has shadow cascades
+        m_lightSources[LightIndex].ShadowMapIndex = (DirLightIndex == 0) ? 0 : -1;
         LightIndex++;
+        DirLightIndex++;
     }
 
+    int NumPointLightShadows = GetNumPointLightShadows(pScene);
+    int PointLightIndex = 0;
+
     for (const PointLight& l : pScene->GetPointLights()) {
-        assert(LightIndex < MAX_NUM_LIGHTS);
         m_lightSources[LightIndex].LightType = LIGHT_TYPE_POINT;
         m_lightSources[LightIndex].AmbientIntensity = l.AmbientIntensity;
         m_lightSources[LightIndex].Atten_Constant = l.Attenuation.Constant;
@@ -655,10 +826,36 @@ void ForwardRenderer::SetupLightSourcesArray(GLScene* pScene)
         m_lightSources[LightIndex].DiffuseIntensity = l.DiffuseIntensity;
         m_lightSources[LightIndex].Direction = glm::vec3(0.0f);
         m_lightSources[LightIndex].WorldPos = l.WorldPosition.ToGLM();
+        m_lightSources[LightIndex].ShadowMapIndex = (PointLightIndex < NumPointLightShadows) ? PointLightIndex : -1;
         LightIndex++;
+        PointLightIndex++;
+    }
+
+    m_numGlobalLights = 0;
+    m_lightSpheres.clear();
+    m_clusteredLightSources.clear();
+
+    for (int i = 0; i < NumLights; i++) {
+        const LightSource& l = m_lightSources[i];
+
+        float Radius = -1.0f;
+
+        if (UseClusteredLighting && (l.LightType != LIGHT_TYPE_DIR)) {
+            float MaxColor = std::max(l.Color.r, std::max(l.Color.g, l.Color.b));
+            float Intensity = MaxColor * (l.DiffuseIntensity + l.AmbientIntensity);
+            Radius = LightClusters::CalcLightRadius(Intensity, l.Atten_Constant, l.Atten_Linear, l.Atten_Exp);
+        }
+
+        if (Radius < 0.0f) {
+            m_lightSources[m_numGlobalLights] = l;      // never ahead of i
+            m_numGlobalLights++;
+        } else {
+            m_clusteredLightSources.push_back(l);
+            m_lightSpheres.push_back(Vector4f(l.WorldPos.x, l.WorldPos.y, l.WorldPos.z, Radius));
+        }
     }
 
-    m_pCurLightingTech->SetNumLights(LightIndex);
+    std::copy(m_clusteredLightSources.begin(), m_clusteredLightSources.end(), m_lightSources.begin() + m_numGlobalLights);
 }
 
 
@@ -673,6 +870,12 @@ void ForwardRenderer::PickingPass(void* pWindow, GLScene* pScene)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     m_pickingTech.Enable();
+    m_pickingTech.ControlIndirectRender(UseIndirectRender);
+    m_pickingTech.ControlPVP(UsePVP);
+
+    if (UseIndirectRender) {
+        m_pickingTech.SetVP(GetViewProjectionMatrix());
+    }
 
     PickingRenderScene(pScene);
 
@@ -684,13 +887,21 @@ void ForwardRenderer::PickingPass(void* pWindow, GLScene* pScene)
 
 void ForwardRenderer::PickingRenderScene(GLScene* pScene)
 {
-    const std::list<CoreSceneObject*>& RenderList = pScene->GetRenderList();
+    const std::vector<CoreSceneObject*>* pRenderList = &m_cameraVisibleList;
 
-    for (std::list<CoreSceneObject*>::const_iterator it = RenderList.begin(); it != RenderList.end(); it++) {
-        int ObjectIndex = (*it)->GetId() + 1;  // Background is zero, the real objects start at 1
+    // The object index of the batched objects is taken from the per object data
+    if (UseIndirectRender && UseSceneIndirectRender) {
+        Matrix4f GlobalRotation(m_pCurCamera->GetGlobalWorldRotation());
+        Matrix4f VP = GetViewProjectionMatrix();
+        m_sceneIndirectRender.Render(m_cameraVisibleList, GlobalRotation, GetGPUCullingVP(VP), m_sceneNotRenderedList);
+        pRenderList = &m_sceneNotRenderedList;
+    }
+
+    for (CoreSceneObject* pSceneObject : *pRenderList) {
+        int ObjectIndex = pSceneObject->GetId() + 1;  // Background is zero, the real objects start at 1
         m_pickingTech.SetObjectIndex(ObjectIndex);
 
-        m_pcurSceneObject = *it;
+        m_pcurSceneObject = pSceneObject;
         RenderSingleObject(m_pcurSceneObject);
     }
 }
@@ -743,71 +954,207 @@ void ForwardRenderer::ShadowMapPass(GLScene* pScene)
     }
 
     int NumDirLights = (int)pScene->GetDirLights().size();
+    int NumPointLights = (int)pScene->GetPointLights().size();
 
     if (NumDirLights > 0) {
-        const std::vector<DirectionalLight>& DirLights = pScene->GetDirLights();
+        m_curRenderPass = RENDER_PASS_SHADOW_DIR;
+        ShadowMapPassCascades(pScene);
+    } else if (NumPointLights > 0) {
+        m_curRenderPass = RENDER_PASS_SHADOW_POINT;
+        ShadowMapPassPoint(pScene);
+    } else {  
+        m_curRenderPass = RENDER_PASS_SHADOW_SPOT;
+        Matrix4f LightVP = m_lightPersProjMatrix * m_lightViewMatrix;
+        CullShadowView(pScene->GetConfig(), LightVP);
+        ShadowMapPassDirAndSpot(LightVP);
+    }
+}
+
+
+//
+// Renders the shadow cube maps of the first point lights. In the layered path every
+// object is submitted once per cube map and the geometry shader replicates its triangles
+// to the faces which the object intersects. Otherwise the entire render list is submitted
+// for every face.
+//
+void ForwardRenderer::ShadowMapPassPoint(GLScene* pScene)
+{
+    std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+    const std::vector<PointLight>& PointLights = pScene->GetPointLights();
+    SceneConfig* pConfig = pScene->GetConfig();
+    bool Layered = pConfig->IsLayeredPointShadowsEnabled();
 
-        OrthoProjInfo LightOrthoProjInfo;
-        Vector3f LightWorldPos;
+    m_pointShadowStats.NumCubeMaps = GetNumPointLightShadows(pScene);
 
-        CalcTightLightProjection(m_pCurCamera->GetViewMatrix(),   // in
-            DirLights[0].WorldDirection,     // in
-            m_pCurCamera->GetPersProjInfo(), // in
-            LightWorldPos,                   // out
-            LightOrthoProjInfo);             // out
+    m_shadowCubeMapTech.Enable();
+    m_shadowCubeMapTech.ControlIndirectRender(UseIndirectRender);
+    m_shadowCubeMapTech.ControlPVP(UsePVP);
 
-        Vector3f Up(0.0f, 1.0f, 0.0f);
-        m_lightViewMatrix.InitCameraTransform(LightWorldPos, DirLights[0].WorldDirection, Up);
+    for (int i = 0; i < m_pointShadowStats.NumCubeMaps; i++) {
+        const Vector3f& LightPos = PointLights[i].WorldPosition;
+
+        Matrix4f FaceVPs[NUM_CUBE_MAP_FACES];
+
+        for (int Face = 0; Face < NUM_CUBE_MAP_FACES; Face++) {
+            Matrix4f FaceView;
+            FaceView.InitCameraTransform(LightPos, gCameraDirections[Face].Target, gCameraDirections[Face].Up);
+            FaceVPs[Face] = m_lightPersProjMatrix * FaceView;
+        }
+
+        m_shadowCubeMaps.BindForWriting(i);
+        m_shadowCubeMaps.Clear();
+
+        m_shadowCubeMapTech.SetLightWorldPos(LightPos);
+        m_shadowCubeMapTech.SetFaceVPs(FaceVPs);
+
+        if (Layered) {
+            if (pConfig->IsCullingEnabled()) {
+                m_culler.CullCube(FaceVPs, m_shadowVisibleList, m_shadowFaceMasks, m_shadowCullingStats);
+            } else {
+                m_culler.GetAllObjects(m_shadowVisibleList, m_shadowCullingStats);
+                m_shadowFaceMasks.assign(m_shadowVisibleList.size(), ALL_CUBE_MAP_FACES);
+            }
+
+            RenderCubeMapObjects(m_shadowVisibleList, m_shadowFaceMasks, m_pointShadowStats);
+        } else {
+            m_culler.GetAllObjects(m_shadowVisibleList, m_shadowCullingStats);
 
-        if (DirLights.size() > 1) {
-            //printf("%s:%d - only a single directional light is supported\n", __FILE__, __LINE__);
+            for (int Face = 0; Face < NUM_CUBE_MAP_FACES; Face++) {
+                m_shadowFaceMasks.assign(m_shadowVisibleList.size(), 1 << Face);
+                RenderCubeMapObjects(m_shadowVisibleList, m_shadowFaceMasks, m_pointShadowStats);
+            }
         }
     }
 
-    int NumPointLights = (int)pScene->GetPointLights().size();
+    std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+    m_pointShadowStats.CPUTimeMs = (float)std::chrono::duration<double, std::milli>(End - Start).count();
+}
 
-    if (NumDirLights > 0) {
-        m_curRenderPass = RENDER_PASS_SHADOW_DIR;
-        ShadowMapPassDirAndSpot(pScene->GetRenderList());
-    } else if (NumPointLights > 0) {
-        m_curRenderPass = RENDER_PASS_SHADOW_POINT;
-        ShadowMapPassPoint(pScene->GetRenderList(), pScene->GetPointLights());
-    } else {  
-        m_curRenderPass = RENDER_PASS_SHADOW_SPOT;
-        ShadowMapPassDirAndSpot(pScene->GetRenderList());
+
+void ForwardRenderer::RenderCubeMapObjects(const std::vector<CoreSceneObject*>& Objects, 
+                                           const std::vector<uint>& FaceMasks, 
+                                           PointShadowStats& Stats)
+{
+    if (UseIndirectRender && UseSceneIndirectRender) {
+        // A single draw for all the objects so they share the union of their faces
+        uint FaceMask = 0;
+
+        for (uint Mask : FaceMasks) {
+            FaceMask |= Mask;
+        }
+
+        m_shadowCubeMapTech.SetFaceMask(FaceMask);
+
+        Matrix4f GlobalRotation(m_pCurCamera->GetGlobalWorldRotation());
+        m_sceneIndirectRender.Render(Objects, GlobalRotation, NULL, m_sceneNotRenderedList);
+
+        int NumFaces = CountCubeMapFaces(FaceMask);
+
+        Stats.NumSubmissions++;
+        Stats.NumDrawCalls++;
+        Stats.NumObjectFaces += (int)(Objects.size() - m_sceneNotRenderedList.size()) * NumFaces;
+
+        for (CoreSceneObject* pSceneObject : m_sceneNotRenderedList) {
+            m_pcurSceneObject = pSceneObject;
+            RenderSingleObject(m_pcurSceneObject);
+            Stats.NumSubmissions++;
+            Stats.NumDrawCalls++;
+            Stats.NumObjectFaces += NumFaces;
+        }
+
+        return;
+    }
+
+    for (int i = 0; i < (int)Objects.size(); i++) {
+        m_pcurSceneObject = Objects[i];
+        m_shadowCubeMapTech.SetFaceMask(FaceMasks[i]);
+        RenderSingleObject(m_pcurSceneObject);
+
+        Stats.NumSubmissions++;
+        Stats.NumDrawCalls += UseIndirectRender ? 1 : (int)m_pcurSceneObject->GetModel()->GetNumMeshes();
+        Stats.NumObjectFaces += CountCubeMapFaces(FaceMasks[i]);
     }
 }
 
 
-void ForwardRenderer::ShadowMapPassPoint(const std::list<CoreSceneObject*>& RenderList, const std::vector<PointLight>& PointLights)
+//
+// Renders the shadow cascades of the first directional light. Every cascade which
+// is due for an update is fitted to its slice of the camera frustum and only the
+// objects inside its projection are rendered into its layer of the shadow map array.
+//
+void ForwardRenderer::ShadowMapPassCascades(GLScene* pScene)
 {
-    m_shadowMapPointLightTech.Enable();
-    m_shadowMapPointLightTech.SetLightWorldPos(PointLights[0].WorldPosition);
+    SceneConfig* pConfig = pScene->GetConfig();
+
+    int NumCascades = pConfig->GetNumShadowCascades();
+
+    if (m_shadowCascades.GetNumCascades() != NumCascades) {
+        m_shadowCascades.Init(NumCascades, CASCADE_SHADOW_MAP_SIZE);
+    }
+
+    for (int i = 0; i < NumCascades; i++) {
+        m_shadowCascades.SetUpdateInterval(i, pConfig->GetShadowCascadeUpdateInterval(i));
+    }
+
+    const PersProjInfo& ProjInfo = m_pCurCamera->GetPersProjInfo();
+    float MaxDistance = pConfig->GetShadowCascadesMaxDistance();
+
+    if ((MaxDistance == 0.0f) || (MaxDistance > ProjInfo.zFar)) {
+        MaxDistance = ProjInfo.zFar;
+    }
+
+    float Splits[MAX_SHADOW_CASCADES + 1];
+    ShadowCascades::CalcSplits(ProjInfo.zNear, MaxDistance, NumCascades, pConfig->GetShadowCascadeSplitLambda(), Splits);
+
+    Vector3f LightDir = pScene->GetDirLights()[0].WorldDirection;
+    LightDir.Normalize();
+
+    Matrix4f View(m_pCurCamera->GetViewMatrix());
+    Matrix4f Projection(m_pCurCamera->GetProjMatrixGLM());
+
+    AABB CasterBounds;
+    bool HasCasterBounds = m_culler.GetSceneBounds(CasterBounds);
+
+    m_shadowMapTech.Enable();
+    m_shadowMapTech.ControlIndirectRender(UseIndirectRender);
+    m_shadowMapTech.ControlPVP(UsePVP);
+
+    for (int i = 0; i < NumCascades; i++) {
+        if (!m_shadowCascades.NeedsUpdate(i, m_frameIndex, Splits[i], Splits[i + 1], LightDir)) {
+            continue;
+        }
+
+        m_shadowCascades.Update(i, m_frameIndex, View, Projection, ProjInfo.zNear, ProjInfo.zFar,
+                                Splits[i], Splits[i + 1], LightDir, HasCasterBounds ? &CasterBounds : NULL);
+
+        m_curLightVP = m_shadowCascades.GetCascade(i).LightVP;
+
+        CullShadowView(pConfig, m_curLightVP);
 
-    glClearColor(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+        m_cascadeShadowMaps.BindForWriting(i);
+        glClear(GL_DEPTH_BUFFER_BIT);
 
-    for (uint i = 0; i < NUM_CUBE_MAP_FACES; i++) {
-        m_shadowCubeMapFBO.BindForWriting(gCameraDirections[i].CubemapFace);
-        glViewport(0, 0, SHADOW_MAP_WIDTH, SHADOW_MAP_HEIGHT);  // TODO: should be done in the FBO
-        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
-        m_lightViewMatrix.InitCameraTransform(PointLights[0].WorldPosition, gCameraDirections[i].Target, gCameraDirections[i].Up);
-        RenderEntireRenderList(RenderList);
+        if (UseIndirectRender) {
+            m_shadowMapTech.SetVP(m_curLightVP);
+        }
+
+        RenderEntireRenderList(m_shadowVisibleList, m_curLightVP);
     }
 }
 
 
-void ForwardRenderer::ShadowMapPassDirAndSpot(const std::list<CoreSceneObject*>& RenderList)
+void ForwardRenderer::ShadowMapPassDirAndSpot(const Matrix4f& LightVP)
 {
     m_shadowMapFBO.BindForWriting();
     glClear(GL_DEPTH_BUFFER_BIT);
     m_shadowMapTech.Enable();
     if (UseIndirectRender) {
-        Matrix4f VP = m_lightPersProjMatrix * m_lightViewMatrix;
-        m_shadowMapTech.SetVP(VP);
+        m_shadowMapTech.SetVP(LightVP);
     }
     m_shadowMapTech.ControlIndirectRender(UseIndirectRender);   // TODO: same for point
     m_shadowMapTech.ControlPVP(UsePVP);                         // TODO: same for point
-    RenderEntireRenderList(RenderList);
+    RenderEntireRenderList(m_shadowVisibleList, LightVP);
 }
 
 
@@ -821,15 +1168,16 @@ void ForwardRenderer::GBufferPass(GLScene* pScene)
 
     m_geometryTech.Enable();
 
+    Matrix4f VP = m_pCurCamera->GetMatrix();
+
     if (UseIndirectRender) {
-        Matrix4f VP = m_pCurCamera->GetMatrix();
         m_geometryTech.SetVP(VP);
     }
 
     m_geometryTech.ControlIndirectRender(UseIndirectRender);
     m_geometryTech.ControlPVP(UsePVP);
 
-    RenderEntireRenderList(pScene->GetRenderList());
+    RenderEntireRenderList(m_cameraVisibleList, VP);
 }
 
 
@@ -877,15 +1225,53 @@ void ForwardRenderer::BlurFilter2Pass(GLScene* pScene)
 }
 
 
-void ForwardRenderer::RenderEntireRenderList(const std::list<CoreSceneObject*>& RenderList)
+// ViewProj is the view projection of the current pass (for the GPU culling)
+void ForwardRenderer::RenderEntireRenderList(const std::vector<CoreSceneObject*>& RenderList, const Matrix4f& ViewProj)
 {
-    for (std::list<CoreSceneObject*>::const_iterator it = RenderList.begin(); it != RenderList.end(); it++) {
-        m_pcurSceneObject = *it;
+    const std::vector<CoreSceneObject*>* pRenderList = &RenderList;
+
+    if (UseIndirectRender && UseSceneIndirectRender) {
+        Matrix4f GlobalRotation(m_pCurCamera->GetGlobalWorldRotation());
+        m_sceneIndirectRender.Render(RenderList, GlobalRotation, GetGPUCullingVP(ViewProj), m_sceneNotRenderedList);
+        pRenderList = &m_sceneNotRenderedList;
+    }
+
+    for (CoreSceneObject* pSceneObject : *pRenderList) {
+        m_pcurSceneObject = pSceneObject;
         RenderSingleObject(m_pcurSceneObject);
     }
 }
 
 
+//
+// The LOD of the meshes is selected per object from the distance to the camera and the
+// projection (see CoreModel::SelectLods). Only the per object path (GLModel::Render) uses
+// the LODs - the indirect draws always use the full meshes.
+//
+void ForwardRenderer::PrepareMeshLod(GLScene* pScene)
+{
+    SceneConfig* pConfig = pScene->GetConfig();
+
+    m_meshLod.Enabled = pConfig->IsMeshLodEnabled();
+    m_meshLod.Stats = MeshLodStats();
+
+    if (m_meshLod.Enabled) {
+        glm::vec3 CameraPos = m_pCurCamera->GetPosition();
+        m_meshLod.CameraPos = Vector3f(CameraPos.x, CameraPos.y, CameraPos.z);
+
+        const glm::mat4& Projection = m_pCurCamera->GetProjMatrixGLM();
+        m_meshLod.ProjScale = Projection[1][1] * (float)m_windowHeight * 0.5f;
+        m_meshLod.MaxPixelError = pConfig->GetMeshLodPixelError();
+    }
+}
+
+
+const Matrix4f* ForwardRenderer::GetGPUCullingVP(const Matrix4f& ViewProj) const
+{
+    return UseGPUCulling ? &ViewProj : NULL;
+}
+
+
 void ForwardRenderer::NormalPass(GLScene* pScene)
 {
     m_curRenderPass = RENDER_PASS_NORMAL;
@@ -896,15 +1282,16 @@ void ForwardRenderer::NormalPass(GLScene* pScene)
 
     m_normalTech.Enable();
 
+    Matrix4f VP = m_pCurCamera->GetVPMatrix();
+
     if (UseIndirectRender) {
-        Matrix4f VP = m_pCurCamera->GetVPMatrix();
         m_normalTech.SetVP(VP);
     }
 
     m_normalTech.ControlIndirectRender(UseIndirectRender); 
     m_normalTech.ControlPVP(UsePVP);                         
 
-    RenderEntireRenderList(pScene->GetRenderList());
+    RenderEntireRenderList(m_cameraVisibleList, VP);
 }
 
 
@@ -921,13 +1308,11 @@ void ForwardRenderer::LightingPass(GLScene* pScene, double TotalRuntime)
 
     BindShadowMaps();
 
-    m_lightParams.BindUBO(LIGHT_UBO_INDEX);
+    m_clusteredLighting.Bind();
 
     // TODO: duplicate code
     if (pScene->GetConfig()->GetTerrainGrid()) {
-        TerrainGrid* pTerrainGrid = (TerrainGrid*)pScene->GetConfig()->GetTerrainGrid();
-        m_terrainTech.Enable();
-        pTerrainGrid->Render();
+        RenderTerrain(pScene->GetConfig());
     } else if (pScene->GetConfig()->GetInfiniteGrid().Enabled) {
         RenderInfiniteGrid(pScene);
     }
@@ -959,63 +1344,27 @@ void ForwardRenderer::LightingPassFBOSetup(GLScene* pScene)
 }
 
 
-void ForwardRenderer::HDRPassGPU(float& AvgLogLum, float& Exposure)
+void ForwardRenderer::HDRPassGPU(GLScene* pScene)
 {
     m_hdrFBO.BindForReading(GL_TEXTURE0);
-    m_luminanceBuffer.BindSSBO(1);
-
-    m_hdrTech.Enable();
-    glDispatchCompute(m_hdrNumGroupsX, m_hdrNumGroupsY, 1);
-    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-    float* p = (float*)m_luminanceBuffer.MapForReading();
-
-    float sum = 0.0f;
-
-    int NumTiles = m_hdrNumGroupsX * m_hdrNumGroupsY;
 
-    for (int i = 0; i < NumTiles; ++i) {
-        sum += p[i];
-    }
-
-    m_luminanceBuffer.Unmap();
-
-    int NumPixels = NumTiles * 100;
-
-    AvgLogLum = sum / (float)NumPixels;
-
-    AvgLogLum = expf(AvgLogLum);
-
-    Exposure = 0.18f / AvgLogLum;
+    float AdaptationRate = pScene->GetConfig()->GetHDRAdaptationRate();
+    m_hdrLuminance.Update(m_deltaTime, AdaptationRate);
 }
 
 
-void ForwardRenderer::HDRPassCPU(float& AvgLogLum, float& Exposure)
+// Stalls on the readback of the HDR buffer - used to validate the GPU path
+void ForwardRenderer::HDRPassCPU(GLScene* pScene)
 {
     m_hdrFBO.BindForReading(GL_TEXTURE0);
 
     glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_FLOAT, m_hdrData.data());
-    
-    float sum = 0.0f;
-
-    int Size = m_windowWidth * m_windowHeight;
-    
-    for (int i = 0; i < Size; i++) {
-        glm::vec3 Pixel(m_hdrData[i * 3 + 0],
-                        m_hdrData[i * 3 + 1],
-                        m_hdrData[i * 3 + 2]);
 
-        float lum = glm::dot(Pixel, glm::vec3(0.2126f, 0.7152f, 0.0722f));
-        sum += logf(lum + 0.0001f);
-    }
-  
-    AvgLogLum = sum / Size;
+    int NumPixels = m_windowWidth * m_windowHeight;
+    float AverageLuminance = HDRLuminance::CalcAverageLuminance(m_hdrData.data(), NumPixels);
 
-    // Forgot to mention this...we calculated the log-average
-    // so we need to undo it to get back the linear luminance.
-    AvgLogLum = expf(AvgLogLum);
-   
-    Exposure = 0.18f / AvgLogLum;
+    float AdaptationRate = pScene->GetConfig()->GetHDRAdaptationRate();
+    m_hdrLuminance.UpdateFromCPU(AverageLuminance, m_deltaTime, AdaptationRate);
 }
 
 
@@ -1023,7 +1372,7 @@ void ForwardRenderer::BindShadowMaps()
 {
     switch (m_curRenderPass) {
     case RENDER_PASS_SHADOW_DIR:
-        m_shadowMapFBO.BindDepthForReading(SHADOW_TEXTURE_UNIT);
+        m_cascadeShadowMaps.BindForReading(SHADOW_CASCADES_TEXTURE_UNIT);
         m_curRenderPass = RENDER_PASS_LIGHTING_DIR;
         break;
 
@@ -1033,7 +1382,7 @@ void ForwardRenderer::BindShadowMaps()
         break;
 
     case RENDER_PASS_SHADOW_POINT:
-        m_shadowCubeMapFBO.BindForReading(SHADOW_CUBE_MAP_TEXTURE_UNIT);
+        m_shadowCubeMaps.BindForReading(SHADOW_CUBE_MAP_TEXTURE_UNIT);
         m_curRenderPass = RENDER_PASS_LIGHTING_POINT;
         break;
 
@@ -1048,10 +1397,17 @@ void ForwardRenderer::RenderObjectList(GLScene* pScene, double TotalRuntime)
 {
     bool FirstTimeForwardLighting = true;
 
-    const std::list<CoreSceneObject*>& RenderList = pScene->GetRenderList();
+    UpdateBonePalettes(pScene, TotalRuntime);
 
-    for (std::list<CoreSceneObject*>::const_iterator it = RenderList.begin(); it != RenderList.end(); it++) {
-        m_pcurSceneObject = *it;
+    const std::vector<CoreSceneObject*>* pRenderList = &m_cameraVisibleList;
+
+    if (UseIndirectRender && UseSceneIndirectRender) {
+        RenderObjectListSceneIndirect(pScene, TotalRuntime);
+        pRenderList = &m_sceneNotRenderedList;
+    }
+
+    for (CoreSceneObject* pSceneObject : *pRenderList) {
+        m_pcurSceneObject = pSceneObject;
 
         if (FirstTimeForwardLighting) {
             StartRenderWithForwardLighting(pScene, m_pcurSceneObject, TotalRuntime);
@@ -1062,6 +1418,143 @@ void ForwardRenderer::RenderObjectList(GLScene* pScene, double TotalRuntime)
 }
 
 
+//
+// Draws all the objects which share the same lighting technique and use the default
+// per object uniforms with a single multi draw call. The rest are left in
+// m_sceneNotRenderedList for the per object path.
+//
+void ForwardRenderer::RenderObjectListSceneIndirect(GLScene* pScene, double TotalRuntime)
+{
+    std::map<LIGHTING_TECHNIQUE, std::vector<CoreSceneObject*>> Batches;
+
+    m_sceneNotRenderedList.clear();
+
+    for (CoreSceneObject* pSceneObject : m_cameraVisibleList) {
+        if (IsSceneIndirectLightingSupported(pSceneObject)) {
+            LIGHTING_TECHNIQUE LightingTech = GetLightingTech(pScene, pSceneObject->GetModel());
+            Batches[LightingTech].push_back(pSceneObject);
+        } else {
+            m_sceneNotRenderedList.push_back(pSceneObject);
+        }
+    }
+
+    Matrix4f GlobalRotation(m_pCurCamera->GetGlobalWorldRotation());
+    Matrix4f VP = m_pCurCamera->GetVPMatrix();     // same as StartRenderWithForwardLighting
+    std::vector<CoreSceneObject*> NotRendered;
+
+    for (std::map<LIGHTING_TECHNIQUE, std::vector<CoreSceneObject*>>::const_iterator it = Batches.begin(); it != Batches.end(); it++) {
+        m_pcurSceneObject = it->second[0];
+
+        StartRenderWithForwardLighting(pScene, m_pcurSceneObject, TotalRuntime);
+
+        m_pCurLightingTech->ControlNormalMap(false);
+        m_pCurLightingTech->ControlParallaxMap(false);
+        m_pCurLightingTech->SetColorMod(Vector4f(1.0f));
+        m_pCurLightingTech->ControlCubemapping(false);
+
+        m_sceneIndirectRender.Render(it->second, GlobalRotation, GetGPUCullingVP(VP), NotRendered);
+        assert(NotRendered.empty());
+    }
+}
+
+
+bool ForwardRenderer::IsSceneIndirectLightingSupported(CoreSceneObject* pSceneObject) const
+{
+    if (!SceneIndirectRender::IsSupported(pSceneObject)) {
+        return false;
+    }
+
+    GLModel* pModel = (GLModel*)pSceneObject->GetModel();
+
+    if (pModel->IsAnimated() || pModel->GetNormalMap() || pModel->GetHeightMap()) {
+        return false;
+    }
+
+    if (pSceneObject->GetFlatColor().x != -1.0f) {
+        return false;
+    }
+
+    if (pSceneObject->IsCubeMapping()) {
+        return false;
+    }
+
+    return pSceneObject->GetColorMod() == Vector3f(1.0f, 1.0f, 1.0f);
+}
+
+
+//
+// Evaluates the poses of all the visible animated objects and uploads
+// their bone palettes to the GPU with a single buffer update. The instances of each
+// model are evaluated together (in parallel) by CoreModel::GetBoneTransformsBatch.
+//
+void ForwardRenderer::UpdateBonePalettes(GLScene* pScene, double TotalRuntime)
+{
+    m_boneBase.clear();
+
+    std::map<CoreModel*, std::vector<const CoreSceneObject*>> AnimatedObjects;
+
+    for (CoreSceneObject* pSceneObject : m_cameraVisibleList) {
+        CoreModel* pModel = pSceneObject->GetModel();
+
+        if (pModel->IsAnimated()) {
+            AnimatedObjects[pModel].push_back(pSceneObject);
+        }
+    }
+
+    if (AnimatedObjects.empty()) {
+        return;
+    }
+
+    size_t NumMatrices = 0;
+
+    for (std::map<CoreModel*, std::vector<const CoreSceneObject*>>::const_iterator it = AnimatedObjects.begin(); it != AnimatedObjects.end(); it++) {
+        NumMatrices += it->first->NumBones() * it->second.size();
+    }
+
+    m_bonePalette.resize(NumMatrices);
+
+    std::vector<CoreModel::AnimationInstance> Instances;
+
+    int BoneBase = 0;
+
+    for (std::map<CoreModel*, std::vector<const CoreSceneObject*>>::const_iterator it = AnimatedObjects.begin(); it != AnimatedObjects.end(); it++) {
+        CoreModel* pModel = it->first;
+        const std::vector<const CoreSceneObject*>& Objects = it->second;
+        int NumBones = (int)pModel->NumBones();
+
+        Instances.resize(Objects.size());
+
+        for (int i = 0; i < (int)Objects.size(); i++) {
+            Instances[i].AnimationTimeSec = (float)TotalRuntime;
+            Instances[i].StartAnimIndex = 0;
+            m_boneBase[Objects[i]] = BoneBase + i * NumBones;
+        }
+
+        pModel->GetBoneTransformsBatch(Instances.data(), (int)Instances.size(), &m_bonePalette[BoneBase]);
+
+        BoneBase += (int)Objects.size() * NumBones;
+    }
+
+    size_t PaletteSize = ARRAY_SIZE_IN_BYTES(m_bonePalette);
+
+    // Grow the buffer geometrically so that adding objects doesn't reallocate it every frame
+    if (PaletteSize > m_bonePaletteBufferSize) {
+        if (m_bonePaletteBuffer) {
+            glDeleteBuffers(1, &m_bonePaletteBuffer);
+        }
+
+        m_bonePaletteBufferSize = std::max(PaletteSize, m_bonePaletteBufferSize * 2);
+
+        glCreateBuffers(1, &m_bonePaletteBuffer);
+        glNamedBufferStorage(m_bonePaletteBuffer, m_bonePaletteBufferSize, NULL, GL_DYNAMIC_STORAGE_BIT);
+    }
+
+    glNamedBufferSubData(m_bonePaletteBuffer, 0, PaletteSize, m_bonePalette.data());
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_BONES, m_bonePaletteBuffer);
+}
+
+
 void ForwardRenderer::StartRenderWithForwardLighting(GLScene* pScene, CoreSceneObject* pSceneObject, double TotalRuntime)
 {
     LIGHTING_TECHNIQUE LightingTech = GetLightingTech(pScene, pSceneObject->GetModel());
@@ -1092,17 +1585,21 @@ void ForwardRenderer::RenderWithForwardLighting(GLScene* pScene, CoreSceneObject
     SwitchToLightingTech(LightingTech);
 
     if (pSceneObject->GetModel()->IsAnimated()) {
-        float AnimationTimeSec = (float)TotalRuntime;
-        int AnimationIndex = 0;
-        vector<Matrix4f> Transforms;
-        pSceneObject->GetModel()->GetBoneTransforms(AnimationTimeSec, Transforms, AnimationIndex);
-
-        for (uint i = 0; i < Transforms.size(); i++) {
-            if (LightingTech == PBR_GLTF2_SKINNING) {
-                m_pbrSkinnedTech.SetBoneTransform(i, Transforms[i]);
-            } else {
-                m_skinningTech.SetBoneTransform(i, Transforms[i]);
-            }            
+        // The palette was already uploaded by UpdateBonePalettes
+        std::map<const CoreSceneObject*, int>::const_iterator it = m_boneBase.find(pSceneObject);
+
+        if (it == m_boneBase.end()) {
+            printf("%s:%d - the animated object '%s' is not in the bone palette\n", __FILE__, __LINE__, pSceneObject->GetName().c_str());
+            assert(0);
+            exit(0);
+        }
+
+        int BoneBase = it->second;
+
+        if (LightingTech == PBR_GLTF2_SKINNING) {
+            m_pbrSkinnedTech.SetBoneBase(BoneBase);
+        } else {
+            m_skinningTech.SetBoneBase(BoneBase);
         }
     }
 
@@ -1139,7 +1636,13 @@ void ForwardRenderer::RenderSingleObject(CoreSceneObject* pSceneObject)
         Matrix4f ObjectMatrix = m_pcurSceneObject->GetMatrix();
         glm::mat4 GlobalWorldRotation = m_pCurCamera->GetGlobalWorldRotation();
         ObjectMatrix = ObjectMatrix * Matrix4f(GlobalWorldRotation);
-        pModel->RenderIndirect(ObjectMatrix);
+        pModel->RenderIndirect(ObjectMatrix, pSceneObject->GetId());
+    }
+    else if (m_meshLod.Enabled) {
+        Matrix4f GlobalWorldRotation(m_pCurCamera->GetGlobalWorldRotation());
+        pModel->SelectLods(pSceneObject->GetMatrix(), GlobalWorldRotation, m_meshLod.CameraPos, m_meshLod.ProjScale,
+                           m_meshLod.MaxPixelError, m_meshLod.Lods, m_meshLod.Stats);
+        pModel->Render(this, m_meshLod.Lods.data());
     }
     else {
         pModel->Render(this);
@@ -1265,13 +1768,13 @@ void ForwardRenderer::SSAOCombinePass()
 }
 
 
-void ForwardRenderer::ToneMappingPass(GLScene* pScene, float AverageLuminance, float Exposure)
+void ForwardRenderer::ToneMappingPass(GLScene* pScene)
 {
     SetRenderToDefaultFB();
 
     m_hdrFBO.BindForReading(GL_TEXTURE0);
 
-    m_luminanceBuffer.BindSSBO(1);
+    m_hdrLuminance.Bind();
 
     bool IsBloom = pScene->GetConfig()->IsBloomEnabled();
     TONE_MAP_METHOD ToneMapMethod = pScene->GetConfig()->GetToneMapMethod();
@@ -1282,8 +1785,6 @@ void ForwardRenderer::ToneMappingPass(GLScene* pScene, float AverageLuminance, f
 
         m_toneMapTechWithBloom.Enable();
 
-        m_toneMapTechWithBloom.SetAverageLuminance(AverageLuminance);
-        m_toneMapTechWithBloom.SetExposure(Exposure);
         m_toneMapTechWithBloom.SetToneMapMethod(ToneMapMethod);
         m_toneMapTechWithBloom.ControlGammaCorrection(EnableGamma);
         float BloomStrength = pScene->GetConfig()->GetBloomStrength();
@@ -1293,8 +1794,6 @@ void ForwardRenderer::ToneMappingPass(GLScene* pScene, float AverageLuminance, f
     } else {
         m_toneMapTech.Enable();
 
-        m_toneMapTech.SetAverageLuminance(AverageLuminance);
-        m_toneMapTech.SetExposure(Exposure);
         m_toneMapTech.SetToneMapMethod(ToneMapMethod);
         m_toneMapTech.ControlGammaCorrection(EnableGamma);
 
@@ -1439,7 +1938,7 @@ void ForwardRenderer::SetWorldMatrix_CB_ShadowPassDir(const Matrix4f& World)
 {
     Matrix4f ObjectMatrix = m_pcurSceneObject->GetMatrix();
     glm::mat4 GlobalWorldRotation = m_pCurCamera->GetGlobalWorldRotation();
-    Matrix4f WVP = m_lightOrthoProjMatrix * m_lightViewMatrix * ObjectMatrix * World * Matrix4f(GlobalWorldRotation);
+    Matrix4f WVP = m_curLightVP * ObjectMatrix * World * Matrix4f(GlobalWorldRotation);
     m_shadowMapTech.SetWVP(WVP);
 }
 
@@ -1458,12 +1957,13 @@ void ForwardRenderer::SetWorldMatrix_CB_ShadowPassSpot(const Matrix4f& World)
 }
 
 
+// The projection of every face of the cube map is done in the geometry shader
 void ForwardRenderer::SetWorldMatrix_CB_ShadowPassPoint(const Matrix4f& World)
 {
+    glm::mat4 GlobalWorldRotation = m_pCurCamera->GetGlobalWorldRotation();
     Matrix4f ObjectMatrix = m_pcurSceneObject->GetMatrix();
-    Matrix4f WVP = m_lightPersProjMatrix * m_lightViewMatrix * ObjectMatrix * World;
-    m_shadowMapPointLightTech.SetWorld(World);
-    m_shadowMapPointLightTech.SetWVP(WVP);
+    Matrix4f FinalWorldMatrix = ObjectMatrix * World * Matrix4f(GlobalWorldRotation);
+    m_shadowCubeMapTech.SetWorld(FinalWorldMatrix);
 }
 
 
@@ -1495,7 +1995,8 @@ void ForwardRenderer::SetWorldMatrix_CB_LightingPass(const Matrix4f& World)
     
     switch (m_curRenderPass) {
     case RENDER_PASS_LIGHTING_DIR:
-        LightWVP = m_lightOrthoProjMatrix * m_lightViewMatrix * FinalWorldMatrix;
+        // Not used by the shaders (the cascades are selected per pixel)
+        LightWVP = m_shadowCascades.GetCascade(0).LightVP * FinalWorldMatrix;
         break;
 
     case RENDER_PASS_LIGHTING_SPOT:
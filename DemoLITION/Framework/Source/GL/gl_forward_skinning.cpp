@@ -46,25 +46,15 @@ bool ForwardSkinningTechnique::Init()
         return false;
     }
 
-    for (unsigned int i = 0 ; i < ARRAY_SIZE_IN_ELEMENTS(m_boneLocation) ; i++) {
-        char Name[128];
-        memset(Name, 0, sizeof(Name));
-        SNPRINTF(Name, sizeof(Name), "gBones[%d]", i);
-        m_boneLocation[i] = GetUniformLocation(Name);
-    }
+    m_boneBaseLoc = GetUniformLocation("gBoneBase");
 
     return true;
 }
 
 
-void ForwardSkinningTechnique::SetBoneTransform(uint Index, const Matrix4f& Transform)
+void ForwardSkinningTechnique::SetBoneBase(int BoneBase)
 {
-    //assert(Index < MAX_BONES);
-    if (Index >= MAX_BONES) {
-        return;
-    }
-    //Transform.Print();
-    glUniformMatrix4fv(m_boneLocation[Index], 1, GL_TRUE, Transform.data());
+    glUniform1i(m_boneBaseLoc, BoneBase);
 }
 
 ///////////////////////////////////////////
@@ -95,23 +85,13 @@ bool PBRSkinningTechnique::Init()
         return false;
     }
 
-    for (unsigned int i = 0; i < ARRAY_SIZE_IN_ELEMENTS(m_boneLocation); i++) {
-        char Name[128];
-        memset(Name, 0, sizeof(Name));
-        SNPRINTF(Name, sizeof(Name), "gBones[%d]", i);
-        m_boneLocation[i] = GetUniformLocation(Name);
-    }
+    m_boneBaseLoc = GetUniformLocation("gBoneBase");
 
     return true;
 }
 
 
-void PBRSkinningTechnique::SetBoneTransform(uint Index, const Matrix4f& Transform)
+void PBRSkinningTechnique::SetBoneBase(int BoneBase)
 {
-    //assert(Index < MAX_BONES);
-    if (Index >= MAX_BONES) {
-        return;
-    }
-    //Transform.Print();
-    glUniformMatrix4fv(m_boneLocation[Index], 1, GL_TRUE, Transform.data());
+    glUniform1i(m_boneBaseLoc, BoneBase);
 }
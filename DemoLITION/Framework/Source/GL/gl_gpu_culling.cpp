@@ -0,0 +1,230 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+
+#include "GL/gl_ssbo_db.h"
+#include "GL/gl_gpu_culling.h"
+
+#define CULLING_GROUP_SIZE 64           // local_size_x in gpu_culling.cs
+#define VISIBLE_CMDS_OFFSET 16          // the draw count and its padding come first
+
+
+GPUCulling::~GPUCulling()
+{
+    if (m_visibleCmdsBuffer) {
+        glDeleteBuffers(1, &m_visibleCmdsBuffer);
+    }
+
+    if (m_visibleDataBuffer) {
+        glDeleteBuffers(1, &m_visibleDataBuffer);
+    }
+}
+
+
+void GPUCulling::Init()
+{
+    if (!m_cullingTech.Init()) {
+        printf("Error initializing the GPU culling technique\n");
+        exit(1);
+    }
+
+    m_isInitialized = true;
+}
+
+
+void GPUCulling::ReserveOutput(int NumDraws)
+{
+    if (NumDraws <= m_capacity) {
+        return;
+    }
+
+    if (m_visibleCmdsBuffer) {
+        glDeleteBuffers(1, &m_visibleCmdsBuffer);
+        glDeleteBuffers(1, &m_visibleDataBuffer);
+    }
+
+    m_capacity = std::max(NumDraws, m_capacity * 2);
+
+    size_t CmdsSize = VISIBLE_CMDS_OFFSET + m_capacity * sizeof(IndirectRender::DrawElementsIndirectCommand);
+    size_t DataSize = m_capacity * sizeof(IndirectRender::PerObjectData);
+
+    glCreateBuffers(1, &m_visibleCmdsBuffer);
+    glNamedBufferStorage(m_visibleCmdsBuffer, CmdsSize, NULL, GL_DYNAMIC_STORAGE_BIT);
+
+    glCreateBuffers(1, &m_visibleDataBuffer);
+    glNamedBufferStorage(m_visibleDataBuffer, DataSize, NULL, 0);
+}
+
+
+void GPUCulling::Cull(const Matrix4f& ViewProj, GLuint Buffer,
+                      size_t DataOffset, size_t CmdsOffset, size_t BoundsOffset, int NumDraws)
+{
+    assert(m_isInitialized);
+
+    m_numDraws = NumDraws;
+
+    if (NumDraws == 0) {
+        return;
+    }
+
+    ReserveOutput(NumDraws);
+
+    GLuint Zero = 0;
+    glClearNamedBufferSubData(m_visibleCmdsBuffer, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &Zero);
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_PER_OBJ_DATA, Buffer, DataOffset,
+                      NumDraws * sizeof(IndirectRender::PerObjectData));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_CULLING_DRAW_CMDS, Buffer, CmdsOffset,
+                      NumDraws * sizeof(IndirectRender::DrawElementsIndirectCommand));
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_CULLING_BOUNDS, Buffer, BoundsOffset,
+                      NumDraws * sizeof(IndirectRender::MeshBounds));
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_CULLING_VISIBLE_CMDS, m_visibleCmdsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_CULLING_VISIBLE_DATA, m_visibleDataBuffer);
+
+    // We are usually in the middle of a pass so its program is restored below
+    GLint CurProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &CurProgram);
+
+    m_cullingTech.Enable();
+    m_cullingTech.SetNumDraws(NumDraws);
+    m_cullingTech.SetFrustumPlanes(FrustumCulling(ViewProj));
+
+    glDispatchCompute((NumDraws + CULLING_GROUP_SIZE - 1) / CULLING_GROUP_SIZE, 1, 1);
+
+    // The commands and the count are read by the draw and the data by the vertex shaders
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(CurProgram);
+}
+
+
+void GPUCulling::Draw()
+{
+    if (m_numDraws == 0) {
+        return;
+    }
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_PER_OBJ_DATA, m_visibleDataBuffer, 0,
+                      m_numDraws * sizeof(IndirectRender::PerObjectData));
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_visibleCmdsBuffer);
+    glBindBuffer(GL_PARAMETER_BUFFER, m_visibleCmdsBuffer);
+
+    // Core in GL 4.6, otherwise from ARB_indirect_parameters (e.g. Mesa llvmpipe which is GL 4.5)
+    if (GLEW_VERSION_4_6) {
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)VISIBLE_CMDS_OFFSET, 0, m_numDraws, 0);
+    } else {
+        glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)VISIBLE_CMDS_OFFSET, 0, m_numDraws, 0);
+    }
+
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+
+void GPUCulling::ReadVisibleDraws(std::vector<IndirectRender::DrawElementsIndirectCommand>& Cmds,
+                                  std::vector<IndirectRender::PerObjectData>& Data)
+{
+    Cmds.clear();
+    Data.clear();
+
+    if (m_numDraws == 0) {
+        return;
+    }
+
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    GLuint NumVisible = 0;
+    glGetNamedBufferSubData(m_visibleCmdsBuffer, 0, sizeof(GLuint), &NumVisible);
+
+    if (NumVisible > (GLuint)m_numDraws) {
+        printf("%s:%d - invalid number of visible draws %d (max %d)\n", __FILE__, __LINE__, NumVisible, m_numDraws);
+        exit(1);
+    }
+
+    if (NumVisible == 0) {
+        return;
+    }
+
+    Cmds.resize(NumVisible);
+    glGetNamedBufferSubData(m_visibleCmdsBuffer, VISIBLE_CMDS_OFFSET, ARRAY_SIZE_IN_BYTES(Cmds), Cmds.data());
+
+    Data.resize(NumVisible);
+    glGetNamedBufferSubData(m_visibleDataBuffer, 0, ARRAY_SIZE_IN_BYTES(Data), Data.data());
+}
+
+
+//
+// Same arithmetic as IsVisible() in gpu_culling.cs
+//
+void GPUCulling::CullReference(const Matrix4f& ViewProj,
+                               const IndirectRender::PerObjectData* pData,
+                               const IndirectRender::MeshBounds* pBounds,
+                               int NumDraws,
+                               float Tolerance,
+                               std::vector<int>& VisibleDraws,
+                               std::vector<int>& BorderlineDraws)
+{
+    VisibleDraws.clear();
+    BorderlineDraws.clear();
+
+    FrustumCulling Frustum(ViewProj);
+
+    for (int i = 0; i < NumDraws; i++) {
+        const IndirectRender::MeshBounds& b = pBounds[i];
+
+        if (b.Min.w == 0.0f) {
+            VisibleDraws.push_back(i);
+            continue;
+        }
+
+        float Center[3] = { (b.Min.x + b.Max.x) * 0.5f, (b.Min.y + b.Max.y) * 0.5f, (b.Min.z + b.Max.z) * 0.5f };
+        float Extent[3] = { (b.Max.x - b.Min.x) * 0.5f, (b.Max.y - b.Min.y) * 0.5f, (b.Max.z - b.Min.z) * 0.5f };
+
+        const Matrix4f& World = pData[i].WorldMatrix;
+
+        float WorldCenter[3], WorldExtent[3];
+
+        for (int r = 0; r < 3; r++) {
+            WorldCenter[r] = World.m[r][0] * Center[0] + World.m[r][1] * Center[1] + World.m[r][2] * Center[2] + World.m[r][3];
+            WorldExtent[r] = fabsf(World.m[r][0]) * Extent[0] + fabsf(World.m[r][1]) * Extent[1] + fabsf(World.m[r][2]) * Extent[2];
+        }
+
+        float MinDist = FLT_MAX;
+
+        for (int p = 0; p < FrustumCulling::NUM_PLANES; p++) {
+            const Vector4f& Plane = Frustum.GetPlane(p);
+
+            float Dist = Plane.x * WorldCenter[0] + Plane.y * WorldCenter[1] + Plane.z * WorldCenter[2] +
+                         fabsf(Plane.x) * WorldExtent[0] + fabsf(Plane.y) * WorldExtent[1] + fabsf(Plane.z) * WorldExtent[2] +
+                         Plane.w;
+
+            MinDist = std::min(MinDist, Dist);
+        }
+
+        if (fabsf(MinDist) <= Tolerance) {
+            BorderlineDraws.push_back(i);
+        } else if (MinDist > 0.0f) {
+            VisibleDraws.push_back(i);
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ogldev_util.h"
+#include "GL/gl_gpu_culling_technique.h"
+
+
+GPUCullingTechnique::GPUCullingTechnique()
+{
+}
+
+
+bool GPUCullingTechnique::Init()
+{
+    if (!Technique::Init()) {
+        return false;
+    }
+
+    if (!AddShader(GL_COMPUTE_SHADER, "Framework/Shaders/GL/gpu_culling.cs")) {
+        return false;
+    }
+
+    if (!Finalize()) {
+        return false;
+    }
+
+    m_numDrawsLoc = GetUniformLocation("gNumDraws");
+    m_frustumPlanesLoc = GetUniformLocation("gFrustumPlanes");
+
+    if (m_numDrawsLoc == INVALID_UNIFORM_LOCATION ||
+        m_frustumPlanesLoc == INVALID_UNIFORM_LOCATION) {
+        return false;
+    }
+
+    return true;
+}
+
+
+void GPUCullingTechnique::SetNumDraws(uint NumDraws)
+{
+    glUniform1ui(m_numDrawsLoc, NumDraws);
+}
+
+
+void GPUCullingTechnique::SetFrustumPlanes(const FrustumCulling& Frustum)
+{
+    Vector4f Planes[FrustumCulling::NUM_PLANES];
+
+    for (int i = 0; i < FrustumCulling::NUM_PLANES; i++) {
+        Planes[i] = Frustum.GetPlane(i);
+    }
+
+    glUniform4fv(m_frustumPlanesLoc, FrustumCulling::NUM_PLANES, (const GLfloat*)Planes);
+}
@@ -0,0 +1,71 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GL/gl_hdr_adapt_technique.h"
+
+
+HDRAdaptTechnique::HDRAdaptTechnique()
+{
+}
+
+
+bool HDRAdaptTechnique::Init()
+{
+    if (!Technique::Init()) {
+        return false;
+    }
+
+    if (!AddShader(GL_COMPUTE_SHADER, "Framework/Shaders/GL/hdr_adapt.cs")) {
+        return false;
+    }
+
+    if (!Finalize()) {
+        return false;
+    }
+
+    GET_UNIFORM(gNumTiles);
+    GET_UNIFORM(gNumPixels);
+    GET_UNIFORM(gDeltaTime);
+    GET_UNIFORM(gAdaptationRate);
+
+    return true;
+}
+
+
+void HDRAdaptTechnique::SetNumTiles(uint NumTiles)
+{
+    glUniform1ui(m_gNumTilesLoc, NumTiles);
+}
+
+
+void HDRAdaptTechnique::SetNumPixels(int NumPixels)
+{
+    glUniform1f(m_gNumPixelsLoc, (float)NumPixels);
+}
+
+
+void HDRAdaptTechnique::SetDeltaTime(float DeltaTime)
+{
+    glUniform1f(m_gDeltaTimeLoc, DeltaTime);
+}
+
+
+void HDRAdaptTechnique::SetAdaptationRate(float Rate)
+{
+    glUniform1f(m_gAdaptationRateLoc, Rate);
+}
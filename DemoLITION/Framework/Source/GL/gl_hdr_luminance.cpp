@@ -0,0 +1,185 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <math.h>
+
+#include "ogldev_util.h"
+#include "GL/gl_ssbo_db.h"
+#include "GL/gl_hdr_luminance.h"
+
+#define HDR_TILE_SIZE 16    // must match hdr.cs
+
+
+HDRLuminance::~HDRLuminance()
+{
+    if (m_readbackFence) {
+        glDeleteSync(m_readbackFence);
+    }
+
+    if (m_tilesBuffer) {
+        glDeleteBuffers(1, &m_tilesBuffer);
+        glDeleteBuffers(1, &m_stateBuffer);
+        glDeleteBuffers(1, &m_readbackBuffer);
+    }
+}
+
+
+void HDRLuminance::Init(int Width, int Height)
+{
+    if (!m_tileTech.Init()) {
+        printf("Error initializing the HDR technique\n");
+        exit(1);
+    }
+
+    if (!m_adaptTech.Init()) {
+        printf("Error initializing the HDR adaptation technique\n");
+        exit(1);
+    }
+
+    m_numPixels = Width * Height;
+    m_numGroupsX = (int)AlignUpToMultiple(Width, HDR_TILE_SIZE) / HDR_TILE_SIZE;
+    m_numGroupsY = (int)AlignUpToMultiple(Height, HDR_TILE_SIZE) / HDR_TILE_SIZE;
+
+    int NumTiles = m_numGroupsX * m_numGroupsY;
+
+    glCreateBuffers(1, &m_tilesBuffer);
+    glNamedBufferStorage(m_tilesBuffer, NumTiles * sizeof(float), NULL, 0);
+
+    HDRLuminanceState State;
+    glCreateBuffers(1, &m_stateBuffer);
+    glNamedBufferStorage(m_stateBuffer, sizeof(HDRLuminanceState), &State, GL_DYNAMIC_STORAGE_BIT);
+
+    GLbitfield Flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &m_readbackBuffer);
+    glNamedBufferStorage(m_readbackBuffer, sizeof(HDRLuminanceState), &State, Flags | GL_CLIENT_STORAGE_BIT);
+    m_pReadback = (HDRLuminanceState*)glMapNamedBufferRange(m_readbackBuffer, 0, sizeof(HDRLuminanceState), Flags);
+
+    if (!m_pReadback) {
+        printf("%s:%d - error mapping the luminance readback buffer\n", __FILE__, __LINE__);
+        exit(1);
+    }
+}
+
+
+void HDRLuminance::Update(float DeltaTime, float AdaptationRate)
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_HDR_TILES, m_tilesBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_HDR_LUMINANCE, m_stateBuffer);
+
+    m_tileTech.Enable();
+    glDispatchCompute(m_numGroupsX, m_numGroupsY, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_adaptTech.Enable();
+    m_adaptTech.SetNumTiles(m_numGroupsX * m_numGroupsY);
+    m_adaptTech.SetNumPixels(m_numPixels);
+    m_adaptTech.SetDeltaTime(DeltaTime);
+    m_adaptTech.SetAdaptationRate(AdaptationRate);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    StartReadback();
+}
+
+
+void HDRLuminance::UpdateFromCPU(float AverageLuminance, float DeltaTime, float AdaptationRate)
+{
+    float Adapted = AverageLuminance;
+
+    if (m_cpuState.IsValid) {
+        Adapted = CalcAdaptedLuminance(m_cpuState.AdaptedLuminance, AverageLuminance, DeltaTime, AdaptationRate);
+    }
+
+    m_cpuState.AverageLuminance = AverageLuminance;
+    m_cpuState.AdaptedLuminance = Adapted;
+    m_cpuState.Exposure = 0.18f / Adapted;
+    m_cpuState.IsValid = 1;
+
+    glNamedBufferSubData(m_stateBuffer, 0, sizeof(HDRLuminanceState), &m_cpuState);
+
+    // No need for the readback
+    m_lastState = m_cpuState;
+}
+
+
+void HDRLuminance::Bind()
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_HDR_LUMINANCE, m_stateBuffer);
+}
+
+
+// A single copy is in flight at any time. The next one starts only after the
+// CPU has picked up the previous one.
+void HDRLuminance::StartReadback()
+{
+    if (m_readbackFence) {
+        return;
+    }
+
+    glCopyNamedBufferSubData(m_stateBuffer, m_readbackBuffer, 0, 0, sizeof(HDRLuminanceState));
+    m_readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+
+const HDRLuminanceState& HDRLuminance::GetLastState()
+{
+    if (m_readbackFence) {
+        GLenum Status = glClientWaitSync(m_readbackFence, 0, 0);
+
+        if ((Status == GL_ALREADY_SIGNALED) || (Status == GL_CONDITION_SATISFIED)) {
+            m_lastState = *m_pReadback;
+            glDeleteSync(m_readbackFence);
+            m_readbackFence = 0;
+        }
+    }
+
+    return m_lastState;
+}
+
+
+void HDRLuminance::ReadState(HDRLuminanceState& State)
+{
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    glGetNamedBufferSubData(m_stateBuffer, 0, sizeof(HDRLuminanceState), &State);
+}
+
+
+float HDRLuminance::CalcAverageLuminance(const float* pRGB, int NumPixels)
+{
+    double Sum = 0.0;
+
+    for (int i = 0; i < NumPixels; i++) {
+        float Lum = pRGB[i * 3 + 0] * 0.2126f + pRGB[i * 3 + 1] * 0.7152f + pRGB[i * 3 + 2] * 0.0722f;
+        Sum += logf(Lum + 0.0001f);
+    }
+
+    // The sum is of the log luminance so we need to undo it to get back the linear luminance
+    return expf((float)(Sum / NumPixels));
+}
+
+
+float HDRLuminance::CalcAdaptedLuminance(float PrevAdapted, float AverageLuminance, float DeltaTime, float AdaptationRate)
+{
+    if (AdaptationRate <= 0.0f) {
+        return AverageLuminance;
+    }
+
+    return PrevAdapted + (AverageLuminance - PrevAdapted) * (1.0f - expf(-DeltaTime * AdaptationRate));
+}
@@ -16,23 +16,15 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <string.h>
+
 #include "GL/gl_ssbo_db.h"
 #include "GL/gl_indirect_render.h"
+#include "GL/gl_persistent_ring_buffer.h"
 
-struct PerObjectData {
-    Matrix4f WorldMatrix;
-    Matrix4f NormalMatrix;
-    glm::ivec4 MaterialIndex = glm::ivec4(0);
-};
-
-struct DrawElementsIndirectCommand {
-    unsigned int  Count = 0;
-    unsigned int  InstanceCount = 0;
-    unsigned int  FirstIndex = 0;
-    int           BaseVertex = 0;
-    unsigned int  BaseInstance = 0;
-};
-
+// The objects which were removed from the scene (or are no longer rendered with this
+// model) are dropped from the cache after this many frames
+#define OBJECT_CACHE_MAX_AGE 120
 
 void IndirectRender::Init(const std::vector<BasicMeshEntry>& Meshes, const std::vector<CoreMaterial>& Materials)
 {
@@ -42,8 +34,6 @@ void IndirectRender::Init(const std::vector<BasicMeshEntry>& Meshes, const std::
 
     InitDrawCmdsBuffer(Meshes);
 
-    AllocPerObjectBuffer(Meshes);
-
     PrepareIndirectRenderMaterials(Materials);
 }
 
@@ -55,13 +45,20 @@ void IndirectRender::InitMeshes(const std::vector<BasicMeshEntry>& Meshes)
     for (int i = 0; i < Meshes.size(); i++) {
         m_meshes[i].m_transformation = Meshes[i].Transformation;
         m_meshes[i].m_materialIndex = Meshes[i].MaterialIndex;
+
+        const AABB& Bounds = Meshes[i].Bounds;
+
+        if (Bounds.IsValid()) {
+            m_meshes[i].m_bounds.Min = Vector4f(Bounds.MinX, Bounds.MinY, Bounds.MinZ, 1.0f);
+            m_meshes[i].m_bounds.Max = Vector4f(Bounds.MaxX, Bounds.MaxY, Bounds.MaxZ, 1.0f);
+        }
     }
 }
 
 
 void IndirectRender::InitDrawCmdsBuffer(const std::vector<BasicMeshEntry>& Meshes)
 {
-    std::vector<DrawElementsIndirectCommand> DrawCommands;
+    std::vector<DrawElementsIndirectCommand>& DrawCommands = m_drawCmds;
     DrawCommands.resize(Meshes.size());
 
     for (int i = 0; i < Meshes.size(); i++) {
@@ -81,34 +78,32 @@ void IndirectRender::InitDrawCmdsBuffer(const std::vector<BasicMeshEntry>& Meshe
 }
 
 
-void IndirectRender::AllocPerObjectBuffer(const std::vector<BasicMeshEntry>& Meshes)
-{
-    glCreateBuffers(1, &m_perObjectBuffer);
-    glNamedBufferStorage(m_perObjectBuffer, sizeof(PerObjectData) * Meshes.size(), 
-                         NULL, GL_DYNAMIC_STORAGE_BIT);
-}
-
-
-void IndirectRender::PrepareIndirectRenderMaterials(const std::vector<CoreMaterial>& Materials)
+void IndirectRender::ConvertMaterials(const std::vector<CoreMaterial>& Materials, std::vector<MaterialIndirect>& MaterialsIndirect)
 {
     int NumMaterials = (int)Materials.size();
 
-    m_materials.resize(NumMaterials);
+    MaterialsIndirect.resize(NumMaterials);
 
     for (int i = 0; i < NumMaterials; i++) {
-        m_materials[i].Color.AmbientColor = Materials[i].AmbientColor;
-        m_materials[i].Color.DiffuseColor = Materials[i].DiffuseColor;
-        m_materials[i].Color.SpecularColor = Materials[i].SpecularColor;
+        MaterialsIndirect[i].Color.AmbientColor = Materials[i].AmbientColor;
+        MaterialsIndirect[i].Color.DiffuseColor = Materials[i].DiffuseColor;
+        MaterialsIndirect[i].Color.SpecularColor = Materials[i].SpecularColor;
 
         if (Materials[i].pTextures[TEX_TYPE_BASE] && (Materials[i].pTextures[TEX_TYPE_BASE]->GetBindlessHandle() == -1)) {
             printf("Diffuse texture exists but bindless handle is missing\n");
             exit(1);
         }
         GLuint64 DiffuseMapBindlessHandle = Materials[i].pTextures[TEX_TYPE_BASE] ? Materials[i].pTextures[TEX_TYPE_BASE]->GetBindlessHandle() : -1;
-        m_materials[i].DiffuseMap = DiffuseMapBindlessHandle;
+        MaterialsIndirect[i].DiffuseMap = DiffuseMapBindlessHandle;
         GLuint64 NormalMapBindlessHandle = Materials[i].pTextures[TEX_TYPE_NORMAL] ? Materials[i].pTextures[TEX_TYPE_NORMAL]->GetBindlessHandle() : -1;
-        m_materials[i].NormalMap = NormalMapBindlessHandle;
+        MaterialsIndirect[i].NormalMap = NormalMapBindlessHandle;
     }
+}
+
+
+void IndirectRender::PrepareIndirectRenderMaterials(const std::vector<CoreMaterial>& Materials)
+{
+    ConvertMaterials(Materials, m_materials);
 
     glCreateBuffers(1, &m_materialsBuffer);
     glNamedBufferStorage(m_materialsBuffer, ARRAY_SIZE_IN_BYTES(m_materials), m_materials.data(), GL_DYNAMIC_STORAGE_BIT);
@@ -116,9 +111,9 @@ void IndirectRender::PrepareIndirectRenderMaterials(const std::vector<CoreMateri
 
 
 
-void IndirectRender::Render(const Matrix4f& ObjectMatrix)
+void IndirectRender::Render(const Matrix4f& ObjectMatrix, int ObjectId)
 {
-    UpdatePerObjectData(ObjectMatrix);
+    UpdatePerObjectData(ObjectMatrix, ObjectId);
 
     glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_drawCmdBuffer);
 
@@ -130,30 +125,80 @@ void IndirectRender::Render(const Matrix4f& ObjectMatrix)
 
 void IndirectRender::RefreshMaterials(const std::vector<CoreMaterial>& Materials)
 {
-    int NumMaterials = (int)Materials.size();
+    ConvertMaterials(Materials, m_materials);
 
-    for (int i = 0; i < NumMaterials; i++) {
-        m_materials[i].Color.AmbientColor = Materials[i].AmbientColor;
-        m_materials[i].Color.DiffuseColor = Materials[i].DiffuseColor;
-        m_materials[i].Color.SpecularColor = Materials[i].SpecularColor;
-        if (Materials[i].pTextures[TEX_TYPE_BASE] && (Materials[i].pTextures[TEX_TYPE_BASE]->GetBindlessHandle() == -1)) {
-            printf("Diffuse texture exists but bindless handle is missing\n");
-            exit(1);
-        }
-        GLuint64 DiffuseMapBindlessHandle = Materials[i].pTextures[TEX_TYPE_BASE] ? Materials[i].pTextures[TEX_TYPE_BASE]->GetBindlessHandle() : -1;
-        m_materials[i].DiffuseMap = DiffuseMapBindlessHandle;
-        GLuint64 NormalMapBindlessHandle = Materials[i].pTextures[TEX_TYPE_NORMAL] ? Materials[i].pTextures[TEX_TYPE_NORMAL]->GetBindlessHandle() : -1;
-        m_materials[i].NormalMap = NormalMapBindlessHandle;
+    glNamedBufferSubData(m_materialsBuffer, 0, ARRAY_SIZE_IN_BYTES(m_materials), m_materials.data());
+}
+
+
+//
+// The per object data is written directly into the persistently mapped ring buffer
+// which is shared by all the models. The world and normal matrices are only
+// calculated when the matrix of the object changes.
+//
+void IndirectRender::UpdatePerObjectData(const Matrix4f& ObjectMatrix, int ObjectId)
+{
+    const std::vector<PerObjectData>& Data = GetPerObjectData(ObjectMatrix, ObjectId);
+    size_t Size = ARRAY_SIZE_IN_BYTES(Data);
+
+    PersistentRingBuffer& Ring = PersistentRingBuffer::GetPerObjectRing();
+
+    size_t Offset = 0;
+    void* p = Ring.Alloc(Size, Offset);
+    memcpy(p, Data.data(), Size);
+
+    Ring.BindRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_PER_OBJ_DATA, Offset, Size);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_MATERIALS, m_materialsBuffer);
+}
+
+
+const std::vector<IndirectRender::PerObjectData>& IndirectRender::GetPerObjectData(const Matrix4f& ObjectMatrix, int ObjectId)
+{
+    int Frame = PersistentRingBuffer::GetPerObjectRing().GetFrameIndex();
+
+    EvictObjectCache(Frame);
+
+    std::map<int, ObjectCache>::iterator it = m_objectCache.find(ObjectId);
+
+    if (it == m_objectCache.end()) {
+        it = m_objectCache.insert(std::make_pair(ObjectId, ObjectCache())).first;
+        CalcPerObjectData(ObjectMatrix, ObjectId, it->second.Data);
+        it->second.ObjectMatrix = ObjectMatrix;
+    } else if (memcmp(&it->second.ObjectMatrix, &ObjectMatrix, sizeof(Matrix4f)) != 0) {
+        CalcPerObjectData(ObjectMatrix, ObjectId, it->second.Data);
+        it->second.ObjectMatrix = ObjectMatrix;
     }
 
-    glNamedBufferSubData(m_materialsBuffer, 0, ARRAY_SIZE_IN_BYTES(m_materials), m_materials.data());
+    it->second.LastFrame = Frame;
+
+    return it->second.Data;
 }
 
 
-void IndirectRender::UpdatePerObjectData(const Matrix4f& ObjectMatrix)
+// Runs once every OBJECT_CACHE_MAX_AGE frames
+void IndirectRender::EvictObjectCache(int Frame)
 {
-    std::vector<PerObjectData> PerObjectDataVector;
-    PerObjectDataVector.resize(m_meshes.size());
+    if (Frame - m_lastEvictionFrame < OBJECT_CACHE_MAX_AGE) {
+        return;
+    }
+
+    m_lastEvictionFrame = Frame;
+
+    std::map<int, ObjectCache>::iterator it = m_objectCache.begin();
+
+    while (it != m_objectCache.end()) {
+        if (Frame - it->second.LastFrame > OBJECT_CACHE_MAX_AGE) {
+            it = m_objectCache.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+
+void IndirectRender::CalcPerObjectData(const Matrix4f& ObjectMatrix, int ObjectId, std::vector<PerObjectData>& Data)
+{
+    Data.resize(m_meshes.size());
 
     for (int i = 0; i < m_meshes.size(); i++) {
         // TODO: move to math3d
@@ -161,14 +206,39 @@ void IndirectRender::UpdatePerObjectData(const Matrix4f& ObjectMatrix)
         Matrix4f WorldInverse = FinalWorldMatrix.Inverse();
         Matrix4f WorldInverseTranspose = WorldInverse.Transpose();
 
-        PerObjectDataVector[i].WorldMatrix = FinalWorldMatrix;
-        PerObjectDataVector[i].NormalMatrix = WorldInverseTranspose;
-        PerObjectDataVector[i].MaterialIndex.x = m_meshes[i].m_materialIndex;
+        Data[i].WorldMatrix = FinalWorldMatrix;
+        Data[i].NormalMatrix = WorldInverseTranspose;
+        Data[i].MaterialIndex.x = m_meshes[i].m_materialIndex;
+        Data[i].MaterialIndex.y = ObjectId + 1;     // Background is zero in the picking texture
+        Data[i].MaterialIndex.z = i;
     }
+}
 
-    glNamedBufferSubData(m_perObjectBuffer, 0, ARRAY_SIZE_IN_BYTES(PerObjectDataVector), 
-                         PerObjectDataVector.data());
 
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_PER_OBJ_DATA, m_perObjectBuffer);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_MATERIALS, m_materialsBuffer);
+void IndirectRender::SetSceneBase(int BaseVertex, int BaseIndex, int BaseMaterial)
+{
+    m_sceneBaseVertex = BaseVertex;
+    m_sceneBaseIndex = BaseIndex;
+    m_sceneBaseMaterial = BaseMaterial;
+}
+
+
+void IndirectRender::WriteSceneDraws(const Matrix4f& ObjectMatrix, int ObjectId, 
+                                     DrawElementsIndirectCommand* pCmds, PerObjectData* pData, MeshBounds* pBounds)
+{
+    const std::vector<PerObjectData>& Data = GetPerObjectData(ObjectMatrix, ObjectId);
+
+    for (int i = 0; i < m_meshes.size(); i++) {
+        DrawElementsIndirectCommand Cmd = m_drawCmds[i];
+        Cmd.FirstIndex += m_sceneBaseIndex;
+        Cmd.BaseVertex += m_sceneBaseVertex;
+        pCmds[i] = Cmd;
+
+        pData[i] = Data[i];
+        pData[i].MaterialIndex.x += m_sceneBaseMaterial;
+
+        if (pBounds) {
+            pBounds[i] = m_meshes[i].m_bounds;
+        }
+    }
 }
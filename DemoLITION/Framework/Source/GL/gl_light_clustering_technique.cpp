@@ -0,0 +1,70 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ogldev_util.h"
+#include "GL/gl_light_clustering_technique.h"
+
+
+LightClusteringTechnique::LightClusteringTechnique()
+{
+}
+
+
+bool LightClusteringTechnique::Init()
+{
+    if (!Technique::Init()) {
+        return false;
+    }
+
+    if (!AddShader(GL_COMPUTE_SHADER, "Framework/Shaders/GL/light_clustering.cs")) {
+        return false;
+    }
+
+    if (!Finalize()) {
+        return false;
+    }
+
+    m_numLightsLoc = GetUniformLocation("gNumLights");
+    m_firstLightLoc = GetUniformLocation("gFirstLight");
+    m_viewLoc = GetUniformLocation("gView");
+
+    if (m_numLightsLoc == INVALID_UNIFORM_LOCATION ||
+        m_firstLightLoc == INVALID_UNIFORM_LOCATION ||
+        m_viewLoc == INVALID_UNIFORM_LOCATION) {
+        return false;
+    }
+
+    return true;
+}
+
+
+void LightClusteringTechnique::SetNumLights(uint NumLights)
+{
+    glUniform1ui(m_numLightsLoc, NumLights);
+}
+
+
+void LightClusteringTechnique::SetFirstLight(uint FirstLight)
+{
+    glUniform1ui(m_firstLightLoc, FirstLight);
+}
+
+
+void LightClusteringTechnique::SetView(const Matrix4f& View)
+{
+    glUniformMatrix4fv(m_viewLoc, 1, GL_TRUE, (const GLfloat*)View.m);
+}
@@ -20,10 +20,13 @@
 #include "GL/gl_model.h"
 #include "GL/gl_engine_common.h"
 #include "GL/gl_ssbo_db.h"
+#include "GL/gl_scene_geometry.h"
 
 
 bool UsePVP = true;     // Programmable Vertex Pulling
 bool UseIndirectRender = false;
+bool UseSceneIndirectRender = false;     // Requires UseIndirectRender
+bool UseGPUCulling = false;              // Requires UseSceneIndirectRender
 
 #define POSITION_LOCATION    0
 #define TEX_COORD0_LOCATION  1
@@ -144,21 +147,35 @@ void GLModel::ConvertToMesh(const char* pFilename)
         printf("\nConverting meshes %d/%d\n", (int)i + 1, (int)NumMeshes);
         Mesh m;
 
-        // TODO: lod
         m.m_baseIndex = m_Meshes[i].BaseIndex;
         m.m_baseVertex = m_Meshes[i].BaseVertex;
         m.m_numIndices = m_Meshes[i].NumIndices;
         m.m_numVertices = m_Meshes[i].NumVertices;
-        m.m_lodOffsets[0] = 0;
-        m.m_lodOffsets[1] = m_Meshes[i].NumIndices;
-        
+        m.m_materialID = std::max(m_Meshes[i].MaterialIndex, 0);
+        m.m_lodCount = m_Meshes[i].LodCount;
+
+        if (m.m_lodCount > 1) {
+            memcpy(m.m_lodOffsets, m_Meshes[i].LodOffsets, sizeof(m.m_lodOffsets));
+            memcpy(m.m_lodErrors, m_Meshes[i].LodErrors, sizeof(m.m_lodErrors));
+        } else {
+            m.m_lodOffsets[0] = 0;
+            m.m_lodOffsets[1] = m_Meshes[i].NumIndices;
+        }
+
+        const AABB& Bounds = m_Meshes[i].Bounds;
+
+        if (Bounds.IsValid()) {
+            mesh.m_boxes[i] = BoundingBox(glm::vec3(Bounds.MinX, Bounds.MinY, Bounds.MinZ),
+                                          glm::vec3(Bounds.MaxX, Bounds.MaxY, Bounds.MaxZ));
+        } else {
+            mesh.m_boxes[i] = BoundingBox(glm::vec3(0.0f), glm::vec3(0.0f));
+        }
+
         mesh.m_meshes[i] = m;
     }
 
     SaveMeshData(pFilename, mesh);
 
-    // recalculateBoundingBoxes(meshData);
-
     glUnmapNamedBuffer(m_Buffers[INDEX_BUFFER]);
     glUnmapNamedBuffer(m_Buffers[VERTEX_BUFFER]);
 }
@@ -182,6 +199,18 @@ bool GLModel::LoadMesh(const std::string& Filename)
         //m_Meshes[i].ValidFaces =
         m_Meshes[i].MaterialIndex = 0;
         m_Meshes[i].Transformation.InitIdentity();
+
+        m_Meshes[i].LodCount = std::max(mesh.m_meshes[i].m_lodCount, 1u);
+        memcpy(m_Meshes[i].LodOffsets, mesh.m_meshes[i].m_lodOffsets, sizeof(m_Meshes[i].LodOffsets));
+        memcpy(m_Meshes[i].LodErrors, mesh.m_meshes[i].m_lodErrors, sizeof(m_Meshes[i].LodErrors));
+
+        const BoundingBox& Box = mesh.m_boxes[i];
+
+        // An empty box means that the bounds were unknown when the file was saved
+        if (Box.m_min != Box.m_max) {
+            m_Meshes[i].Bounds.Add(Vector3f(Box.m_min.x, Box.m_min.y, Box.m_min.z));
+            m_Meshes[i].Bounds.Add(Vector3f(Box.m_max.x, Box.m_max.y, Box.m_max.z));
+        }
     }
 
     m_Indices.resize(mesh.m_totalIndices);
@@ -232,6 +261,11 @@ void GLModel::InitGeometryPost()
 {
     if (UseIndirectRender) {
         m_indirectRender.Init(m_Meshes, m_Materials);
+
+        if (IsInSceneGeometry()) {
+            m_sceneBaseMaterial = GLSceneGeometry::Get().AddMaterials(m_Materials);
+            m_indirectRender.SetSceneBase(m_sceneBaseVertex, m_sceneBaseIndex, m_sceneBaseMaterial);
+        }
     }
 }
 
@@ -259,6 +293,16 @@ void GLModel::PopulateBuffersInternal(std::vector<VertexType>& Vertices)
             PopulateBuffersNonDSA(Vertices);
         }
     }
+
+    // Only the static models share the scene geometry since the skinned vertices
+    // have a different layout. The model keeps its own buffers for the other paths.
+    if constexpr (std::is_same_v<VertexType, Vertex>) {
+        if (UseIndirectRender && UseSceneIndirectRender && UsePVP) {
+            GLSceneGeometry& SceneGeometry = GLSceneGeometry::Get();
+            m_sceneBaseVertex = SceneGeometry.AddVertices(Vertices.data(), (int)Vertices.size(), sizeof(VertexType));
+            m_sceneBaseIndex = SceneGeometry.AddIndices(m_Indices);
+        }
+    }
 }
 
 
@@ -406,7 +450,7 @@ void GLModel::PopulateBuffersDSA(std::vector<VertexType>& Vertices)
 }
 
 
-void GLModel::Render(DemolitionRenderCallbacks* pRenderCallbacks)
+void GLModel::Render(DemolitionRenderCallbacks* pRenderCallbacks, const uint* pLods)
 {
     assert(!UseIndirectRender);
 
@@ -417,7 +461,7 @@ void GLModel::Render(DemolitionRenderCallbacks* pRenderCallbacks)
     }
 
     for (unsigned int i = 0; i < m_Meshes.size(); i++) {
-        RenderMesh(i, pRenderCallbacks);
+        RenderMesh(i, pRenderCallbacks, pLods ? pLods[i] : 0);
     }
 
     // Make sure the VAO is not changed from the outside
@@ -425,7 +469,7 @@ void GLModel::Render(DemolitionRenderCallbacks* pRenderCallbacks)
 }
 
 
-void GLModel::RenderMesh(int MeshIndex, DemolitionRenderCallbacks* pRenderCallbacks)
+void GLModel::RenderMesh(int MeshIndex, DemolitionRenderCallbacks* pRenderCallbacks, uint Lod)
 {
     int MaterialIndex = m_Meshes[MeshIndex].MaterialIndex;
     assert((MaterialIndex >= 0) && (MaterialIndex < m_Materials.size()));
@@ -440,11 +484,13 @@ void GLModel::RenderMesh(int MeshIndex, DemolitionRenderCallbacks* pRenderCallba
         pRenderCallbacks->SetWorldMatrix_CB(m_Meshes[MeshIndex].Transformation);
     }
 
+    const BasicMeshEntry& Mesh = m_Meshes[MeshIndex];
+
     glDrawElementsBaseVertex(GL_TRIANGLES,
-                             m_Meshes[MeshIndex].NumIndices,
+                             Mesh.GetLodIndicesCount(Lod),
                              GL_UNSIGNED_INT,
-                             (void*)(sizeof(unsigned int) * m_Meshes[MeshIndex].BaseIndex),
-                             m_Meshes[MeshIndex].BaseVertex);
+                             (void*)(sizeof(unsigned int) * Mesh.GetLodFirstIndex(Lod)),
+                             Mesh.BaseVertex);
 }
 
 
@@ -572,7 +618,7 @@ void GLModel::Render(unsigned int NumInstances, const Matrix4f* WVPMats, const M
 }
 
 
-void GLModel::RenderIndirect(const Matrix4f& ObjectMatrix)
+void GLModel::RenderIndirect(const Matrix4f& ObjectMatrix, int ObjectId)
 {
     assert(UseIndirectRender);
 
@@ -582,7 +628,7 @@ void GLModel::RenderIndirect(const Matrix4f& ObjectMatrix)
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_VERTICES, m_Buffers[VERTEX_BUFFER]);
     }
 
-    m_indirectRender.Render(ObjectMatrix);
+    m_indirectRender.Render(ObjectMatrix, ObjectId);
 
     // Make sure the VAO is not changed from the outside
     glBindVertexArray(0);
@@ -630,6 +676,10 @@ void GLModel::SetNormalMap(int TextureHandle)
 
             if (UseIndirectRender) {
                 m_indirectRender.RefreshMaterials(m_Materials);
+
+                if (IsInSceneGeometry()) {
+                    GLSceneGeometry::Get().UpdateMaterials(m_sceneBaseMaterial, m_Materials);
+                }
             }
         }
     }
@@ -0,0 +1,161 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "GL/gl_persistent_ring_buffer.h"
+
+#define INITIAL_REGION_SIZE (1024 * 1024)
+
+
+PersistentRingBuffer& PersistentRingBuffer::GetPerObjectRing()
+{
+    static PersistentRingBuffer Ring;
+    return Ring;
+}
+
+
+void PersistentRingBuffer::InitAlignment()
+{
+    if (m_alignment == 0) {
+        GLint Alignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+        m_alignment = std::max(Alignment, 16);
+    }
+}
+
+
+size_t PersistentRingBuffer::GetAlignedSize(size_t Size)
+{
+    InitAlignment();
+
+    return (Size + m_alignment - 1) / m_alignment * m_alignment;
+}
+
+
+void PersistentRingBuffer::CreateBuffer(size_t RegionSize)
+{
+    InitAlignment();
+
+    // Draws which were already submitted may still be using the old buffer.
+    // GL keeps its storage alive until they are done.
+    if (m_buffer) {
+        glDeleteBuffers(1, &m_buffer);
+    }
+
+    for (int i = 0; i < NUM_FRAMES; i++) {
+        if (m_fences[i]) {
+            glDeleteSync(m_fences[i]);
+            m_fences[i] = NULL;
+        }
+    }
+
+    m_regionSize = GetAlignedSize(RegionSize);
+
+    GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, m_regionSize * NUM_FRAMES, NULL, Flags);
+
+    m_pMapping = (unsigned char*)glMapNamedBufferRange(m_buffer, 0, m_regionSize * NUM_FRAMES, Flags);
+
+    if (!m_pMapping) {
+        printf("%s:%d - error mapping the ring buffer\n", __FILE__, __LINE__);
+        exit(1);
+    }
+}
+
+
+void PersistentRingBuffer::WaitForRegion(int Region)
+{
+    GLsync Fence = m_fences[Region];
+
+    if (!Fence) {
+        return;
+    }
+
+    GLenum Status = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+    while ((Status != GL_ALREADY_SIGNALED) && (Status != GL_CONDITION_SATISFIED)) {
+        if (Status == GL_WAIT_FAILED) {
+            printf("%s:%d - glClientWaitSync failed\n", __FILE__, __LINE__);
+            exit(1);
+        }
+
+        Status = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // 1ms
+    }
+
+    glDeleteSync(Fence);
+    m_fences[Region] = NULL;
+}
+
+
+void PersistentRingBuffer::BeginFrame()
+{
+    if (!m_buffer) {
+        CreateBuffer(INITIAL_REGION_SIZE);
+    }
+
+    WaitForRegion(m_curRegion);
+
+    m_curOffset = 0;
+}
+
+
+void PersistentRingBuffer::EndFrame()
+{
+    if (!m_buffer) {
+        return;
+    }
+
+    m_fences[m_curRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_curRegion = (m_curRegion + 1) % NUM_FRAMES;
+    m_frameIndex++;
+}
+
+
+void* PersistentRingBuffer::Alloc(size_t Size, size_t& Offset)
+{
+    if (!m_buffer) {
+        CreateBuffer(std::max(Size, (size_t)INITIAL_REGION_SIZE));
+    }
+
+    size_t AlignedSize = GetAlignedSize(Size);
+
+    if (m_curOffset + AlignedSize > m_regionSize) {
+        // The new buffer has no pending frames so we start over at its first region
+        CreateBuffer(std::max(m_regionSize * 2, AlignedSize));
+        m_curRegion = 0;
+        m_curOffset = 0;
+    }
+
+    Offset = m_curRegion * m_regionSize + m_curOffset;
+
+    m_curOffset += AlignedSize;
+
+    return m_pMapping + Offset;
+}
+
+
+void PersistentRingBuffer::BindRange(GLenum Target, GLuint Index, size_t Offset, size_t Size)
+{
+    glBindBufferRange(Target, Index, m_buffer, Offset, Size);
+}
@@ -43,10 +43,16 @@ bool PickingTechnique::Init()
     m_WVPLocation = GetUniformLocation("gWVP");
     m_objectIndexLocation = GetUniformLocation("gObjectIndex");
     m_drawIndexLocation = GetUniformLocation("gDrawIndex");
+    m_VPLocation = GetUniformLocation("gVP");
+    m_isIndirectRenderLocation = GetUniformLocation("gIsIndirectRender");
+    m_isPVPLocation = GetUniformLocation("gIsPVP");
 
     if (m_WVPLocation == INVALID_UNIFORM_LOCATION ||
         m_objectIndexLocation == INVALID_UNIFORM_LOCATION ||
-        m_drawIndexLocation == INVALID_UNIFORM_LOCATION) {
+        m_drawIndexLocation == INVALID_UNIFORM_LOCATION ||
+        m_VPLocation == INVALID_UNIFORM_LOCATION ||
+        m_isIndirectRenderLocation == INVALID_UNIFORM_LOCATION ||
+        m_isPVPLocation == INVALID_UNIFORM_LOCATION) {
         return false;
     }
 
@@ -70,3 +76,21 @@ void PickingTechnique::SetObjectIndex(uint ObjectIndex)
 {
     glUniform1ui(m_objectIndexLocation, ObjectIndex);
 }
+
+
+void PickingTechnique::SetVP(const Matrix4f& VP)
+{
+    glUniformMatrix4fv(m_VPLocation, 1, GL_TRUE, (const GLfloat*)VP.m);
+}
+
+
+void PickingTechnique::ControlIndirectRender(bool IsIndirectRender)
+{
+    glUniform1i(m_isIndirectRenderLocation, IsIndirectRender);
+}
+
+
+void PickingTechnique::ControlPVP(bool IsPVP)
+{
+    glUniform1i(m_isPVPLocation, IsPVP);
+}
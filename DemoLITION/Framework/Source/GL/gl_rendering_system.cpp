@@ -461,6 +461,16 @@ void* RenderingSystemGL::CreateTerrainGrid(int Width, int Height)
 }
 
 
+void* RenderingSystemGL::CreateTerrainClipmap(int Width, int Height)
+{
+    TerrainClipmap* pClipmap = new TerrainClipmap(Width, Height);
+
+    pClipmap->CreateBuffers();
+
+    return pClipmap;
+}
+
+
 int RenderingSystemGL::GetTextureAPIHandle(int TextureHandle)
 {
     Texture* pTexture = (Texture*)GetTexture(TextureHandle);
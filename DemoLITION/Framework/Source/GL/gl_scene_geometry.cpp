@@ -0,0 +1,148 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include "ogldev_util.h"
+#include "GL/gl_ssbo_db.h"
+#include "GL/gl_scene_geometry.h"
+
+#define INITIAL_BUFFER_SIZE (4 * 1024 * 1024)
+
+
+GLSceneGeometry& GLSceneGeometry::Get()
+{
+    static GLSceneGeometry SceneGeometry;
+    return SceneGeometry;
+}
+
+
+// Appends the data to the buffer. The buffer is reallocated (and the existing data
+// copied on the GPU) with twice the capacity when it runs out of space.
+void GLSceneGeometry::AddData(GLuint& Buffer, size_t& Capacity, size_t& Size, const void* pData, size_t DataSize)
+{
+    if (Size + DataSize > Capacity) {
+        size_t NewCapacity = std::max(std::max(Capacity * 2, Size + DataSize), (size_t)INITIAL_BUFFER_SIZE);
+
+        GLuint NewBuffer = 0;
+        glCreateBuffers(1, &NewBuffer);
+        glNamedBufferStorage(NewBuffer, NewCapacity, NULL, GL_DYNAMIC_STORAGE_BIT);
+
+        if (Buffer) {
+            glCopyNamedBufferSubData(Buffer, NewBuffer, 0, 0, Size);
+            glDeleteBuffers(1, &Buffer);
+        }
+
+        Buffer = NewBuffer;
+        Capacity = NewCapacity;
+    }
+
+    glNamedBufferSubData(Buffer, Size, DataSize, pData);
+
+    Size += DataSize;
+}
+
+
+int GLSceneGeometry::AddVertices(const void* pVertices, int NumVertices, int VertexSize)
+{
+    if (m_vertexSize == 0) {
+        m_vertexSize = VertexSize;
+    } else if (m_vertexSize != VertexSize) {
+        printf("%s:%d - vertex size mismatch %d != %d\n", __FILE__, __LINE__, VertexSize, m_vertexSize);
+        exit(1);
+    }
+
+    int BaseVertex = (int)(m_vertexBufferSize / m_vertexSize);
+
+    AddData(m_vertexBuffer, m_vertexBufferCapacity, m_vertexBufferSize, pVertices, (size_t)NumVertices * VertexSize);
+
+    return BaseVertex;
+}
+
+
+int GLSceneGeometry::AddIndices(const std::vector<uint>& Indices)
+{
+    if (m_VAO == 0) {
+        glCreateVertexArrays(1, &m_VAO);
+    }
+
+    int BaseIndex = (int)(m_indexBufferSize / sizeof(uint));
+
+    GLuint PrevIndexBuffer = m_indexBuffer;
+
+    AddData(m_indexBuffer, m_indexBufferCapacity, m_indexBufferSize, Indices.data(), ARRAY_SIZE_IN_BYTES(Indices));
+
+    if (m_indexBuffer != PrevIndexBuffer) {
+        glVertexArrayElementBuffer(m_VAO, m_indexBuffer);
+    }
+
+    return BaseIndex;
+}
+
+
+int GLSceneGeometry::AddMaterials(const std::vector<CoreMaterial>& Materials)
+{
+    int BaseMaterial = (int)m_materials.size();
+
+    std::vector<IndirectRender::MaterialIndirect> MaterialsIndirect;
+    IndirectRender::ConvertMaterials(Materials, MaterialsIndirect);
+
+    m_materials.insert(m_materials.end(), MaterialsIndirect.begin(), MaterialsIndirect.end());
+
+    // The materials are added only at load time so we simply recreate the buffer when it's full
+    size_t Size = ARRAY_SIZE_IN_BYTES(m_materials);
+
+    if (Size > m_materialsBufferCapacity) {
+        if (m_materialsBuffer) {
+            glDeleteBuffers(1, &m_materialsBuffer);
+        }
+
+        m_materialsBufferCapacity = std::max(Size, m_materialsBufferCapacity * 2);
+
+        glCreateBuffers(1, &m_materialsBuffer);
+        glNamedBufferStorage(m_materialsBuffer, m_materialsBufferCapacity, NULL, GL_DYNAMIC_STORAGE_BIT);
+    }
+
+    glNamedBufferSubData(m_materialsBuffer, 0, Size, m_materials.data());
+
+    return BaseMaterial;
+}
+
+
+void GLSceneGeometry::UpdateMaterials(int BaseMaterial, const std::vector<CoreMaterial>& Materials)
+{
+    assert(BaseMaterial + Materials.size() <= m_materials.size());
+
+    std::vector<IndirectRender::MaterialIndirect> MaterialsIndirect;
+    IndirectRender::ConvertMaterials(Materials, MaterialsIndirect);
+
+    std::copy(MaterialsIndirect.begin(), MaterialsIndirect.end(), m_materials.begin() + BaseMaterial);
+
+    glNamedBufferSubData(m_materialsBuffer, BaseMaterial * sizeof(m_materials[0]), 
+                         ARRAY_SIZE_IN_BYTES(MaterialsIndirect), MaterialsIndirect.data());
+}
+
+
+void GLSceneGeometry::Bind()
+{
+    glBindVertexArray(m_VAO);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_VERTICES, m_vertexBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_MATERIALS, m_materialsBuffer);
+}
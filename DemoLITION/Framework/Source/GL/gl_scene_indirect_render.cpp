@@ -0,0 +1,108 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GL/gl_model.h"
+#include "GL/gl_ssbo_db.h"
+#include "GL/gl_scene_geometry.h"
+#include "GL/gl_persistent_ring_buffer.h"
+#include "GL/gl_scene_indirect_render.h"
+
+
+bool SceneIndirectRender::IsSupported(const CoreSceneObject* pSceneObject)
+{
+    const GLModel* pModel = (const GLModel*)pSceneObject->GetModel();
+
+    return pModel->IsInSceneGeometry();
+}
+
+
+void SceneIndirectRender::Render(const std::vector<CoreSceneObject*>& Objects, 
+                                 const Matrix4f& GlobalRotation, 
+                                 const Matrix4f* pCullingVP,
+                                 std::vector<CoreSceneObject*>& NotRendered)
+{
+    m_objects.clear();
+    NotRendered.clear();
+
+    int NumDraws = 0;
+
+    for (CoreSceneObject* pSceneObject : Objects) {
+        if (IsSupported(pSceneObject)) {
+            m_objects.push_back(pSceneObject);
+            NumDraws += ((GLModel*)pSceneObject->GetModel())->GetIndirectRender().GetNumDraws();
+        } else {
+            NotRendered.push_back(pSceneObject);
+        }
+    }
+
+    if (NumDraws == 0) {
+        return;
+    }
+
+    bool IsGPUCulling = (pCullingVP != NULL);
+
+    PersistentRingBuffer& Ring = PersistentRingBuffer::GetPerObjectRing();
+
+    // A single allocation for the per object data followed by the draw commands and
+    // the mesh bounds (used only by the GPU culling). Each part is aligned so that
+    // it can be bound as an SSBO.
+    size_t DataSize = NumDraws * sizeof(IndirectRender::PerObjectData);
+    size_t CmdsSize = NumDraws * sizeof(IndirectRender::DrawElementsIndirectCommand);
+    size_t BoundsSize = IsGPUCulling ? NumDraws * sizeof(IndirectRender::MeshBounds) : 0;
+
+    size_t CmdsStart = Ring.GetAlignedSize(DataSize);
+    size_t BoundsStart = CmdsStart + Ring.GetAlignedSize(CmdsSize);
+
+    size_t DataOffset = 0;
+    unsigned char* p = (unsigned char*)Ring.Alloc(BoundsStart + BoundsSize, DataOffset);
+
+    IndirectRender::PerObjectData* pData = (IndirectRender::PerObjectData*)p;
+    IndirectRender::DrawElementsIndirectCommand* pCmds = (IndirectRender::DrawElementsIndirectCommand*)(p + CmdsStart);
+    IndirectRender::MeshBounds* pBounds = IsGPUCulling ? (IndirectRender::MeshBounds*)(p + BoundsStart) : NULL;
+
+    int DrawIndex = 0;
+
+    for (CoreSceneObject* pSceneObject : m_objects) {
+        IndirectRender& Indirect = ((GLModel*)pSceneObject->GetModel())->GetIndirectRender();
+        Matrix4f ObjectMatrix = pSceneObject->GetMatrix() * GlobalRotation;
+        Indirect.WriteSceneDraws(ObjectMatrix, pSceneObject->GetId(), &pCmds[DrawIndex], &pData[DrawIndex], 
+                                 pBounds ? &pBounds[DrawIndex] : NULL);
+        DrawIndex += Indirect.GetNumDraws();
+    }
+
+    GLSceneGeometry::Get().Bind();
+
+    if (IsGPUCulling) {
+        if (!m_gpuCulling.IsInitialized()) {
+            m_gpuCulling.Init();
+        }
+
+        m_gpuCulling.Cull(*pCullingVP, Ring.GetBuffer(), DataOffset, DataOffset + CmdsStart, DataOffset + BoundsStart, NumDraws);
+        m_gpuCulling.Draw();
+    } else {
+        Ring.BindRange(GL_SHADER_STORAGE_BUFFER, SSBO_INDEX_PER_OBJ_DATA, DataOffset, DataSize);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, Ring.GetBuffer());
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(DataOffset + CmdsStart), NumDraws, 0);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    glBindVertexArray(0);
+}
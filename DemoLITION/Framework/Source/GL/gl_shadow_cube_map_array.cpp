@@ -0,0 +1,107 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <float.h>
+
+#include "ogldev_util.h"
+#include "GL/gl_shadow_cube_map_array.h"
+
+
+ShadowCubeMapArray::~ShadowCubeMapArray()
+{
+    if (m_fbo != 0) {
+        glDeleteFramebuffers(1, &m_fbo);
+    }
+
+    if (m_views.size() > 0) {
+        glDeleteTextures((GLsizei)m_views.size(), m_views.data());
+    }
+
+    if (m_cubeMapArray != 0) {
+        glDeleteTextures(1, &m_cubeMapArray);
+    }
+
+    if (m_depth != 0) {
+        glDeleteTextures(1, &m_depth);
+    }
+}
+
+
+bool ShadowCubeMapArray::Init(int Size, int NumCubeMaps)
+{
+    m_size = Size;
+
+    // The distance from the light of all the cube maps
+    glCreateTextures(GL_TEXTURE_CUBE_MAP_ARRAY, 1, &m_cubeMapArray);
+    glTextureStorage3D(m_cubeMapArray, 1, GL_R32F, m_size, m_size, NumCubeMaps * NUM_CUBE_MAP_FACES);
+    glTextureParameteri(m_cubeMapArray, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(m_cubeMapArray, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(m_cubeMapArray, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_cubeMapArray, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(m_cubeMapArray, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    // A layered attachment takes all the layers of the texture so every light gets a view of its own faces
+    m_views.resize(NumCubeMaps);
+    glGenTextures(NumCubeMaps, m_views.data());
+
+    for (int i = 0; i < NumCubeMaps; i++) {
+        glTextureView(m_views[i], GL_TEXTURE_CUBE_MAP, m_cubeMapArray, GL_R32F, 0, 1, i * NUM_CUBE_MAP_FACES, NUM_CUBE_MAP_FACES);
+    }
+
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_depth);
+    glTextureStorage2D(m_depth, 1, GL_DEPTH_COMPONENT24, m_size, m_size);
+
+    glCreateFramebuffers(1, &m_fbo);
+    glNamedFramebufferTexture(m_fbo, GL_COLOR_ATTACHMENT0, m_views[0], 0);
+    glNamedFramebufferTexture(m_fbo, GL_DEPTH_ATTACHMENT, m_depth, 0);
+    glNamedFramebufferDrawBuffer(m_fbo, GL_COLOR_ATTACHMENT0);
+    glNamedFramebufferReadBuffer(m_fbo, GL_NONE);
+
+    GLenum Status = glCheckNamedFramebufferStatus(m_fbo, GL_FRAMEBUFFER);
+
+    if (Status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("FB error, status: 0x%x\n", Status);
+        return false;
+    }
+
+    return GLCheckError();
+}
+
+
+void ShadowCubeMapArray::BindForWriting(int CubeMapIndex)
+{
+    glNamedFramebufferTexture(m_fbo, GL_COLOR_ATTACHMENT0, m_views[CubeMapIndex], 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_size, m_size);
+}
+
+
+void ShadowCubeMapArray::Clear()
+{
+    // Nothing is closer than the cleared distance
+    glClearColor(FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX);
+    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+}
+
+
+void ShadowCubeMapArray::BindForReading(GLenum TextureUnit)
+{
+    glActiveTexture(TextureUnit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, m_cubeMapArray);
+}
@@ -0,0 +1,94 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ogldev_util.h"
+#include "GL/gl_shadow_cube_map_technique.h"
+
+ShadowCubeMapTechnique::ShadowCubeMapTechnique()
+{
+
+}
+
+
+bool ShadowCubeMapTechnique::Init()
+{
+    if (!Technique::Init()) {
+        return false;
+    }
+
+    if (!AddShader(GL_VERTEX_SHADER, "Framework/Shaders/GL/shadow_cube_map.vs")) {
+        return false;
+    }
+
+    if (!AddShader(GL_GEOMETRY_SHADER, "Framework/Shaders/GL/shadow_cube_map.gs")) {
+        return false;
+    }
+
+    if (!AddShader(GL_FRAGMENT_SHADER, "Framework/Shaders/GL/shadow_cube_map.fs")) {
+        return false;
+    }
+
+    if (!Finalize()) {
+        return false;
+    }
+
+    GET_UNIFORM_AND_CHECK(m_worldLoc, "gWorld");
+    GET_UNIFORM_AND_CHECK(m_faceVPLoc, "gFaceVP");
+    GET_UNIFORM_AND_CHECK(m_faceMaskLoc, "gFaceMask");
+    GET_UNIFORM_AND_CHECK(m_lightWorldPosLoc, "gLightWorldPos");
+    GET_UNIFORM_AND_CHECK(m_isIndirectRenderLoc, "gIsIndirectRender");
+    GET_UNIFORM_AND_CHECK(m_isPVPLoc, "gIsPVP");
+
+    return true;
+}
+
+
+void ShadowCubeMapTechnique::SetWorld(const Matrix4f& World)
+{
+    glUniformMatrix4fv(m_worldLoc, 1, GL_TRUE, (const GLfloat*)World.m);
+}
+
+
+void ShadowCubeMapTechnique::SetFaceVPs(const Matrix4f* pFaceVPs)
+{
+    glUniformMatrix4fv(m_faceVPLoc, NUM_CUBE_MAP_FACES, GL_TRUE, (const GLfloat*)pFaceVPs);
+}
+
+
+void ShadowCubeMapTechnique::SetFaceMask(uint FaceMask)
+{
+    glUniform1ui(m_faceMaskLoc, FaceMask);
+}
+
+
+void ShadowCubeMapTechnique::SetLightWorldPos(const Vector3f& Pos)
+{
+    glUniform3f(m_lightWorldPosLoc, Pos.x, Pos.y, Pos.z);
+}
+
+
+void ShadowCubeMapTechnique::ControlIndirectRender(bool IsIndirectRender)
+{
+    glUniform1i(m_isIndirectRenderLoc, IsIndirectRender);
+}
+
+
+void ShadowCubeMapTechnique::ControlPVP(bool IsPVP)
+{
+    glUniform1i(m_isPVPLoc, IsPVP);
+}
@@ -0,0 +1,81 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#include "ogldev_util.h"
+#include "GL/gl_shadow_map_array.h"
+
+
+ShadowMapArray::~ShadowMapArray()
+{
+    if (m_fbo != 0) {
+        glDeleteFramebuffers(1, &m_fbo);
+    }
+
+    if (m_depthArray != 0) {
+        glDeleteTextures(1, &m_depthArray);
+    }
+}
+
+
+bool ShadowMapArray::Init(int Size, int NumLayers)
+{
+    m_size = Size;
+    m_numLayers = NumLayers;
+
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_depthArray);
+    glTextureStorage3D(m_depthArray, 1, GL_DEPTH_COMPONENT32F, m_size, m_size, m_numLayers);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Everything outside of a cascade is lit
+    float BorderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTextureParameteri(m_depthArray, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTextureParameteri(m_depthArray, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTextureParameterfv(m_depthArray, GL_TEXTURE_BORDER_COLOR, BorderColor);
+
+    glCreateFramebuffers(1, &m_fbo);
+    glNamedFramebufferTextureLayer(m_fbo, GL_DEPTH_ATTACHMENT, m_depthArray, 0, 0);
+    glNamedFramebufferDrawBuffer(m_fbo, GL_NONE);
+    glNamedFramebufferReadBuffer(m_fbo, GL_NONE);
+
+    GLenum Status = glCheckNamedFramebufferStatus(m_fbo, GL_FRAMEBUFFER);
+
+    if (Status != GL_FRAMEBUFFER_COMPLETE) {
+        printf("FB error, status: 0x%x\n", Status);
+        return false;
+    }
+
+    return GLCheckError();
+}
+
+
+void ShadowMapArray::BindForWriting(int Layer)
+{
+    glNamedFramebufferTextureLayer(m_fbo, GL_DEPTH_ATTACHMENT, m_depthArray, 0, Layer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, m_size, m_size);
+}
+
+
+void ShadowMapArray::BindForReading(GLenum TextureUnit)
+{
+    glActiveTexture(TextureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_depthArray);
+}
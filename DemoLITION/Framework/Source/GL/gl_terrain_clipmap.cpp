@@ -0,0 +1,258 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "GL/gl_terrain_clipmap.h"
+
+
+TerrainClipmap::TerrainClipmap(int Width, int Height, int BlockSize) : TerrainGrid(BlockSize * BlockSize * 6)
+{
+    if ((Width < 2) || (Height < 2)) {
+        printf("%s:%d - invalid terrain size %dx%d\n", __FILE__, __LINE__, Width, Height);
+        exit(0);
+    }
+
+    if ((BlockSize < 2) || (BlockSize % 2)) {
+        printf("%s:%d - the block size must be even (%d)\n", __FILE__, __LINE__, BlockSize);
+        exit(0);
+    }
+
+    m_width = Width;
+    m_height = Height;
+    m_blockSize = BlockSize;
+
+    // Same layout as CreateTerrainGridVectors
+    m_mapMinX = -Width / 2.0f;
+    m_mapMinZ = -Height / 2.0f;
+    m_mapMaxX = m_mapMinX + (float)(Width - 1);
+    m_mapMaxZ = m_mapMinZ + (float)(Height - 1);
+
+    // The window of the coarsest level must cover the map from anywhere inside it.
+    // Because of the alignment the camera can be up to a quarter of the window off center.
+    int MaxSize = std::max(Width, Height);
+    int WindowSize = CLIPMAP_WINDOW_BLOCKS * BlockSize;
+
+    m_numLevels = 1;
+
+    while ((WindowSize < 3 * MaxSize) && (m_numLevels < MAX_CLIPMAP_LEVELS)) {
+        WindowSize *= 2;
+        m_numLevels++;
+    }
+}
+
+
+TerrainClipmap::~TerrainClipmap()
+{
+    if (m_instanceBuffer) {
+        glDeleteBuffers(1, &m_instanceBuffer);
+    }
+
+    if (m_vao) {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ibo);
+    }
+}
+
+
+void TerrainClipmap::CreateBuffers()
+{
+    int NumVerticesPerSide = m_blockSize + 1;
+
+    std::vector<Vector2f> Vertices(NumVerticesPerSide * NumVerticesPerSide);
+
+    for (int z = 0; z < NumVerticesPerSide; z++) {
+        for (int x = 0; x < NumVerticesPerSide; x++) {
+            Vertices[z * NumVerticesPerSide + x] = Vector2f((float)x, (float)z);
+        }
+    }
+
+    std::vector<u32> Indices;
+    Indices.reserve(m_indexCount);
+
+    for (int z = 0; z < m_blockSize; z++) {
+        for (int x = 0; x < m_blockSize; x++) {
+            u32 TopLeft = z * NumVerticesPerSide + x;
+            u32 TopRight = TopLeft + 1;
+            u32 BottomLeft = (z + 1) * NumVerticesPerSide + x;
+            u32 BottomRight = BottomLeft + 1;
+
+            // Same winding as CreateTerrainGridVectors
+            Indices.push_back(TopLeft);
+            Indices.push_back(BottomLeft);
+            Indices.push_back(TopRight);
+
+            Indices.push_back(TopRight);
+            Indices.push_back(BottomLeft);
+            Indices.push_back(BottomRight);
+        }
+    }
+
+    int MaxInstances = CLIPMAP_WINDOW_BLOCKS * CLIPMAP_WINDOW_BLOCKS * m_numLevels;
+
+    glCreateVertexArrays(1, &m_vao);
+    glCreateBuffers(1, &m_vbo);
+    glCreateBuffers(1, &m_ibo);
+    glCreateBuffers(1, &m_instanceBuffer);
+
+    glNamedBufferStorage(m_vbo, Vertices.size() * sizeof(Vector2f), Vertices.data(), 0);
+    glNamedBufferStorage(m_ibo, Indices.size() * sizeof(u32), Indices.data(), 0);
+    glNamedBufferStorage(m_instanceBuffer, MaxInstances * sizeof(Block), NULL, GL_DYNAMIC_STORAGE_BIT);
+
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(Vector2f));
+    glVertexArrayVertexBuffer(m_vao, 1, m_instanceBuffer, 0, sizeof(Block));
+    glVertexArrayBindingDivisor(m_vao, 1, 1);
+    glVertexArrayElementBuffer(m_vao, m_ibo);
+
+    // Attribute 0: position inside the block (vec2)
+    glEnableVertexArrayAttrib(m_vao, 0);
+    glVertexArrayAttribFormat(m_vao, 0, 2, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(m_vao, 0, 0);
+
+    // Attribute 1: origin, scale and level of the block (vec4 per instance)
+    glEnableVertexArrayAttrib(m_vao, 1);
+    glVertexArrayAttribFormat(m_vao, 1, 4, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(m_vao, 1, 1);
+}
+
+
+void TerrainClipmap::Update(const Vector3f& CameraPos, const Matrix4f& VP, float HorizontalScale, float MaxHeight)
+{
+    FrustumCulling Frustum(VP);
+
+    SelectBlocks(CameraPos, &Frustum, HorizontalScale, MaxHeight);
+
+    m_numInstances = (int)m_blocks.size();
+
+    if (m_numInstances > 0) {
+        glNamedBufferSubData(m_instanceBuffer, 0, m_numInstances * sizeof(Block), m_blocks.data());
+    }
+}
+
+
+void TerrainClipmap::SelectBlocks(const Vector3f& CameraPos, const FrustumCulling* pFrustum, float HorizontalScale, float MaxHeight)
+{
+    m_blocks.clear();
+    m_finestLevel = -1;
+    m_coarsestLevel = -1;
+
+    float CameraX = CameraPos.x / HorizontalScale;
+    float CameraZ = CameraPos.z / HorizontalScale;
+
+    float MinY = std::min(0.0f, MaxHeight);
+    float MaxY = std::max(0.0f, MaxHeight);
+
+    // In samples
+    float HeightAboveTerrain = std::max(CameraPos.y - MaxY, 0.0f) / HorizontalScale;
+
+    for (int Level = 0; Level < m_numLevels; Level++) {
+        float Scale = (float)(1 << Level);
+        float BlockExtent = (float)m_blockSize * Scale;
+        float HalfWindow = BlockExtent * CLIPMAP_WINDOW_BLOCKS / 2;
+
+        // The finest levels are too far below the camera to matter
+        if ((HalfWindow < HeightAboveTerrain) && (Level < m_numLevels - 1)) {
+            continue;
+        }
+
+        // Align the window to the blocks of the next level so that the hole
+        // in the next level is exactly where this level is
+        float ParentBlockExtent = 2.0f * BlockExtent;
+
+        Window& Cur = m_windows[Level];
+        Cur.MinX = floorf((CameraX - HalfWindow) / ParentBlockExtent + 0.5f) * ParentBlockExtent;
+        Cur.MinZ = floorf((CameraZ - HalfWindow) / ParentBlockExtent + 0.5f) * ParentBlockExtent;
+        Cur.MaxX = Cur.MinX + 2.0f * HalfWindow;
+        Cur.MaxZ = Cur.MinZ + 2.0f * HalfWindow;
+
+        bool HasHole = (m_finestLevel != -1);
+        const Window& Hole = m_windows[std::max(Level - 1, 0)];
+
+        for (int z = 0; z < CLIPMAP_WINDOW_BLOCKS; z++) {
+            float MinZ = Cur.MinZ + (float)z * BlockExtent;
+            float MaxZ = MinZ + BlockExtent;
+
+            if ((MaxZ <= m_mapMinZ) || (MinZ >= m_mapMaxZ)) {
+                continue;
+            }
+
+            for (int x = 0; x < CLIPMAP_WINDOW_BLOCKS; x++) {
+                float MinX = Cur.MinX + (float)x * BlockExtent;
+                float MaxX = MinX + BlockExtent;
+
+                if ((MaxX <= m_mapMinX) || (MinX >= m_mapMaxX)) {
+                    continue;
+                }
+
+                // The finer level is aligned to the blocks of this level so
+                // a block is either completely inside it or completely outside
+                if (HasHole && (MinX >= Hole.MinX) && (MinX < Hole.MaxX) &&
+                               (MinZ >= Hole.MinZ) && (MinZ < Hole.MaxZ)) {
+                    continue;
+                }
+
+                if (pFrustum) {
+                    // The vertices are clamped to the map in the shader
+                    AABB Box;
+                    Box.MinX = std::max(MinX, m_mapMinX) * HorizontalScale;
+                    Box.MaxX = std::min(MaxX, m_mapMaxX) * HorizontalScale;
+                    Box.MinY = MinY;
+                    Box.MaxY = MaxY;
+                    Box.MinZ = std::max(MinZ, m_mapMinZ) * HorizontalScale;
+                    Box.MaxZ = std::min(MaxZ, m_mapMaxZ) * HorizontalScale;
+
+                    if (!pFrustum->IsAABBInsideViewFrustum(Box)) {
+                        continue;
+                    }
+                }
+
+                Block b;
+                b.OriginX = MinX;
+                b.OriginZ = MinZ;
+                b.Scale = Scale;
+                b.Level = (float)Level;
+                m_blocks.push_back(b);
+            }
+        }
+
+        if (m_finestLevel == -1) {
+            m_finestLevel = Level;
+        }
+
+        m_coarsestLevel = Level;
+
+        // The coarser levels would only add blocks outside the map
+        if ((Cur.MinX <= m_mapMinX) && (Cur.MinZ <= m_mapMinZ) &&
+            (Cur.MaxX >= m_mapMaxX) && (Cur.MaxZ >= m_mapMaxZ)) {
+            break;
+        }
+    }
+}
+
+
+void TerrainClipmap::Render()
+{
+    if (m_numInstances == 0) {
+        return;
+    }
+
+    glBindVertexArray(m_vao);
+    glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, NULL, m_numInstances);
+    glBindVertexArray(0);
+}
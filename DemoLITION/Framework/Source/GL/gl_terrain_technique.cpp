@@ -53,6 +53,8 @@ bool TerrainTechnique::InitCommon()
     GET_UNIFORM(gAmbientFactor);
     GET_UNIFORM(gTexCoordScale);
     GET_UNIFORM(gRenderMode);
+    GET_UNIFORM(gUseNormalMap);
+    GET_UNIFORM(gNormalMapSlopeScale);
 
     return true;
 }
@@ -106,3 +108,52 @@ void TerrainTechnique::SetRenderMode(TERRAIN_RENDER_MODE RenderMode)
 {
     glUniform1i(m_gRenderModeLoc, RenderMode);
 }
+
+
+void TerrainTechnique::SetNormalMap(bool Enabled, float SlopeScale)
+{
+    glUniform1i(m_gUseNormalMapLoc, Enabled ? 1 : 0);
+    glUniform1f(m_gNormalMapSlopeScaleLoc, SlopeScale);
+}
+
+
+bool TerrainClipmapTechnique::Init()
+{
+    if (!Technique::Init()) {
+        return false;
+    }
+
+    if (!AddShader(GL_VERTEX_SHADER, "Framework/Shaders/GL/terrain_clipmap.vs")) {
+        return false;
+    }
+
+    if (!AddShader(GL_FRAGMENT_SHADER, "Framework/Shaders/GL/terrain.fs")) {
+        return false;
+    }
+
+    if (!Finalize()) {
+        return false;
+    }
+
+    if (!InitCommon()) {
+        return false;
+    }
+
+    GET_UNIFORM(gMapSize);
+    GET_UNIFORM(gBlockSize);
+    GET_UNIFORM(gCoarsestLevel);
+    GET_UNIFORM(gLevelWindow);
+
+    return true;
+}
+
+
+void TerrainClipmapTechnique::SetClipmap(const TerrainClipmap& Clipmap)
+{
+    glUniform2f(m_gMapSizeLoc, (float)Clipmap.GetWidth(), (float)Clipmap.GetHeight());
+    glUniform1f(m_gBlockSizeLoc, (float)Clipmap.GetBlockSize());
+    glUniform1i(m_gCoarsestLevelLoc, Clipmap.GetCoarsestLevel());
+
+    // The shader indexes the array by the level. The inactive levels are not used.
+    glUniform4fv(m_gLevelWindowLoc, MAX_CLIPMAP_LEVELS, (const GLfloat*)&Clipmap.GetLevelWindow(0));
+}
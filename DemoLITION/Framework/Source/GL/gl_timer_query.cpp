@@ -0,0 +1,77 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GL/gl_timer_query.h"
+
+
+GLTimerQuery::~GLTimerQuery()
+{
+    if (m_queries[0] != 0) {
+        glDeleteQueries(NUM_QUERIES, m_queries);
+    }
+}
+
+
+void GLTimerQuery::Begin()
+{
+    if (m_queries[0] == 0) {
+        glCreateQueries(GL_TIME_ELAPSED, NUM_QUERIES, m_queries);
+    }
+
+    // Still not done after NUM_QUERIES frames - drop the old result
+    if (m_pending[m_curQuery]) {
+        GetTimeMs();
+        m_pending[m_curQuery] = false;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[m_curQuery]);
+}
+
+
+void GLTimerQuery::End()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+
+    m_pending[m_curQuery] = true;
+    m_curQuery = (m_curQuery + 1) % NUM_QUERIES;
+}
+
+
+float GLTimerQuery::GetTimeMs()
+{
+    // Starts from the oldest query so the newest available result wins
+    for (int i = 0; i < NUM_QUERIES; i++) {
+        int Query = (m_curQuery + i) % NUM_QUERIES;
+
+        if (!m_pending[Query]) {
+            continue;
+        }
+
+        GLint Available = 0;
+        glGetQueryObjectiv(m_queries[Query], GL_QUERY_RESULT_AVAILABLE, &Available);
+
+        if (Available) {
+            GLuint64 TimeNs = 0;
+            glGetQueryObjectui64v(m_queries[Query], GL_QUERY_RESULT, &TimeNs);
+            m_lastTimeMs = (float)((double)TimeNs / 1000000.0);
+            m_pending[Query] = false;
+        }
+    }
+
+    return m_lastTimeMs;
+}
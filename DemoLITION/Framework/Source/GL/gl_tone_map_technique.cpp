@@ -44,9 +44,7 @@ bool ToneMapTechnique::Init()
 
     glGenVertexArrays(1, &m_dummyVAO);
 
-    GET_UNIFORM(gAvgLum);
     GET_UNIFORM(gHDRSampler);
-    GET_UNIFORM(gExposure);
     GET_UNIFORM(gMethodType);
     GET_UNIFORM(gEnableGammaCorrection);
 
@@ -66,12 +64,6 @@ void ToneMapTechnique::Render()
 }
 
 
-void ToneMapTechnique::SetAverageLuminance(float AvgLum)
-{
-    glUniform1f(m_gAvgLumLoc, AvgLum);
-}
-
-
 void ToneMapTechnique::SetHDRSampler(unsigned int TextureUnit)
 {
     glUniform1i(m_gHDRSamplerLoc, TextureUnit);
@@ -84,12 +76,6 @@ void ToneMapTechnique::SetBlurSampler(unsigned int TextureUnit)
 }
 
 
-void ToneMapTechnique::SetExposure(float Exposure)
-{
-    glUniform1f(m_gExposureLoc, Exposure);
-}
-
-
 void ToneMapTechnique::SetToneMapMethod(TONE_MAP_METHOD Method)
 {
     glUniform1i(m_gMethodTypeLoc, Method);
@@ -16,16 +16,300 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <limits>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/noise.hpp>
 
 #include "3rdparty/stb_image_write.h"
 
 #include "ogldev_util.h"
+#include "ogldev_thread_pool.h"
 #include "Services/perlin.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PERLIN_SSE
+#include <emmintrin.h>
+#endif
+
+#define PERLIN_ROWS_PER_BATCH 8
+
+
+static void CalcOctaveOffsets(const PerlinConfig& Config, std::vector<glm::vec2>& OctaveOffsets)
+{
+    OctaveOffsets.resize(Config.octaves);
+    srand(Config.seed);
+
+    for (int i = 0; i < Config.octaves; i++) {
+        float offsetX = (float)(rand() % 200000 - 100000);
+        float offsetY = (float)(rand() % 200000 - 100000);
+        OctaveOffsets[i] = glm::vec2(offsetX, offsetY);
+    }
+}
+
+
+static float CalcSafeScale(const PerlinConfig& Config)
+{
+    float SafeScale = Config.scale;
+    if (SafeScale <= 0.0f) {
+        SafeScale = 0.0001f;
+    }
+
+    return SafeScale;
+}
+
+
+#ifdef PERLIN_SSE
+
+static inline __m128 Floor4(__m128 x)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+}
+
+
+static inline __m128 Mod289(__m128 x)
+{
+    const __m128 C = _mm_set1_ps(289.0f);
+    const __m128 InvC = _mm_set1_ps(1.0f / 289.0f);
+    return _mm_sub_ps(x, _mm_mul_ps(Floor4(_mm_mul_ps(x, InvC)), C));
+}
+
+
+static inline __m128 Permute(__m128 x)
+{
+    __m128 t = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(34.0f)), _mm_set1_ps(1.0f));
+    return Mod289(_mm_mul_ps(t, x));
+}
+
+
+// The gradient of one corner of the cell dotted with the offset from the corner
+static inline __m128 CornerNoise(__m128 ix, __m128 iy, __m128 fx, __m128 fy)
+{
+    __m128 i = Permute(_mm_add_ps(Permute(ix), iy));
+
+    __m128 t = _mm_div_ps(i, _mm_set1_ps(41.0f));
+    __m128 gx = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f), _mm_sub_ps(t, Floor4(t))), _mm_set1_ps(1.0f));
+    __m128 AbsGx = _mm_andnot_ps(_mm_set1_ps(-0.0f), gx);
+    __m128 gy = _mm_sub_ps(AbsGx, _mm_set1_ps(0.5f));
+    __m128 tx = Floor4(_mm_add_ps(gx, _mm_set1_ps(0.5f)));
+    gx = _mm_sub_ps(gx, tx);
+
+    __m128 Dot = _mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gy, gy));
+    __m128 Norm = _mm_sub_ps(_mm_set1_ps(1.79284291400159f), _mm_mul_ps(_mm_set1_ps(0.85373472095314f), Dot));
+    gx = _mm_mul_ps(gx, Norm);
+    gy = _mm_mul_ps(gy, Norm);
+
+    return _mm_add_ps(_mm_mul_ps(gx, fx), _mm_mul_ps(gy, fy));
+}
+
+
+static inline __m128 Fade(__m128 t)
+{
+    __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    __m128 Inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+    Inner = _mm_add_ps(_mm_mul_ps(t, Inner), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(t3, Inner);
+}
+
+
+static inline __m128 Mix(__m128 x, __m128 y, __m128 a)
+{
+    return _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(_mm_set1_ps(1.0f), a)), _mm_mul_ps(y, a));
+}
+
+
+// glm::perlin(vec2) for four positions. The operations are done in the same order
+// as in glm so the results are the same as the scalar version.
+static __m128 Perlin4(__m128 x, __m128 y)
+{
+    __m128 FloorX = Floor4(x);
+    __m128 FloorY = Floor4(y);
+
+    // fract(p) and fract(p) - 1
+    __m128 Pf0x = _mm_sub_ps(x, FloorX);
+    __m128 Pf0y = _mm_sub_ps(y, FloorY);
+    __m128 Pf1x = _mm_sub_ps(Pf0x, _mm_set1_ps(1.0f));
+    __m128 Pf1y = _mm_sub_ps(Pf0y, _mm_set1_ps(1.0f));
+
+    // mod(floor(p) + {0, 1}, 289)
+    const __m128 C = _mm_set1_ps(289.0f);
+    __m128 Pi0x = FloorX;
+    __m128 Pi0y = FloorY;
+    __m128 Pi1x = _mm_add_ps(FloorX, _mm_set1_ps(1.0f));
+    __m128 Pi1y = _mm_add_ps(FloorY, _mm_set1_ps(1.0f));
+    Pi0x = _mm_sub_ps(Pi0x, _mm_mul_ps(C, Floor4(_mm_div_ps(Pi0x, C))));
+    Pi0y = _mm_sub_ps(Pi0y, _mm_mul_ps(C, Floor4(_mm_div_ps(Pi0y, C))));
+    Pi1x = _mm_sub_ps(Pi1x, _mm_mul_ps(C, Floor4(_mm_div_ps(Pi1x, C))));
+    Pi1y = _mm_sub_ps(Pi1y, _mm_mul_ps(C, Floor4(_mm_div_ps(Pi1y, C))));
+
+    __m128 n00 = CornerNoise(Pi0x, Pi0y, Pf0x, Pf0y);
+    __m128 n10 = CornerNoise(Pi1x, Pi0y, Pf1x, Pf0y);
+    __m128 n01 = CornerNoise(Pi0x, Pi1y, Pf0x, Pf1y);
+    __m128 n11 = CornerNoise(Pi1x, Pi1y, Pf1x, Pf1y);
+
+    __m128 FadeX = Fade(Pf0x);
+    __m128 FadeY = Fade(Pf0y);
+
+    __m128 nx0 = Mix(n00, n10, FadeX);
+    __m128 nx1 = Mix(n01, n11, FadeX);
+    __m128 nxy = Mix(nx0, nx1, FadeY);
+
+    return _mm_mul_ps(_mm_set1_ps(2.3f), nxy);
+}
+
+#endif
+
+
+// Sums the octaves of the samples [StartX, StartX + Width) of row y
+static void CalcRow(const PerlinConfig& Config, const std::vector<glm::vec2>& OctaveOffsets, float SafeScale,
+                    int StartX, int y, int Width, float* pRow)
+{
+    int x = 0;
+
+#ifdef PERLIN_SSE
+    for ( ; x + 4 <= Width; x += 4) {
+        int col = StartX + x;
+        __m128 Cols = _mm_set_ps((float)(col + 3), (float)(col + 2), (float)(col + 1), (float)col);
+
+        __m128 Sum = _mm_setzero_ps();
+        float Freq = 1.0f;
+        float Amplitude = 1.0f;
+
+        for (int Oct = 0; Oct < Config.octaves; Oct++) {
+            __m128 SampleX = _mm_div_ps(Cols, _mm_set1_ps(SafeScale));
+            SampleX = _mm_add_ps(_mm_mul_ps(SampleX, _mm_set1_ps(Freq)), _mm_set1_ps(OctaveOffsets[Oct].x));
+            float SampleY = y / SafeScale * Freq + OctaveOffsets[Oct].y;
+
+            __m128 p = _mm_mul_ps(Perlin4(SampleX, _mm_set1_ps(SampleY)), _mm_set1_ps(Amplitude));
+
+            Sum = _mm_add_ps(Sum, p);
+
+            Freq *= Config.lacunarity;
+            Amplitude *= Config.persistence;
+        }
+
+        _mm_storeu_ps(pRow + x, Sum);
+    }
+#endif
+
+    for ( ; x < Width; x++) {
+        int col = StartX + x;
+
+        float Sum = 0.0f;
+        float Freq = 1.0f;
+        float Amplitude = 1.0f;
+
+        for (int Oct = 0; Oct < Config.octaves; Oct++) {
+            float SampleX = col / SafeScale * Freq + OctaveOffsets[Oct].x;
+            float SampleY = y / SafeScale * Freq + OctaveOffsets[Oct].y;
+
+            float p = glm::perlin(glm::vec2(SampleX, SampleY)) * Amplitude;
+
+            Sum += p;
+
+            Freq *= Config.lacunarity;
+            Amplitude *= Config.persistence;
+        }
+
+        pRow[x] = Sum;
+    }
+}
+
+
+void CreatePerlinMap(const PerlinConfig& Config, std::vector<float>& HeightMap, ThreadPool* pPool)
+{
+    HeightMap.resize(Config.width * Config.height);
+
+    std::vector<glm::vec2> OctaveOffsets;
+    CalcOctaveOffsets(Config, OctaveOffsets);
+
+    float SafeScale = CalcSafeScale(Config);
+
+    ThreadPool& Pool = pPool ? *pPool : ThreadPool::GetDefault();
+
+    // Min/max per batch - the batches are the same for any number of threads
+    int NumBatches = (Config.height + PERLIN_ROWS_PER_BATCH - 1) / PERLIN_ROWS_PER_BATCH;
+    std::vector<float> BatchMin(NumBatches, std::numeric_limits<float>::max());
+    std::vector<float> BatchMax(NumBatches, std::numeric_limits<float>::lowest());
+
+    Pool.ParallelFor(Config.height, PERLIN_ROWS_PER_BATCH, [&](int Start, int End) {
+        int Batch = Start / PERLIN_ROWS_PER_BATCH;
+
+        for (int row = Start; row < End; row++) {
+            float* pRow = &HeightMap[row * Config.width];
+
+            CalcRow(Config, OctaveOffsets, SafeScale, 0, row, Config.width, pRow);
+
+            for (int col = 0; col < Config.width; col++) {
+                BatchMin[Batch] = std::min(BatchMin[Batch], pRow[col]);
+                BatchMax[Batch] = std::max(BatchMax[Batch], pRow[col]);
+            }
+        }
+    });
+
+    float MinValue = std::numeric_limits<float>::max();
+    float MaxValue = std::numeric_limits<float>::lowest();
+
+    for (int i = 0; i < NumBatches; i++) {
+        MinValue = std::min(MinValue, BatchMin[i]);
+        MaxValue = std::max(MaxValue, BatchMax[i]);
+    }
+
+    if (MaxValue != MinValue) {
+        float Range = MaxValue - MinValue;
+
+        Pool.ParallelFor(Config.height, PERLIN_ROWS_PER_BATCH, [&](int Start, int End) {
+            for (int i = Start * Config.width; i < End * Config.width; i++) {
+                HeightMap[i] = (HeightMap[i] - MinValue) / Range;
+            }
+        });
+    }
+}
+
+
+void CreatePerlinTile(const PerlinConfig& Config, int StartX, int StartY, int Width, int Height,
+                      std::vector<float>& Tile, ThreadPool* pPool)
+{
+    Tile.resize(Width * Height);
+
+    std::vector<glm::vec2> OctaveOffsets;
+    CalcOctaveOffsets(Config, OctaveOffsets);
+
+    float SafeScale = CalcSafeScale(Config);
+
+    // The noise is roughly in [-1,1] so the sum of the octaves is within the sum of the amplitudes
+    float MaxAmplitude = 0.0f;
+    float Amplitude = 1.0f;
+
+    for (int Oct = 0; Oct < Config.octaves; Oct++) {
+        MaxAmplitude += Amplitude;
+        Amplitude *= Config.persistence;
+    }
+
+    if (MaxAmplitude <= 0.0f) {
+        MaxAmplitude = 1.0f;
+    }
+
+    ThreadPool& Pool = pPool ? *pPool : ThreadPool::GetDefault();
+
+    Pool.ParallelFor(Height, PERLIN_ROWS_PER_BATCH, [&](int Start, int End) {
+        for (int row = Start; row < End; row++) {
+            float* pRow = &Tile[row * Width];
+
+            CalcRow(Config, OctaveOffsets, SafeScale, StartX, StartY + row, Width, pRow);
+
+            for (int col = 0; col < Width; col++) {
+                float h = pRow[col] / MaxAmplitude * 0.5f + 0.5f;
+                pRow[col] = std::min(std::max(h, 0.0f), 1.0f);
+            }
+        }
+    });
+}
+
 
-void CreatePerlinMap(const PerlinConfig& Config, std::vector<float>& HeightMap)
+void CreatePerlinMapReference(const PerlinConfig& Config, std::vector<float>& HeightMap)
 {
     HeightMap.resize(Config.width * Config.height);
 
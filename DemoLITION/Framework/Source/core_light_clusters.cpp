@@ -0,0 +1,191 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+
+#include "ogldev_thread_pool.h"
+#include "Int/core_light_clusters.h"
+
+
+void LightClusters::Init(const Matrix4f& Projection, float zNear, float zFar)
+{
+    assert(zNear > 0.0f);
+    assert(zFar > zNear);
+
+    m_projection = Projection;
+    m_zNear = zNear;
+    m_zFar = zFar;
+
+    float LogRatio = logf(zFar / zNear);
+    m_depthScale = (float)LIGHT_CLUSTERS_Z / LogRatio;
+    m_depthBias = -(float)LIGHT_CLUSTERS_Z * logf(zNear) / LogRatio;
+
+    // For a symmetric projection the NDC of a view space position is P[0][0] * x / Depth
+    float ScaleX = 1.0f / Projection.m[0][0];
+    float ScaleY = 1.0f / Projection.m[1][1];
+
+    m_boxes.resize(NUM_LIGHT_CLUSTERS);
+
+    for (int z = 0; z < LIGHT_CLUSTERS_Z; z++) {
+        float DepthNear = zNear * powf(zFar / zNear, (float)z / (float)LIGHT_CLUSTERS_Z);
+        float DepthFar = zNear * powf(zFar / zNear, (float)(z + 1) / (float)LIGHT_CLUSTERS_Z);
+
+        for (int y = 0; y < LIGHT_CLUSTERS_Y; y++) {
+            float NDCMinY = -1.0f + 2.0f * (float)y / (float)LIGHT_CLUSTERS_Y;
+            float NDCMaxY = -1.0f + 2.0f * (float)(y + 1) / (float)LIGHT_CLUSTERS_Y;
+
+            for (int x = 0; x < LIGHT_CLUSTERS_X; x++) {
+                float NDCMinX = -1.0f + 2.0f * (float)x / (float)LIGHT_CLUSTERS_X;
+                float NDCMaxX = -1.0f + 2.0f * (float)(x + 1) / (float)LIGHT_CLUSTERS_X;
+
+                // The tile grows with the depth so the extremes are on either the near or the far side
+                float MinX = std::min(NDCMinX * DepthNear, NDCMinX * DepthFar) * ScaleX;
+                float MaxX = std::max(NDCMaxX * DepthNear, NDCMaxX * DepthFar) * ScaleX;
+                float MinY = std::min(NDCMinY * DepthNear, NDCMinY * DepthFar) * ScaleY;
+                float MaxY = std::max(NDCMaxY * DepthNear, NDCMaxY * DepthFar) * ScaleY;
+
+                ClusterBox& Box = m_boxes[(z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x];
+                Box.Min = Vector4f(MinX, MinY, -DepthFar, 0.0f);
+                Box.Max = Vector4f(MaxX, MaxY, -DepthNear, 0.0f);
+            }
+        }
+    }
+}
+
+
+bool LightClusters::IsSameProjection(const Matrix4f& Projection, float zNear, float zFar) const
+{
+    return IsInitialized() && 
+           (zNear == m_zNear) && 
+           (zFar == m_zFar) &&
+           (memcmp(&Projection, &m_projection, sizeof(Matrix4f)) == 0);
+}
+
+
+int LightClusters::GetClusterIndex(const Vector3f& ViewPos) const
+{
+    float Depth = -ViewPos.z;
+
+    float NDCX = m_projection.m[0][0] * ViewPos.x / Depth;
+    float NDCY = m_projection.m[1][1] * ViewPos.y / Depth;
+
+    int x = (int)floorf((NDCX * 0.5f + 0.5f) * (float)LIGHT_CLUSTERS_X);
+    int y = (int)floorf((NDCY * 0.5f + 0.5f) * (float)LIGHT_CLUSTERS_Y);
+    int z = (int)floorf(logf(Depth) * m_depthScale + m_depthBias);
+
+    x = std::clamp(x, 0, LIGHT_CLUSTERS_X - 1);
+    y = std::clamp(y, 0, LIGHT_CLUSTERS_Y - 1);
+    z = std::clamp(z, 0, LIGHT_CLUSTERS_Z - 1);
+
+    return (z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x;
+}
+
+
+int LightClusters::Assign(const Matrix4f& View,
+                          const Vector4f* pSpheres,
+                          int NumLights,
+                          uint FirstLight,
+                          std::vector<uint>& Counts,
+                          std::vector<uint>& Indices) const
+{
+    assert(IsInitialized());
+
+    Counts.assign(NUM_LIGHT_CLUSTERS, 0);
+    Indices.resize(NUM_LIGHT_CLUSTERS * MAX_LIGHTS_PER_CLUSTER);
+
+    if (NumLights == 0) {
+        return 0;
+    }
+
+    std::vector<Vector4f> ViewSpheres(NumLights);
+
+    for (int i = 0; i < NumLights; i++) {
+        Vector4f Center = View * Vector4f(pSpheres[i].x, pSpheres[i].y, pSpheres[i].z, 1.0f);
+        ViewSpheres[i] = Vector4f(Center.x, Center.y, Center.z, pSpheres[i].w);
+    }
+
+    std::atomic<int> NumDropped = 0;
+
+    // The clusters are independent so every one of them walks the lights in order
+    // and its indices come out sorted
+    ThreadPool::GetDefault().ParallelFor(NUM_LIGHT_CLUSTERS, 64, [&](int Start, int End) {
+        int Dropped = 0;
+
+        for (int c = Start; c < End; c++) {
+            const ClusterBox& Box = m_boxes[c];
+            uint* pIndices = &Indices[c * MAX_LIGHTS_PER_CLUSTER];
+            uint Count = 0;
+
+            for (int i = 0; i < NumLights; i++) {
+                const Vector4f& s = ViewSpheres[i];
+
+                if (IntersectsSphere(Box, Vector3f(s.x, s.y, s.z), s.w)) {
+                    if (Count < MAX_LIGHTS_PER_CLUSTER) {
+                        pIndices[Count] = FirstLight + i;
+                        Count++;
+                    } else {
+                        Dropped++;
+                    }
+                }
+            }
+
+            Counts[c] = Count;
+        }
+
+        NumDropped += Dropped;
+    });
+
+    return NumDropped;
+}
+
+
+bool LightClusters::IntersectsSphere(const ClusterBox& Box, const Vector3f& ViewCenter, float Radius)
+{
+    // Distance from the center to the closest point of the box
+    float dx = ViewCenter.x - std::clamp(ViewCenter.x, Box.Min.x, Box.Max.x);
+    float dy = ViewCenter.y - std::clamp(ViewCenter.y, Box.Min.y, Box.Max.y);
+    float dz = ViewCenter.z - std::clamp(ViewCenter.z, Box.Min.z, Box.Max.z);
+
+    float Dist2 = dx * dx + dy * dy + dz * dz;
+
+    return Dist2 <= Radius * Radius;
+}
+
+
+float LightClusters::CalcLightRadius(float Intensity, float Constant, float Linear, float Exp)
+{
+    // Solve Exp * d^2 + Linear * d + Constant = Intensity / LIGHT_CUTOFF_INTENSITY
+    float c = Constant - Intensity / LIGHT_CUTOFF_INTENSITY;
+
+    if (c >= 0.0f) {
+        return 0.0f;   // never bright enough
+    }
+
+    if (Exp > 0.0f) {
+        return (-Linear + sqrtf(Linear * Linear - 4.0f * Exp * c)) / (2.0f * Exp);
+    }
+
+    if (Linear > 0.0f) {
+        return -c / Linear;
+    }
+
+    return -1.0f;
+}
@@ -31,6 +31,12 @@ MeshFileHeader LoadMeshData(const char* pMeshFile, MeshData& out)
         exit(EXIT_FAILURE);
     }
 
+    if ((header.m_magicValue != MESH_FILE_MAGIC) || (header.m_version != MESH_FILE_VERSION)) {
+        printf("'%s' is not a mesh file or its version is not %d - convert the model again.\n", pMeshFile, MESH_FILE_VERSION);
+        assert(false);
+        exit(EXIT_FAILURE);
+    }
+
     out.m_vertexSize = header.m_vertexSizeBytes;
     out.m_totalIndices = header.m_numIndices;
     out.m_totalVertices = header.m_numVertices;
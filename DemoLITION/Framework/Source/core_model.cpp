@@ -16,11 +16,17 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include <assimp/GltfMaterial.h>
 
+#include "ogldev_thread_pool.h"
 #include "Int/core_rendering_system.h"
 #include "Int/core_model.h"
 #include "3rdparty/meshoptimizer/src/meshoptimizer.h"
+#ifndef OGLDEV_VULKAN
+#include "3rdparty/stb_image.h"
+#endif
 
 //#define DEBUG_COLORS
 //#define DEBUG_MATERIALS
@@ -30,7 +36,9 @@
 
 // config flags
 static bool UseMeshOptimizer = false;
+static bool UseMeshLods = true;          // see GenerateLods
 static bool MissingTextureDetection = false;
+static bool UseModelCache = true;
 
 #ifdef OGLDEV_VULKAN
 
@@ -207,18 +215,35 @@ bool CoreModel::LoadAssimpModel(const std::string& Filename, const ModelLoadFlag
         LoadFlags |= aiProcess_ConvertToLeftHanded;
     }
 
-    m_pScene = m_Importer.ReadFile(Filename.c_str(), LoadFlags);
+    long long StartTime = GetCurrentTimeMillis();
+
+    if (UseModelCache && LoadModelCache(Filename, LoadFlags, UseMeshOptimizer, UseMeshLods)) {
+        printf("Loaded '%s' from the model cache in %lld ms\n", Filename.c_str(), GetCurrentTimeMillis() - StartTime);
+        Ret = true;
+    } else {
+        m_pScene = m_Importer.ReadFile(Filename.c_str(), LoadFlags);
 
-    if (m_pScene) {
-        printf("--- START Node Hierarchy ---\n");
-        traverse(0, m_pScene->mRootNode);
-        printf("--- END Node Hierarchy ---\n");
-        m_GlobalInverseTransform = m_pScene->mRootNode->mTransformation;
-        m_GlobalInverseTransform = m_GlobalInverseTransform.Inverse();
-        Ret = InitFromScene(m_pScene, Filename);
+        if (m_pScene) {
+            printf("--- START Node Hierarchy ---\n");
+            traverse(0, m_pScene->mRootNode);
+            printf("--- END Node Hierarchy ---\n");
+            m_GlobalInverseTransform = m_pScene->mRootNode->mTransformation;
+            m_GlobalInverseTransform = m_GlobalInverseTransform.Inverse();
+            Ret = InitFromScene(m_pScene, Filename);
+
+            printf("Imported '%s' with Assimp in %lld ms\n", Filename.c_str(), GetCurrentTimeMillis() - StartTime);
+
+            if (Ret && UseModelCache) {
+                SaveModelCache(Filename, LoadFlags, UseMeshOptimizer, UseMeshLods);
+            }
+        }
+        else {
+            printf("Error parsing '%s': '%s'\n", Filename.c_str(), m_Importer.GetErrorString());
+        }
     }
-    else {
-        printf("Error parsing '%s': '%s'\n", Filename.c_str(), m_Importer.GetErrorString());
+
+    if (Ret) {
+        CompileAnimations();
     }
 
 #ifndef OGLDEV_VULKAN // TODO: move to GLModel using virtual function
@@ -281,11 +306,17 @@ void CoreModel::InitBuffers(const aiScene* pScene, unsigned int NumVertices, uns
     if (pScene->mNumAnimations > 0) {
         std::vector<SkinnedVertex> Vertices;
         InitGeometryInternal<SkinnedVertex>(Vertices, NumVertices, NumIndices);
+        if (UseModelCache) {
+            KeepVerticesForCache(Vertices.data(), Vertices.size() * sizeof(SkinnedVertex));
+        }
         PopulateBuffersSkinned(Vertices);
     }
     else {
         std::vector<Vertex> Vertices;
         InitGeometryInternal<Vertex>(Vertices, NumVertices, NumIndices);
+        if (UseModelCache) {
+            KeepVerticesForCache(Vertices.data(), Vertices.size() * sizeof(Vertex));
+        }
         PopulateBuffers(Vertices);
     }
 }
@@ -343,17 +374,86 @@ void CoreModel::ReserveSpace(std::vector<VertexType>& Vertices, unsigned int Num
 }
 
 
+//
+// The meshes are processed in parallel, each one into its own local buffers,
+// and then concatenated in the original mesh order. This makes the result
+// identical to processing the meshes one after the other.
+//
 template<typename VertexType>
 void CoreModel::InitAllMeshes(const aiScene* pScene, std::vector<VertexType>& Vertices)
 {
-    for (unsigned int i = 0 ; i < m_Meshes.size() ; i++) {
-        const aiMesh* paiMesh = pScene->mMeshes[i];
+    int NumMeshes = (int)m_Meshes.size();
+
+    // The bone indices depend on the order in which the bones are found
+    // so they must be allocated serially before the parallel stage.
+    if constexpr (std::is_same_v<VertexType, SkinnedVertex>) {
+        for (int i = 0; i < NumMeshes; i++) {
+            AllocMeshBones(pScene->mMeshes[i]);
+        }
+    }
+
+    std::vector<MeshBuffers<VertexType>> Meshes(NumMeshes);
+
+    long long StartTime = GetCurrentTimeMillis();
+
+    ThreadPool::GetDefault().ParallelFor(NumMeshes, 1, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            if (UseMeshOptimizer) {
+                InitSingleMeshOpt<VertexType>(Meshes[i], pScene->mMeshes[i]);
+            } else {
+                InitSingleMesh<VertexType>(Meshes[i], pScene->mMeshes[i]);
+            }
+
+            if (UseMeshLods) {
+                GenerateLods<VertexType>(Meshes[i]);
+            }
+        }
+    });
+
+    printf("Processed %d meshes in %lld ms\n", NumMeshes, GetCurrentTimeMillis() - StartTime);
+
+    size_t TotalNumIndices = 0;
+
+    for (int i = 0; i < NumMeshes; i++) {
+        MeshBuffers<VertexType>& Mesh = Meshes[i];
+
+        printf("Mesh %d: %s\n", i, pScene->mMeshes[i]->mName.C_Str());
+
+        m_Meshes[i].BaseVertex = (uint)Vertices.size();
+        m_Meshes[i].BaseIndex = (uint)m_Indices.size();
 
         if (UseMeshOptimizer) {
-            InitSingleMeshOpt<VertexType>(Vertices, i, paiMesh);
-        } else {
-            InitSingleMesh<VertexType>(Vertices, i, paiMesh);
+            TotalNumIndices += pScene->mMeshes[i]->mNumFaces * 3;
+            m_Meshes[i].NumIndices = (Mesh.LodCount > 1) ? Mesh.LodOffsets[1] : (uint)Mesh.Indices.size();
+        }
+
+        m_Meshes[i].LodCount = Mesh.LodCount;
+        memcpy(m_Meshes[i].LodOffsets, Mesh.LodOffsets, sizeof(Mesh.LodOffsets));
+        memcpy(m_Meshes[i].LodErrors, Mesh.LodErrors, sizeof(Mesh.LodErrors));
+
+        m_minPos.x = std::min(m_minPos.x, Mesh.MinPos.x);
+        m_minPos.y = std::min(m_minPos.y, Mesh.MinPos.y);
+        m_minPos.z = std::min(m_minPos.z, Mesh.MinPos.z);
+
+        m_maxPos.x = std::max(m_maxPos.x, Mesh.MaxPos.x);
+        m_maxPos.y = std::max(m_maxPos.y, Mesh.MaxPos.y);
+        m_maxPos.z = std::max(m_maxPos.z, Mesh.MaxPos.z);
+
+        if (!Mesh.Vertices.empty()) {
+            m_Meshes[i].Bounds.Add(Mesh.MinPos);
+            m_Meshes[i].Bounds.Add(Mesh.MaxPos);
         }
+
+        Vertices.insert(Vertices.end(), Mesh.Vertices.begin(), Mesh.Vertices.end());
+        m_Indices.insert(m_Indices.end(), Mesh.Indices.begin(), Mesh.Indices.end());
+
+        // Release the local buffers as we go to limit the peak memory usage
+        Mesh = MeshBuffers<VertexType>();
+    }
+
+    if (UseMeshOptimizer) {
+        printf("Num indices %d\n", (int)TotalNumIndices);
+        printf("Optimized number of indices %d\n", (int)m_Indices.size());
     }
 }
 
@@ -427,12 +527,16 @@ void CoreModel::TraverseNodeHierarchy(Matrix4f ParentTransformation, aiNode* pNo
 }
 
 
+// Called in parallel for several meshes so it must only touch the local mesh buffers
 template<typename VertexType>
-void CoreModel::InitSingleMesh(vector<VertexType>& Vertices, uint MeshIndex, const aiMesh* paiMesh)
+void CoreModel::InitSingleMesh(MeshBuffers<VertexType>& Mesh, const aiMesh* paiMesh)
 {
     const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
 
-    printf("Mesh %d: %s\n", MeshIndex, paiMesh->mName.C_Str());
+    std::vector<VertexType>& Vertices = Mesh.Vertices;
+    Vertices.reserve(paiMesh->mNumVertices);
+    Mesh.Indices.reserve(paiMesh->mNumFaces * 3);
+
     // Populate the vertex attribute vectors
     VertexType v;
 
@@ -440,13 +544,13 @@ void CoreModel::InitSingleMesh(vector<VertexType>& Vertices, uint MeshIndex, con
         const aiVector3D& Pos = paiMesh->mVertices[i];       
         v.Position = Vector3f(Pos.x, Pos.y, Pos.z);
 
-        m_minPos.x = std::min(m_minPos.x, v.Position.x);
-        m_minPos.y = std::min(m_minPos.y, v.Position.y);
-        m_minPos.z = std::min(m_minPos.z, v.Position.z);
+        Mesh.MinPos.x = std::min(Mesh.MinPos.x, v.Position.x);
+        Mesh.MinPos.y = std::min(Mesh.MinPos.y, v.Position.y);
+        Mesh.MinPos.z = std::min(Mesh.MinPos.z, v.Position.z);
 
-        m_maxPos.x = std::max(m_maxPos.x, v.Position.x);
-        m_maxPos.y = std::max(m_maxPos.y, v.Position.y);
-        m_maxPos.z = std::max(m_maxPos.z, v.Position.z);
+        Mesh.MaxPos.x = std::max(Mesh.MaxPos.x, v.Position.x);
+        Mesh.MaxPos.y = std::max(Mesh.MaxPos.y, v.Position.y);
+        Mesh.MaxPos.z = std::max(Mesh.MaxPos.z, v.Position.z);
 
         if (paiMesh->mNormals) {
             const aiVector3D& pNormal   = paiMesh->mNormals[i];
@@ -512,19 +616,20 @@ void CoreModel::InitSingleMesh(vector<VertexType>& Vertices, uint MeshIndex, con
      /*   printf("%d: %d\n", i * 3, Face.mIndices[0]);
         printf("%d: %d\n", i * 3 + 1, Face.mIndices[1]);
         printf("%d: %d\n", i * 3 + 2, Face.mIndices[2]);*/
-        m_Indices.push_back(Face.mIndices[0]);
-        m_Indices.push_back(Face.mIndices[1]);
-        m_Indices.push_back(Face.mIndices[2]);
+        Mesh.Indices.push_back(Face.mIndices[0]);
+        Mesh.Indices.push_back(Face.mIndices[1]);
+        Mesh.Indices.push_back(Face.mIndices[2]);
     }
 
     if constexpr (std::is_same_v<VertexType, SkinnedVertex>) {
-        LoadMeshBones(Vertices, MeshIndex, paiMesh);
+        LoadMeshBones(Vertices, paiMesh);
     }  
 }
 
 
+// Called in parallel for several meshes so it must only touch the local mesh buffers
 template<typename VertexType>
-void CoreModel::InitSingleMeshOpt(vector<VertexType>& AllVertices, uint MeshIndex, const aiMesh* paiMesh)
+void CoreModel::InitSingleMeshOpt(MeshBuffers<VertexType>& Mesh, const aiMesh* paiMesh)
 {
     const aiVector3D Zero3D(0.0f, 0.0f, 0.0f);
 
@@ -539,12 +644,12 @@ void CoreModel::InitSingleMeshOpt(vector<VertexType>& AllVertices, uint MeshInde
         // printf("%d: ", i); Vector3f v(pPos.x, pPos.y, pPos.z); v.Print();
         v.Position = Vector3f(Pos.x, Pos.y, Pos.z);
 
-        m_minPos.x = std::min(m_minPos.x, v.Position.x);
-        m_minPos.y = std::min(m_minPos.y, v.Position.y);
-        m_minPos.z = std::min(m_minPos.z, v.Position.z);
-        m_maxPos.x = std::max(m_maxPos.x, v.Position.x);
-        m_maxPos.y = std::max(m_maxPos.y, v.Position.y);
-        m_maxPos.z = std::max(m_maxPos.z, v.Position.z);
+        Mesh.MinPos.x = std::min(Mesh.MinPos.x, v.Position.x);
+        Mesh.MinPos.y = std::min(Mesh.MinPos.y, v.Position.y);
+        Mesh.MinPos.z = std::min(Mesh.MinPos.z, v.Position.z);
+        Mesh.MaxPos.x = std::max(Mesh.MaxPos.x, v.Position.x);
+        Mesh.MaxPos.y = std::max(Mesh.MaxPos.y, v.Position.y);
+        Mesh.MaxPos.z = std::max(Mesh.MaxPos.z, v.Position.z);
 
         if (paiMesh->mNormals) {
             const aiVector3D& pNormal = paiMesh->mNormals[i];
@@ -592,9 +697,6 @@ void CoreModel::InitSingleMeshOpt(vector<VertexType>& AllVertices, uint MeshInde
         Vertices[i] = v;
     }
 
-    m_Meshes[MeshIndex].BaseVertex = (uint)AllVertices.size();
-    m_Meshes[MeshIndex].BaseIndex = (uint)m_Indices.size();
-
     int NumIndices = paiMesh->mNumFaces * 3;
 
     std::vector<uint> Indices;
@@ -615,15 +717,15 @@ void CoreModel::InitSingleMeshOpt(vector<VertexType>& AllVertices, uint MeshInde
     }
 
     if constexpr (std::is_same_v<VertexType, SkinnedVertex>) {
-	    LoadMeshBones(Vertices, MeshIndex, paiMesh);
+	    LoadMeshBones(Vertices, paiMesh);
 	}
 
-    OptimizeMesh(MeshIndex, Indices, Vertices, AllVertices);
+    OptimizeMesh(Indices, Vertices, Mesh);
 }
 
 
 template<typename VertexType>
-void CoreModel::OptimizeMesh(int MeshIndex, std::vector<uint>&Indices, std::vector<VertexType>&Vertices, std::vector<VertexType>& AllVertices)
+void CoreModel::OptimizeMesh(std::vector<uint>& Indices, std::vector<VertexType>& Vertices, MeshBuffers<VertexType>& Mesh)
 {
     size_t NumIndices = Indices.size();
     size_t NumVertices = Vertices.size();
@@ -656,30 +758,78 @@ void CoreModel::OptimizeMesh(int MeshIndex, std::vector<uint>&Indices, std::vect
     // Optimization #4: optimize access to the vertex buffer
     meshopt_optimizeVertexFetch(OptVertices.data(), OptIndices.data(), NumIndices, OptVertices.data(), OptVertexCount, sizeof(VertexType));
 
-    // Optimization #5: create a simplified version of the model
-    float Threshold = 1.0f;
-    size_t TargetIndexCount = (size_t)(NumIndices * Threshold);
-    
-    float TargetError = 0.0f;
-    std::vector<unsigned int> SimplifiedIndices(OptIndices.size());
-    size_t OptIndexCount = meshopt_simplify(SimplifiedIndices.data(), OptIndices.data(), NumIndices,
-                                            &OptVertices[0].Position.x, OptVertexCount, sizeof(VertexType), TargetIndexCount, TargetError);
-
-    static int num_indices = 0;
-    num_indices += (int)NumIndices;
-    static int opt_indices = 0;
-    opt_indices += (int)OptIndexCount;
-    printf("Num indices %d\n", num_indices);
-    //printf("Target num indices %d\n", TargetIndexCount);
-    printf("Optimized number of indices %d\n", opt_indices);
-    SimplifiedIndices.resize(OptIndexCount);
-    
-    // Concatenate the local arrays into the class attributes arrays
-    m_Indices.insert(m_Indices.end(), SimplifiedIndices.begin(), SimplifiedIndices.end());
+    // The simplified versions of the mesh are created by GenerateLods
+
+    // The caller concatenates the local arrays into the class attributes arrays
+    Mesh.Indices = std::move(OptIndices);
+    Mesh.Vertices = std::move(OptVertices);
+}
+
 
-    AllVertices.insert(AllVertices.end(), OptVertices.begin(), OptVertices.end());
+#define LOD_MIN_INDICES     (3 * 64)    // don't simplify meshes which are already small
+#define LOD_MAX_ERROR       0.1f        // relative to the size of the mesh
+#define LOD_MIN_REDUCTION   0.8f        // stop when a LOD is not at least 20% smaller than the previous one
 
-    m_Meshes[MeshIndex].NumIndices = (uint)OptIndexCount;
+//
+// Appends up to MAX_LOD_COUNT - 1 simplified versions of the mesh to its index buffer. Each LOD
+// targets half the triangles of the previous one and is simplified from it (rather than from
+// LOD 0) so the error of a LOD is the sum of the errors of all the steps up to it. The vertices
+// are shared by all the LODs.
+//
+template<typename VertexType>
+void CoreModel::GenerateLods(MeshBuffers<VertexType>& Mesh)
+{
+    size_t NumIndices = Mesh.Indices.size();
+
+    Mesh.LodCount = 1;
+    Mesh.LodOffsets[0] = 0;
+    Mesh.LodOffsets[1] = (uint)NumIndices;
+    Mesh.LodErrors[0] = 0.0f;
+
+    if ((NumIndices < LOD_MIN_INDICES) || Mesh.Vertices.empty()) {
+        return;
+    }
+
+    const float* pPositions = &Mesh.Vertices[0].Position.x;
+    size_t NumVertices = Mesh.Vertices.size();
+
+    // The error of meshopt_simplify is relative to the extents of the mesh
+    float Scale = meshopt_simplifyScale(pPositions, NumVertices, sizeof(VertexType));
+
+    std::vector<uint> SrcIndices(Mesh.Indices);
+    std::vector<uint> LodIndices(NumIndices);
+
+    float Error = 0.0f;
+
+    while (Mesh.LodCount < MAX_LOD_COUNT) {
+        size_t SrcCount = SrcIndices.size();
+        size_t TargetIndexCount = (SrcCount / 2) / 3 * 3;
+
+        if (TargetIndexCount < LOD_MIN_INDICES / 2) {
+            break;
+        }
+
+        float StepError = 0.0f;
+        size_t NumLodIndices = meshopt_simplify(LodIndices.data(), SrcIndices.data(), SrcCount,
+                                           pPositions, NumVertices, sizeof(VertexType),
+                                           TargetIndexCount, LOD_MAX_ERROR, 0, &StepError);
+
+        // The mesh cannot be simplified any further within the error limit
+        if ((NumLodIndices == 0) || (NumLodIndices > (size_t)(SrcCount * LOD_MIN_REDUCTION))) {
+            break;
+        }
+
+        meshopt_optimizeVertexCache(LodIndices.data(), LodIndices.data(), NumLodIndices, NumVertices);
+
+        Error += StepError * Scale;
+
+        Mesh.Indices.insert(Mesh.Indices.end(), LodIndices.begin(), LodIndices.begin() + NumLodIndices);
+        Mesh.LodErrors[Mesh.LodCount] = Error;
+        Mesh.LodCount++;
+        Mesh.LodOffsets[Mesh.LodCount] = (uint)Mesh.Indices.size();
+
+        SrcIndices.assign(LodIndices.begin(), LodIndices.begin() + NumLodIndices);
+    }
 }
 
 
@@ -705,6 +855,8 @@ bool CoreModel::InitMaterials(const aiScene* pScene, const string& Filename)
         LoadColors(pMaterial, i);
     }
 
+    DecodeAndUploadTextures();
+
     return Ret;
 }
 
@@ -748,6 +900,12 @@ void CoreModel::GetVertexSizesInBytes(size_t& VertexSize, size_t& SkinnedVertexS
 }
 
 
+void CoreModel::EnableModelCache(bool Enable)
+{
+    UseModelCache = Enable;
+}
+
+
 static int GetTextureCount(const aiMaterial* pMaterial)
 {
     int TextureCount = 0;
@@ -909,9 +1067,23 @@ void CoreModel::LoadTextureEmbedded(const aiTexture* paiTexture, int MaterialInd
 #ifdef DEBUG_MATERIALS
     printf("Loaded embeddeded texture type '%s'\n", paiTexture->achFormatHint);
 #endif
-    m_Materials[MaterialIndex].pTextures[MyType] = AllocTexture2D();
     int buffer_size = paiTexture->mWidth;   // TODO: just the width???
-    m_Materials[MaterialIndex].pTextures[MyType]->Load(buffer_size, paiTexture->pcData, IsSRGB);
+    LoadTextureEmbedded(buffer_size, paiTexture->pcData, MaterialIndex, MyType, IsSRGB);
+}
+
+
+// The texture object is allocated here but the image is loaded later by DecodeAndUploadTextures
+void CoreModel::LoadTextureEmbedded(u32 BufferSize, const void* pData, int MaterialIndex, TEXTURE_TYPE MyType, bool IsSRGB)
+{
+    m_Materials[MaterialIndex].pTextures[MyType] = AllocTexture2D();
+
+    TextureSource Source;
+    Source.MaterialIndex = MaterialIndex;
+    Source.Type = MyType;
+    Source.IsSRGB = IsSRGB;
+    Source.pEmbeddedData = pData;
+    Source.EmbeddedSize = BufferSize;
+    m_textureSources.push_back(Source);
 }
 
 
@@ -919,15 +1091,163 @@ void CoreModel::LoadTextureFromFile(const string& Dir, const aiString& Path, int
 {
     std::string FullPath = GetFullPath(Dir, Path);
 
+    LoadTextureFromFile(FullPath, MaterialIndex, MyType, IsSRGB);
+}
+
+
+// The texture object is allocated here but the image is loaded later by DecodeAndUploadTextures
+void CoreModel::LoadTextureFromFile(const string& FullPath, int MaterialIndex, TEXTURE_TYPE MyType, bool IsSRGB)
+{
     m_Materials[MaterialIndex].pTextures[MyType] = AllocTexture2D();
-    m_Materials[MaterialIndex].pTextures[MyType]->Load(FullPath.c_str(), IsSRGB);
+
+    TextureSource Source;
+    Source.MaterialIndex = MaterialIndex;
+    Source.Type = MyType;
+    Source.IsSRGB = IsSRGB;
+    Source.FullPath = FullPath;
+    m_textureSources.push_back(Source);
 
 #ifdef DEBUG_MATERIALS
-    printf("Loaded texture type %d from '%s'\n", MyType, FullPath.c_str());
+    printf("Loading texture type %d from '%s'\n", MyType, FullPath.c_str());
 #endif
 }
 
 
+#ifdef OGLDEV_VULKAN
+
+void CoreModel::DecodeAndUploadTextures()
+{
+    for (const TextureSource& Source : m_textureSources) {
+        Texture* pTexture = m_Materials[Source.MaterialIndex].pTextures[Source.Type];
+
+        if (Source.pEmbeddedData) {
+            // The Vulkan texture takes a non-const pointer
+            pTexture->Load(Source.EmbeddedSize, (void*)Source.pEmbeddedData, Source.IsSRGB);
+        } else {
+            pTexture->Load(Source.FullPath, Source.IsSRGB);
+        }
+    }
+}
+
+#else
+
+struct DecodedImage {
+    unsigned char* pData = NULL;
+    int Width = 0;
+    int Height = 0;
+    int BPP = 0;
+    const char* pFailureReason = "";   // stb keeps the failure reason per thread
+};
+
+
+static bool IsKTXFile(const std::string& Filename)
+{
+    const char* pExt = strrchr(Filename.c_str(), '.');
+
+    return pExt && !strcmp(pExt, ".ktx");
+}
+
+
+static void DecodeImage(const void* pEmbeddedData, u32 EmbeddedSize, const std::string& FullPath, DecodedImage& Image)
+{
+    if (pEmbeddedData) {
+        Image.pData = stbi_load_from_memory((const stbi_uc*)pEmbeddedData, EmbeddedSize,
+                                            &Image.Width, &Image.Height, &Image.BPP, 0);
+    } else if (!IsKTXFile(FullPath)) {
+        Image.pData = stbi_load(FullPath.c_str(), &Image.Width, &Image.Height, &Image.BPP, 0);
+    }
+
+    if (!Image.pData) {
+        Image.pFailureReason = stbi_failure_reason();
+    }
+}
+
+
+//
+// Texture loading is done in two stages:
+// 1. Decode all the images of the model on the thread pool (stb_image only, no GL calls)
+// 2. Upload the decoded pixels on the GL thread in the original order
+//
+// Every image is decoded into its own slot so the result does not depend on the
+// scheduling of the threads. Both embedded and file textures are flipped vertically,
+// same as Texture::Load() does for files. KTX files are loaded by Texture::Load()
+// during the upload stage since they are not decoded by stb_image.
+//
+void CoreModel::DecodeAndUploadTextures()
+{
+    if (m_textureSources.empty()) {
+        return;
+    }
+
+    std::vector<DecodedImage> Images(m_textureSources.size());
+
+    long long StartTime = GetCurrentTimeMillis();
+
+    ThreadPool& Pool = ThreadPool::GetDefault();
+
+    if (Pool.GetNumThreads() > 0) {
+        std::vector<std::future<void>> Jobs;
+
+        for (int i = 0; i < (int)m_textureSources.size(); i++) {
+            Jobs.push_back(Pool.Submit([this, i, &Images]() {
+                // The flip flag must be set per thread. Only the workers do this because once
+                // it is set the thread ignores stbi_set_flip_vertically_on_load() forever.
+                stbi_set_flip_vertically_on_load_thread(1);
+                const TextureSource& Source = m_textureSources[i];
+                DecodeImage(Source.pEmbeddedData, Source.EmbeddedSize, Source.FullPath, Images[i]);
+            }));
+        }
+
+        for (std::future<void>& Job : Jobs) {
+            Job.wait();
+        }
+    } else {
+        stbi_set_flip_vertically_on_load(1);
+
+        for (int i = 0; i < (int)m_textureSources.size(); i++) {
+            const TextureSource& Source = m_textureSources[i];
+            DecodeImage(Source.pEmbeddedData, Source.EmbeddedSize, Source.FullPath, Images[i]);
+        }
+    }
+
+    long long DecodeTime = GetCurrentTimeMillis() - StartTime;
+
+    StartTime = GetCurrentTimeMillis();
+
+    for (int i = 0; i < (int)m_textureSources.size(); i++) {
+        const TextureSource& Source = m_textureSources[i];
+        Texture* pTexture = m_Materials[Source.MaterialIndex].pTextures[Source.Type];
+        DecodedImage& Image = Images[i];
+
+        if (!Source.pEmbeddedData && IsKTXFile(Source.FullPath)) {
+            pTexture->Load(Source.FullPath, Source.IsSRGB);
+            continue;
+        }
+
+        const char* pName = Source.pEmbeddedData ? "<embedded>" : Source.FullPath.c_str();
+
+        if (!Image.pData) {
+            printf("Can't load texture from '%s' - %s\n", pName, Image.pFailureReason);
+            exit(0);
+        }
+
+        printf("Loaded texture '%s' width %d, height %d, bpp %d\n", pName, Image.Width, Image.Height, Image.BPP);
+
+        pTexture->LoadRaw(Image.Width, Image.Height, Image.BPP, Image.pData, Source.IsSRGB);
+
+        stbi_image_free(Image.pData);
+        Image.pData = NULL;
+    }
+
+    long long UploadTime = GetCurrentTimeMillis() - StartTime;
+
+    printf("Textures: %d images, decode %lld ms (%d worker threads), upload %lld ms\n",
+           (int)m_textureSources.size(), DecodeTime, Pool.GetNumThreads(), UploadTime);
+}
+
+#endif
+
+
 void CoreModel::LoadColors(const aiMaterial* pMaterial, int index)
 {
     CoreMaterial& material = m_Materials[index];
@@ -1390,7 +1710,8 @@ void CoreModel::InitSpotLight(const aiScene* pScene, const aiLight& light)
 }
 
 
-void CoreModel::LoadMeshBones(vector<SkinnedVertex>& SkinnedVertices, uint MeshIndex, const aiMesh* pMesh)
+// Allocates the bone indices of a mesh. Must be called serially in mesh order.
+void CoreModel::AllocMeshBones(const aiMesh* pMesh)
 {
     if (pMesh->mNumBones > MAX_BONES) {
         printf("The number of bones in the model (%d) is larger than the maximum supported (%d)\n", pMesh->mNumBones, MAX_BONES);
@@ -1398,38 +1719,56 @@ void CoreModel::LoadMeshBones(vector<SkinnedVertex>& SkinnedVertices, uint MeshI
         assert(0);
     }
 
-    // printf("Loading mesh bones %d\n", MeshIndex);
     for (uint i = 0 ; i < pMesh->mNumBones ; i++) {
-        // printf("Bone %d %s\n", i, pMesh->mBones[i]->mName.C_Str());
-        LoadSingleBone(SkinnedVertices, MeshIndex, pMesh->mBones[i]);
+        const aiBone* pBone = pMesh->mBones[i];
+
+        int BoneId = GetBoneId(pBone);
+
+        if (BoneId == m_BoneInfo.size()) {
+            BoneInfo bi(pBone->mOffsetMatrix);
+            // bi.OffsetMatrix.Print();
+            m_BoneInfo.push_back(bi);
+        }
+
+        MarkRequiredNodesForBone(pBone);
     }
 }
 
 
-void CoreModel::LoadSingleBone(vector<SkinnedVertex>& SkinnedVertices, uint MeshIndex, const aiBone* pBone)
+// Loads the bone weights into the local vertices of a single mesh. The bone map
+// is only read here so this can run in parallel for several meshes.
+void CoreModel::LoadMeshBones(vector<SkinnedVertex>& SkinnedVertices, const aiMesh* pMesh)
 {
-    int BoneId = GetBoneId(pBone);
-
-    if (BoneId == m_BoneInfo.size()) {
-        BoneInfo bi(pBone->mOffsetMatrix);
-        // bi.OffsetMatrix.Print();
-        m_BoneInfo.push_back(bi);
+    for (uint i = 0 ; i < pMesh->mNumBones ; i++) {
+        // printf("Bone %d %s\n", i, pMesh->mBones[i]->mName.C_Str());
+        LoadSingleBone(SkinnedVertices, pMesh->mBones[i]);
     }
+}
+
+
+void CoreModel::LoadSingleBone(vector<SkinnedVertex>& SkinnedVertices, const aiBone* pBone)
+{
+    map<string,uint>::const_iterator it = m_BoneNameToIndexMap.find(string(pBone->mName.C_Str()));
+    assert(it != m_BoneNameToIndexMap.end());
+    uint BoneId = it->second;
 
     for (uint i = 0 ; i < pBone->mNumWeights ; i++) {
         const aiVertexWeight& vw = pBone->mWeights[i];
-        uint GlobalVertexID = m_Meshes[MeshIndex].BaseVertex + pBone->mWeights[i].mVertexId;
         // printf("%d: %d %f\n",i, pBone->mWeights[i].mVertexId, vw.mWeight);
-        SkinnedVertices[GlobalVertexID].Bones.AddBoneData(BoneId, vw.mWeight);
+        SkinnedVertices[vw.mVertexId].Bones.AddBoneData(BoneId, vw.mWeight);
     }
-
-    MarkRequiredNodesForBone(pBone);
 }
 
 
 void CoreModel::MarkRequiredNodesForBone(const aiBone* pBone)
 {
-    string NodeName(pBone->mName.C_Str());
+    MarkRequiredNodesForBone(string(pBone->mName.C_Str()));
+}
+
+
+void CoreModel::MarkRequiredNodesForBone(const string& BoneName)
+{
+    string NodeName(BoneName);
 
     const aiNode* pParent = NULL;
 
@@ -1748,7 +2087,7 @@ void CoreModel::CalcLocalTransform(LocalTransform& Transform, float AnimationTim
 }
 
 
-void CoreModel::GetBoneTransforms(float TimeInSeconds, vector<Matrix4f>& Transforms, unsigned int AnimationIndex)
+void CoreModel::GetBoneTransformsReference(float TimeInSeconds, vector<Matrix4f>& Transforms, unsigned int AnimationIndex)
 {
     if (AnimationIndex >= m_pScene->mNumAnimations) {
         printf("Invalid animation index %d, max is %d\n", AnimationIndex, m_pScene->mNumAnimations);
@@ -1770,11 +2109,11 @@ void CoreModel::GetBoneTransforms(float TimeInSeconds, vector<Matrix4f>& Transfo
 }
 
 
-void CoreModel::GetBoneTransformsBlended(float TimeInSeconds,
-                                           vector<Matrix4f>& BlendedTransforms,
-                                           unsigned int StartAnimIndex,
-                                           unsigned int EndAnimIndex,
-                                           float BlendFactor)
+void CoreModel::GetBoneTransformsBlendedReference(float TimeInSeconds,
+                                                  vector<Matrix4f>& BlendedTransforms,
+                                                  unsigned int StartAnimIndex,
+                                                  unsigned int EndAnimIndex,
+                                                  float BlendFactor)
 {
     if (StartAnimIndex >= m_pScene->mNumAnimations) {
         printf("Invalid start animation index %d, max is %d\n", StartAnimIndex, m_pScene->mNumAnimations);
@@ -1810,7 +2149,378 @@ void CoreModel::GetBoneTransformsBlended(float TimeInSeconds,
 }
 
 
-float CoreModel::CalcAnimationTimeTicks(float TimeInSeconds, unsigned int AnimationIndex)
+void CoreModel::CompileAnimations()
+{
+    m_animNodes.clear();
+    m_compiledAnimations.clear();
+
+    if (!m_pScene || (m_pScene->mNumAnimations == 0)) {
+        return;
+    }
+
+    CompileNodeHierarchy(m_pScene->mRootNode, -1);
+
+    m_animNodeTransforms.resize(m_animNodes.size());
+
+    m_compiledAnimations.resize(m_pScene->mNumAnimations);
+
+    for (uint AnimIndex = 0 ; AnimIndex < m_pScene->mNumAnimations ; AnimIndex++) {
+        const aiAnimation* pAnimation = m_pScene->mAnimations[AnimIndex];
+        CompiledAnimation& Compiled = m_compiledAnimations[AnimIndex];
+
+        // If several channels have the same name the first one wins (same as FindNodeAnim)
+        map<string,int> ChannelNameToIndex;
+
+        for (uint i = 0 ; i < pAnimation->mNumChannels ; i++) {
+            ChannelNameToIndex.emplace(string(pAnimation->mChannels[i]->mNodeName.data), (int)i);
+        }
+
+        Compiled.NodeToChannel.resize(m_animNodes.size(), -1);
+
+        for (uint NodeIndex = 0 ; NodeIndex < m_animNodes.size() ; NodeIndex++) {
+            map<string,int>::const_iterator it = ChannelNameToIndex.find(string(m_animNodes[NodeIndex].pNode->mName.data));
+
+            if (it == ChannelNameToIndex.end()) {
+                continue;
+            }
+
+            const aiNodeAnim* pNodeAnim = pAnimation->mChannels[it->second];
+
+            AnimChannel Channel;
+            Channel.pNodeAnim = pNodeAnim;
+
+            Channel.PositionTimes.resize(pNodeAnim->mNumPositionKeys);
+            for (uint i = 0 ; i < pNodeAnim->mNumPositionKeys ; i++) {
+                Channel.PositionTimes[i] = (float)pNodeAnim->mPositionKeys[i].mTime;
+            }
+
+            Channel.RotationTimes.resize(pNodeAnim->mNumRotationKeys);
+            for (uint i = 0 ; i < pNodeAnim->mNumRotationKeys ; i++) {
+                Channel.RotationTimes[i] = (float)pNodeAnim->mRotationKeys[i].mTime;
+            }
+
+            Channel.ScalingTimes.resize(pNodeAnim->mNumScalingKeys);
+            for (uint i = 0 ; i < pNodeAnim->mNumScalingKeys ; i++) {
+                Channel.ScalingTimes[i] = (float)pNodeAnim->mScalingKeys[i].mTime;
+            }
+
+            Compiled.NodeToChannel[NodeIndex] = (int)Compiled.Channels.size();
+            Compiled.Channels.push_back(std::move(Channel));
+        }
+    }
+
+    printf("Compiled %d animations over %d nodes\n", (int)m_compiledAnimations.size(), (int)m_animNodes.size());
+}
+
+
+// Visits the nodes exactly like ReadNodeHierarchy so the flattened order matches the recursion
+void CoreModel::CompileNodeHierarchy(const aiNode* pNode, int ParentIndex)
+{
+    AnimNode Node;
+    Node.pNode = pNode;
+    Node.ParentIndex = ParentIndex;
+    Node.Transformation = Matrix4f(pNode->mTransformation);
+
+    map<string,uint>::const_iterator BoneIt = m_BoneNameToIndexMap.find(string(pNode->mName.data));
+
+    if (BoneIt != m_BoneNameToIndexMap.end()) {
+        Node.BoneIndex = (int)BoneIt->second;
+    }
+
+    int NodeIndex = (int)m_animNodes.size();
+    m_animNodes.push_back(Node);
+
+    for (uint i = 0 ; i < pNode->mNumChildren ; i++) {
+        string ChildName(pNode->mChildren[i]->mName.data);
+
+        map<string,NodeInfo>::iterator it = m_requiredNodeMap.find(ChildName);
+
+        if (it == m_requiredNodeMap.end()) {
+            printf("Child %s cannot be found in the required node map\n", ChildName.c_str());
+            assert(0);
+        }
+
+        if (it->second.isRequired) {
+            CompileNodeHierarchy(pNode->mChildren[i], NodeIndex);
+        }
+    }
+}
+
+
+// Returns the same key index as the linear search in FindPosition/FindRotation/FindScaling:
+// the first key which is followed by a key later than the current time or zero if there is none.
+static uint FindKey(const vector<float>& Times, float AnimationTimeTicks)
+{
+    vector<float>::const_iterator it = std::upper_bound(Times.begin() + 1, Times.end(), AnimationTimeTicks);
+
+    if (it == Times.end()) {
+        return 0;
+    }
+
+    return (uint)(it - Times.begin()) - 1;
+}
+
+
+static void InterpolateVectorKeys(aiVector3D& Out, float AnimationTimeTicks, const aiVectorKey* pKeys, const vector<float>& Times)
+{
+    // we need at least two values to interpolate...
+    if (Times.size() == 1) {
+        Out = pKeys[0].mValue;
+        return;
+    }
+
+    uint Index = FindKey(Times, AnimationTimeTicks);
+    uint NextIndex = Index + 1;
+    assert(NextIndex < Times.size());
+    float t1 = Times[Index];
+    if (t1 > AnimationTimeTicks) {
+        Out = pKeys[Index].mValue;
+    } else {
+        float t2 = Times[NextIndex];
+        float DeltaTime = t2 - t1;
+        float Factor = (AnimationTimeTicks - t1) / DeltaTime;
+        assert(Factor >= 0.0f && Factor <= 1.0f);
+        const aiVector3D& Start = pKeys[Index].mValue;
+        const aiVector3D& End = pKeys[NextIndex].mValue;
+        aiVector3D Delta = End - Start;
+        Out = Start + Factor * Delta;
+    }
+}
+
+
+static void InterpolateRotationKeys(aiQuaternion& Out, float AnimationTimeTicks, const aiQuatKey* pKeys, const vector<float>& Times)
+{
+    assert(Times.size() > 0);
+
+    // we need at least two values to interpolate...
+    if (Times.size() == 1) {
+        Out = pKeys[0].mValue;
+        return;
+    }
+
+    uint Index = FindKey(Times, AnimationTimeTicks);
+    uint NextIndex = Index + 1;
+    assert(NextIndex < Times.size());
+    float t1 = Times[Index];
+    if (t1 > AnimationTimeTicks) {
+        Out = pKeys[Index].mValue;
+    } else {
+        float t2 = Times[NextIndex];
+        float DeltaTime = t2 - t1;
+        float Factor = (AnimationTimeTicks - t1) / DeltaTime;
+        assert(Factor >= 0.0f && Factor <= 1.0f);
+        const aiQuaternion& StartRotationQ = pKeys[Index].mValue;
+        const aiQuaternion& EndRotationQ   = pKeys[NextIndex].mValue;
+        aiQuaternion::Interpolate(Out, StartRotationQ, EndRotationQ, Factor);
+    }
+
+    Out.Normalize();
+}
+
+
+void CoreModel::CalcLocalTransform(LocalTransform& Transform, float AnimationTimeTicks, const AnimChannel& Channel) const
+{
+    const aiNodeAnim* pNodeAnim = Channel.pNodeAnim;
+
+    InterpolateVectorKeys(Transform.Scaling, AnimationTimeTicks, pNodeAnim->mScalingKeys, Channel.ScalingTimes);
+    InterpolateRotationKeys(Transform.Rotation, AnimationTimeTicks, pNodeAnim->mRotationKeys, Channel.RotationTimes);
+    InterpolateVectorKeys(Transform.Translation, AnimationTimeTicks, pNodeAnim->mPositionKeys, Channel.PositionTimes);
+}
+
+
+//
+// Calculates the final transformation of every bone using the compiled animation data.
+// pNodeTransforms must have room for one matrix per AnimNode and pBoneTransforms one per bone.
+// If pEndAnimation is NULL there is no blending and EndAnimationTimeTicks/BlendFactor are ignored.
+// The model is not modified so this can run concurrently for several instances.
+//
+void CoreModel::CalcPoseTransforms(float StartAnimationTimeTicks, float EndAnimationTimeTicks,
+                                   const CompiledAnimation& StartAnimation, const CompiledAnimation* pEndAnimation,
+                                   float BlendFactor, Matrix4f* pNodeTransforms, Matrix4f* pBoneTransforms) const
+{
+    Matrix4f Identity;
+    Identity.InitIdentity();
+
+    // Bones which are not reached by the traversal
+    for (uint i = 0 ; i < m_BoneInfo.size() ; i++) {
+        pBoneTransforms[i].SetZero();
+    }
+
+    for (uint NodeIndex = 0 ; NodeIndex < m_animNodes.size() ; NodeIndex++) {
+        const AnimNode& Node = m_animNodes[NodeIndex];
+
+        Matrix4f NodeTransformation = Node.Transformation;
+
+        int StartChannel = StartAnimation.NodeToChannel[NodeIndex];
+
+        if (!pEndAnimation) {
+            if (StartChannel >= 0) {
+                LocalTransform Transform;
+                CalcLocalTransform(Transform, StartAnimationTimeTicks, StartAnimation.Channels[StartChannel]);
+
+                Matrix4f ScalingM;
+                ScalingM.InitScaleTransform(Transform.Scaling.x, Transform.Scaling.y, Transform.Scaling.z);
+
+                Matrix4f RotationM = Matrix4f(Transform.Rotation.GetMatrix());
+
+                Matrix4f TranslationM;
+                TranslationM.InitTranslationTransform(Transform.Translation.x, Transform.Translation.y, Transform.Translation.z);
+
+                // Combine the above transformations
+                NodeTransformation = TranslationM * RotationM * ScalingM;
+            }
+        } else {
+            int EndChannel = pEndAnimation->NodeToChannel[NodeIndex];
+
+            if ((StartChannel >= 0) != (EndChannel >= 0)) {
+                printf("On the node %s there is an animation node for only one of the start/end animations.\n", Node.pNode->mName.C_Str());
+                printf("This case is not supported\n");
+                exit(0);
+            }
+
+            if (StartChannel >= 0) {
+                LocalTransform StartTransform;
+                CalcLocalTransform(StartTransform, StartAnimationTimeTicks, StartAnimation.Channels[StartChannel]);
+
+                LocalTransform EndTransform;
+                CalcLocalTransform(EndTransform, EndAnimationTimeTicks, pEndAnimation->Channels[EndChannel]);
+
+                // Interpolate scaling
+                const aiVector3D& Scale0 = StartTransform.Scaling;
+                const aiVector3D& Scale1 = EndTransform.Scaling;
+                aiVector3D BlendedScaling = (1.0f - BlendFactor) * Scale0 + Scale1 * BlendFactor;
+                Matrix4f ScalingM;
+                ScalingM.InitScaleTransform(BlendedScaling.x, BlendedScaling.y, BlendedScaling.z);
+
+                // Interpolate rotation
+                const aiQuaternion& Rot0 = StartTransform.Rotation;
+                const aiQuaternion& Rot1 = EndTransform.Rotation;
+                aiQuaternion BlendedRot;
+                aiQuaternion::Interpolate(BlendedRot, Rot0, Rot1, BlendFactor);
+                Matrix4f RotationM = Matrix4f(BlendedRot.GetMatrix());
+
+                // Interpolate translation
+                const aiVector3D& Pos0 = StartTransform.Translation;
+                const aiVector3D& Pos1 = EndTransform.Translation;
+                aiVector3D BlendedTranslation = (1.0f - BlendFactor) * Pos0 + Pos1 * BlendFactor;
+                Matrix4f TranslationM;
+                TranslationM.InitTranslationTransform(BlendedTranslation.x, BlendedTranslation.y, BlendedTranslation.z);
+
+                // Combine it all
+                NodeTransformation = TranslationM * RotationM * ScalingM;
+            }
+        }
+
+        const Matrix4f& ParentTransform = (Node.ParentIndex < 0) ? Identity : pNodeTransforms[Node.ParentIndex];
+
+        pNodeTransforms[NodeIndex] = ParentTransform * NodeTransformation;
+
+        if (Node.BoneIndex >= 0) {
+            pBoneTransforms[Node.BoneIndex] = m_GlobalInverseTransform * pNodeTransforms[NodeIndex] * m_BoneInfo[Node.BoneIndex].OffsetMatrix;
+        }
+    }
+}
+
+
+void CoreModel::GetBoneTransforms(float TimeInSeconds, vector<Matrix4f>& Transforms, unsigned int AnimationIndex)
+{
+    if (AnimationIndex >= m_compiledAnimations.size()) {
+        printf("Invalid animation index %d, max is %d\n", AnimationIndex, (int)m_compiledAnimations.size());
+        assert(0);
+    }
+
+    float AnimationTimeTicks = CalcAnimationTimeTicks(TimeInSeconds, AnimationIndex);
+
+    Transforms.resize(m_BoneInfo.size());
+
+    CalcPoseTransforms(AnimationTimeTicks, 0.0f, m_compiledAnimations[AnimationIndex], NULL, 0.0f,
+                       m_animNodeTransforms.data(), Transforms.data());
+}
+
+
+void CoreModel::GetBoneTransformsBlended(float TimeInSeconds,
+                                         vector<Matrix4f>& BlendedTransforms,
+                                         unsigned int StartAnimIndex,
+                                         unsigned int EndAnimIndex,
+                                         float BlendFactor)
+{
+    if (StartAnimIndex >= m_compiledAnimations.size()) {
+        printf("Invalid start animation index %d, max is %d\n", StartAnimIndex, (int)m_compiledAnimations.size());
+        assert(0);
+    }
+
+    if (EndAnimIndex >= m_compiledAnimations.size()) {
+        printf("Invalid end animation index %d, max is %d\n", EndAnimIndex, (int)m_compiledAnimations.size());
+        assert(0);
+    }
+
+    if ((BlendFactor < 0.0f) || (BlendFactor > 1.0f)) {
+        printf("Invalid blend factor %f\n", BlendFactor);
+        assert(0);
+    }
+
+    float StartAnimationTimeTicks = CalcAnimationTimeTicks(TimeInSeconds, StartAnimIndex);
+    float EndAnimationTimeTicks = CalcAnimationTimeTicks(TimeInSeconds, EndAnimIndex);
+
+    BlendedTransforms.resize(m_BoneInfo.size());
+
+    CalcPoseTransforms(StartAnimationTimeTicks, EndAnimationTimeTicks,
+                       m_compiledAnimations[StartAnimIndex], &m_compiledAnimations[EndAnimIndex], BlendFactor,
+                       m_animNodeTransforms.data(), BlendedTransforms.data());
+}
+
+
+void CoreModel::GetBoneTransformsBatch(const AnimationInstance* pInstances, int NumInstances, Matrix4f* pTransforms)
+{
+    for (int i = 0 ; i < NumInstances ; i++) {
+        const AnimationInstance& Instance = pInstances[i];
+
+        if ((Instance.StartAnimIndex >= m_compiledAnimations.size()) ||
+            ((Instance.BlendFactor > 0.0f) && (Instance.EndAnimIndex >= m_compiledAnimations.size()))) {
+            printf("Invalid animation index in instance %d, max is %d\n", i, (int)m_compiledAnimations.size());
+            assert(0);
+        }
+
+        if ((Instance.BlendFactor < 0.0f) || (Instance.BlendFactor > 1.0f)) {
+            printf("Invalid blend factor %f in instance %d\n", Instance.BlendFactor, i);
+            assert(0);
+        }
+    }
+
+    int NumBones = (int)m_BoneInfo.size();
+
+    // A few instances per batch to amortize the scheduling and the scratch space allocation
+    const int BatchSize = 8;
+
+    ThreadPool::GetDefault().ParallelFor(NumInstances, BatchSize, [&](int Start, int End) {
+        vector<Matrix4f> NodeTransforms(m_animNodes.size());
+
+        for (int i = Start ; i < End ; i++) {
+            CalcInstancePose(pInstances[i], NodeTransforms.data(), pTransforms + (size_t)i * NumBones);
+        }
+    });
+}
+
+
+// Called in parallel for several instances so it must not modify the model
+void CoreModel::CalcInstancePose(const AnimationInstance& Instance, Matrix4f* pNodeTransforms, Matrix4f* pBoneTransforms) const
+{
+    float StartAnimationTimeTicks = CalcAnimationTimeTicks(Instance.AnimationTimeSec, Instance.StartAnimIndex);
+
+    if (Instance.BlendFactor > 0.0f) {
+        float EndAnimationTimeTicks = CalcAnimationTimeTicks(Instance.AnimationTimeSec, Instance.EndAnimIndex);
+
+        CalcPoseTransforms(StartAnimationTimeTicks, EndAnimationTimeTicks,
+                           m_compiledAnimations[Instance.StartAnimIndex], &m_compiledAnimations[Instance.EndAnimIndex],
+                           Instance.BlendFactor, pNodeTransforms, pBoneTransforms);
+    } else {
+        CalcPoseTransforms(StartAnimationTimeTicks, 0.0f, m_compiledAnimations[Instance.StartAnimIndex], NULL, 0.0f,
+                           pNodeTransforms, pBoneTransforms);
+    }
+}
+
+
+float CoreModel::CalcAnimationTimeTicks(float TimeInSeconds, unsigned int AnimationIndex) const
 {
     float TicksPerSecond = (float)(m_pScene->mAnimations[AnimationIndex]->mTicksPerSecond != 0 ? m_pScene->mAnimations[AnimationIndex]->mTicksPerSecond : 25.0f);
     float TimeInTicks = TimeInSeconds * TicksPerSecond;
@@ -1837,6 +2547,108 @@ const aiNodeAnim* CoreModel::FindNodeAnim(const aiAnimation&
 }
 
 
+bool CoreModel::CalcWorldBounds(const Matrix4f& ObjectMatrix, const Matrix4f& GlobalRotation, AABB& WorldBounds) const
+{
+    WorldBounds = AABB();
+
+    for (uint i = 0 ; i < m_Meshes.size() ; i++) {
+        const BasicMeshEntry& Mesh = m_Meshes[i];
+
+        if (!Mesh.Bounds.IsValid()) {
+            if (Mesh.NumIndices == 0) {
+                continue;   // nothing is rendered for this mesh anyway
+            }
+
+            return false;
+        }
+
+        // Same order as the world matrix in the render callbacks
+        Matrix4f World = ObjectMatrix * Mesh.Transformation * GlobalRotation;
+
+        Vector3f Center((Mesh.Bounds.MinX + Mesh.Bounds.MaxX) * 0.5f,
+                        (Mesh.Bounds.MinY + Mesh.Bounds.MaxY) * 0.5f,
+                        (Mesh.Bounds.MinZ + Mesh.Bounds.MaxZ) * 0.5f);
+
+        Vector3f Extent((Mesh.Bounds.MaxX - Mesh.Bounds.MinX) * 0.5f,
+                        (Mesh.Bounds.MaxY - Mesh.Bounds.MinY) * 0.5f,
+                        (Mesh.Bounds.MaxZ - Mesh.Bounds.MinZ) * 0.5f);
+
+        // Transform the center and project the extents on the world axes
+        float WorldCenter[3], WorldExtent[3];
+
+        for (int r = 0 ; r < 3 ; r++) {
+            WorldCenter[r] = World.m[r][0] * Center.x + World.m[r][1] * Center.y + World.m[r][2] * Center.z + World.m[r][3];
+            WorldExtent[r] = fabsf(World.m[r][0]) * Extent.x + fabsf(World.m[r][1]) * Extent.y + fabsf(World.m[r][2]) * Extent.z;
+        }
+
+        WorldBounds.Add(Vector3f(WorldCenter[0] - WorldExtent[0], WorldCenter[1] - WorldExtent[1], WorldCenter[2] - WorldExtent[2]));
+        WorldBounds.Add(Vector3f(WorldCenter[0] + WorldExtent[0], WorldCenter[1] + WorldExtent[1], WorldCenter[2] + WorldExtent[2]));
+    }
+
+    return WorldBounds.IsValid();
+}
+
+
+void CoreModel::SelectLods(const Matrix4f& ObjectMatrix, const Matrix4f& GlobalRotation, const Vector3f& CameraPos,
+                           float ProjScale, float MaxPixelError, std::vector<uint>& Lods, MeshLodStats& Stats) const
+{
+    Lods.resize(m_Meshes.size());
+
+    for (uint i = 0 ; i < m_Meshes.size() ; i++) {
+        const BasicMeshEntry& Mesh = m_Meshes[i];
+
+        uint Lod = 0;
+
+        if ((Mesh.LodCount > 1) && Mesh.Bounds.IsValid()) {
+            // Same order as the world matrix in the render callbacks
+            Matrix4f World = ObjectMatrix * Mesh.Transformation * GlobalRotation;
+
+            Vector3f Center((Mesh.Bounds.MinX + Mesh.Bounds.MaxX) * 0.5f,
+                            (Mesh.Bounds.MinY + Mesh.Bounds.MaxY) * 0.5f,
+                            (Mesh.Bounds.MinZ + Mesh.Bounds.MaxZ) * 0.5f);
+
+            Vector3f Extent((Mesh.Bounds.MaxX - Mesh.Bounds.MinX) * 0.5f,
+                            (Mesh.Bounds.MaxY - Mesh.Bounds.MinY) * 0.5f,
+                            (Mesh.Bounds.MaxZ - Mesh.Bounds.MinZ) * 0.5f);
+
+            // The errors and the bounding sphere are scaled by the largest axis of the world matrix
+            float MaxScale = 0.0f;
+            float WorldCenter[3];
+
+            for (int c = 0 ; c < 3 ; c++) {
+                float AxisScale = sqrtf(World.m[0][c] * World.m[0][c] + World.m[1][c] * World.m[1][c] + World.m[2][c] * World.m[2][c]);
+                MaxScale = std::max(MaxScale, AxisScale);
+                WorldCenter[c] = World.m[c][0] * Center.x + World.m[c][1] * Center.y + World.m[c][2] * Center.z + World.m[c][3];
+            }
+
+            float Radius = Extent.Length() * MaxScale;
+
+            Vector3f ToCamera(WorldCenter[0] - CameraPos.x, WorldCenter[1] - CameraPos.y, WorldCenter[2] - CameraPos.z);
+
+            // Distance to the nearest point of the bounding sphere. LOD 0 is used inside it.
+            float Distance = ToCamera.Length() - Radius;
+
+            if (Distance > 0.0f) {
+                float PixelsPerUnit = ProjScale * MaxScale / Distance;
+
+                Lod = Mesh.LodCount - 1;
+
+                while ((Lod > 0) && (Mesh.LodErrors[Lod] * PixelsPerUnit > MaxPixelError)) {
+                    Lod--;
+                }
+            }
+        }
+
+        Lods[i] = Lod;
+
+        Stats.NumMeshes++;
+        Stats.NumSimplifiedMeshes += (Lod > 0) ? 1 : 0;
+        Stats.NumTrianglesFull += Mesh.NumIndices / 3;
+        Stats.NumTrianglesRendered += Mesh.GetLodIndicesCount(Lod) / 3;
+    }
+}
+
+
 bool CoreModel::IsAnimated() const
 {
     bool ret = m_numAnimations > 0;
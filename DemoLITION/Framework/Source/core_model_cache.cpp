@@ -0,0 +1,907 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+    Binary model cache
+
+    The first time a model is loaded we run the full Assimp import and (optionally)
+    meshoptimizer and then dump the result into '<model file>.cache'. On the next
+    launch the cache file is memory mapped and its content is fed directly into
+    PopulateBuffers/PopulateBuffersSkinned.
+
+    The cache is keyed by a hash of the source file and the Assimp load flags. If
+    either one changes (or the version/vertex layout below) the cache is ignored
+    and rewritten. Note that only the main model file is hashed so a glTF whose
+    external .bin file was modified must have its cache file deleted manually.
+
+    File layout (everything is little endian, no padding between fields):
+        ModelCacheHeader
+        Node hierarchy (pre-order)
+        Animations
+        Cameras
+        Lights
+        Mesh entries (including the LOD offsets and errors)
+        Bounding box
+        Bones
+        Indices
+        Vertices (Vertex or SkinnedVertex)
+        Materials + texture sources (embedded textures are stored inline)
+*/
+
+#include <type_traits>
+
+#include "Int/core_model.h"
+
+#define MODEL_CACHE_MAGIC   0x4D434C44      // 'DLCM'
+#define MODEL_CACHE_VERSION 3
+
+//#define DEBUG_MODEL_CACHE
+
+struct ModelCacheHeader {
+    u32 Magic = MODEL_CACHE_MAGIC;
+    u32 Version = MODEL_CACHE_VERSION;
+    u64 SourceHash = 0;
+    u64 SourceSize = 0;
+    u32 LoadFlags = 0;
+    u32 UseMeshOptimizer = 0;
+    u32 VertexSize = 0;
+    u32 SkinnedVertexSize = 0;
+    u32 IsSkinned = 0;
+    u32 UseMeshLods = 0;
+};
+
+
+// The smallest number of bytes that each element of the cache can take in the file (with
+// empty strings). Used to reject the corrupted counts before anything is allocated.
+#define MIN_NODE_SIZE       (sizeof(u32) + sizeof(aiMatrix4x4) + 2 * sizeof(u32))
+#define MIN_ANIMATION_SIZE  (sizeof(u32) + 2 * sizeof(double) + sizeof(u32))
+#define MIN_CHANNEL_SIZE    (6 * sizeof(u32))
+#define VECTOR_KEY_SIZE     (sizeof(double) + sizeof(aiVector3D))
+#define QUAT_KEY_SIZE       (sizeof(double) + sizeof(aiQuaternion))
+#define MIN_CAMERA_SIZE     (sizeof(u32) + 3 * sizeof(aiVector3D) + 4 * sizeof(float))
+#define MIN_LIGHT_SIZE      (2 * sizeof(u32) + 3 * sizeof(aiVector3D) + 14 * sizeof(float))
+#define MESH_ENTRY_SIZE     (7 * sizeof(u32) + sizeof(AABB) + sizeof(BasicMeshEntry::LodOffsets) + sizeof(BasicMeshEntry::LodErrors))
+#define MIN_BONE_SIZE       (sizeof(u32) + sizeof(Matrix4f))
+#define MIN_MATERIAL_SIZE   (3 * sizeof(u32) + 7 * sizeof(Vector4f) + 3 * sizeof(float))
+#define MIN_TEXTURE_SIZE    (5 * sizeof(u32))
+
+
+enum TEXTURE_SOURCE_KIND {
+    TEXTURE_SOURCE_NONE = 0,
+    TEXTURE_SOURCE_FILE = 1,
+    TEXTURE_SOURCE_EMBEDDED = 2
+};
+
+
+class ModelCacheWriter {
+
+public:
+
+    template<typename T>
+    void Write(const T& Val)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be written to the cache");
+        WriteBytes(&Val, sizeof(T));
+    }
+
+    void WriteBytes(const void* pData, size_t Size)
+    {
+        const char* p = (const char*)pData;
+        m_data.insert(m_data.end(), p, p + Size);
+    }
+
+    void WriteString(const std::string& Str)
+    {
+        Write((u32)Str.size());
+        WriteBytes(Str.data(), Str.size());
+    }
+
+    void WriteString(const aiString& Str)
+    {
+        Write((u32)Str.length);
+        WriteBytes(Str.data, Str.length);
+    }
+
+    std::vector<char> m_data;
+};
+
+
+class ModelCacheReader {
+
+public:
+
+    ModelCacheReader(const char* pData, size_t Size)
+    {
+        m_pCur = pData;
+        m_pEnd = pData + Size;
+    }
+
+    template<typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be read from the cache");
+
+        T Val = {};
+
+        const char* p = ReadBytes(sizeof(T));
+
+        if (p) {
+            memcpy(&Val, p, sizeof(T));
+        }
+
+        return Val;
+    }
+
+    // Returns a pointer into the mapped file or NULL if the file is truncated
+    const char* ReadBytes(size_t Size)
+    {
+        if (m_error || (Size > (size_t)(m_pEnd - m_pCur))) {
+            m_error = true;
+            return NULL;
+        }
+
+        const char* p = m_pCur;
+        m_pCur += Size;
+        return p;
+    }
+
+    std::string ReadString()
+    {
+        u32 Len = Read<u32>();
+
+        const char* p = ReadBytes(Len);
+
+        return p ? std::string(p, Len) : std::string();
+    }
+
+    void ReadString(aiString& Str)
+    {
+        std::string s = ReadString();
+        Str.Set(s);
+    }
+
+    bool IsValid() const { return !m_error; }
+
+    size_t Remaining() const { return m_error ? 0 : (size_t)(m_pEnd - m_pCur); }
+
+    // A corrupted count must fail the load and not turn into a huge allocation so the
+    // file must have room for Count elements of at least MinElementSize bytes each
+    bool CheckCount(u64 Count, size_t MinElementSize)
+    {
+        if (m_error || (Count > Remaining() / MinElementSize)) {
+            m_error = true;
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    const char* m_pCur = NULL;
+    const char* m_pEnd = NULL;
+    bool m_error = false;
+};
+
+
+std::string CoreModel::GetModelCacheFilename(const std::string& Filename)
+{
+    return Filename + ".cache";
+}
+
+
+static bool HashSourceFile(const std::string& Filename, u64& Hash, u64& Size)
+{
+    MemoryMappedFile SourceFile;
+
+    if (!SourceFile.Open(Filename.c_str())) {
+        return false;
+    }
+
+    Hash = HashBuffer(SourceFile.GetData(), SourceFile.GetSize());
+    Size = SourceFile.GetSize();
+
+    return true;
+}
+
+
+static void InitCacheHeader(ModelCacheHeader& Header, uint LoadFlags, bool MeshOptimizer, bool MeshLods)
+{
+    size_t VertexSize = 0;
+    size_t SkinnedVertexSize = 0;
+    CoreModel::GetVertexSizesInBytes(VertexSize, SkinnedVertexSize);
+
+    Header.LoadFlags = LoadFlags;
+    Header.UseMeshOptimizer = MeshOptimizer ? 1 : 0;
+    Header.UseMeshLods = MeshLods ? 1 : 0;
+    Header.VertexSize = (u32)VertexSize;
+    Header.SkinnedVertexSize = (u32)SkinnedVertexSize;
+}
+
+
+/////////////////////////////////////
+// Scene graph serialization
+/////////////////////////////////////
+
+static void WriteNode(ModelCacheWriter& Writer, const aiNode* pNode)
+{
+    Writer.WriteString(pNode->mName);
+    Writer.Write(pNode->mTransformation);
+
+    Writer.Write((u32)pNode->mNumMeshes);
+    Writer.WriteBytes(pNode->mMeshes, pNode->mNumMeshes * sizeof(unsigned int));
+
+    Writer.Write((u32)pNode->mNumChildren);
+
+    for (uint i = 0; i < pNode->mNumChildren; i++) {
+        WriteNode(Writer, pNode->mChildren[i]);
+    }
+}
+
+
+static aiNode* ReadNode(ModelCacheReader& Reader, aiNode* pParent)
+{
+    aiNode* pNode = new aiNode();
+    pNode->mParent = pParent;
+
+    Reader.ReadString(pNode->mName);
+    pNode->mTransformation = Reader.Read<aiMatrix4x4>();
+
+    u32 NumMeshes = Reader.Read<u32>();
+    const char* pMeshes = Reader.ReadBytes(NumMeshes * sizeof(unsigned int));
+
+    if (pMeshes && (NumMeshes > 0)) {
+        pNode->mNumMeshes = NumMeshes;
+        pNode->mMeshes = new unsigned int[NumMeshes];
+        memcpy(pNode->mMeshes, pMeshes, NumMeshes * sizeof(unsigned int));
+    }
+
+    u32 NumChildren = Reader.Read<u32>();
+
+    if (!Reader.CheckCount(NumChildren, MIN_NODE_SIZE)) {
+        return pNode;
+    }
+
+    if (NumChildren > 0) {
+        pNode->mChildren = new aiNode*[NumChildren];
+
+        for (u32 i = 0; i < NumChildren; i++) {
+            pNode->mChildren[i] = ReadNode(Reader, pNode);
+            pNode->mNumChildren++;
+
+            if (!Reader.IsValid()) {
+                break;
+            }
+        }
+    }
+
+    return pNode;
+}
+
+
+static void WriteAnimation(ModelCacheWriter& Writer, const aiAnimation* pAnimation)
+{
+    Writer.WriteString(pAnimation->mName);
+    Writer.Write(pAnimation->mDuration);
+    Writer.Write(pAnimation->mTicksPerSecond);
+    Writer.Write((u32)pAnimation->mNumChannels);
+
+    for (uint i = 0; i < pAnimation->mNumChannels; i++) {
+        const aiNodeAnim* pNodeAnim = pAnimation->mChannels[i];
+
+        Writer.WriteString(pNodeAnim->mNodeName);
+        Writer.Write((u32)pNodeAnim->mPreState);
+        Writer.Write((u32)pNodeAnim->mPostState);
+
+        Writer.Write((u32)pNodeAnim->mNumPositionKeys);
+
+        for (uint k = 0; k < pNodeAnim->mNumPositionKeys; k++) {
+            Writer.Write(pNodeAnim->mPositionKeys[k].mTime);
+            Writer.Write(pNodeAnim->mPositionKeys[k].mValue);
+        }
+
+        Writer.Write((u32)pNodeAnim->mNumRotationKeys);
+
+        for (uint k = 0; k < pNodeAnim->mNumRotationKeys; k++) {
+            Writer.Write(pNodeAnim->mRotationKeys[k].mTime);
+            Writer.Write(pNodeAnim->mRotationKeys[k].mValue);
+        }
+
+        Writer.Write((u32)pNodeAnim->mNumScalingKeys);
+
+        for (uint k = 0; k < pNodeAnim->mNumScalingKeys; k++) {
+            Writer.Write(pNodeAnim->mScalingKeys[k].mTime);
+            Writer.Write(pNodeAnim->mScalingKeys[k].mValue);
+        }
+    }
+}
+
+
+static aiAnimation* ReadAnimation(ModelCacheReader& Reader)
+{
+    aiAnimation* pAnimation = new aiAnimation();
+
+    Reader.ReadString(pAnimation->mName);
+    pAnimation->mDuration = Reader.Read<double>();
+    pAnimation->mTicksPerSecond = Reader.Read<double>();
+
+    u32 NumChannels = Reader.Read<u32>();
+
+    if (!Reader.CheckCount(NumChannels, MIN_CHANNEL_SIZE) || (NumChannels == 0)) {
+        return pAnimation;
+    }
+
+    pAnimation->mChannels = new aiNodeAnim*[NumChannels];
+
+    for (u32 i = 0; i < NumChannels; i++) {
+        aiNodeAnim* pNodeAnim = new aiNodeAnim();
+        pAnimation->mChannels[i] = pNodeAnim;
+        pAnimation->mNumChannels++;
+
+        Reader.ReadString(pNodeAnim->mNodeName);
+        pNodeAnim->mPreState = (aiAnimBehaviour)Reader.Read<u32>();
+        pNodeAnim->mPostState = (aiAnimBehaviour)Reader.Read<u32>();
+
+        pNodeAnim->mNumPositionKeys = Reader.Read<u32>();
+
+        if (!Reader.CheckCount(pNodeAnim->mNumPositionKeys, VECTOR_KEY_SIZE)) {
+            pNodeAnim->mNumPositionKeys = 0;
+            break;
+        }
+
+        pNodeAnim->mPositionKeys = new aiVectorKey[pNodeAnim->mNumPositionKeys];
+
+        for (uint k = 0; k < pNodeAnim->mNumPositionKeys; k++) {
+            pNodeAnim->mPositionKeys[k].mTime = Reader.Read<double>();
+            pNodeAnim->mPositionKeys[k].mValue = Reader.Read<aiVector3D>();
+        }
+
+        pNodeAnim->mNumRotationKeys = Reader.Read<u32>();
+
+        if (!Reader.CheckCount(pNodeAnim->mNumRotationKeys, QUAT_KEY_SIZE)) {
+            pNodeAnim->mNumRotationKeys = 0;
+            break;
+        }
+
+        pNodeAnim->mRotationKeys = new aiQuatKey[pNodeAnim->mNumRotationKeys];
+
+        for (uint k = 0; k < pNodeAnim->mNumRotationKeys; k++) {
+            pNodeAnim->mRotationKeys[k].mTime = Reader.Read<double>();
+            pNodeAnim->mRotationKeys[k].mValue = Reader.Read<aiQuaternion>();
+        }
+
+        pNodeAnim->mNumScalingKeys = Reader.Read<u32>();
+
+        if (!Reader.CheckCount(pNodeAnim->mNumScalingKeys, VECTOR_KEY_SIZE)) {
+            pNodeAnim->mNumScalingKeys = 0;
+            break;
+        }
+
+        pNodeAnim->mScalingKeys = new aiVectorKey[pNodeAnim->mNumScalingKeys];
+
+        for (uint k = 0; k < pNodeAnim->mNumScalingKeys; k++) {
+            pNodeAnim->mScalingKeys[k].mTime = Reader.Read<double>();
+            pNodeAnim->mScalingKeys[k].mValue = Reader.Read<aiVector3D>();
+        }
+    }
+
+    return pAnimation;
+}
+
+
+static void WriteCamera(ModelCacheWriter& Writer, const aiCamera* pCamera)
+{
+    Writer.WriteString(pCamera->mName);
+    Writer.Write(pCamera->mPosition);
+    Writer.Write(pCamera->mUp);
+    Writer.Write(pCamera->mLookAt);
+    Writer.Write(pCamera->mHorizontalFOV);
+    Writer.Write(pCamera->mClipPlaneNear);
+    Writer.Write(pCamera->mClipPlaneFar);
+    Writer.Write(pCamera->mAspect);
+}
+
+
+static aiCamera* ReadCamera(ModelCacheReader& Reader)
+{
+    aiCamera* pCamera = new aiCamera();
+
+    Reader.ReadString(pCamera->mName);
+    pCamera->mPosition = Reader.Read<aiVector3D>();
+    pCamera->mUp = Reader.Read<aiVector3D>();
+    pCamera->mLookAt = Reader.Read<aiVector3D>();
+    pCamera->mHorizontalFOV = Reader.Read<float>();
+    pCamera->mClipPlaneNear = Reader.Read<float>();
+    pCamera->mClipPlaneFar = Reader.Read<float>();
+    pCamera->mAspect = Reader.Read<float>();
+
+    return pCamera;
+}
+
+
+// aiColor3D is not trivially copyable
+static void WriteColor(ModelCacheWriter& Writer, const aiColor3D& Color)
+{
+    Writer.Write(Color.r);
+    Writer.Write(Color.g);
+    Writer.Write(Color.b);
+}
+
+
+static aiColor3D ReadColor(ModelCacheReader& Reader)
+{
+    aiColor3D Color;
+    Color.r = Reader.Read<float>();
+    Color.g = Reader.Read<float>();
+    Color.b = Reader.Read<float>();
+    return Color;
+}
+
+
+static void WriteLight(ModelCacheWriter& Writer, const aiLight* pLight)
+{
+    Writer.WriteString(pLight->mName);
+    Writer.Write((u32)pLight->mType);
+    Writer.Write(pLight->mPosition);
+    Writer.Write(pLight->mDirection);
+    Writer.Write(pLight->mUp);
+    Writer.Write(pLight->mAttenuationConstant);
+    Writer.Write(pLight->mAttenuationLinear);
+    Writer.Write(pLight->mAttenuationQuadratic);
+    WriteColor(Writer, pLight->mColorDiffuse);
+    WriteColor(Writer, pLight->mColorSpecular);
+    WriteColor(Writer, pLight->mColorAmbient);
+    Writer.Write(pLight->mAngleInnerCone);
+    Writer.Write(pLight->mAngleOuterCone);
+}
+
+
+static aiLight* ReadLight(ModelCacheReader& Reader)
+{
+    aiLight* pLight = new aiLight();
+
+    Reader.ReadString(pLight->mName);
+    pLight->mType = (aiLightSourceType)Reader.Read<u32>();
+    pLight->mPosition = Reader.Read<aiVector3D>();
+    pLight->mDirection = Reader.Read<aiVector3D>();
+    pLight->mUp = Reader.Read<aiVector3D>();
+    pLight->mAttenuationConstant = Reader.Read<float>();
+    pLight->mAttenuationLinear = Reader.Read<float>();
+    pLight->mAttenuationQuadratic = Reader.Read<float>();
+    pLight->mColorDiffuse = ReadColor(Reader);
+    pLight->mColorSpecular = ReadColor(Reader);
+    pLight->mColorAmbient = ReadColor(Reader);
+    pLight->mAngleInnerCone = Reader.Read<float>();
+    pLight->mAngleOuterCone = Reader.Read<float>();
+
+    return pLight;
+}
+
+
+// Allocates the array of pointers of a scene section (animations, cameras, lights)
+// and reads each element using the supplied function
+template<typename T>
+static void ReadSceneArray(ModelCacheReader& Reader, T**& pArray, unsigned int& Count, T* (*ReadFunc)(ModelCacheReader&),
+                           size_t MinElementSize)
+{
+    u32 NumElements = Reader.Read<u32>();
+
+    if (!Reader.CheckCount(NumElements, MinElementSize) || (NumElements == 0)) {
+        return;
+    }
+
+    pArray = new T*[NumElements];
+
+    for (u32 i = 0; i < NumElements; i++) {
+        pArray[i] = ReadFunc(Reader);
+        Count++;
+
+        if (!Reader.IsValid()) {
+            break;
+        }
+    }
+}
+
+
+/////////////////////////////////////
+// CoreModel interface
+/////////////////////////////////////
+
+void CoreModel::KeepVerticesForCache(const void* pVertices, size_t Size)
+{
+    const char* p = (const char*)pVertices;
+    m_cacheVertices.assign(p, p + Size);
+}
+
+
+// The cache is written to a temporary file which is then renamed over the old one so
+// a crash in the middle of the write never leaves a truncated cache behind
+static bool WriteCacheFile(const std::string& CacheFilename, const std::vector<char>& Data)
+{
+    std::string TempFilename = CacheFilename + ".tmp";
+
+#ifdef _WIN64
+    FILE* f = NULL;
+    fopen_s(&f, TempFilename.c_str(), "wb");
+#else
+    FILE* f = fopen(TempFilename.c_str(), "wb");
+#endif
+
+    if (!f) {
+        printf("Warning! cannot open '%s' for writing, the model cache will not be written\n", TempFilename.c_str());
+        return false;
+    }
+
+    size_t BytesWritten = fwrite(Data.data(), 1, Data.size(), f);
+
+    bool Ok = (BytesWritten == Data.size());
+
+    if (fclose(f) != 0) {
+        Ok = false;
+    }
+
+    if (!Ok) {
+        printf("Warning! error writing the model cache '%s'\n", TempFilename.c_str());
+        remove(TempFilename.c_str());
+        return false;
+    }
+
+#ifdef _WIN64
+    // rename() doesn't replace an existing file on Windows
+    remove(CacheFilename.c_str());
+#endif
+
+    if (rename(TempFilename.c_str(), CacheFilename.c_str()) != 0) {
+        printf("Warning! cannot rename '%s' to '%s'\n", TempFilename.c_str(), CacheFilename.c_str());
+        remove(TempFilename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+void CoreModel::SaveModelCache(const std::string& Filename, uint LoadFlags, bool MeshOptimizer, bool MeshLods)
+{
+    ModelCacheHeader Header;
+    InitCacheHeader(Header, LoadFlags, MeshOptimizer, MeshLods);
+    Header.IsSkinned = (m_pScene->mNumAnimations > 0) ? 1 : 0;
+
+    ModelCacheWriter Writer;
+
+    Writer.Write(Header);
+
+    // Scene graph
+    WriteNode(Writer, m_pScene->mRootNode);
+
+    Writer.Write((u32)m_pScene->mNumAnimations);
+    for (uint i = 0; i < m_pScene->mNumAnimations; i++) {
+        WriteAnimation(Writer, m_pScene->mAnimations[i]);
+    }
+
+    Writer.Write((u32)m_pScene->mNumCameras);
+    for (uint i = 0; i < m_pScene->mNumCameras; i++) {
+        WriteCamera(Writer, m_pScene->mCameras[i]);
+    }
+
+    Writer.Write((u32)m_pScene->mNumLights);
+    for (uint i = 0; i < m_pScene->mNumLights; i++) {
+        WriteLight(Writer, m_pScene->mLights[i]);
+    }
+
+    // Geometry
+    Writer.Write((u32)m_Meshes.size());
+
+    for (const BasicMeshEntry& Mesh : m_Meshes) {
+        Writer.Write(Mesh.NumIndices);
+        Writer.Write(Mesh.NumVertices);
+        Writer.Write(Mesh.BaseVertex);
+        Writer.Write(Mesh.BaseIndex);
+        Writer.Write(Mesh.ValidFaces);
+        Writer.Write(Mesh.MaterialIndex);
+        Writer.Write(Mesh.Bounds);
+        Writer.Write(Mesh.LodCount);
+        Writer.WriteBytes(Mesh.LodOffsets, sizeof(Mesh.LodOffsets));
+        Writer.WriteBytes(Mesh.LodErrors, sizeof(Mesh.LodErrors));
+    }
+
+    Writer.Write(m_minPos);
+    Writer.Write(m_maxPos);
+
+    // The bone map is sorted by name so we store the names according to the bone index
+    std::vector<std::string> BoneNames(m_BoneInfo.size());
+
+    for (const auto& it : m_BoneNameToIndexMap) {
+        BoneNames[it.second] = it.first;
+    }
+
+    Writer.Write((u32)m_BoneInfo.size());
+
+    for (uint i = 0; i < m_BoneInfo.size(); i++) {
+        Writer.WriteString(BoneNames[i]);
+        Writer.Write(m_BoneInfo[i].OffsetMatrix);
+    }
+
+    Writer.Write((u64)m_Indices.size());
+    Writer.WriteBytes(m_Indices.data(), m_Indices.size() * sizeof(uint));
+
+    Writer.Write((u64)m_cacheVertices.size());
+    Writer.WriteBytes(m_cacheVertices.data(), m_cacheVertices.size());
+
+    // Materials
+    Writer.Write((u32)m_Materials.size());
+
+    for (const CoreMaterial& Material : m_Materials) {
+        Writer.WriteString(Material.m_name);
+        Writer.Write((u32)Material.m_isPBR);
+        Writer.Write(Material.m_materialType);
+        Writer.Write(Material.AmbientColor);
+        Writer.Write(Material.DiffuseColor);
+        Writer.Write(Material.SpecularColor);
+        Writer.Write(Material.BaseColor);
+        Writer.Write(Material.EmissiveColor);
+        Writer.Write(Material.MetallicRoughnessNormalOcclusion);
+        Writer.Write(Material.ClearCoatTransmissionThickness);
+        Writer.Write(Material.m_transparencyFactor);
+        Writer.Write(Material.m_alphaTest);
+        Writer.Write(Material.m_ior);
+    }
+
+    Writer.Write((u32)m_textureSources.size());
+
+    for (const TextureSource& Source : m_textureSources) {
+        Writer.Write((u32)Source.MaterialIndex);
+        Writer.Write((u32)Source.Type);
+        Writer.Write((u32)Source.IsSRGB);
+
+        if (Source.pEmbeddedData) {
+            Writer.Write((u32)TEXTURE_SOURCE_EMBEDDED);
+            Writer.Write(Source.EmbeddedSize);
+            Writer.WriteBytes(Source.pEmbeddedData, Source.EmbeddedSize);
+        } else {
+            Writer.Write((u32)TEXTURE_SOURCE_FILE);
+            Writer.WriteString(Source.FullPath);
+        }
+    }
+
+    // Everything we need is in the writer now
+    m_cacheVertices.clear();
+    m_cacheVertices.shrink_to_fit();
+    m_textureSources.clear();
+
+    if (!HashSourceFile(Filename, Header.SourceHash, Header.SourceSize)) {
+        printf("Warning! cannot hash '%s', the model cache will not be written\n", Filename.c_str());
+        return;
+    }
+
+    // Patch the header now that we have the hash
+    memcpy(Writer.m_data.data(), &Header, sizeof(Header));
+
+    std::string CacheFilename = GetModelCacheFilename(Filename);
+
+    if (WriteCacheFile(CacheFilename, Writer.m_data)) {
+        printf("Model cache '%s' written (%zu bytes)\n", CacheFilename.c_str(), Writer.m_data.size());
+    }
+}
+
+
+bool CoreModel::LoadModelCache(const std::string& Filename, uint LoadFlags, bool MeshOptimizer, bool MeshLods)
+{
+    std::string CacheFilename = GetModelCacheFilename(Filename);
+
+    MemoryMappedFile CacheFile;
+
+    if (!CacheFile.Open(CacheFilename.c_str())) {
+        return false;
+    }
+
+    ModelCacheReader Reader(CacheFile.GetData(), CacheFile.GetSize());
+
+    ModelCacheHeader Header = Reader.Read<ModelCacheHeader>();
+
+    ModelCacheHeader Expected;
+    InitCacheHeader(Expected, LoadFlags, MeshOptimizer, MeshLods);
+
+    if (!Reader.IsValid() ||
+        (Header.Magic != Expected.Magic) ||
+        (Header.Version != Expected.Version) ||
+        (Header.LoadFlags != Expected.LoadFlags) ||
+        (Header.UseMeshOptimizer != Expected.UseMeshOptimizer) ||
+        (Header.UseMeshLods != Expected.UseMeshLods) ||
+        (Header.VertexSize != Expected.VertexSize) ||
+        (Header.SkinnedVertexSize != Expected.SkinnedVertexSize)) {
+        printf("Model cache '%s' is out of date\n", CacheFilename.c_str());
+        return false;
+    }
+
+    u64 SourceHash = 0;
+    u64 SourceSize = 0;
+
+    if (!HashSourceFile(Filename, SourceHash, SourceSize) ||
+        (SourceHash != Header.SourceHash) || (SourceSize != Header.SourceSize)) {
+        printf("Model cache '%s' does not match the source file\n", CacheFilename.c_str());
+        return false;
+    }
+
+    // Scene graph
+    std::unique_ptr<aiScene> pScene(new aiScene());
+
+    pScene->mRootNode = ReadNode(Reader, NULL);
+    ReadSceneArray<aiAnimation>(Reader, pScene->mAnimations, pScene->mNumAnimations, ReadAnimation, MIN_ANIMATION_SIZE);
+    ReadSceneArray<aiCamera>(Reader, pScene->mCameras, pScene->mNumCameras, ReadCamera, MIN_CAMERA_SIZE);
+    ReadSceneArray<aiLight>(Reader, pScene->mLights, pScene->mNumLights, ReadLight, MIN_LIGHT_SIZE);
+
+    // Geometry
+    u32 NumMeshes = Reader.Read<u32>();
+
+    std::vector<BasicMeshEntry> Meshes(Reader.CheckCount(NumMeshes, MESH_ENTRY_SIZE) ? NumMeshes : 0);
+
+    for (BasicMeshEntry& Mesh : Meshes) {
+        Mesh.NumIndices = Reader.Read<uint>();
+        Mesh.NumVertices = Reader.Read<uint>();
+        Mesh.BaseVertex = Reader.Read<uint>();
+        Mesh.BaseIndex = Reader.Read<uint>();
+        Mesh.ValidFaces = Reader.Read<uint>();
+        Mesh.MaterialIndex = Reader.Read<int>();
+        Mesh.Bounds = Reader.Read<AABB>();
+        Mesh.LodCount = Reader.Read<uint>();
+
+        const char* pLodOffsets = Reader.ReadBytes(sizeof(Mesh.LodOffsets));
+        const char* pLodErrors = Reader.ReadBytes(sizeof(Mesh.LodErrors));
+
+        if (pLodOffsets && pLodErrors) {
+            memcpy(Mesh.LodOffsets, pLodOffsets, sizeof(Mesh.LodOffsets));
+            memcpy(Mesh.LodErrors, pLodErrors, sizeof(Mesh.LodErrors));
+        }
+    }
+
+    Vector3f MinPos = Reader.Read<Vector3f>();
+    Vector3f MaxPos = Reader.Read<Vector3f>();
+
+    u32 NumBones = Reader.Read<u32>();
+
+    std::vector<std::string> BoneNames(Reader.CheckCount(NumBones, MIN_BONE_SIZE) ? NumBones : 0);
+    std::vector<Matrix4f> BoneOffsets(BoneNames.size());
+
+    for (uint i = 0; i < BoneNames.size(); i++) {
+        BoneNames[i] = Reader.ReadString();
+        BoneOffsets[i] = Reader.Read<Matrix4f>();
+    }
+
+    u64 NumIndices = Reader.Read<u64>();
+    const char* pIndices = Reader.CheckCount(NumIndices, sizeof(uint)) ? Reader.ReadBytes(NumIndices * sizeof(uint)) : NULL;
+
+    u64 VertexDataSize = Reader.Read<u64>();
+    const char* pVertices = Reader.ReadBytes(VertexDataSize);
+
+    // Materials
+    u32 NumMaterials = Reader.Read<u32>();
+
+    std::vector<CoreMaterial> Materials(Reader.CheckCount(NumMaterials, MIN_MATERIAL_SIZE) ? NumMaterials : 0);
+
+    for (CoreMaterial& Material : Materials) {
+        Material.m_name = Reader.ReadString();
+        Material.m_isPBR = Reader.Read<u32>() != 0;
+        Material.m_materialType = Reader.Read<int>();
+        Material.AmbientColor = Reader.Read<Vector4f>();
+        Material.DiffuseColor = Reader.Read<Vector4f>();
+        Material.SpecularColor = Reader.Read<Vector4f>();
+        Material.BaseColor = Reader.Read<Vector4f>();
+        Material.EmissiveColor = Reader.Read<Vector4f>();
+        Material.MetallicRoughnessNormalOcclusion = Reader.Read<Vector4f>();
+        Material.ClearCoatTransmissionThickness = Reader.Read<Vector4f>();
+        Material.m_transparencyFactor = Reader.Read<float>();
+        Material.m_alphaTest = Reader.Read<float>();
+        Material.m_ior = Reader.Read<float>();
+    }
+
+    // The embedded data points into the mapping which stays open until the textures are uploaded
+    u32 NumTextures = Reader.Read<u32>();
+
+    std::vector<TextureSource> TextureSources(Reader.CheckCount(NumTextures, MIN_TEXTURE_SIZE) ? NumTextures : 0);
+
+    for (TextureSource& Source : TextureSources) {
+        Source.MaterialIndex = (int)Reader.Read<u32>();
+        Source.Type = (TEXTURE_TYPE)Reader.Read<u32>();
+        Source.IsSRGB = Reader.Read<u32>() != 0;
+        u32 Kind = Reader.Read<u32>();
+
+        if (!Reader.IsValid()) {
+            break;
+        }
+
+        if (((u32)Source.MaterialIndex >= Materials.size()) || ((u32)Source.Type >= TEX_TYPE_NUM) ||
+            ((Kind != TEXTURE_SOURCE_EMBEDDED) && (Kind != TEXTURE_SOURCE_FILE))) {
+            printf("Invalid texture source in the model cache '%s'\n", CacheFilename.c_str());
+            return false;
+        }
+
+        if (Kind == TEXTURE_SOURCE_EMBEDDED) {
+            Source.EmbeddedSize = Reader.Read<u32>();
+            Source.pEmbeddedData = Reader.ReadBytes(Source.EmbeddedSize);
+        } else {
+            Source.FullPath = Reader.ReadString();
+        }
+    }
+
+    if (!Reader.IsValid()) {
+        printf("Model cache '%s' is corrupted\n", CacheFilename.c_str());
+        return false;
+    }
+
+    // Up to here nothing was changed in the model so we could still fall back to Assimp
+    m_pCachedScene = std::move(pScene);
+    m_pScene = m_pCachedScene.get();
+
+    m_GlobalInverseTransform = m_pScene->mRootNode->mTransformation;
+    m_GlobalInverseTransform = m_GlobalInverseTransform.Inverse();
+
+    m_numAnimations = m_pScene->mNumAnimations;
+    m_Meshes = Meshes;
+    m_minPos = MinPos;
+    m_maxPos = MaxPos;
+
+    InitializeRequiredNodeMap(m_pScene->mRootNode);
+
+    for (uint i = 0; i < BoneNames.size(); i++) {
+        m_BoneNameToIndexMap[BoneNames[i]] = i;
+        m_BoneInfo.push_back(BoneInfo(BoneOffsets[i]));
+        MarkRequiredNodesForBone(BoneNames[i]);
+    }
+
+    m_Indices.resize(NumIndices);
+    memcpy(m_Indices.data(), pIndices, NumIndices * sizeof(uint));
+
+    if (Header.IsSkinned) {
+        std::vector<SkinnedVertex> Vertices(VertexDataSize / sizeof(SkinnedVertex));
+        memcpy(Vertices.data(), pVertices, Vertices.size() * sizeof(SkinnedVertex));
+        PopulateBuffersSkinned(Vertices);
+    } else {
+        std::vector<Vertex> Vertices(VertexDataSize / sizeof(Vertex));
+        memcpy(Vertices.data(), pVertices, Vertices.size() * sizeof(Vertex));
+        PopulateBuffers(Vertices);
+    }
+
+    m_Materials = std::move(Materials);
+
+    for (const TextureSource& Source : TextureSources) {
+        if (Source.pEmbeddedData) {
+            LoadTextureEmbedded(Source.EmbeddedSize, Source.pEmbeddedData, Source.MaterialIndex, Source.Type, Source.IsSRGB);
+        } else {
+            LoadTextureFromFile(Source.FullPath, Source.MaterialIndex, Source.Type, Source.IsSRGB);
+        }
+    }
+
+    DecodeAndUploadTextures();
+
+    // The embedded texture pointers reference the mapping which is going away
+    m_textureSources.clear();
+
+#ifdef DEBUG_MODEL_CACHE
+    printf("Model cache: %d meshes, %d materials, %d bones, %d animations\n",
+           (int)m_Meshes.size(), (int)m_Materials.size(), (int)m_BoneInfo.size(), m_numAnimations);
+#endif
+
+    CalculateMeshTransformations(m_pScene);
+
+    InitGeometryPost();
+
+    InitCameras(m_pScene);
+
+    InitLights(m_pScene);
+
+    return true;
+}
@@ -0,0 +1,164 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Int/core_render_list_culler.h"
+
+
+void RenderListCuller::UpdateBounds(const std::list<CoreSceneObject*>& RenderList, 
+                                    const Matrix4f& GlobalRotation,
+                                    bool (*pIsCulledElsewhere)(const CoreSceneObject*))
+{
+    m_objects.resize(RenderList.size());
+
+    int i = 0;
+
+    for (std::list<CoreSceneObject*>::const_iterator it = RenderList.begin(); it != RenderList.end(); it++) {
+        ObjectBounds& Object = m_objects[i];
+
+        Object.pObject = *it;
+
+        if (pIsCulledElsewhere && pIsCulledElsewhere(Object.pObject)) {
+            Object.HasBounds = false;
+        } else {
+            Object.HasBounds = Object.pObject->GetModel()->CalcWorldBounds(Object.pObject->GetMatrix(), GlobalRotation, Object.Bounds);
+        }
+
+        i++;
+    }
+}
+
+
+// Distance from a point to the closest point of the box (zero if the point is inside)
+static float DistanceToAABB(const Vector3f& p, const AABB& Box)
+{
+    float dx = std::max(std::max(Box.MinX - p.x, 0.0f), p.x - Box.MaxX);
+    float dy = std::max(std::max(Box.MinY - p.y, 0.0f), p.y - Box.MaxY);
+    float dz = std::max(std::max(Box.MinZ - p.z, 0.0f), p.z - Box.MaxZ);
+
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+
+void RenderListCuller::Cull(const Matrix4f& ViewProj,
+                            const Vector3f& DistanceOrigin,
+                            float MaxDistance,
+                            std::vector<CoreSceneObject*>& VisibleObjects,
+                            CullingStats& Stats) const
+{
+    VisibleObjects.clear();
+
+    FrustumCulling Frustum(ViewProj);
+
+    for (const ObjectBounds& Object : m_objects) {
+        if (Object.HasBounds) {
+            if ((MaxDistance > 0.0f) && (DistanceToAABB(DistanceOrigin, Object.Bounds) > MaxDistance)) {
+                Stats.NumDistanceCulled++;
+                continue;
+            }
+
+            if (!Frustum.IsAABBInsideViewFrustum(Object.Bounds)) {
+                Stats.NumFrustumCulled++;
+                continue;
+            }
+        }
+
+        VisibleObjects.push_back(Object.pObject);
+    }
+
+    Stats.NumViews++;
+    Stats.NumTested += (int)m_objects.size();
+    Stats.NumSubmitted += (int)VisibleObjects.size();
+}
+
+
+void RenderListCuller::CullCube(const Matrix4f* pFaceVPs,
+                                std::vector<CoreSceneObject*>& VisibleObjects,
+                                std::vector<uint>& FaceMasks,
+                                CullingStats& Stats) const
+{
+    VisibleObjects.clear();
+    FaceMasks.clear();
+
+    std::vector<FrustumCulling> Frustums;
+    Frustums.reserve(NUM_CUBE_MAP_FACES);
+
+    for (int i = 0; i < NUM_CUBE_MAP_FACES; i++) {
+        Frustums.push_back(FrustumCulling(pFaceVPs[i]));
+    }
+
+    uint AllFaces = (1 << NUM_CUBE_MAP_FACES) - 1;
+
+    for (const ObjectBounds& Object : m_objects) {
+        uint FaceMask = AllFaces;
+        int NumFaces = NUM_CUBE_MAP_FACES;
+
+        if (Object.HasBounds) {
+            FaceMask = 0;
+            NumFaces = 0;
+
+            for (int i = 0; i < NUM_CUBE_MAP_FACES; i++) {
+                if (Frustums[i].IsAABBInsideViewFrustum(Object.Bounds)) {
+                    FaceMask |= (1 << i);
+                    NumFaces++;
+                } else {
+                    Stats.NumFrustumCulled++;
+                }
+            }
+        }
+
+        if (FaceMask != 0) {
+            VisibleObjects.push_back(Object.pObject);
+            FaceMasks.push_back(FaceMask);
+            Stats.NumSubmitted += NumFaces;
+        }
+    }
+
+    Stats.NumViews += NUM_CUBE_MAP_FACES;
+    Stats.NumTested += (int)m_objects.size() * NUM_CUBE_MAP_FACES;
+}
+
+
+void RenderListCuller::GetAllObjects(std::vector<CoreSceneObject*>& Objects, CullingStats& Stats) const
+{
+    Objects.resize(m_objects.size());
+
+    for (int i = 0; i < (int)m_objects.size(); i++) {
+        Objects[i] = m_objects[i].pObject;
+    }
+
+    Stats.NumViews++;
+    Stats.NumTested += (int)m_objects.size();
+    Stats.NumSubmitted += (int)Objects.size();
+}
+
+
+bool RenderListCuller::GetSceneBounds(AABB& Bounds) const
+{
+    Bounds = AABB();
+
+    for (const ObjectBounds& o : m_objects) {
+        if (!o.HasBounds) {
+            return false;
+        }
+
+        Bounds.Add(Vector3f(o.Bounds.MinX, o.Bounds.MinY, o.Bounds.MinZ));
+        Bounds.Add(Vector3f(o.Bounds.MaxX, o.Bounds.MaxY, o.Bounds.MaxZ));
+    }
+
+    return Bounds.IsValid();
+}
@@ -355,6 +355,8 @@ void CoreScene::StartSceneGUI(const char* pTitle)
     HDRAndToneMappingGUI();
 
     TerrainGUI();
+
+    CullingGUI();
 }
 
 
@@ -463,10 +465,37 @@ void CoreScene::GeneralGUI()
         ImGui::RadioButton("Normals", (int*)&RenderMode, RENDER_MODE_NORMALS);
         m_config.SetRenderMode(RenderMode);
 
+        const RenderPassTimes& Times = m_config.GetRenderPassTimes();
+        ImGui::Text("GPU time: shadow pass %.3f ms, lighting pass %.3f ms", Times.ShadowPassMs, Times.LightingPassMs);
+
+        ImGui::TreePop();
+    }
+}
+
+void CoreScene::CullingGUI()
+{
+    if (ImGui::TreeNode("Culling")) {
+        bool EnableCulling = m_config.IsCullingEnabled();
+        ImGui::Checkbox("Enable Culling", &EnableCulling);
+        m_config.ControlCulling(EnableCulling);
+
+        float MaxDrawDistance = m_config.GetMaxDrawDistance();
+        ImGui::SliderFloat("Max Draw Distance (0 = none)", &MaxDrawDistance, 0.0f, 5000.0f);
+        m_config.SetMaxDrawDistance(MaxDrawDistance);
+
+        const CullingStats& Camera = m_config.GetCameraCullingStats();
+        ImGui::Text("Camera: submitted %d of %d (frustum culled %d, distance culled %d)",
+                    Camera.NumSubmitted, Camera.NumTested, Camera.NumFrustumCulled, Camera.NumDistanceCulled);
+
+        const CullingStats& Shadow = m_config.GetShadowCullingStats();
+        ImGui::Text("Shadows: %d views, submitted %d of %d (frustum culled %d, distance culled %d)",
+                    Shadow.NumViews, Shadow.NumSubmitted, Shadow.NumTested, Shadow.NumFrustumCulled, Shadow.NumDistanceCulled);
+
         ImGui::TreePop();
     }
 }
 
+
 void CoreScene::HDRAndToneMappingGUI()
 {
     if (ImGui::TreeNode("HDR & Tone Mapping")) {
@@ -0,0 +1,199 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <math.h>
+#include <algorithm>
+
+#include "Int/core_shadow_cascades.h"
+
+// How far the near plane of the light is moved back when the casters are unknown
+#define SHADOW_CASCADE_CASTER_DISTANCE 100.0f
+
+
+void ShadowCascades::Init(int NumCascades, int ShadowMapSize)
+{
+    if ((NumCascades < 1) || (NumCascades > MAX_SHADOW_CASCADES)) {
+        printf("%s:%d - invalid number of shadow cascades %d\n", __FILE__, __LINE__, NumCascades);
+        exit(1);
+    }
+
+    m_numCascades = NumCascades;
+    m_shadowMapSize = ShadowMapSize;
+
+    for (int i = 0; i < MAX_SHADOW_CASCADES; i++) {
+        m_cascades[i] = Cascade();
+        m_cascades[i].UpdateInterval = (i < 2) ? 1 : (1 << (i - 1));
+    }
+}
+
+
+void ShadowCascades::SetUpdateInterval(int CascadeIndex, int NumFrames)
+{
+    m_cascades[CascadeIndex].UpdateInterval = std::max(NumFrames, 1);
+}
+
+
+void ShadowCascades::CalcSplits(float zNear, float zFar, int NumCascades, float Lambda, float* pSplits)
+{
+    for (int i = 0; i <= NumCascades; i++) {
+        float f = (float)i / (float)NumCascades;
+        float Log = zNear * powf(zFar / zNear, f);
+        float Uniform = zNear + (zFar - zNear) * f;
+        pSplits[i] = Lambda * Log + (1.0f - Lambda) * Uniform;
+    }
+
+    // No rounding errors at the ends
+    pSplits[0] = zNear;
+    pSplits[NumCascades] = zFar;
+}
+
+
+bool ShadowCascades::NeedsUpdate(int CascadeIndex, int Frame, float SplitNear, float SplitFar, const Vector3f& LightDir) const
+{
+    const Cascade& c = m_cascades[CascadeIndex];
+
+    if ((c.LastUpdateFrame < 0) || (c.SplitNear != SplitNear) || (c.SplitFar != SplitFar) ||
+        (c.LightDir.x != LightDir.x) || (c.LightDir.y != LightDir.y) || (c.LightDir.z != LightDir.z)) {
+        return true;
+    }
+
+    // Safety net in case the frame counter jumped
+    if (Frame - c.LastUpdateFrame >= 2 * c.UpdateInterval) {
+        return true;
+    }
+
+    return ((Frame + CascadeIndex) % c.UpdateInterval) == 0;
+}
+
+
+void ShadowCascades::Update(int CascadeIndex,
+                            int Frame,
+                            const Matrix4f& CameraView,
+                            const Matrix4f& CameraProjection,
+                            float zNear,
+                            float zFar,
+                            float SplitNear,
+                            float SplitFar,
+                            const Vector3f& LightDir,
+                            const AABB* pCasterBounds)
+{
+    Cascade& c = m_cascades[CascadeIndex];
+
+    //
+    // Step #1: the corners of the slice in view space. The depth changes linearly
+    // along the edges of the frustum between the near and the far corners.
+    // The view space shape of the slice doesn't depend on the camera position and
+    // orientation so its size doesn't change from frame to frame.
+    //
+    Matrix4f InverseProjection = CameraProjection.Inverse();
+
+    float NearT = (SplitNear - zNear) / (zFar - zNear);
+    float FarT = (SplitFar - zNear) / (zFar - zNear);
+
+    Vector3f ViewCorners[8];
+
+    for (int i = 0; i < 4; i++) {
+        float x = (i & 1) ? 1.0f : -1.0f;
+        float y = (i & 2) ? 1.0f : -1.0f;
+
+        Vector4f Near = InverseProjection * Vector4f(x, y, -1.0f, 1.0f);
+        Vector4f Far = InverseProjection * Vector4f(x, y, 1.0f, 1.0f);
+
+        Vector3f Near3 = Vector3f(Near.x, Near.y, Near.z) / Near.w;
+        Vector3f Far3 = Vector3f(Far.x, Far.y, Far.z) / Far.w;
+
+        ViewCorners[i] = Near3 + (Far3 - Near3) * NearT;
+        ViewCorners[i + 4] = Near3 + (Far3 - Near3) * FarT;
+    }
+
+    //
+    // Step #2: the size of the projection is the diameter of the slice so that it
+    // contains the slice in any orientation. Two texels are added for the snapping.
+    //
+    float Diameter = 0.0f;
+
+    for (int i = 0; i < 8; i++) {
+        for (int j = i + 1; j < 8; j++) {
+            Diameter = std::max(Diameter, (ViewCorners[i] - ViewCorners[j]).Length());
+        }
+    }
+
+    c.TexelSize = Diameter / (float)(m_shadowMapSize - 2);
+
+    Matrix4f InverseView = CameraView.Inverse();
+
+    Vector3f Corners[8];
+
+    for (int i = 0; i < 8; i++) {
+        Vector4f p = InverseView * Vector4f(ViewCorners[i], 1.0f);
+        Corners[i] = Vector3f(p.x, p.y, p.z);
+    }
+
+    //
+    // Step #3: transform the slice to light space and calculate its box
+    //
+    Vector3f Origin(0.0f, 0.0f, 0.0f);
+    Vector3f Up = (fabsf(LightDir.y) > 0.99f * LightDir.Length()) ? Vector3f(0.0f, 0.0f, 1.0f) : Vector3f(0.0f, 1.0f, 0.0f);
+    c.LightView.InitCameraTransform(Origin, LightDir, Up);
+
+    AABB SliceBox;
+
+    for (int i = 0; i < 8; i++) {
+        Vector4f p = c.LightView * Vector4f(Corners[i], 1.0f);
+        SliceBox.Add(Vector3f(p.x, p.y, p.z));
+    }
+
+    //
+    // Step #4: snap the center to the texels of the shadow map
+    //
+    float CenterX = floorf((SliceBox.MinX + SliceBox.MaxX) * 0.5f / c.TexelSize) * c.TexelSize;
+    float CenterY = floorf((SliceBox.MinY + SliceBox.MaxY) * 0.5f / c.TexelSize) * c.TexelSize;
+    float HalfSize = c.TexelSize * (float)m_shadowMapSize * 0.5f;
+
+    //
+    // Step #5: the casters between the light and the slice must be inside the projection
+    //
+    float MinZ = SliceBox.MinZ - SHADOW_CASCADE_CASTER_DISTANCE;
+
+    if (pCasterBounds && pCasterBounds->IsValid()) {
+        MinZ = SliceBox.MinZ;
+
+        for (int i = 0; i < 8; i++) {
+            Vector3f p((i & 1) ? pCasterBounds->MaxX : pCasterBounds->MinX,
+                       (i & 2) ? pCasterBounds->MaxY : pCasterBounds->MinY,
+                       (i & 4) ? pCasterBounds->MaxZ : pCasterBounds->MinZ);
+            Vector4f LightSpace = c.LightView * Vector4f(p, 1.0f);
+            MinZ = std::min(MinZ, LightSpace.z);
+        }
+    }
+
+    OrthoProjInfo OrthoInfo;
+    OrthoInfo.l = CenterX - HalfSize;
+    OrthoInfo.r = CenterX + HalfSize;
+    OrthoInfo.b = CenterY - HalfSize;
+    OrthoInfo.t = CenterY + HalfSize;
+    OrthoInfo.n = MinZ;
+    OrthoInfo.f = SliceBox.MaxZ;
+    c.LightProjection.InitOrthoProjTransform(OrthoInfo);
+
+    c.LightVP = c.LightProjection * c.LightView;
+    c.SplitNear = SplitNear;
+    c.SplitFar = SplitFar;
+    c.LightDir = LightDir;
+    c.LastUpdateFrame = Frame;
+}
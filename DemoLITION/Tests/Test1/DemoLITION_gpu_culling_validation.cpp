@@ -0,0 +1,254 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - GPU Culling Validation
+
+    Doesn't depend on the rendering system so that it can also run from a
+    standalone harness (see Sandbox/GPUCullingTest).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "GL/gl_gpu_culling.h"
+#include "DemoLITION_gpu_culling_validation.h"
+
+#define NUM_DRAWS 20000
+#define NUM_VIEWS 10
+
+#define VIEWPORT_WIDTH  1000
+#define VIEWPORT_HEIGHT 1000
+
+// Draws this close to one of the planes may go either way due to floating point differences
+#define BORDERLINE_TOLERANCE 0.001f
+
+
+class GPUCullingValidation
+{
+public:
+
+    GPUCullingValidation()
+    {
+        m_gpuCulling.Init();
+
+        InitDraws();
+        InitBuffer();
+    }
+
+
+    ~GPUCullingValidation()
+    {
+        glDeleteBuffers(1, &m_buffer);
+    }
+
+
+    bool Run()
+    {
+        int TotalVisible = 0;
+        int TotalBorderline = 0;
+
+        for (int i = 0; i < NUM_VIEWS; i++) {
+            Matrix4f VP = CreateViewProj(i);
+
+            m_gpuCulling.Cull(VP, m_buffer, m_dataOffset, m_cmdsOffset, m_boundsOffset, NUM_DRAWS);
+
+            std::vector<IndirectRender::DrawElementsIndirectCommand> Cmds;
+            std::vector<IndirectRender::PerObjectData> Data;
+            m_gpuCulling.ReadVisibleDraws(Cmds, Data);
+
+            std::vector<int> Visible, Borderline;
+            GPUCulling::CullReference(VP, m_data.data(), m_bounds.data(), NUM_DRAWS, BORDERLINE_TOLERANCE, Visible, Borderline);
+
+            if (!Validate(i, Cmds, Data, Visible, Borderline)) {
+                return false;
+            }
+
+            printf("View %d: %d visible draws (reference %d, borderline %d)\n", i, (int)Cmds.size(), (int)Visible.size(), (int)Borderline.size());
+
+            TotalVisible += (int)Cmds.size();
+            TotalBorderline += (int)Borderline.size();
+        }
+
+        printf("The GPU culling matches the reference - %d draws, %d views, %d visible, %d borderline\n",
+               NUM_DRAWS, NUM_VIEWS, TotalVisible, TotalBorderline);
+
+        return true;
+    }
+
+private:
+
+    void InitDraws()
+    {
+        m_cmds.resize(NUM_DRAWS);
+        m_data.resize(NUM_DRAWS);
+        m_bounds.resize(NUM_DRAWS);
+
+        srand(0);
+
+        for (int i = 0; i < NUM_DRAWS; i++) {
+            IndirectRender::DrawElementsIndirectCommand& Cmd = m_cmds[i];
+            Cmd.Count = 3 * (i % 100 + 1);
+            Cmd.InstanceCount = 1;
+            Cmd.FirstIndex = i * 300;
+            Cmd.BaseVertex = i * 100;
+            Cmd.BaseInstance = 0;
+
+            Matrix4f Translation, Rotation, Scale;
+            Translation.InitTranslationTransform(RandomFloatRange(-200.0f, 200.0f),
+                                                 RandomFloatRange(-200.0f, 200.0f),
+                                                 RandomFloatRange(-200.0f, 200.0f));
+            Rotation.InitRotateTransform(RandomFloatRange(0.0f, 360.0f), RandomFloatRange(0.0f, 360.0f), RandomFloatRange(0.0f, 360.0f));
+            Scale.InitScaleTransform(RandomFloatRange(0.5f, 3.0f), RandomFloatRange(0.5f, 3.0f), RandomFloatRange(0.5f, 3.0f));
+
+            m_data[i].WorldMatrix = Translation * Rotation * Scale;
+            m_data[i].NormalMatrix = m_data[i].WorldMatrix.Inverse().Transpose();
+            m_data[i].MaterialIndex = glm::ivec4(i % 7, i + 1, i, 0);
+
+            // Every 50th mesh has unknown bounds and must always be visible
+            if (i % 50 != 0) {
+                Vector3f Min(RandomFloatRange(-5.0f, 0.0f), RandomFloatRange(-5.0f, 0.0f), RandomFloatRange(-5.0f, 0.0f));
+                Vector3f Max(RandomFloatRange(0.0f, 5.0f), RandomFloatRange(0.0f, 5.0f), RandomFloatRange(0.0f, 5.0f));
+                m_bounds[i].Min = Vector4f(Min, 1.0f);
+                m_bounds[i].Max = Vector4f(Max, 1.0f);
+            }
+        }
+    }
+
+
+    // The same layout as SceneIndirectRender - data, commands and bounds in a single buffer
+    void InitBuffer()
+    {
+        GLint Alignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &Alignment);
+
+        m_dataOffset = 0;
+        m_cmdsOffset = AlignOffset(m_dataOffset + ARRAY_SIZE_IN_BYTES(m_data), Alignment);
+        m_boundsOffset = AlignOffset(m_cmdsOffset + ARRAY_SIZE_IN_BYTES(m_cmds), Alignment);
+        size_t Size = m_boundsOffset + ARRAY_SIZE_IN_BYTES(m_bounds);
+
+        glCreateBuffers(1, &m_buffer);
+        glNamedBufferStorage(m_buffer, Size, NULL, GL_DYNAMIC_STORAGE_BIT);
+        glNamedBufferSubData(m_buffer, m_dataOffset, ARRAY_SIZE_IN_BYTES(m_data), m_data.data());
+        glNamedBufferSubData(m_buffer, m_cmdsOffset, ARRAY_SIZE_IN_BYTES(m_cmds), m_cmds.data());
+        glNamedBufferSubData(m_buffer, m_boundsOffset, ARRAY_SIZE_IN_BYTES(m_bounds), m_bounds.data());
+    }
+
+
+    static size_t AlignOffset(size_t Offset, int Alignment)
+    {
+        return (Offset + Alignment - 1) / Alignment * Alignment;
+    }
+
+
+    // A camera at a different location and direction for each view
+    Matrix4f CreateViewProj(int ViewIndex)
+    {
+        PersProjInfo persProjInfo;
+        persProjInfo.FOV = 45.0f + ViewIndex * 5.0f;
+        persProjInfo.Width = (float)VIEWPORT_WIDTH;
+        persProjInfo.Height = (float)VIEWPORT_HEIGHT;
+        persProjInfo.zNear = 1.0f;
+        persProjInfo.zFar = 150.0f + ViewIndex * 20.0f;
+
+        Matrix4f Projection;
+        Projection.InitPersProjTransform(persProjInfo);
+
+        Vector3f Pos(RandomFloatRange(-100.0f, 100.0f), RandomFloatRange(-100.0f, 100.0f), RandomFloatRange(-100.0f, 100.0f));
+        Vector3f Target(RandomFloatRange(-1.0f, 1.0f), RandomFloatRange(-1.0f, 1.0f), 1.0f);
+        Vector3f Up(0.0f, 1.0f, 0.0f);
+
+        Matrix4f View;
+        View.InitCameraTransform(Pos, Target, Up);
+
+        return Projection * View;
+    }
+
+
+    bool Validate(int ViewIndex,
+                  const std::vector<IndirectRender::DrawElementsIndirectCommand>& Cmds,
+                  const std::vector<IndirectRender::PerObjectData>& Data,
+                  const std::vector<int>& Visible,
+                  const std::vector<int>& Borderline)
+    {
+        std::vector<unsigned char> IsDrawn(NUM_DRAWS, 0);
+
+        for (int i = 0; i < (int)Cmds.size(); i++) {
+            int DrawIndex = (int)Cmds[i].BaseInstance;
+
+            if ((DrawIndex >= NUM_DRAWS) || IsDrawn[DrawIndex]) {
+                printf("View %d: invalid or duplicate draw %d\n", ViewIndex, DrawIndex);
+                return false;
+            }
+
+            IsDrawn[DrawIndex] = 1;
+
+            const IndirectRender::DrawElementsIndirectCommand& Cmd = m_cmds[DrawIndex];
+
+            if ((Cmds[i].Count != Cmd.Count) || (Cmds[i].InstanceCount != Cmd.InstanceCount) ||
+                (Cmds[i].FirstIndex != Cmd.FirstIndex) || (Cmds[i].BaseVertex != Cmd.BaseVertex)) {
+                printf("View %d: the command of draw %d was not copied correctly\n", ViewIndex, DrawIndex);
+                return false;
+            }
+
+            // The per object data must move together with its command (gl_DrawID)
+            if (memcmp(&Data[i], &m_data[DrawIndex], sizeof(IndirectRender::PerObjectData)) != 0) {
+                printf("View %d: the per object data of draw %d was not copied correctly\n", ViewIndex, DrawIndex);
+                return false;
+            }
+        }
+
+        for (int DrawIndex : Visible) {
+            if (!IsDrawn[DrawIndex]) {
+                printf("View %d: draw %d is visible in the reference but was culled on the GPU\n", ViewIndex, DrawIndex);
+                return false;
+            }
+
+            IsDrawn[DrawIndex] = 0;
+        }
+
+        for (int DrawIndex : Borderline) {
+            IsDrawn[DrawIndex] = 0;
+        }
+
+        for (int i = 0; i < NUM_DRAWS; i++) {
+            if (IsDrawn[i]) {
+                printf("View %d: draw %d is culled in the reference but was drawn by the GPU\n", ViewIndex, i);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    GPUCulling m_gpuCulling;
+    std::vector<IndirectRender::DrawElementsIndirectCommand> m_cmds;
+    std::vector<IndirectRender::PerObjectData> m_data;
+    std::vector<IndirectRender::MeshBounds> m_bounds;
+    GLuint m_buffer = 0;
+    size_t m_dataOffset = 0;
+    size_t m_cmdsOffset = 0;
+    size_t m_boundsOffset = 0;
+};
+
+
+bool ValidateGPUCulling()
+{
+    GPUCullingValidation Validation;
+    return Validation.Run();
+}
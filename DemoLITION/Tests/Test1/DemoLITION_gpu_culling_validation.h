@@ -0,0 +1,28 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - GPU Culling Validation
+
+    Shared by test_gpu_culling and Sandbox/GPUCullingTest.
+*/
+
+#pragma once
+
+// Culls random draws from several views with the GPU culling compute shader
+// and compares the compacted draws with GPUCulling::CullReference. Only needs
+// a current GL 4.5 context. Returns false on the first mismatch.
+bool ValidateGPUCulling();
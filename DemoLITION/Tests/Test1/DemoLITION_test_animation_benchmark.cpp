@@ -0,0 +1,188 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Skeletal Animation Benchmark
+
+    Compares the compiled animation sampler (single and batched) against
+    the original implementation which walks the Assimp node hierarchy.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+#include "demolition.h"
+#include "Int/core_model.h"
+
+
+#define WINDOW_WIDTH  1000
+#define WINDOW_HEIGHT 1000
+
+#define NUM_POSES 20000
+
+
+class AnimationBenchmark : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Animation Benchmark");
+
+        Model* pModel = m_pRenderingSystem->LoadModel("../Content/Mixamo/Running/Running.dae");
+
+        m_pModel = dynamic_cast<CoreModel*>(pModel);
+
+        if (!m_pModel || !m_pModel->IsAnimated()) {
+            printf("The benchmark requires an animated model\n");
+            exit(1);
+        }
+    }
+
+
+    void Run()
+    {
+        Validate();
+
+        double ReferenceTime = Measure(true);
+        double CompiledTime = Measure(false);
+        double BatchTime = MeasureBatch();
+
+        double NumBones = (double)NUM_POSES * m_pModel->NumBones();
+
+        printf("Bones %d, poses %d\n", m_pModel->NumBones(), NUM_POSES);
+        printf("Reference: %.2f ms, %.2f million bones per second\n", ReferenceTime * 1000.0, NumBones / ReferenceTime / 1000000.0);
+        printf("Compiled:  %.2f ms, %.2f million bones per second\n", CompiledTime * 1000.0, NumBones / CompiledTime / 1000000.0);
+        printf("Batch:     %.2f ms, %.2f million bones per second\n", BatchTime * 1000.0, NumBones / BatchTime / 1000000.0);
+        printf("Speedup %.2fx (batch %.2fx)\n", ReferenceTime / CompiledTime, ReferenceTime / BatchTime);
+    }
+
+private:
+
+    // The compiled sampler must produce exactly the same matrices as the reference
+    void Validate()
+    {
+        std::vector<Matrix4f> Reference, Compiled;
+
+        for (int i = 0; i < 1000; i++) {
+            float Time = (float)i * 0.013f;
+
+            m_pModel->GetBoneTransformsReference(Time, Reference);
+            m_pModel->GetBoneTransforms(Time, Compiled);
+
+            if ((Reference.size() != Compiled.size()) ||
+                (memcmp(Reference.data(), Compiled.data(), Reference.size() * sizeof(Matrix4f)) != 0)) {
+                printf("Mismatch between the reference and the compiled bone transforms at time %f\n", Time);
+                exit(1);
+            }
+
+            m_pModel->GetBoneTransformsBlendedReference(Time, Reference, 0, 0, 0.3f);
+            m_pModel->GetBoneTransformsBlended(Time, Compiled, 0, 0, 0.3f);
+
+            if ((Reference.size() != Compiled.size()) ||
+                (memcmp(Reference.data(), Compiled.data(), Reference.size() * sizeof(Matrix4f)) != 0)) {
+                printf("Mismatch between the reference and the compiled blended bone transforms at time %f\n", Time);
+                exit(1);
+            }
+        }
+
+        // One instance per pose, alternating between plain and blended
+        int NumBones = m_pModel->NumBones();
+        std::vector<CoreModel::AnimationInstance> Instances(1000);
+
+        for (int i = 0; i < (int)Instances.size(); i++) {
+            Instances[i].AnimationTimeSec = (float)i * 0.013f;
+            Instances[i].BlendFactor = (i % 2) ? 0.3f : 0.0f;
+        }
+
+        std::vector<Matrix4f> Batch(Instances.size() * NumBones);
+        m_pModel->GetBoneTransformsBatch(Instances.data(), (int)Instances.size(), Batch.data());
+
+        for (int i = 0; i < (int)Instances.size(); i++) {
+            if (Instances[i].BlendFactor > 0.0f) {
+                m_pModel->GetBoneTransformsBlendedReference(Instances[i].AnimationTimeSec, Reference, 0, 0, Instances[i].BlendFactor);
+            } else {
+                m_pModel->GetBoneTransformsReference(Instances[i].AnimationTimeSec, Reference);
+            }
+
+            if (memcmp(Reference.data(), &Batch[i * NumBones], NumBones * sizeof(Matrix4f)) != 0) {
+                printf("Mismatch between the reference and the batch bone transforms of instance %d\n", i);
+                exit(1);
+            }
+        }
+
+        printf("The compiled bone transforms match the reference\n");
+    }
+
+
+    // Returns the time in seconds
+    double Measure(bool UseReference)
+    {
+        std::vector<Matrix4f> Transforms;
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < NUM_POSES; i++) {
+            float Time = (float)i * 0.001f;
+
+            if (UseReference) {
+                m_pModel->GetBoneTransformsReference(Time, Transforms);
+            } else {
+                m_pModel->GetBoneTransforms(Time, Transforms);
+            }
+        }
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(End - Start).count();
+    }
+
+
+    // Returns the time in seconds
+    double MeasureBatch()
+    {
+        std::vector<CoreModel::AnimationInstance> Instances(NUM_POSES);
+
+        for (int i = 0; i < NUM_POSES; i++) {
+            Instances[i].AnimationTimeSec = (float)i * 0.001f;
+        }
+
+        std::vector<Matrix4f> Transforms(NUM_POSES * m_pModel->NumBones());
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        m_pModel->GetBoneTransformsBatch(Instances.data(), NUM_POSES, Transforms.data());
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(End - Start).count();
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    CoreModel* m_pModel = NULL;
+};
+
+
+void test_animation_benchmark()
+{
+    AnimationBenchmark App;
+    App.Init();
+    App.Run();
+}
@@ -184,7 +184,9 @@ public:
         Box.pParticle->SetPosition(0.0f, 9.5f, 0.0f);
 
         m_buoyancyForceGenerator.Init(5.0f, 1.0f, 10.0f, 0.1f);
-        m_fakeSpringForceGenerator.Init(&Water.pParticle->GetPosition(), 0.000001f, 0.01f);
+        // The water has an infinite mass so its position never changes
+        m_waterAnchor = Water.pParticle->GetPosition();
+        m_fakeSpringForceGenerator.Init(&m_waterAnchor, 0.000001f, 0.01f);
         m_physicsSystem.GetRegistry().Add(Box.pParticle, &m_fakeSpringForceGenerator);
     }
 
@@ -356,6 +358,7 @@ private:
     OgldevPhysics::SpringForceGenerator m_springForceGenerator;
     OgldevPhysics::BuoyancyForceGenerator m_buoyancyForceGenerator;
     OgldevPhysics::FakeSpringForceGenerator m_fakeSpringForceGenerator;
+    Vector3f m_waterAnchor;
 };
 
 
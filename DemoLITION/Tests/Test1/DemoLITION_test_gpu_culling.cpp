@@ -0,0 +1,69 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - GPU Culling Test
+
+    Culls random draws with the GPU culling compute shader and compares the
+    compacted draws with the CPU reference. Creating the window initializes the
+    whole renderer so this requires GL 4.6 with ARB_bindless_texture (the lighting
+    shaders). Sandbox/GPUCullingTest runs only the culling pass and works on
+    GL 4.5 software drivers such as Mesa llvmpipe. The comparison itself is in
+    DemoLITION_gpu_culling_validation.cpp and is shared by both.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "demolition.h"
+#include "DemoLITION_gpu_culling_validation.h"
+
+
+#define WINDOW_WIDTH  1000
+#define WINDOW_HEIGHT 1000
+
+
+class GPUCullingTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "GPU Culling Test");
+    }
+
+
+    void Run()
+    {
+        if (!ValidateGPUCulling()) {
+            exit(1);
+        }
+    }
+
+private:
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+};
+
+
+void test_gpu_culling()
+{
+    GPUCullingTest App;
+    App.Init();
+    App.Run();
+}
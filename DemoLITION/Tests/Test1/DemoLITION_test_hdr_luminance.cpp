@@ -0,0 +1,233 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - HDR Luminance Test
+
+    Reduces random HDR images on the GPU and compares the average luminance
+    and the adaptation with the CPU reference. Both paths are then timed
+    (the CPU path includes the readback of the HDR image).
+
+    Creating the window initializes the whole renderer so this requires GL 4.6
+    with ARB_bindless_texture (the lighting shaders). Sandbox/HDRLuminanceTest
+    runs only the luminance passes and works on GL 4.5 software drivers such as
+    Mesa llvmpipe.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+#include "demolition.h"
+#include "GL/gl_hdr_luminance.h"
+
+
+#define WINDOW_WIDTH  1920
+#define WINDOW_HEIGHT 1080
+
+#define NUM_IMAGES 10
+#define NUM_FRAMES 30               // of adaptation per image
+#define NUM_TIMING_RUNS 20
+
+#define DELTA_TIME (1.0f / 60.0f)
+#define ADAPTATION_RATE 1.5f
+
+// The GPU sums in single precision in a different order than the CPU
+#define RELATIVE_TOLERANCE 0.001f
+
+
+class HDRLuminanceTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "HDR Luminance Test");
+
+        m_hdrLuminance.Init(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        m_image.resize(WINDOW_WIDTH * WINDOW_HEIGHT * 3);
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_texture);
+        glTextureStorage2D(m_texture, 1, GL_RGB32F, WINDOW_WIDTH, WINDOW_HEIGHT);
+        glTextureParameteri(m_texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(m_texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+
+    ~HDRLuminanceTest()
+    {
+        if (m_texture) {
+            glDeleteTextures(1, &m_texture);
+        }
+    }
+
+
+    void Run()
+    {
+        for (int i = 0; i < NUM_IMAGES; i++) {
+            CreateImage(i);
+
+            ValidateAverage(i);
+            ValidateAdaptation(i);
+        }
+
+        printf("The GPU luminance matches the CPU reference\n");
+
+        double CPUTime = MeasureCPU();
+        double GPUTime = MeasureGPU();
+
+        printf("Pixels %d\n", WINDOW_WIDTH * WINDOW_HEIGHT);
+        printf("CPU (with readback): %.3f ms\n", CPUTime * 1000.0);
+        printf("GPU:                 %.3f ms\n", GPUTime * 1000.0);
+        printf("Speedup %.2fx\n", CPUTime / GPUTime);
+    }
+
+private:
+
+    // The brightness of the images spans several orders of magnitude
+    void CreateImage(int Index)
+    {
+        float Scale = powf(10.0f, (float)(Index % 5) - 2.0f);
+
+        for (int i = 0; i < WINDOW_WIDTH * WINDOW_HEIGHT; i++) {
+            // A few very bright pixels, like the sun or a light source
+            float Boost = (RandomFloat() < 0.001f) ? 1000.0f : 1.0f;
+
+            for (int c = 0; c < 3; c++) {
+                m_image[i * 3 + c] = RandomFloat() * Scale * Boost;
+            }
+        }
+
+        glTextureSubImage2D(m_texture, 0, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_RGB, GL_FLOAT, m_image.data());
+    }
+
+
+    // Without adaptation the adapted luminance is the average as is
+    void ValidateAverage(int Index)
+    {
+        float Reference = HDRLuminance::CalcAverageLuminance(m_image.data(), WINDOW_WIDTH * WINDOW_HEIGHT);
+
+        glBindTextureUnit(0, m_texture);
+        m_hdrLuminance.Update(DELTA_TIME, 0.0f);
+        m_hdrLuminance.ReadState(m_state);
+
+        Compare(Index, "average", m_state.AverageLuminance, Reference);
+        Compare(Index, "adapted", m_state.AdaptedLuminance, Reference);
+        Compare(Index, "exposure", m_state.Exposure, 0.18f / Reference);
+    }
+
+
+    // Adapts from the previous image towards the current one
+    void ValidateAdaptation(int Index)
+    {
+        float Average = HDRLuminance::CalcAverageLuminance(m_image.data(), WINDOW_WIDTH * WINDOW_HEIGHT);
+
+        // The state of ValidateAverage() of the previous image is no longer there so start from a
+        // known value which is far from the average.
+        float Start = Average * 50.0f;
+        float Adapted = Start;
+        m_hdrLuminance.UpdateFromCPU(Adapted, DELTA_TIME, 0.0f);
+
+        glBindTextureUnit(0, m_texture);
+
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            m_hdrLuminance.Update(DELTA_TIME, ADAPTATION_RATE);
+            m_hdrLuminance.ReadState(m_state);
+
+            Adapted = HDRLuminance::CalcAdaptedLuminance(Adapted, Average, DELTA_TIME, ADAPTATION_RATE);
+
+            Compare(Index, "adapted", m_state.AdaptedLuminance, Adapted);
+        }
+
+        // The GPU result must be moving towards the average
+        if ((m_state.AdaptedLuminance >= Start) || (m_state.AdaptedLuminance <= Average)) {
+            printf("Image %d: the luminance did not adapt (%f, average %f)\n", Index, m_state.AdaptedLuminance, Average);
+            exit(1);
+        }
+    }
+
+
+    void Compare(int Index, const char* pName, float Value, float Reference)
+    {
+        float Error = fabsf(Value - Reference) / fmaxf(fabsf(Reference), 1e-6f);
+
+        if (Error > RELATIVE_TOLERANCE) {
+            printf("Image %d: mismatch in the %s luminance - GPU %f CPU %f\n", Index, pName, Value, Reference);
+            exit(1);
+        }
+    }
+
+
+    // Returns the time in seconds of a single frame
+    double MeasureCPU()
+    {
+        std::vector<float> Readback(m_image.size());
+
+        glBindTextureUnit(0, m_texture);
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < NUM_TIMING_RUNS; i++) {
+            glGetTextureImage(m_texture, 0, GL_RGB, GL_FLOAT, (GLsizei)(Readback.size() * sizeof(float)), Readback.data());
+            float Average = HDRLuminance::CalcAverageLuminance(Readback.data(), WINDOW_WIDTH * WINDOW_HEIGHT);
+            m_hdrLuminance.UpdateFromCPU(Average, DELTA_TIME, ADAPTATION_RATE);
+        }
+
+        glFinish();
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(End - Start).count() / NUM_TIMING_RUNS;
+    }
+
+
+    // Returns the time in seconds of a single frame
+    double MeasureGPU()
+    {
+        glBindTextureUnit(0, m_texture);
+
+        glFinish();
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < NUM_TIMING_RUNS; i++) {
+            m_hdrLuminance.Update(DELTA_TIME, ADAPTATION_RATE);
+        }
+
+        glFinish();
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(End - Start).count() / NUM_TIMING_RUNS;
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    HDRLuminance m_hdrLuminance;
+    HDRLuminanceState m_state;
+    std::vector<float> m_image;
+    GLuint m_texture = 0;
+};
+
+
+void test_hdr_luminance()
+{
+    HDRLuminanceTest App;
+    App.Init();
+    App.Run();
+}
@@ -0,0 +1,335 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Light Clusters Test
+
+    Assigns random lights to the clusters of random views on the CPU and checks
+    that every light which reaches a random point inside the frustum is in the
+    list of the cluster of that point. The clusters of the compute shader are
+    then compared with the CPU reference and both are timed.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#include "demolition.h"
+#include "GL/gl_clustered_lighting.h"
+
+
+#define WINDOW_WIDTH  1920
+#define WINDOW_HEIGHT 1080
+
+#define NUM_GLOBAL_LIGHTS 2
+#define NUM_LIGHTS 1000             // assigned to the clusters
+#define NUM_VIEWS 10
+#define NUM_POINTS 100000           // per view
+#define NUM_TIMING_RUNS 20
+
+// Lights this close to the box of a cluster may go either way due to floating point differences
+#define BORDERLINE_TOLERANCE 0.001f
+
+
+class LightClustersTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Light Clusters Test");
+
+        m_clusteredLighting.Init();
+
+        InitLights();
+    }
+
+
+    void Run()
+    {
+        for (int i = 0; i < NUM_VIEWS; i++) {
+            CreateView(i);
+
+            m_clusters.Init(m_projection, m_zNear, m_zFar);
+
+            std::vector<uint> Counts, Indices;
+            int NumDropped = m_clusters.Assign(m_view, m_spheres.data(), NUM_LIGHTS, NUM_GLOBAL_LIGHTS, Counts, Indices);
+
+            ValidateLists(i, Counts, Indices);
+            int NumChecks = ValidatePoints(i, Counts, Indices);
+
+            int NumBorderline = CompareWithGPU(i, Counts, Indices);
+
+            int TotalAssigned = 0;
+
+            for (uint Count : Counts) {
+                TotalAssigned += Count;
+            }
+
+            printf("View %d: %.2f lights per cluster, %d dropped, %d points checked, %d borderline on the GPU\n",
+                   i, (float)TotalAssigned / (float)NUM_LIGHT_CLUSTERS, NumDropped, NumChecks, NumBorderline);
+        }
+
+        printf("The light clusters match the reference - %d lights, %d views\n", NUM_LIGHTS, NUM_VIEWS);
+
+        Measure();
+    }
+
+private:
+
+    void InitLights()
+    {
+        m_lights.resize(NUM_GLOBAL_LIGHTS + NUM_LIGHTS);
+        m_spheres.resize(NUM_LIGHTS);
+
+        for (int i = 0; i < (int)m_lights.size(); i++) {
+            LightSource& l = m_lights[i];
+            l.LightType = (i < NUM_GLOBAL_LIGHTS) ? LIGHT_TYPE_DIR : LIGHT_TYPE_POINT;
+            l.Color = glm::vec3(1.0f);
+            l.DiffuseIntensity = 1.0f;
+            l.AmbientIntensity = 0.0f;
+            l.Atten_Constant = 1.0f;
+            l.Atten_Linear = 0.0f;
+            l.Atten_Exp = 0.0f;
+            l.Cutoff = 0.0f;
+            l.Direction = glm::vec3(0.0f, -1.0f, 0.0f);
+            l.WorldPos = glm::vec3(0.0f);
+            l.ShadowMapIndex = -1;
+        }
+
+        for (int i = 0; i < NUM_LIGHTS; i++) {
+            LightSource& l = m_lights[NUM_GLOBAL_LIGHTS + i];
+
+            l.WorldPos = glm::vec3(RandomFloatRange(-100.0f, 100.0f), RandomFloatRange(-20.0f, 20.0f), RandomFloatRange(-100.0f, 100.0f));
+            l.Atten_Exp = RandomFloatRange(1.0f, 50.0f);
+
+            float Radius = LightClusters::CalcLightRadius(l.DiffuseIntensity, l.Atten_Constant, l.Atten_Linear, l.Atten_Exp);
+
+            m_spheres[i] = Vector4f(l.WorldPos.x, l.WorldPos.y, l.WorldPos.z, Radius);
+        }
+    }
+
+
+    // A camera at a different location and direction for each view (right handed, like GLMCameraFirstPerson)
+    void CreateView(int ViewIndex)
+    {
+        m_zNear = 0.1f + ViewIndex * 0.1f;
+        m_zFar = 100.0f + ViewIndex * 30.0f;
+
+        float FOV = 45.0f + ViewIndex * 5.0f;
+        glm::mat4 Projection = glm::perspective(glm::radians(FOV), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, m_zNear, m_zFar);
+
+        glm::vec3 Pos(RandomFloatRange(-80.0f, 80.0f), RandomFloatRange(-10.0f, 10.0f), RandomFloatRange(-80.0f, 80.0f));
+        glm::vec3 Target(RandomFloatRange(-50.0f, 50.0f), 0.0f, RandomFloatRange(-50.0f, 50.0f));
+        glm::mat4 View = glm::lookAt(Pos, Target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        m_projection = Matrix4f(Projection);
+        m_view = Matrix4f(View);
+        m_viewInverse = Matrix4f(glm::inverse(View));
+    }
+
+
+    // The lists must be sorted and only contain the clustered lights
+    void ValidateLists(int ViewIndex, const std::vector<uint>& Counts, const std::vector<uint>& Indices)
+    {
+        for (int c = 0; c < NUM_LIGHT_CLUSTERS; c++) {
+            const uint* pIndices = &Indices[c * MAX_LIGHTS_PER_CLUSTER];
+
+            for (uint i = 0; i < Counts[c]; i++) {
+                if ((pIndices[i] < NUM_GLOBAL_LIGHTS) || (pIndices[i] >= NUM_GLOBAL_LIGHTS + NUM_LIGHTS)) {
+                    printf("View %d: invalid light %d in cluster %d\n", ViewIndex, pIndices[i], c);
+                    exit(1);
+                }
+
+                if ((i > 0) && (pIndices[i] <= pIndices[i - 1])) {
+                    printf("View %d: the lights of cluster %d are not sorted\n", ViewIndex, c);
+                    exit(1);
+                }
+            }
+        }
+    }
+
+
+    // Every light which reaches a point must be in the cluster of the point (unless the cluster is full)
+    int ValidatePoints(int ViewIndex, const std::vector<uint>& Counts, const std::vector<uint>& Indices)
+    {
+        int NumChecks = 0;
+
+        std::vector<unsigned char> IsInCluster(NUM_LIGHTS);
+
+        for (int p = 0; p < NUM_POINTS; p++) {
+            float NDCX = RandomFloatRange(-1.0f, 1.0f);
+            float NDCY = RandomFloatRange(-1.0f, 1.0f);
+            float Depth = m_zNear * powf(m_zFar / m_zNear, RandomFloatRange(0.0f, 1.0f));
+
+            Vector3f ViewPos(NDCX * Depth / m_projection.m[0][0], NDCY * Depth / m_projection.m[1][1], -Depth);
+            Vector4f WorldPos = m_viewInverse * Vector4f(ViewPos, 1.0f);
+
+            int Cluster = m_clusters.GetClusterIndex(ViewPos);
+
+            if (Counts[Cluster] == MAX_LIGHTS_PER_CLUSTER) {
+                continue;
+            }
+
+            std::fill(IsInCluster.begin(), IsInCluster.end(), 0);
+
+            for (uint i = 0; i < Counts[Cluster]; i++) {
+                IsInCluster[Indices[Cluster * MAX_LIGHTS_PER_CLUSTER + i] - NUM_GLOBAL_LIGHTS] = 1;
+            }
+
+            for (int i = 0; i < NUM_LIGHTS; i++) {
+                const Vector4f& s = m_spheres[i];
+                Vector3f d(WorldPos.x - s.x, WorldPos.y - s.y, WorldPos.z - s.z);
+
+                if (d.Length() < s.w - BORDERLINE_TOLERANCE) {
+                    NumChecks++;
+
+                    if (!IsInCluster[i]) {
+                        printf("View %d: light %d reaches (%f,%f,%f) but is not in its cluster %d\n",
+                               ViewIndex, i, WorldPos.x, WorldPos.y, WorldPos.z, Cluster);
+                        exit(1);
+                    }
+                }
+            }
+        }
+
+        return NumChecks;
+    }
+
+
+    // Distance between the sphere of a light and the box of a cluster
+    float CalcBoxDistance(int Cluster, int Light)
+    {
+        const LightClusters::ClusterBox& Box = m_clusters.GetBoxes()[Cluster];
+        const Vector4f& s = m_spheres[Light];
+        Vector4f c = m_view * Vector4f(s.x, s.y, s.z, 1.0f);
+
+        Vector3f d(c.x - std::clamp(c.x, Box.Min.x, Box.Max.x),
+                   c.y - std::clamp(c.y, Box.Min.y, Box.Max.y),
+                   c.z - std::clamp(c.z, Box.Min.z, Box.Max.z));
+
+        return d.Length() - s.w;
+    }
+
+
+    // The compute shader must produce the same lists except for lights which barely touch the cluster.
+    // The CPU path of ClusteredLighting must produce exactly the same lists.
+    int CompareWithGPU(int ViewIndex, const std::vector<uint>& Counts, const std::vector<uint>& Indices)
+    {
+        std::vector<uint> UploadedCounts, UploadedIndices;
+
+        m_clusteredLighting.Update(m_view, m_projection, m_zNear, m_zFar, m_lights, NUM_GLOBAL_LIGHTS, m_spheres, false);
+        m_clusteredLighting.ReadClusters(UploadedCounts, UploadedIndices);
+
+        for (int c = 0; c < NUM_LIGHT_CLUSTERS; c++) {
+            if ((UploadedCounts[c] != Counts[c]) ||
+                !std::equal(&Indices[c * MAX_LIGHTS_PER_CLUSTER], &Indices[c * MAX_LIGHTS_PER_CLUSTER] + Counts[c],
+                            &UploadedIndices[c * MAX_LIGHTS_PER_CLUSTER])) {
+                printf("View %d: the uploaded cluster %d does not match the reference\n", ViewIndex, c);
+                exit(1);
+            }
+        }
+
+        std::vector<uint> GPUCounts, GPUIndices;
+
+        m_clusteredLighting.Update(m_view, m_projection, m_zNear, m_zFar, m_lights, NUM_GLOBAL_LIGHTS, m_spheres, true);
+        m_clusteredLighting.ReadClusters(GPUCounts, GPUIndices);
+
+        int NumBorderline = 0;
+
+        for (int c = 0; c < NUM_LIGHT_CLUSTERS; c++) {
+            // A borderline light can push a different light out of a full cluster
+            if ((Counts[c] == MAX_LIGHTS_PER_CLUSTER) || (GPUCounts[c] == MAX_LIGHTS_PER_CLUSTER)) {
+                continue;
+            }
+
+            std::vector<uint> Diff;
+
+            std::set_symmetric_difference(&Indices[c * MAX_LIGHTS_PER_CLUSTER], &Indices[c * MAX_LIGHTS_PER_CLUSTER] + Counts[c],
+                                          &GPUIndices[c * MAX_LIGHTS_PER_CLUSTER], &GPUIndices[c * MAX_LIGHTS_PER_CLUSTER] + GPUCounts[c],
+                                          std::back_inserter(Diff));
+
+            for (uint LightIndex : Diff) {
+                int Light = (int)LightIndex - NUM_GLOBAL_LIGHTS;
+
+                if ((Light < 0) || (Light >= NUM_LIGHTS) || (fabsf(CalcBoxDistance(c, Light)) > BORDERLINE_TOLERANCE)) {
+                    printf("View %d: light %d in cluster %d does not match between the GPU and the reference\n", ViewIndex, LightIndex, c);
+                    exit(1);
+                }
+
+                NumBorderline++;
+            }
+        }
+
+        return NumBorderline;
+    }
+
+
+    void Measure()
+    {
+        std::vector<uint> Counts, Indices;
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < NUM_TIMING_RUNS; i++) {
+            m_clusters.Assign(m_view, m_spheres.data(), NUM_LIGHTS, NUM_GLOBAL_LIGHTS, Counts, Indices);
+        }
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        double CPUTime = std::chrono::duration<double>(End - Start).count() / NUM_TIMING_RUNS;
+
+        // Includes the upload of the lights
+        glFinish();
+
+        Start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < NUM_TIMING_RUNS; i++) {
+            m_clusteredLighting.Update(m_view, m_projection, m_zNear, m_zFar, m_lights, NUM_GLOBAL_LIGHTS, m_spheres, true);
+        }
+
+        glFinish();
+
+        End = std::chrono::high_resolution_clock::now();
+
+        double GPUTime = std::chrono::duration<double>(End - Start).count() / NUM_TIMING_RUNS;
+
+        printf("%d lights, %d clusters: CPU %.3f ms, GPU %.3f ms\n", NUM_LIGHTS, NUM_LIGHT_CLUSTERS, CPUTime * 1000.0, GPUTime * 1000.0);
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    ClusteredLighting m_clusteredLighting;
+    LightClusters m_clusters;
+    std::vector<LightSource> m_lights;
+    std::vector<Vector4f> m_spheres;
+    Matrix4f m_projection;
+    Matrix4f m_view;
+    Matrix4f m_viewInverse;
+    float m_zNear = 0.0f;
+    float m_zFar = 0.0f;
+};
+
+
+void test_light_clusters()
+{
+    LightClustersTest App;
+    App.Init();
+    App.Run();
+}
@@ -28,6 +28,18 @@ void test_normal_map();
 void test_parallax_map();
 void test_grid();
 void carbonara();
+void test_animation_benchmark();
+void test_gpu_culling();
+void test_terrain_clipmap();
+void test_perlin_benchmark();
+void test_normal_baker();
+void test_mesh_lod();
+void test_light_clusters();
+void test_many_lights();
+void test_point_shadows();
+void test_shadow_cascades();
+void test_hdr_luminance();
+void test_model_cache_benchmark();
 
 
 int main(int argc, char* arg[])
@@ -42,5 +54,17 @@ int main(int argc, char* arg[])
     //test_normal_map();
     //test_parallax_map();
     //test_grid();
+    //test_animation_benchmark();
+    //test_gpu_culling();
+    //test_terrain_clipmap();
+    //test_perlin_benchmark();
+    //test_normal_baker();
+    //test_mesh_lod();
+    //test_light_clusters();
+    //test_many_lights();
+    //test_point_shadows();
+    //test_shadow_cascades();
+    //test_hdr_luminance();
+    //test_model_cache_benchmark();
     carbonara();
 }
\ No newline at end of file
@@ -0,0 +1,177 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Many Lights Test
+
+    A field of boxes lit by 1000 moving point and spot lights. The lights are
+    assigned to the clusters of the camera every frame (clustered forward
+    lighting) and the average frame time is printed periodically.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "demolition.h"
+
+
+#define WINDOW_WIDTH  1920
+#define WINDOW_HEIGHT 1080
+
+#define NUM_POINT_LIGHTS 800
+#define NUM_SPOT_LIGHTS 200
+#define GRID_SIZE 30
+#define GRID_SPACING 5.0f
+#define FRAMES_PER_REPORT 200
+
+
+class ManyLightsTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Many Lights Test");
+
+        m_pScene = m_pRenderingSystem->CreateEmptyScene();
+        m_pScene->SetClearColor(Vector4f(0.0f, 0.0f, 0.0f, 0.0f));
+        m_pScene->GetConfig()->ControlShadowMapping(false);
+        m_pScene->SetCamera(Vector3f(0.0f, 40.0f, -90.0f), Vector3f(0.0f, -0.5f, 1.0f));
+        m_pScene->SetCameraSpeed(0.5f);
+        m_pRenderingSystem->SetScene(m_pScene);
+
+        InitObjects();
+
+        InitLights();
+    }
+
+
+    void Run()
+    {
+        m_pRenderingSystem->Execute();
+    }
+
+
+    void OnFrame(double DeltaTime)
+    {
+        m_time += (float)DeltaTime;
+
+        std::vector<PointLight>& PointLights = m_pScene->GetPointLights();
+        std::vector<SpotLight>& SpotLights = m_pScene->GetSpotLights();
+
+        for (int i = 0; i < (int)m_orbits.size(); i++) {
+            const Orbit& o = m_orbits[i];
+            float Angle = o.StartAngle + o.Speed * m_time;
+            Vector3f Pos(o.Center.x + o.Radius * cosf(Angle), o.Center.y, o.Center.z + o.Radius * sinf(Angle));
+
+            if (i < NUM_POINT_LIGHTS) {
+                PointLights[i].WorldPosition = Pos;
+            } else {
+                SpotLights[i - NUM_POINT_LIGHTS].WorldPosition = Pos;
+            }
+        }
+
+        m_frameTime += DeltaTime;
+        m_numFrames++;
+
+        if (m_numFrames == FRAMES_PER_REPORT) {
+            printf("%d lights: %.2f ms per frame\n", NUM_POINT_LIGHTS + NUM_SPOT_LIGHTS, m_frameTime * 1000.0 / m_numFrames);
+            m_frameTime = 0.0;
+            m_numFrames = 0;
+        }
+    }
+
+private:
+
+    void InitObjects()
+    {
+        Model* pBox = m_pRenderingSystem->LoadModel("../Content/box.obj");
+
+        float Offset = (GRID_SIZE - 1) * GRID_SPACING * 0.5f;
+
+        for (int z = 0; z < GRID_SIZE; z++) {
+            for (int x = 0; x < GRID_SIZE; x++) {
+                SceneObject* pSceneObject = m_pScene->CreateSceneObject(pBox);
+                pSceneObject->SetPosition(x * GRID_SPACING - Offset, 0.0f, z * GRID_SPACING - Offset);
+                pSceneObject->SetScale(2.0f, RandomFloatRange(0.5f, 4.0f), 2.0f);
+                m_pScene->AddToRenderList(pSceneObject);
+            }
+        }
+    }
+
+
+    // The attenuation limits the range of every light to a few boxes (see LightClusters::CalcLightRadius)
+    void InitLights()
+    {
+        float Extent = GRID_SIZE * GRID_SPACING * 0.5f;
+
+        for (int i = 0; i < NUM_POINT_LIGHTS + NUM_SPOT_LIGHTS; i++) {
+            Orbit o;
+            o.Center = Vector3f(RandomFloatRange(-Extent, Extent), RandomFloatRange(2.0f, 8.0f), RandomFloatRange(-Extent, Extent));
+            o.Radius = RandomFloatRange(1.0f, 6.0f);
+            o.Speed = RandomFloatRange(-1.0f, 1.0f);
+            o.StartAngle = RandomFloatRange(0.0f, 6.28f);
+            m_orbits.push_back(o);
+
+            Vector3f Color(RandomFloatRange(0.2f, 1.0f), RandomFloatRange(0.2f, 1.0f), RandomFloatRange(0.2f, 1.0f));
+
+            if (i < NUM_POINT_LIGHTS) {
+                PointLight l;
+                l.Color = Color;
+                l.DiffuseIntensity = 0.5f;
+                l.Attenuation.Constant = 1.0f;
+                l.Attenuation.Linear = 0.0f;
+                l.Attenuation.Exp = 2.0f;
+                m_pScene->GetPointLights().push_back(l);
+            } else {
+                SpotLight l;
+                l.Color = Color;
+                l.DiffuseIntensity = 1.0f;
+                l.Attenuation.Constant = 1.0f;
+                l.Attenuation.Linear = 0.0f;
+                l.Attenuation.Exp = 1.0f;
+                l.WorldDirection = Vector3f(0.0f, -1.0f, 0.0f);
+                l.Cutoff = 30.0f;
+                m_pScene->GetSpotLights().push_back(l);
+            }
+        }
+    }
+
+    struct Orbit {
+        Vector3f Center;
+        float Radius = 0.0f;
+        float Speed = 0.0f;
+        float StartAngle = 0.0f;
+    };
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    Scene* m_pScene = NULL;
+    std::vector<Orbit> m_orbits;
+    float m_time = 0.0f;
+    double m_frameTime = 0.0;
+    int m_numFrames = 0;
+};
+
+
+void test_many_lights()
+{
+    ManyLightsTest App;
+    App.Init();
+    App.Run();
+}
@@ -0,0 +1,155 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+    DemoLITION - Mesh LOD Test
+
+    Selects the LOD of a high poly model from a range of distances and prints
+    the number of triangles which are rendered relative to the full model. The
+    model is then converted to the mesh format and loaded back to make sure
+    that the LOD chain survives the round trip.
+*/
+
+#include <stdio.h>
+#include <vector>
+
+#include "demolition.h"
+#include "Int/core_model.h"
+
+
+#define WINDOW_WIDTH  1000
+#define WINDOW_HEIGHT 1000
+
+#define FOV 45.0f
+#define MAX_PIXEL_ERROR 1.0f
+#define NUM_DISTANCES 10
+
+// The distant objects must render at least an order of magnitude fewer triangles
+#define MIN_DISTANT_REDUCTION 10.0
+
+
+class MeshLodTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Mesh LOD Test");
+
+        m_pModel = (CoreModel*)m_pRenderingSystem->LoadModel("../Content/dragon.obj");
+
+        m_identity.InitIdentity();
+
+        AABB Bounds;
+
+        if (!m_pModel->CalcWorldBounds(m_identity, m_identity, Bounds)) {
+            printf("The bounds of the model are unknown\n");
+            exit(1);
+        }
+
+        m_size = std::max(Bounds.MaxX - Bounds.MinX, std::max(Bounds.MaxY - Bounds.MinY, Bounds.MaxZ - Bounds.MinZ));
+
+        // Half the viewport height times Proj[1][1]
+        m_projScale = (float)WINDOW_HEIGHT * 0.5f / tanf(ToRadian(FOV / 2.0f));
+    }
+
+
+    void Run()
+    {
+        MeshLodStats Stats;
+
+        for (int i = 0; i < NUM_DISTANCES; i++) {
+            float Distance = GetDistance(i);
+
+            std::vector<uint> Lods;
+            Stats = MeshLodStats();
+            SelectLods(m_pModel, Distance, Lods, Stats);
+
+            printf("Distance %8.2f: %lld/%lld triangles (%.1f%%), %d/%d meshes simplified\n", Distance,
+                   Stats.NumTrianglesRendered, Stats.NumTrianglesFull,
+                   100.0 * (double)Stats.NumTrianglesRendered / (double)Stats.NumTrianglesFull,
+                   Stats.NumSimplifiedMeshes, Stats.NumMeshes);
+        }
+
+        // The last distance is the farthest one
+        double Reduction = (double)Stats.NumTrianglesFull / (double)std::max(Stats.NumTrianglesRendered, 1LL);
+
+        if (Reduction < MIN_DISTANT_REDUCTION) {
+            printf("The distant model is rendered with only %.1fx fewer triangles\n", Reduction);
+            exit(1);
+        }
+
+        ValidateMeshFile();
+
+        printf("Mesh LOD test passed - %.1fx fewer triangles at a distance of %.2f\n", Reduction, GetDistance(NUM_DISTANCES - 1));
+    }
+
+private:
+
+    // From right next to the model to 512 times its size
+    float GetDistance(int Index) const
+    {
+        return m_size * powf(2.0f, (float)Index);
+    }
+
+
+    void SelectLods(const CoreModel* pModel, float Distance, std::vector<uint>& Lods, MeshLodStats& Stats) const
+    {
+        Vector3f CameraPos(0.0f, 0.0f, Distance);
+        pModel->SelectLods(m_identity, m_identity, CameraPos, m_projScale, MAX_PIXEL_ERROR, Lods, Stats);
+    }
+
+
+    // The mesh file must select exactly the same LODs as the original model
+    void ValidateMeshFile()
+    {
+        m_pModel->ConvertToMesh("dragon_lod_test.mesh");
+
+        CoreModel* pMesh = (CoreModel*)m_pRenderingSystem->LoadMesh("dragon_lod_test.mesh");
+
+        for (int i = 0; i < NUM_DISTANCES; i++) {
+            std::vector<uint> ModelLods, MeshLods;
+            MeshLodStats ModelStats, MeshStats;
+
+            SelectLods(m_pModel, GetDistance(i), ModelLods, ModelStats);
+            SelectLods(pMesh, GetDistance(i), MeshLods, MeshStats);
+
+            if ((ModelLods != MeshLods) || (ModelStats.NumTrianglesRendered != MeshStats.NumTrianglesRendered)) {
+                printf("The LODs of the mesh file don't match the model at distance %f\n", GetDistance(i));
+                exit(1);
+            }
+        }
+
+        printf("The mesh file selects the same LODs as the model\n");
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    CoreModel* m_pModel = NULL;
+    Matrix4f m_identity;
+    float m_size = 0.0f;
+    float m_projScale = 0.0f;
+};
+
+
+void test_mesh_lod()
+{
+    MeshLodTest App;
+    App.Init();
+    App.Run();
+}
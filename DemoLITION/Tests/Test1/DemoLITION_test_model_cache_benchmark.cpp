@@ -0,0 +1,191 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Model Cache Benchmark
+
+    Loads the same model several times through Assimp and then through the
+    binary model cache and prints the load times of both. The cache is
+    recreated at the start so the results don't depend on an old cache file.
+    Checks that the cached model matches the one imported by Assimp.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#include "demolition.h"
+#include "Int/core_rendering_system.h"
+#include "GL/gl_model.h"
+
+
+#define WINDOW_WIDTH  1000
+#define WINDOW_HEIGHT 1000
+
+#define MODEL_FILENAME "../Content/Mixamo/Running/Running.dae"
+
+#define NUM_LOADS 10
+
+
+class ModelCacheBenchmark : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Model Cache Benchmark");
+
+        m_pCoreRenderingSystem = dynamic_cast<CoreRenderingSystem*>(m_pRenderingSystem);
+    }
+
+
+    void Run()
+    {
+        // Assimp only
+        CoreModel::EnableModelCache(false);
+        LoadTimes AssimpTimes = Measure();
+
+        // The first load writes the cache and the rest read it
+        CoreModel::EnableModelCache(true);
+        remove(CoreModel::GetModelCacheFilename(MODEL_FILENAME).c_str());
+
+        double WriteTime = 0.0;
+        GLModel* pWriteModel = Load(WriteTime);
+        delete pWriteModel;
+
+        LoadTimes CacheTimes = Measure();
+
+        Validate();
+
+        printf("Model '%s', %d loads\n", MODEL_FILENAME, NUM_LOADS);
+        printf("Assimp:           average %.2f ms, min %.2f ms\n", AssimpTimes.Average, AssimpTimes.Min);
+        printf("Assimp + cache:   %.2f ms (first load, writes the cache)\n", WriteTime);
+        printf("Cache:            average %.2f ms, min %.2f ms\n", CacheTimes.Average, CacheTimes.Min);
+        printf("Speedup %.2fx\n", AssimpTimes.Average / CacheTimes.Average);
+    }
+
+private:
+
+    struct LoadTimes {
+        double Average = 0.0;   // in milliseconds
+        double Min = 0.0;
+    };
+
+
+    GLModel* Load(double& Time)
+    {
+        GLModel* pModel = new GLModel(m_pCoreRenderingSystem);
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        if (!pModel->LoadAssimpModel(MODEL_FILENAME)) {
+            printf("Error loading '%s'\n", MODEL_FILENAME);
+            exit(1);
+        }
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        Time = std::chrono::duration<double, std::milli>(End - Start).count();
+
+        return pModel;
+    }
+
+
+    LoadTimes Measure()
+    {
+        LoadTimes Times;
+        Times.Min = 1e30;
+
+        for (int i = 0; i < NUM_LOADS; i++) {
+            double Time = 0.0;
+            GLModel* pModel = Load(Time);
+            delete pModel;
+
+            Times.Average += Time;
+            Times.Min = std::min(Times.Min, Time);
+        }
+
+        Times.Average /= NUM_LOADS;
+
+        return Times;
+    }
+
+
+    // The model from the cache must have the same meshes, bounds and poses as the one from Assimp
+    void Validate()
+    {
+        double Time = 0.0;
+
+        CoreModel::EnableModelCache(false);
+        GLModel* pAssimpModel = Load(Time);
+
+        CoreModel::EnableModelCache(true);
+        GLModel* pCacheModel = Load(Time);
+
+        if ((pAssimpModel->GetNumMeshes() != pCacheModel->GetNumMeshes()) ||
+            (pAssimpModel->NumBones() != pCacheModel->NumBones()) ||
+            (pAssimpModel->IsAnimated() != pCacheModel->IsAnimated())) {
+            printf("The cached model doesn't match the Assimp model\n");
+            exit(1);
+        }
+
+        Matrix4f Identity;
+        Identity.InitIdentity();
+
+        AABB AssimpBounds, CacheBounds;
+        pAssimpModel->CalcWorldBounds(Identity, Identity, AssimpBounds);
+        pCacheModel->CalcWorldBounds(Identity, Identity, CacheBounds);
+
+        if (memcmp(&AssimpBounds, &CacheBounds, sizeof(AABB)) != 0) {
+            printf("The bounds of the cached model don't match the Assimp model\n");
+            exit(1);
+        }
+
+        std::vector<Matrix4f> AssimpTransforms, CacheTransforms;
+
+        for (int i = 0; i < 100; i++) {
+            float AnimationTime = (float)i * 0.013f;
+
+            pAssimpModel->GetBoneTransforms(AnimationTime, AssimpTransforms);
+            pCacheModel->GetBoneTransforms(AnimationTime, CacheTransforms);
+
+            if ((AssimpTransforms.size() != CacheTransforms.size()) ||
+                (memcmp(AssimpTransforms.data(), CacheTransforms.data(), AssimpTransforms.size() * sizeof(Matrix4f)) != 0)) {
+                printf("The bone transforms of the cached model don't match the Assimp model at time %f\n", AnimationTime);
+                exit(1);
+            }
+        }
+
+        delete pAssimpModel;
+        delete pCacheModel;
+
+        printf("The cached model matches the Assimp model\n");
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    CoreRenderingSystem* m_pCoreRenderingSystem = NULL;
+};
+
+
+void test_model_cache_benchmark()
+{
+    ModelCacheBenchmark App;
+    App.Init();
+    App.Run();
+}
@@ -0,0 +1,244 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Height Field Normal Baker
+
+    Compares the normals of the central difference baker and the original
+    average of the face normals against the exact normals of a smooth height
+    field, checks the tangents and the edges and prints the time of both.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include "ogldev_math_3d.h"
+#include "ogldev_normal_baker.h"
+
+
+#define TEST_SIZE 513
+#define BENCHMARK_SIZE 2049
+
+#define WORLD_SCALE 2.0f
+#define HEIGHT_SCALE 30.0f
+
+// In degrees
+#define MAX_ANGLE_ERROR 1.0f
+
+
+class NormalBakerTest
+{
+public:
+
+    void Run()
+    {
+        ValidateAccuracy();
+        ValidateTangents();
+
+        double BakerTime = Measure(false);
+        double FacesTime = Measure(true);
+
+        double NumVertices = (double)BENCHMARK_SIZE * BENCHMARK_SIZE;
+
+        printf("Size %dx%d\n", BENCHMARK_SIZE, BENCHMARK_SIZE);
+        printf("Faces: %.2f ms, %.2f million vertices per second\n", FacesTime * 1000.0, NumVertices / FacesTime / 1000000.0);
+        printf("Baker: %.2f ms, %.2f million vertices per second\n", BakerTime * 1000.0, NumVertices / BakerTime / 1000000.0);
+        printf("Speedup %.2fx\n", FacesTime / BakerTime);
+    }
+
+private:
+
+    static float Height(int x, int z)
+    {
+        return sinf((float)x * 0.05f) * cosf((float)z * 0.03f);
+    }
+
+
+    static Vector3f ExactNormal(int x, int z)
+    {
+        // The derivatives of the height in world units
+        float dHdx = 0.05f * cosf((float)x * 0.05f) * cosf((float)z * 0.03f) * HEIGHT_SCALE / WORLD_SCALE;
+        float dHdz = -0.03f * sinf((float)x * 0.05f) * sinf((float)z * 0.03f) * HEIGHT_SCALE / WORLD_SCALE;
+
+        Vector3f Normal(-dHdx, 1.0f, -dHdz);
+        Normal.Normalize();
+        return Normal;
+    }
+
+
+    static void CreateHeights(int Size, std::vector<float>& Heights)
+    {
+        Heights.resize(Size * Size);
+
+        for (int z = 0; z < Size; z++) {
+            for (int x = 0; x < Size; x++) {
+                Heights[z * Size + x] = Height(x, z);
+            }
+        }
+    }
+
+
+    static float AngleInDegrees(const Vector3f& a, const Vector3f& b)
+    {
+        float Dot = a.Dot(b);
+        Dot = (Dot > 1.0f) ? 1.0f : ((Dot < -1.0f) ? -1.0f : Dot);
+        return ToDegree(acosf(Dot));
+    }
+
+
+    void ValidateAccuracy()
+    {
+        std::vector<float> Heights;
+        CreateHeights(TEST_SIZE, Heights);
+
+        std::vector<Vector3f> Baked(Heights.size());
+        std::vector<Vector3f> Faces(Heights.size());
+
+        BakeHeightFieldNormals(Heights.data(), TEST_SIZE, TEST_SIZE, WORLD_SCALE, HEIGHT_SCALE, Baked.data());
+        BakeHeightFieldNormalsFromFaces(Heights.data(), TEST_SIZE, TEST_SIZE, WORLD_SCALE, HEIGHT_SCALE, Faces.data());
+
+        float MaxBakedError = 0.0f;
+        float MaxFacesError = 0.0f;
+        double SumBakedError = 0.0;
+        double SumFacesError = 0.0;
+        int NumSamples = 0;
+
+        for (int z = 0; z < TEST_SIZE; z++) {
+            for (int x = 0; x < TEST_SIZE; x++) {
+                const Vector3f& n = Baked[z * TEST_SIZE + x];
+
+                if (isnan(n.x) || isnan(n.y) || isnan(n.z) || (fabsf(n.Length() - 1.0f) > 1e-4f) || (n.y <= 0.0f)) {
+                    printf("Invalid normal at %d %d: ", x, z);
+                    n.Print();
+                    exit(1);
+                }
+
+                // The one sided differences on the edges are less accurate
+                if ((x == 0) || (z == 0) || (x == TEST_SIZE - 1) || (z == TEST_SIZE - 1)) {
+                    continue;
+                }
+
+                Vector3f Exact = ExactNormal(x, z);
+
+                float BakedError = AngleInDegrees(n, Exact);
+                float FacesError = AngleInDegrees(Faces[z * TEST_SIZE + x], Exact);
+
+                MaxBakedError = (BakedError > MaxBakedError) ? BakedError : MaxBakedError;
+                MaxFacesError = (FacesError > MaxFacesError) ? FacesError : MaxFacesError;
+                SumBakedError += BakedError;
+                SumFacesError += FacesError;
+                NumSamples++;
+            }
+        }
+
+        double AvgBakedError = SumBakedError / NumSamples;
+        double AvgFacesError = SumFacesError / NumSamples;
+
+        printf("Angle error - baker max %f avg %f degrees, faces max %f avg %f degrees\n",
+               MaxBakedError, AvgBakedError, MaxFacesError, AvgFacesError);
+
+        if (MaxBakedError > MAX_ANGLE_ERROR) {
+            printf("The baked normals are too far from the exact normals\n");
+            exit(1);
+        }
+
+        if (AvgBakedError > AvgFacesError) {
+            printf("The baked normals are less accurate than the face normals\n");
+            exit(1);
+        }
+
+        // Same field through the Array2D overload
+        Array2D<float> HeightMap;
+        HeightMap.InitArray2D(TEST_SIZE, TEST_SIZE, 0.0f);
+
+        for (int z = 0; z < TEST_SIZE; z++) {
+            for (int x = 0; x < TEST_SIZE; x++) {
+                HeightMap.Set(x, z, Heights[z * TEST_SIZE + x]);
+            }
+        }
+
+        std::vector<Vector3f> Baked2;
+        BakeHeightFieldNormals(HeightMap, WORLD_SCALE, HEIGHT_SCALE, Baked2);
+
+        if (memcmp(Baked.data(), Baked2.data(), Baked.size() * sizeof(Vector3f)) != 0) {
+            printf("Mismatch between the normals of the Array2D and the raw heights\n");
+            exit(1);
+        }
+    }
+
+
+    void ValidateTangents()
+    {
+        std::vector<float> Heights;
+        CreateHeights(TEST_SIZE, Heights);
+
+        std::vector<Vector3f> Normals(Heights.size());
+        std::vector<Vector3f> Tangents(Heights.size());
+
+        BakeHeightFieldNormals(Heights.data(), TEST_SIZE, TEST_SIZE, WORLD_SCALE, HEIGHT_SCALE, Normals.data(), Tangents.data());
+
+        for (int i = 0; i < (int)Normals.size(); i++) {
+            if ((fabsf(Normals[i].Dot(Tangents[i])) > 1e-4f) || (fabsf(Tangents[i].Length() - 1.0f) > 1e-4f) || (Tangents[i].x <= 0.0f)) {
+                printf("Invalid tangent at %d\n", i);
+                exit(1);
+            }
+        }
+
+        // Degenerate maps
+        Vector3f Normal;
+        float Height = 1.0f;
+        BakeHeightFieldNormals(&Height, 1, 1, WORLD_SCALE, HEIGHT_SCALE, &Normal);
+
+        if ((Normal.x != 0.0f) || (Normal.y != 1.0f) || (Normal.z != 0.0f)) {
+            printf("Invalid normal of a single sample map\n");
+            exit(1);
+        }
+
+        printf("The tangents are valid\n");
+    }
+
+
+    // Returns the time in seconds
+    double Measure(bool UseFaces)
+    {
+        std::vector<float> Heights;
+        CreateHeights(BENCHMARK_SIZE, Heights);
+
+        std::vector<Vector3f> Normals(Heights.size());
+
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        if (UseFaces) {
+            BakeHeightFieldNormalsFromFaces(Heights.data(), BENCHMARK_SIZE, BENCHMARK_SIZE, WORLD_SCALE, HEIGHT_SCALE, Normals.data());
+        } else {
+            BakeHeightFieldNormals(Heights.data(), BENCHMARK_SIZE, BENCHMARK_SIZE, WORLD_SCALE, HEIGHT_SCALE, Normals.data());
+        }
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(End - Start).count();
+    }
+};
+
+
+void test_normal_baker()
+{
+    NormalBakerTest Test;
+    Test.Run();
+}
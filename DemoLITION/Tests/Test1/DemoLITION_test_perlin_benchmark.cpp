@@ -0,0 +1,192 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Perlin Noise Benchmark
+
+    Compares the parallel and vectorized Perlin height map generator with the
+    original serial one. Checks that the output doesn't depend on the number of
+    threads and that tiles of the infinite map match at the seams, then prints
+    the throughput in megapixels per second.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+#include "ogldev_thread_pool.h"
+#include "Services/perlin.h"
+
+
+#define BENCHMARK_SIZE 2048
+#define TILE_SIZE 256
+
+
+class PerlinBenchmark
+{
+public:
+
+    PerlinBenchmark()
+    {
+        m_config.octaves = 6;
+        m_config.scale = 200.0f;
+        m_config.seed = 17;
+    }
+
+
+    void Run()
+    {
+        ValidateReference();
+        ValidateThreads();
+        ValidateTiles();
+
+        PerlinConfig Config = m_config;
+        Config.width = BENCHMARK_SIZE;
+        Config.height = BENCHMARK_SIZE;
+
+        std::vector<float> HeightMap;
+
+        double ReferenceTime = Measure([&]() { CreatePerlinMapReference(Config, HeightMap); });
+
+        ThreadPool SingleWorker(1);
+        double TwoThreadsTime = Measure([&]() { CreatePerlinMap(Config, HeightMap, &SingleWorker); });
+
+        double DefaultTime = Measure([&]() { CreatePerlinMap(Config, HeightMap); });
+
+        std::vector<float> Tile;
+        double TileTime = Measure([&]() { CreatePerlinTile(Config, 100000, -50000, BENCHMARK_SIZE, BENCHMARK_SIZE, Tile); });
+
+        double MegaPixels = (double)BENCHMARK_SIZE * BENCHMARK_SIZE / 1000000.0;
+
+        printf("%dx%d, %d octaves\n", BENCHMARK_SIZE, BENCHMARK_SIZE, Config.octaves);
+        printf("Reference:           %8.2f ms, %7.2f MP/s\n", ReferenceTime * 1000.0, MegaPixels / ReferenceTime);
+        printf("Parallel, 2 threads: %8.2f ms, %7.2f MP/s\n", TwoThreadsTime * 1000.0, MegaPixels / TwoThreadsTime);
+        printf("Parallel, %d threads: %8.2f ms, %7.2f MP/s\n", ThreadPool::GetDefault().GetNumThreads() + 1, DefaultTime * 1000.0, MegaPixels / DefaultTime);
+        printf("Tile:                %8.2f ms, %7.2f MP/s\n", TileTime * 1000.0, MegaPixels / TileTime);
+        printf("Speedup %.2fx\n", ReferenceTime / DefaultTime);
+    }
+
+private:
+
+    void ValidateReference()
+    {
+        PerlinConfig Config = m_config;
+        Config.width = 517;     // not a multiple of the SIMD width
+        Config.height = 300;
+
+        std::vector<float> Reference, HeightMap;
+        CreatePerlinMapReference(Config, Reference);
+        CreatePerlinMap(Config, HeightMap);
+
+        // The vectorized kernel does the same operations as glm::perlin so the
+        // output must be bit-identical
+        for (int i = 0; i < (int)Reference.size(); i++) {
+            if (memcmp(&Reference[i], &HeightMap[i], sizeof(float)) != 0) {
+                printf("The Perlin map is different from the reference at %d,%d: %.9g vs %.9g\n",
+                       i % Config.width, i / Config.width, Reference[i], HeightMap[i]);
+                exit(1);
+            }
+        }
+
+        printf("The Perlin map matches the reference exactly\n");
+    }
+
+
+    void ValidateThreads()
+    {
+        PerlinConfig Config = m_config;
+        Config.width = 1000;
+        Config.height = 700;
+
+        std::vector<float> Default, One, Three;
+
+        ThreadPool OneWorker(1);
+        ThreadPool ThreeWorkers(3);
+
+        CreatePerlinMap(Config, Default);
+        CreatePerlinMap(Config, One, &OneWorker);
+        CreatePerlinMap(Config, Three, &ThreeWorkers);
+
+        if ((memcmp(Default.data(), One.data(), Default.size() * sizeof(float)) != 0) ||
+            (memcmp(Default.data(), Three.data(), Default.size() * sizeof(float)) != 0)) {
+            printf("The Perlin map depends on the number of threads\n");
+            exit(1);
+        }
+
+        printf("The Perlin map is the same for any number of threads\n");
+    }
+
+
+    // A 2x2 block of tiles must be identical to one big tile
+    void ValidateTiles()
+    {
+        int StartX = -3 * TILE_SIZE;
+        int StartY = 5 * TILE_SIZE + 3;
+
+        std::vector<float> Big;
+        CreatePerlinTile(m_config, StartX, StartY, 2 * TILE_SIZE, 2 * TILE_SIZE, Big);
+
+        float MinValue = 1.0f;
+        float MaxValue = 0.0f;
+
+        for (int TileY = 0; TileY < 2; TileY++) {
+            for (int TileX = 0; TileX < 2; TileX++) {
+                std::vector<float> Tile;
+                CreatePerlinTile(m_config, StartX + TileX * TILE_SIZE, StartY + TileY * TILE_SIZE, TILE_SIZE, TILE_SIZE, Tile);
+
+                for (int y = 0; y < TILE_SIZE; y++) {
+                    const float* pBigRow = &Big[(TileY * TILE_SIZE + y) * 2 * TILE_SIZE + TileX * TILE_SIZE];
+
+                    if (memcmp(&Tile[y * TILE_SIZE], pBigRow, TILE_SIZE * sizeof(float)) != 0) {
+                        printf("Tile %d,%d doesn't match the big tile at row %d\n", TileX, TileY, y);
+                        exit(1);
+                    }
+                }
+
+                for (float h : Tile) {
+                    MinValue = std::min(MinValue, h);
+                    MaxValue = std::max(MaxValue, h);
+                }
+            }
+        }
+
+        printf("The tiles match at the seams (range %f - %f)\n", MinValue, MaxValue);
+    }
+
+
+    // Returns the time in seconds
+    template<typename Func>
+    double Measure(Func f)
+    {
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        f();
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(End - Start).count();
+    }
+
+    PerlinConfig m_config;
+};
+
+
+void test_perlin_benchmark()
+{
+    PerlinBenchmark Benchmark;
+    Benchmark.Run();
+}
@@ -0,0 +1,153 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Point Light Shadows Test
+
+    A field of boxes with shadows from several moving point lights. The cube
+    maps are rendered alternately in a single layered pass per light and one
+    face at a time, and the submissions, draw calls and CPU time of the point
+    light shadow pass are printed for both.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "demolition.h"
+
+
+#define WINDOW_WIDTH  1920
+#define WINDOW_HEIGHT 1080
+
+#define NUM_POINT_LIGHTS 4
+#define GRID_SIZE 20
+#define GRID_SPACING 5.0f
+#define FRAMES_PER_REPORT 200
+
+
+class PointShadowsTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Point Light Shadows Test");
+
+        m_pScene = m_pRenderingSystem->CreateEmptyScene();
+        m_pScene->SetClearColor(Vector4f(0.0f, 0.0f, 0.0f, 0.0f));
+        m_pScene->GetConfig()->ControlShadowMapping(true);
+        m_pScene->SetCamera(Vector3f(0.0f, 30.0f, -60.0f), Vector3f(0.0f, -0.5f, 1.0f));
+        m_pScene->SetCameraSpeed(0.5f);
+        m_pRenderingSystem->SetScene(m_pScene);
+
+        InitObjects();
+
+        InitLights();
+    }
+
+
+    void Run()
+    {
+        m_pRenderingSystem->Execute();
+    }
+
+
+    void OnFrame(double DeltaTime)
+    {
+        m_time += (float)DeltaTime;
+
+        std::vector<PointLight>& PointLights = m_pScene->GetPointLights();
+
+        for (int i = 0; i < NUM_POINT_LIGHTS; i++) {
+            float Angle = m_time * 0.3f + i * 6.28f / NUM_POINT_LIGHTS;
+            PointLights[i].WorldPosition = Vector3f(15.0f * cosf(Angle), 6.0f, 15.0f * sinf(Angle));
+        }
+
+        // The stats are of the previous frame
+        SceneConfig* pConfig = m_pScene->GetConfig();
+        const PointShadowStats& Stats = pConfig->GetPointShadowStats();
+
+        m_total.NumCubeMaps += Stats.NumCubeMaps;
+        m_total.NumSubmissions += Stats.NumSubmissions;
+        m_total.NumDrawCalls += Stats.NumDrawCalls;
+        m_total.NumObjectFaces += Stats.NumObjectFaces;
+        m_total.CPUTimeMs += Stats.CPUTimeMs;
+        m_numFrames++;
+
+        if (m_numFrames == FRAMES_PER_REPORT) {
+            printf("%-10s: %d cube maps, %.1f submissions, %.1f draw calls, %.1f object faces, %.3f ms CPU per shadow update\n",
+                   pConfig->IsLayeredPointShadowsEnabled() ? "Layered" : "Per face",
+                   m_total.NumCubeMaps / m_numFrames,
+                   (float)m_total.NumSubmissions / m_numFrames,
+                   (float)m_total.NumDrawCalls / m_numFrames,
+                   (float)m_total.NumObjectFaces / m_numFrames,
+                   m_total.CPUTimeMs / m_numFrames);
+
+            pConfig->ControlLayeredPointShadows(!pConfig->IsLayeredPointShadowsEnabled());
+            m_total = PointShadowStats();
+            m_numFrames = 0;
+        }
+    }
+
+private:
+
+    void InitObjects()
+    {
+        Model* pBox = m_pRenderingSystem->LoadModel("../Content/box.obj");
+
+        float Offset = (GRID_SIZE - 1) * GRID_SPACING * 0.5f;
+
+        for (int z = 0; z < GRID_SIZE; z++) {
+            for (int x = 0; x < GRID_SIZE; x++) {
+                SceneObject* pSceneObject = m_pScene->CreateSceneObject(pBox);
+                pSceneObject->SetPosition(x * GRID_SPACING - Offset, 0.0f, z * GRID_SPACING - Offset);
+                pSceneObject->SetScale(2.0f, RandomFloatRange(0.5f, 4.0f), 2.0f);
+                m_pScene->AddToRenderList(pSceneObject);
+            }
+        }
+    }
+
+
+    void InitLights()
+    {
+        for (int i = 0; i < NUM_POINT_LIGHTS; i++) {
+            PointLight l;
+            l.Color = Vector3f(RandomFloatRange(0.5f, 1.0f), RandomFloatRange(0.5f, 1.0f), RandomFloatRange(0.5f, 1.0f));
+            l.DiffuseIntensity = 1.0f;
+            l.Attenuation.Constant = 1.0f;
+            l.Attenuation.Linear = 0.0f;
+            l.Attenuation.Exp = 0.01f;
+            m_pScene->GetPointLights().push_back(l);
+        }
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    Scene* m_pScene = NULL;
+    float m_time = 0.0f;
+    PointShadowStats m_total;
+    int m_numFrames = 0;
+};
+
+
+void test_point_shadows()
+{
+    PointShadowsTest App;
+    App.Init();
+    App.Run();
+}
@@ -0,0 +1,241 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Shadow Cascades Test
+
+    First validates the fitting of the cascades on random camera views: every
+    point of the camera frustum must be inside the projection of its cascade,
+    the projections must be aligned to the texels of the shadow map and their
+    size must not change when the camera rotates.
+
+    Then renders a long field of boxes with a directional light. The update
+    intervals of the cascades alternate between every frame and the defaults
+    and the shadow culling stats are printed for both.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "demolition.h"
+#include "Int/core_shadow_cascades.h"
+
+
+#define WINDOW_WIDTH  1920
+#define WINDOW_HEIGHT 1080
+
+#define NUM_CASCADES 4
+#define CASCADE_SIZE 2048
+#define Z_NEAR 0.1f
+#define Z_FAR 500.0f
+#define NUM_VIEWS 500
+#define NUM_POINTS_PER_VIEW 1000
+
+#define FIELD_WIDTH 10
+#define FIELD_LENGTH 100
+#define FIELD_SPACING 5.0f
+#define FRAMES_PER_REPORT 200
+
+
+class ShadowCascadesTest : public GameCallbacks
+{
+public:
+
+    void Init()
+    {
+        bool LoadBasicShapes = false;
+        m_pRenderingSystem = RenderingSystem::CreateRenderingSystem(RENDERING_SYSTEM_GL, this, LoadBasicShapes);
+        m_pRenderingSystem->CreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Shadow Cascades Test");
+
+        m_pScene = m_pRenderingSystem->CreateEmptyScene();
+        m_pScene->SetClearColor(Vector4f(0.0f, 0.0f, 0.0f, 0.0f));
+        m_pScene->GetConfig()->ControlShadowMapping(true);
+        m_pScene->GetConfig()->SetNumShadowCascades(NUM_CASCADES);
+        m_pScene->SetCamera(Vector3f(0.0f, 10.0f, -10.0f), Vector3f(0.0f, -0.2f, 1.0f));
+        m_pScene->SetCameraSpeed(0.5f);
+        m_pRenderingSystem->SetScene(m_pScene);
+
+        InitObjects();
+
+        DirectionalLight DirLight;
+        DirLight.WorldDirection = Vector3f(1.0f, -1.0f, 0.5f);
+        DirLight.DiffuseIntensity = 1.0f;
+        DirLight.AmbientIntensity = 0.1f;
+        m_pScene->GetDirLights().push_back(DirLight);
+    }
+
+
+    void Run()
+    {
+        Validate();
+
+        m_pRenderingSystem->Execute();
+    }
+
+
+    void OnFrame(double DeltaTime)
+    {
+        // The stats are of the previous frame
+        SceneConfig* pConfig = m_pScene->GetConfig();
+        const CullingStats& Stats = pConfig->GetShadowCullingStats();
+
+        m_total.NumViews += Stats.NumViews;
+        m_total.NumTested += Stats.NumTested;
+        m_total.NumSubmitted += Stats.NumSubmitted;
+        m_numFrames++;
+
+        if (m_numFrames == FRAMES_PER_REPORT) {
+            printf("%-17s: %.2f cascades rendered, %.1f objects submitted per frame\n",
+                   m_everyFrame ? "Every frame" : "Staggered updates",
+                   (float)m_total.NumViews / m_numFrames,
+                   (float)m_total.NumSubmitted / m_numFrames);
+
+            m_everyFrame = !m_everyFrame;
+
+            int DefaultIntervals[NUM_CASCADES] = { 1, 1, 2, 4 };
+
+            for (int i = 0; i < NUM_CASCADES; i++) {
+                pConfig->SetShadowCascadeUpdateInterval(i, m_everyFrame ? 1 : DefaultIntervals[i]);
+            }
+
+            m_total = CullingStats();
+            m_numFrames = 0;
+        }
+    }
+
+private:
+
+    void Validate()
+    {
+        glm::mat4 Projection = glm::perspectiveRH(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, Z_NEAR, Z_FAR);
+
+        float Splits[NUM_CASCADES + 1];
+        ShadowCascades::CalcSplits(Z_NEAR, Z_FAR, NUM_CASCADES, 0.75f, Splits);
+
+        int NumOutside = 0;
+        int NumNotSnapped = 0;
+        int NumSizeChanged = 0;
+
+        for (int v = 0; v < NUM_VIEWS; v++) {
+            glm::vec3 Pos(RandomFloatRange(-500.0f, 500.0f), RandomFloatRange(0.0f, 100.0f), RandomFloatRange(-500.0f, 500.0f));
+            glm::mat4 View = CreateRandomView(Pos);
+
+            // Straight down every few views to check the degenerate up vector
+            Vector3f LightDir(RandomFloatRange(-1.0f, 1.0f), RandomFloatRange(-1.0f, -0.1f), RandomFloatRange(-1.0f, 1.0f));
+
+            if (v % 10 == 0) {
+                LightDir = Vector3f(0.0f, -1.0f, 0.0f);
+            }
+
+            LightDir.Normalize();
+
+            ShadowCascades Cascades;
+            Cascades.Init(NUM_CASCADES, CASCADE_SIZE);
+
+            // Same position, another orientation
+            ShadowCascades RotatedCascades;
+            RotatedCascades.Init(NUM_CASCADES, CASCADE_SIZE);
+
+            for (int i = 0; i < NUM_CASCADES; i++) {
+                Cascades.Update(i, 0, Matrix4f(View), Matrix4f(Projection), Z_NEAR, Z_FAR, Splits[i], Splits[i + 1], LightDir, NULL);
+                RotatedCascades.Update(i, 0, Matrix4f(CreateRandomView(Pos)), Matrix4f(Projection), Z_NEAR, Z_FAR, Splits[i], Splits[i + 1], LightDir, NULL);
+
+                const ShadowCascades::Cascade& c = Cascades.GetCascade(i);
+
+                if (c.TexelSize != RotatedCascades.GetCascade(i).TexelSize) {
+                    NumSizeChanged++;
+                }
+
+                // The translation of the ortho projection is -(r + l) / (r - l) and the window is TexelSize * CASCADE_SIZE wide.
+                // Far from the origin the center is tens of thousands of texels so the float error is a few hundredths of a texel.
+                float Center = -c.LightProjection.m[0][3] * c.TexelSize * CASCADE_SIZE * 0.5f;
+                float NumTexels = Center / c.TexelSize;
+
+                if (fabsf(NumTexels - roundf(NumTexels)) > 0.05f) {
+                    NumNotSnapped++;
+                }
+            }
+
+            glm::mat4 InverseVP = glm::inverse(Projection * View);
+
+            for (int p = 0; p < NUM_POINTS_PER_VIEW; p++) {
+                glm::vec4 NDC(RandomFloatRange(-1.0f, 1.0f), RandomFloatRange(-1.0f, 1.0f), RandomFloatRange(-1.0f, 1.0f), 1.0f);
+                glm::vec4 WorldPos = InverseVP * NDC;
+                WorldPos /= WorldPos.w;
+
+                float ViewDepth = -(View * WorldPos).z;
+
+                int CascadeIndex = 0;
+
+                while ((CascadeIndex < NUM_CASCADES - 1) && (ViewDepth > Splits[CascadeIndex + 1])) {
+                    CascadeIndex++;
+                }
+
+                Vector4f LightPos = Cascades.GetCascade(CascadeIndex).LightVP * Vector4f(WorldPos.x, WorldPos.y, WorldPos.z, 1.0f);
+
+                if ((fabsf(LightPos.x) > 1.0001f) || (fabsf(LightPos.y) > 1.0001f) || (fabsf(LightPos.z) > 1.0001f)) {
+                    NumOutside++;
+                }
+            }
+        }
+
+        printf("Shadow cascades: %d points outside, %d cascades not snapped, %d size changes\n", NumOutside, NumNotSnapped, NumSizeChanged);
+
+        if ((NumOutside > 0) || (NumNotSnapped > 0) || (NumSizeChanged > 0)) {
+            printf("Shadow cascades validation failed\n");
+            exit(1);
+        }
+    }
+
+
+    glm::mat4 CreateRandomView(const glm::vec3& Pos)
+    {
+        glm::vec3 Dir(RandomFloatRange(-1.0f, 1.0f), RandomFloatRange(-0.9f, 0.9f), RandomFloatRange(-1.0f, 1.0f));
+        return glm::lookAtRH(Pos, Pos + glm::normalize(Dir), glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+
+    void InitObjects()
+    {
+        Model* pBox = m_pRenderingSystem->LoadModel("../Content/box.obj");
+
+        float Offset = (FIELD_WIDTH - 1) * FIELD_SPACING * 0.5f;
+
+        for (int z = 0; z < FIELD_LENGTH; z++) {
+            for (int x = 0; x < FIELD_WIDTH; x++) {
+                SceneObject* pSceneObject = m_pScene->CreateSceneObject(pBox);
+                pSceneObject->SetPosition(x * FIELD_SPACING - Offset, 0.0f, z * FIELD_SPACING);
+                pSceneObject->SetScale(1.0f, RandomFloatRange(0.5f, 4.0f), 1.0f);
+                m_pScene->AddToRenderList(pSceneObject);
+            }
+        }
+    }
+
+    RenderingSystem* m_pRenderingSystem = NULL;
+    Scene* m_pScene = NULL;
+    CullingStats m_total;
+    int m_numFrames = 0;
+    bool m_everyFrame = false;
+};
+
+
+void test_shadow_cascades()
+{
+    ShadowCascadesTest App;
+    App.Init();
+    App.Run();
+}
@@ -0,0 +1,170 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    DemoLITION - Terrain Clipmap Test
+
+    Checks the block selection of the terrain clipmap for several map sizes and
+    camera positions: every point of the map must be covered by exactly one block
+    and the vertices on the outer edge of a level must morph onto the grid of the
+    next level. Also prints the number of triangles vs. the full terrain grid.
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <random>
+
+#include "GL/gl_terrain_clipmap.h"
+
+
+#define NUM_CAMERAS 50
+#define NUM_SAMPLES 2000
+
+
+class TerrainClipmapTest
+{
+public:
+
+    void Run()
+    {
+        int Sizes[] = { 1024, 4096, 16384 };
+
+        for (int i = 0; i < ARRAY_SIZE_IN_ELEMENTS(Sizes); i++) {
+            TestMapSize(Sizes[i]);
+        }
+
+        printf("The terrain clipmap test passed\n");
+    }
+
+private:
+
+    void TestMapSize(int Size)
+    {
+        TerrainClipmap Clipmap(Size, Size);
+
+        std::uniform_real_distribution<float> Position(-Size / 2.0f, Size / 2.0f - 1.0f);
+        std::uniform_real_distribution<float> Height(0.0f, 3000.0f);
+
+        int MaxTriangles = 0;
+
+        for (int i = 0; i < NUM_CAMERAS; i++) {
+            // Start on the ground
+            Vector3f CameraPos(Position(m_generator), (i == 0) ? 0.0f : Height(m_generator), Position(m_generator));
+
+            Clipmap.SelectBlocks(CameraPos, NULL, HORIZONTAL_SCALE, MAX_HEIGHT);
+
+            CheckCoverage(Clipmap, i);
+            CheckMorph(Clipmap, i);
+
+            MaxTriangles = std::max(MaxTriangles, Clipmap.GetNumTriangles());
+        }
+
+        long long GridTriangles = (long long)(Size - 1) * (long long)(Size - 1) * 2;
+
+        printf("Map %dx%d: %d levels, up to %d triangles (full grid %lld)\n", 
+               Size, Size, Clipmap.GetNumLevels(), MaxTriangles, GridTriangles);
+    }
+
+
+    // Every point of the map must be inside exactly one block
+    void CheckCoverage(const TerrainClipmap& Clipmap, int CameraIndex)
+    {
+        float MapMin = -Clipmap.GetWidth() / 2.0f;
+        float MapMax = MapMin + (float)(Clipmap.GetWidth() - 1);
+
+        std::uniform_real_distribution<float> Position(MapMin, MapMax);
+
+        const std::vector<TerrainClipmap::Block>& Blocks = Clipmap.GetBlocks();
+
+        for (int i = 0; i < NUM_SAMPLES; i++) {
+            float x = Position(m_generator);
+            float z = Position(m_generator);
+
+            int Count = 0;
+
+            for (int b = 0; b < (int)Blocks.size(); b++) {
+                float Extent = Blocks[b].Scale * Clipmap.GetBlockSize();
+
+                if ((x >= Blocks[b].OriginX) && (x < Blocks[b].OriginX + Extent) &&
+                    (z >= Blocks[b].OriginZ) && (z < Blocks[b].OriginZ + Extent)) {
+                    Count++;
+                }
+            }
+
+            if (Count != 1) {
+                printf("Camera %d: the point %f,%f is covered by %d blocks\n", CameraIndex, x, z, Count);
+                exit(1);
+            }
+        }
+    }
+
+
+    // The vertices on the outer edge of a level must land on the vertices of the next level.
+    // This is the position calculation of terrain_clipmap.vs without the clamping to the map.
+    void CheckMorph(const TerrainClipmap& Clipmap, int CameraIndex)
+    {
+        int BlockSize = Clipmap.GetBlockSize();
+        int CoarsestLevel = Clipmap.GetCoarsestLevel();
+
+        for (const TerrainClipmap::Block& b : Clipmap.GetBlocks()) {
+            int Level = (int)b.Level;
+
+            if (Level == CoarsestLevel) {
+                continue;
+            }
+
+            const TerrainClipmap::Window& Window = Clipmap.GetLevelWindow(Level);
+
+            for (int z = 0; z <= BlockSize; z++) {
+                for (int x = 0; x <= BlockSize; x++) {
+                    float PosX = b.OriginX + x * b.Scale;
+                    float PosZ = b.OriginZ + z * b.Scale;
+
+                    float Dist = std::min(std::min(PosX - Window.MinX, PosZ - Window.MinZ),
+                                          std::min(Window.MaxX - PosX, Window.MaxZ - PosZ));
+
+                    if (Dist != 0.0f) {
+                        continue;
+                    }
+
+                    // Morph is one on the edge
+                    PosX -= (float)(x % 2) * b.Scale;
+                    PosZ -= (float)(z % 2) * b.Scale;
+
+                    float ParentScale = 2.0f * b.Scale;
+
+                    if ((fmodf(PosX, ParentScale) != 0.0f) || (fmodf(PosZ, ParentScale) != 0.0f)) {
+                        printf("Camera %d: vertex %f,%f of level %d is not on the grid of the next level\n",
+                               CameraIndex, PosX, PosZ, Level);
+                        exit(1);
+                    }
+                }
+            }
+        }
+    }
+
+    static constexpr float HORIZONTAL_SCALE = 4.0f;
+    static constexpr float MAX_HEIGHT = 500.0f;
+
+    std::mt19937 m_generator { 1234 };
+};
+
+
+void test_terrain_clipmap()
+{
+    TerrainClipmapTest Test;
+    Test.Run();
+}
@@ -11,6 +11,7 @@ source ../build_base.sh
 
 SOURCES="$ROOTDIR/Common/ogldev_util.cpp \
          $ROOTDIR/Common/math_3d.cpp \
+         $ROOTDIR/Common/ogldev_normal_baker.cpp \
 	 $ROOTDIR/Common/ogldev_texture.cpp \
 	 $ROOTDIR/Common/3rdparty/stb_image.cpp \
 	 $ROOTDIR/Common/ogldev_glm_camera.cpp \
@@ -0,0 +1,31 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OGLDEV_EGL_H
+#define OGLDEV_EGL_H
+
+//
+// Creates an OpenGL core context without a window through EGL (Linux only). Used by
+// the sandbox tests of the compute shaders which need to run on headless machines and
+// on software drivers (e.g. Mesa llvmpipe with LIBGL_ALWAYS_SOFTWARE=1). Requires
+// EGL_MESA_platform_surfaceless or a default display which supports EGL_KHR_surfaceless_context.
+// Exits on failure.
+//
+void egl_init_headless(int major_ver, int minor_ver);
+
+#endif
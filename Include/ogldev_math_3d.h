@@ -844,6 +844,9 @@ public:
     float MinZ = FLT_MAX;
     float MaxZ = -FLT_MAX;
 
+    // False until at least one point was added
+    bool IsValid() const { return (MinX <= MaxX) && (MinY <= MaxY) && (MinZ <= MaxZ); }
+
     void Print()
     {
         printf("X: [%f,%f]\n", MinX, MaxX);
@@ -947,6 +950,55 @@ public:
 };
 
 
+// A list of boxes stored as a structure of arrays for FrustumCulling::ClassifyAABBs
+class AABBArray
+{
+public:
+    AABBArray() {}
+
+    void Resize(int Size)
+    {
+        MinX.resize(Size);
+        MinY.resize(Size);
+        MinZ.resize(Size);
+        MaxX.resize(Size);
+        MaxY.resize(Size);
+        MaxZ.resize(Size);
+    }
+
+    void Set(int Index, const AABB& Box)
+    {
+        MinX[Index] = Box.MinX;
+        MinY[Index] = Box.MinY;
+        MinZ[Index] = Box.MinZ;
+        MaxX[Index] = Box.MaxX;
+        MaxY[Index] = Box.MaxY;
+        MaxZ[Index] = Box.MaxZ;
+    }
+
+    AABB Get(int Index) const
+    {
+        AABB Box;
+        Box.MinX = MinX[Index];
+        Box.MinY = MinY[Index];
+        Box.MinZ = MinZ[Index];
+        Box.MaxX = MaxX[Index];
+        Box.MaxY = MaxY[Index];
+        Box.MaxZ = MaxZ[Index];
+        return Box;
+    }
+
+    int Size() const { return (int)MinX.size(); }
+
+    std::vector<float> MinX;
+    std::vector<float> MinY;
+    std::vector<float> MinZ;
+    std::vector<float> MaxX;
+    std::vector<float> MaxY;
+    std::vector<float> MaxZ;
+};
+
+
 class FrustumCulling
 {
 public:
@@ -956,39 +1008,91 @@ public:
         Update(ViewProj);
     }
 
-    void Update(const Matrix4f& ViewProj)
+    void Update(const Matrix4f& ViewProj);
+
+    // Ignores the top and bottom planes like the original version of this test. The
+    // terrain demos check the corners of the patches with it and rely on that.
+    bool IsPointInsideViewFrustum(const Vector3f& p) const
     {
-        ViewProj.CalcClipPlanes(m_leftClipPlane,
-                                m_rightClipPlane,
-                                m_bottomClipPlane,
-                                m_topClipPlane,
-                                m_nearClipPlane,
-                                m_farClipPlane);
+        for (int i = 0; i < NUM_PLANES; i++) {
+            if ((i == BOTTOM_PLANE) || (i == TOP_PLANE)) {
+                continue;
+            }
+
+            if (DistanceToPlane(m_planes[i], p) < 0.0f) {
+                return false;
+            }
+        }
+
+        return true;
     }
 
-    bool IsPointInsideViewFrustum(const Vector3f& p) const
+    bool IsPointInsideViewFrustumAllPlanes(const Vector3f& p) const
+    {
+        for (int i = 0; i < NUM_PLANES; i++) {
+            if (DistanceToPlane(m_planes[i], p) < 0.0f) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Returns false only if the box is completely behind one of the planes. A box which
+    // is outside the frustum near one of its edges may still be reported as inside.
+    bool IsAABBInsideViewFrustum(const AABB& Box) const
     {
-        Vector4f p4D(p, 1.0f);
+        for (int i = 0; i < NUM_PLANES; i++) {
+            // Check the corner of the box which is the farthest along the plane normal
+            const Vector4f& Plane = m_planes[i];
+
+            Vector3f p((Plane.x >= 0.0f) ? Box.MaxX : Box.MinX,
+                       (Plane.y >= 0.0f) ? Box.MaxY : Box.MinY,
+                       (Plane.z >= 0.0f) ? Box.MaxZ : Box.MinZ);
 
-        bool Inside =
-            (m_leftClipPlane.Dot(p4D)   >= 0) &&
-            (m_rightClipPlane.Dot(p4D)  <= 0) &&
-         //   (m_topClipPlane.Dot(p4D)    <= 0) &&
-         //   (m_bottomClipPlane.Dot(p4D) >= 0) &&
-            (m_nearClipPlane.Dot(p4D)   >= 0) &&
-            (m_farClipPlane.Dot(p4D)    <= 0);
+            if (DistanceToPlane(Plane, p) < 0.0f) {
+                return false;
+            }
+        }
 
-        return Inside;
+        return true;
     }
 
+    // Same conservative test as the box version
+    bool IsSphereInsideViewFrustum(const Vector3f& Center, float Radius) const
+    {
+        for (int i = 0; i < NUM_PLANES; i++) {
+            if (DistanceToPlane(m_planes[i], Center) < -Radius) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Sets pVisible[i] to 1 if the box i is inside the frustum and to 0 otherwise.
+    // Returns the number of visible boxes. Uses AVX or SSE when available.
+    int ClassifyAABBs(const AABBArray& Boxes, unsigned char* pVisible) const;
+
+    // Reference implementation of ClassifyAABBs
+    int ClassifyAABBsScalar(const AABBArray& Boxes, unsigned char* pVisible) const;
+
+    // Left, right, bottom, top, near, far. The planes are normalized
+    // and their normals point into the frustum.
+    static const int NUM_PLANES = 6;
+    static const int BOTTOM_PLANE = 2;
+    static const int TOP_PLANE = 3;
+
+    const Vector4f& GetPlane(int i) const { return m_planes[i]; }
+
 private:
 
-    Vector4f m_leftClipPlane;
-    Vector4f m_rightClipPlane;
-    Vector4f m_bottomClipPlane;
-    Vector4f m_topClipPlane;
-    Vector4f m_nearClipPlane;
-    Vector4f m_farClipPlane;
+    static float DistanceToPlane(const Vector4f& Plane, const Vector3f& p)
+    {
+        return Plane.x * p.x + Plane.y * p.y + Plane.z * p.z + Plane.w;
+    }
+
+    Vector4f m_planes[NUM_PLANES];
 };
 
 void CalcTightLightProjection(const Matrix4f& CameraView,        // in
@@ -0,0 +1,55 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "ogldev_array_2d.h"
+
+//
+// Normals and tangents of a height field.
+//
+// The heights are row major (Width samples per row, Depth rows), the samples are
+// WorldScale apart and the heights are multiplied by HeightScale. The normals are
+// calculated by central differences (one sided on the edges) which is the limit
+// of averaging the face normals of the grid for a smooth field.
+//
+// The rows are processed in parallel by the default thread pool and the interior
+// of each row is vectorized with SSE2 when available.
+//
+
+// pNormals and pTangents (optional) must have room for Width * Depth elements.
+// The tangents are along +X (the direction of the texture U coordinate).
+void BakeHeightFieldNormals(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                            Vector3f* pNormals, Vector3f* pTangents = NULL);
+
+void BakeHeightFieldNormals(const Array2D<float>& Heights, float WorldScale, float HeightScale,
+                            std::vector<Vector3f>& Normals);
+
+// Width * Depth * 3 bytes of normals packed as N * 0.5 + 0.5 for an RGB8 texture.
+// Y is up (the normals are in the space of the terrain, not tangent space).
+void BakeNormalMap(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                   std::vector<unsigned char>& NormalMap);
+
+// The normals of the triangles of the grid accumulated into their vertices, using the
+// triangle fans of the geomipmapping grid (Width and Depth must be odd). This is how
+// GeomipGrid used to calculate its normals and it is kept for testing.
+void BakeHeightFieldNormalsFromFaces(const float* pHeights, int Width, int Depth, float WorldScale, float HeightScale,
+                                     Vector3f* pNormals);
@@ -0,0 +1,198 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// A simple pool of worker threads.
+//
+// Submit() queues a single job and returns a future for it.
+// ParallelFor() splits a range into batches and blocks until all of them
+// are done. The calling thread works on the batches as well so it is safe to
+// call ParallelFor() from inside a job (it will simply run on fewer threads).
+//
+// The jobs must not make any OpenGL calls since the context is only current
+// on the main thread.
+//
+class ThreadPool
+{
+public:
+    // Zero means one thread per core minus the calling thread
+    ThreadPool(int NumThreads = 0)
+    {
+        if (NumThreads <= 0) {
+            NumThreads = (int)std::thread::hardware_concurrency() - 1;
+        }
+
+        for (int i = 0; i < NumThreads; i++) {
+            m_threads.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_mutex);
+            m_quit = true;
+        }
+
+        m_cond.notify_all();
+
+        for (std::thread& t : m_threads) {
+            t.join();
+        }
+    }
+
+    // Shared by all the users of the framework
+    static ThreadPool& GetDefault()
+    {
+        static ThreadPool DefaultPool;
+        return DefaultPool;
+    }
+
+    int GetNumThreads() const { return (int)m_threads.size(); }
+
+    template<typename Func>
+    std::future<void> Submit(Func&& Job)
+    {
+        auto pTask = std::make_shared<std::packaged_task<void()>>(std::forward<Func>(Job));
+
+        std::future<void> Future = pTask->get_future();
+
+        if (m_threads.empty()) {
+            (*pTask)();
+        } else {
+            Enqueue([pTask]() { (*pTask)(); });
+        }
+
+        return Future;
+    }
+
+    // Calls Func(Start, End) on consecutive sub-ranges of [0, Count) of up to
+    // BatchSize elements. Every element is processed exactly once, the order
+    // between the batches is undefined.
+    void ParallelFor(int Count, int BatchSize, const std::function<void(int Start, int End)>& Func)
+    {
+        if (Count <= 0) {
+            return;
+        }
+
+        BatchSize = std::max(BatchSize, 1);
+
+        int NumBatches = (Count + BatchSize - 1) / BatchSize;
+
+        if ((NumBatches == 1) || m_threads.empty()) {
+            Func(0, Count);
+            return;
+        }
+
+        // The helpers may be dequeued after we return (when all the batches have already
+        // been taken) so the state they touch must outlive this function. They never call
+        // Func in that case.
+        struct SharedState {
+            std::atomic<int> NextBatch { 0 };
+            std::atomic<int> DoneBatches { 0 };
+            std::mutex Mutex;
+            std::condition_variable Cond;
+        };
+
+        std::shared_ptr<SharedState> pState = std::make_shared<SharedState>();
+
+        const std::function<void(int, int)>* pFunc = &Func;
+
+        auto RunBatches = [pState, pFunc, Count, BatchSize, NumBatches]() {
+            int Batch;
+
+            while ((Batch = pState->NextBatch.fetch_add(1)) < NumBatches) {
+                int Start = Batch * BatchSize;
+                int End = std::min(Start + BatchSize, Count);
+
+                (*pFunc)(Start, End);
+
+                if (pState->DoneBatches.fetch_add(1) + 1 == NumBatches) {
+                    std::lock_guard<std::mutex> Lock(pState->Mutex);
+                    pState->Cond.notify_all();
+                }
+            }
+        };
+
+        int NumHelpers = std::min(NumBatches - 1, GetNumThreads());
+
+        for (int i = 0; i < NumHelpers; i++) {
+            Enqueue(RunBatches);
+        }
+
+        RunBatches();
+
+        std::unique_lock<std::mutex> Lock(pState->Mutex);
+        pState->Cond.wait(Lock, [&pState, NumBatches]() { return pState->DoneBatches.load() == NumBatches; });
+    }
+
+private:
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Enqueue(std::function<void()> Job)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_mutex);
+            m_jobs.push_back(std::move(Job));
+        }
+
+        m_cond.notify_one();
+    }
+
+    void WorkerLoop()
+    {
+        while (true) {
+            std::function<void()> Job;
+
+            {
+                std::unique_lock<std::mutex> Lock(m_mutex);
+                m_cond.wait(Lock, [this]() { return m_quit || !m_jobs.empty(); });
+
+                if (m_quit && m_jobs.empty()) {
+                    return;
+                }
+
+                Job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            Job();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_quit = false;
+};
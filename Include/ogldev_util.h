@@ -41,6 +41,42 @@ char* ReadBinaryFile(const char* pFileName, int& size);
 
 void WriteBinaryFile(const char* pFilename, const void* pData, int size);
 
+// Read-only memory mapping of an entire file. The mapping is released
+// by Close() or when the object goes out of scope.
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile() {}
+
+    ~MemoryMappedFile() { Close(); }
+
+    bool Open(const char* pFilename);
+
+    void Close();
+
+    const char* GetData() const { return m_pData; }
+
+    size_t GetSize() const { return m_size; }
+
+    // Drops the pages of the range from the resident set of the process. They
+    // are read again from the file on the next access.
+    void Evict(size_t Offset, size_t Size) const;
+
+private:
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    const char* m_pData = NULL;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_hFile = NULL;
+    void* m_hMapping = NULL;
+#endif
+};
+
+// 64 bit FNV-1a hash
+u64 HashBuffer(const void* pData, size_t Size, u64 Seed = 0xcbf29ce484222325ULL);
+
 void OgldevError(const char* pFileName, uint line, const char* msg, ... );
 void OgldevFileError(const char* pFileName, uint line, const char* pFileError);
 
@@ -35,6 +35,7 @@ public:
     float GetPenetration() const { return m_penetration; }
     void SetPenetration(float Penetration) { m_penetration = Penetration; }
 
+    float GetRestitution() const { return m_restitution; }
     void SetRestitution(float Restitution) { m_restitution = Restitution; }
 
     void Resolve(float dt);
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <vector>
 
 namespace OgldevPhysics
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "ogldev_types.h"
+#include "particle_store.h"
 #include "particle.h"
 #include "firework.h"
 #include "gravity_force_generator.h"
@@ -33,12 +34,18 @@
 #include "buoyancy_force_generator.h"
 #include "fake_spring_force_generator.h"
 #include "contact_resolver.h"
+#include "sequential_impulse_solver.h"
 
 namespace OgldevPhysics
 {
 
 const static Vector3f GRAVITY = Vector3f(0.0f, -9.81f, 0.0f);
 
+enum CONTACT_SOLVER {
+    CONTACT_SOLVER_WORST_FIRST,         // ParticleContactResolver
+    CONTACT_SOLVER_SEQUENTIAL_IMPULSE   // SequentialImpulseSolver
+};
+
 class PhysicsSystem {
 
 public:
@@ -46,10 +53,17 @@ public:
 
     ~PhysicsSystem() {}
 
-    void Init(uint NumParticles, uint MaxContacts, uint Iterations);
+    // Iterations zero means automatic (twice the number of contacts for the worst
+    // first resolver and a fixed number of sweeps for the sequential impulse solver)
+    void Init(uint NumParticles, uint MaxContacts, uint Iterations, CONTACT_SOLVER ContactSolver = CONTACT_SOLVER_WORST_FIRST);
 
     Particle* AllocParticle();
 
+    Particle* GetParticle(ParticleHandle Handle) { return &m_particles[Handle]; }
+
+    // Direct access to the particles, e.g. for effects which allocate many particles by handle
+    ParticleStore& GetParticleStore() { return m_particleStore; }
+
     Firework* AllocFirework();
 
     void Update(double DeltaTime);
@@ -71,16 +85,19 @@ private:
 
     uint GenerateContacts();
 
-    std::vector<Particle> m_particles;
-    std::vector<Firework> m_fireworks;
+    ParticleStore m_particleStore;
+    ParticleStore m_fireworkStore;
+    std::vector<Particle> m_particles;      // views of m_particleStore
+    std::vector<Firework> m_fireworks;      // views of m_fireworkStore
     std::vector<FireworkConfig> m_fireworkConfigs;
     std::vector<ParticleContactGenerator*> m_contactGenerators;
     std::vector<ParticleContact> m_contacts;
 
     ForceRegistry m_forceRegistry;
     ParticleContactResolver m_resolver;
+    SequentialImpulseSolver m_sequentialImpulseSolver;
+    CONTACT_SOLVER m_contactSolver = CONTACT_SOLVER_WORST_FIRST;
 
-    uint m_numParticles = 0;
     uint m_numFireworks = 0;
     uint m_nextFirework = 0; 
     uint m_numContactGenerators = 0;
@@ -22,54 +22,58 @@
 #include <assert.h>
 
 #include "ogldev_math_3d.h"
+#include "particle_store.h"
 
 namespace OgldevPhysics
 {
 
+//
+// A view of a single particle in a ParticleStore. It must be bound to a
+// store before it is used. The data itself lives in the store so the
+// getters return copies.
+//
 class Particle {
 
 public:
 
-    const Vector3f& GetPosition() const { return m_position; }
-    void SetPosition(const Vector3f& Position) { m_position = Position; }    
-    void SetPosition(float x, float y, float z) { m_position.x = x; m_position.y = y; m_position.z = z; }
+    void Bind(ParticleStore* pStore, ParticleHandle Handle) { m_pStore = pStore; m_handle = Handle; }
+
+    ParticleHandle GetHandle() const { return m_handle; }
+
+    Vector3f GetPosition() const { return m_pStore->GetPosition(m_handle); }
+    void SetPosition(const Vector3f& Position) { m_pStore->SetPosition(m_handle, Position); }
+    void SetPosition(float x, float y, float z) { m_pStore->SetPosition(m_handle, Vector3f(x, y, z)); }
 
     float GetMass() const;
     void SetMass(float Mass);
 
-    float GetReciprocalMass() const { return m_reciprocalMass; }
-    void SetReciprocalMass(float ReciprocalMass) { m_reciprocalMass = ReciprocalMass; }
+    float GetReciprocalMass() const { return m_pStore->GetReciprocalMass(m_handle); }
+    void SetReciprocalMass(float ReciprocalMass) { m_pStore->SetReciprocalMass(m_handle, ReciprocalMass); }
 
-    const Vector3f& GetVelocity() const { return m_velocity; }
+    Vector3f GetVelocity() const { return m_pStore->GetVelocity(m_handle); }
     void SetVelocity(const Vector3f& Velocity) 
     { 
-        m_velocity = Velocity; 
+        m_pStore->SetVelocity(m_handle, Velocity);
       //  printf("velocity y %f\n", Velocity.y);
     }
 
-    const Vector3f& GetAcceleration() const { return m_acceleration; }
-    void SetAcceleration(const Vector3f& Acceleration) { m_acceleration = Acceleration; }
+    Vector3f GetAcceleration() const { return m_pStore->GetAcceleration(m_handle); }
+    void SetAcceleration(const Vector3f& Acceleration) { m_pStore->SetAcceleration(m_handle, Acceleration); }
 
-    void SetDamping(float Damping) { m_damping = Damping; }
+    void SetDamping(float Damping) { m_pStore->SetDamping(m_handle, Damping); }
 
-    void Integrate(float dt);
+    void Integrate(float dt) { m_pStore->Integrate(m_handle, dt); }
 
-    void AddForce(const Vector3f& Force) { m_forceAccum += Force; }
+    void AddForce(const Vector3f& Force) { m_pStore->AddForce(m_handle, Force); }
 
-    bool HasFiniteMass() const { return (m_reciprocalMass >= 0.0f); }
+    bool HasFiniteMass() const { return (GetReciprocalMass() >= 0.0f); }
 
-    void ClearAccum();
+    void ClearAccum() { m_pStore->ClearForce(m_handle); }
 
 protected:    
 
-    Vector3f m_position = Vector3f(0.0f, 0.0f, 0.0f);
-    Vector3f m_velocity = Vector3f(0.0f, 0.0f, 0.0f);
-    Vector3f m_acceleration = Vector3f(0.0f, 0.0f, 0.0f);
-
-    Vector3f m_forceAccum = Vector3f(0.0f, 0.0f, 0.0f);
-
-    float m_damping = 0.999f;
-    float m_reciprocalMass = 0.0f;
+    ParticleStore* m_pStore = NULL;
+    ParticleHandle m_handle = 0;
 };
 
 
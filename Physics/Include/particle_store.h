@@ -0,0 +1,99 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "ogldev_types.h"
+#include "ogldev_math_3d.h"
+
+namespace OgldevPhysics
+{
+
+typedef uint ParticleHandle;
+
+//
+// Structure of arrays storage for the particles of the physics system.
+// Every component is kept in its own array so that Integrate() and
+// ClearForces() can process four particles at a time. The Particle class
+// is a view of a single particle in the store.
+//
+class ParticleStore {
+
+public:
+
+    ParticleStore() {}
+
+    void Init(uint MaxParticles);
+
+    ParticleHandle Alloc();
+
+    uint GetNumParticles() const { return m_numParticles; }
+
+    uint GetMaxParticles() const { return (uint)m_posX.size(); }
+
+    Vector3f GetPosition(ParticleHandle h) const { return Vector3f(m_posX[h], m_posY[h], m_posZ[h]); }
+    void SetPosition(ParticleHandle h, const Vector3f& Position) { m_posX[h] = Position.x; m_posY[h] = Position.y; m_posZ[h] = Position.z; }
+
+    Vector3f GetVelocity(ParticleHandle h) const { return Vector3f(m_velX[h], m_velY[h], m_velZ[h]); }
+    void SetVelocity(ParticleHandle h, const Vector3f& Velocity) { m_velX[h] = Velocity.x; m_velY[h] = Velocity.y; m_velZ[h] = Velocity.z; }
+
+    Vector3f GetAcceleration(ParticleHandle h) const { return Vector3f(m_accelX[h], m_accelY[h], m_accelZ[h]); }
+    void SetAcceleration(ParticleHandle h, const Vector3f& Accel) { m_accelX[h] = Accel.x; m_accelY[h] = Accel.y; m_accelZ[h] = Accel.z; }
+
+    void AddForce(ParticleHandle h, const Vector3f& Force) { m_forceX[h] += Force.x; m_forceY[h] += Force.y; m_forceZ[h] += Force.z; }
+    void ClearForce(ParticleHandle h) { m_forceX[h] = 0.0f; m_forceY[h] = 0.0f; m_forceZ[h] = 0.0f; }
+
+    float GetReciprocalMass(ParticleHandle h) const { return m_reciprocalMass[h]; }
+    void SetReciprocalMass(ParticleHandle h, float ReciprocalMass) { m_reciprocalMass[h] = ReciprocalMass; }
+
+    float GetDamping(ParticleHandle h) const { return m_damping[h]; }
+    void SetDamping(ParticleHandle h, float Damping);
+
+    // Integrates all the allocated particles and clears their forces
+    void Integrate(float dt);
+
+    // Integrates a single particle exactly like Integrate()
+    void Integrate(ParticleHandle h, float dt);
+
+    // Scalar version of Integrate() for validation and benchmarking
+    void IntegrateReference(float dt);
+
+    void ClearForces();
+
+private:
+
+    void UpdateDampingPow(float dt);
+
+    std::vector<float> m_posX, m_posY, m_posZ;
+    std::vector<float> m_velX, m_velY, m_velZ;
+    std::vector<float> m_accelX, m_accelY, m_accelZ;
+    std::vector<float> m_forceX, m_forceY, m_forceZ;
+    std::vector<float> m_reciprocalMass;
+    std::vector<float> m_damping;
+
+    // powf(m_damping, m_dampingPowDt) - only recalculated when the time step changes
+    std::vector<float> m_dampingPow;
+    float m_dampingPowDt = 0.0f;
+
+    uint m_numParticles = 0;
+};
+
+}
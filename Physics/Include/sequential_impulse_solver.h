@@ -0,0 +1,105 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include "ogldev_math_3d.h"
+#include "particle.h"
+#include "contact_resolver.h"
+
+namespace OgldevPhysics
+{
+
+//
+// Alternative to ParticleContactResolver. Instead of looking for the worst
+// contact on every iteration it sweeps all the contacts (Gauss-Seidel) with
+// accumulated impulses, first on the velocities and then on the positions.
+// The impulses of the previous frame are used as a starting point (warm
+// starting) so that long chains of rods and cables converge quickly.
+//
+class SequentialImpulseSolver {
+
+public:
+
+    SequentialImpulseSolver() {}
+
+    // Zero means the default number of iterations
+    void Init(int Iterations);
+
+    void SetIterations(int Iterations) { m_iterations = Iterations; }
+
+    void ResolveContacts(std::vector<ParticleContact>& ContactArray, uint NumContacts, float dt);
+
+private:
+
+    void GatherBodies(std::vector<ParticleContact>& ContactArray, uint NumContacts, float dt);
+
+    void WarmStart();
+
+    void SolveVelocities();
+
+    void SolvePositions();
+
+    void ScatterBodies();
+
+    struct SolverContact {
+        int Body[2];                // the second one is -1 for contacts with the world
+        Vector3f Normal;
+        float Penetration = 0.0f;
+        float EffectiveMass = 0.0f; // 1 / (the sum of the reciprocal masses)
+        float TargetVelocity = 0.0f;
+        float Impulse = 0.0f;
+    };
+
+    struct SolverBody {
+        Particle* pParticle = NULL;
+        Vector3f Velocity;
+        Vector3f Move;
+        float ReciprocalMass = 0.0f;
+    };
+
+    struct CachedImpulse {
+        Vector3f Normal;
+        float Impulse = 0.0f;
+    };
+
+    struct ContactKey {
+        const Particle* p0;
+        const Particle* p1;
+
+        bool operator==(const ContactKey& Other) const { return (p0 == Other.p0) && (p1 == Other.p1); }
+    };
+
+    struct ContactKeyHash {
+        size_t operator()(const ContactKey& Key) const
+        {
+            return std::hash<const void*>()(Key.p0) ^ (std::hash<const void*>()(Key.p1) * 31);
+        }
+    };
+
+    int m_iterations = 0;
+    std::vector<SolverContact> m_contacts;
+    std::vector<SolverBody> m_bodies;
+    std::unordered_map<const Particle*, int> m_bodyIndex;
+    std::unordered_map<ContactKey, CachedImpulse, ContactKeyHash> m_prevCache;
+};
+
+}
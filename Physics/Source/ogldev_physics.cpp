@@ -23,17 +23,31 @@
 namespace OgldevPhysics
 {
 
-void PhysicsSystem::Init(uint NumObjects, uint MaxContacts, uint Iterations)
+void PhysicsSystem::Init(uint NumObjects, uint MaxContacts, uint Iterations, CONTACT_SOLVER ContactSolver)
 {
+    m_particleStore.Init(NumObjects);
     m_particles.resize(NumObjects);
-    m_numParticles = 0;
 
+    for (uint i = 0; i < NumObjects; i++) {
+        m_particles[i].Bind(&m_particleStore, i);
+    }
+
+    // The fireworks are integrated separately by FireworkUpdate()
+    m_fireworkStore.Init(NumObjects);
     m_fireworks.resize(NumObjects);
+
+    for (uint i = 0; i < NumObjects; i++) {
+        m_fireworks[i].Bind(&m_fireworkStore, m_fireworkStore.Alloc());
+    }
+
     m_numFireworks = 0;
 
     InitFireworksConfig();
 
+    m_contactSolver = ContactSolver;
+
     m_resolver.Init(Iterations);
+    m_sequentialImpulseSolver.Init(Iterations);
 
     m_contacts.resize(MaxContacts);
 
@@ -45,13 +59,9 @@ void PhysicsSystem::Init(uint NumObjects, uint MaxContacts, uint Iterations)
 
 Particle* PhysicsSystem::AllocParticle()
 {
-    if (m_numParticles == m_particles.size()) {
-        printf("%s:%d - exceeded max number of particles\n", __FILE__, __LINE__);
-        exit(1);
-    }
+    ParticleHandle Handle = m_particleStore.Alloc();
 
-    Particle* ret = &m_particles[m_numParticles];
-    m_numParticles++;
+    Particle* ret = &m_particles[Handle];
 
     return ret;
 }
@@ -88,20 +98,22 @@ void PhysicsSystem::Update(double DeltaTime)
     uint UsedContacts = GenerateContacts();
    // printf("used contacts %d\n", UsedContacts);
     if (UsedContacts) {
-        if (m_calcIters) {
-            m_resolver.SetIterations(UsedContacts * 2);
-        }
+        if (m_contactSolver == CONTACT_SOLVER_SEQUENTIAL_IMPULSE) {
+            m_sequentialImpulseSolver.ResolveContacts(m_contacts, UsedContacts, dt);
+        } else {
+            if (m_calcIters) {
+                m_resolver.SetIterations(UsedContacts * 2);
+            }
 
-        m_resolver.ResolveContacts(m_contacts, UsedContacts, dt);
+            m_resolver.ResolveContacts(m_contacts, UsedContacts, dt);
+        }
     }
 }
 
 
 void PhysicsSystem::ParticleUpdate(float dt)
 {
-    for (uint i = 0; i < m_numParticles; i++) {
-        m_particles[i].Integrate(dt);
-    }
+    m_particleStore.Integrate(dt);
 }
 
 
@@ -137,9 +149,7 @@ void PhysicsSystem::FireworkUpdate(float dt)
 
 void PhysicsSystem::StartFrame()
 {
-    for (uint i = 0; i < m_numParticles; i++) {
-        m_particles[i].ClearAccum(); // Also called from Particle::Integrate !!!
-    }
+    m_particleStore.ClearForces(); // Also done by ParticleStore::Integrate !!!
 }
 
 
@@ -0,0 +1,204 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "particle_store.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PARTICLE_STORE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace OgldevPhysics
+{
+
+void ParticleStore::Init(uint MaxParticles)
+{
+    m_posX.assign(MaxParticles, 0.0f);
+    m_posY.assign(MaxParticles, 0.0f);
+    m_posZ.assign(MaxParticles, 0.0f);
+    m_velX.assign(MaxParticles, 0.0f);
+    m_velY.assign(MaxParticles, 0.0f);
+    m_velZ.assign(MaxParticles, 0.0f);
+    m_accelX.assign(MaxParticles, 0.0f);
+    m_accelY.assign(MaxParticles, 0.0f);
+    m_accelZ.assign(MaxParticles, 0.0f);
+    m_forceX.assign(MaxParticles, 0.0f);
+    m_forceY.assign(MaxParticles, 0.0f);
+    m_forceZ.assign(MaxParticles, 0.0f);
+    m_reciprocalMass.assign(MaxParticles, 0.0f);
+    m_damping.assign(MaxParticles, 0.999f);
+
+    m_dampingPowDt = 0.0f;
+    m_dampingPow.assign(MaxParticles, 1.0f);
+
+    m_numParticles = 0;
+}
+
+
+ParticleHandle ParticleStore::Alloc()
+{
+    if (m_numParticles == GetMaxParticles()) {
+        printf("%s:%d - exceeded max number of particles\n", __FILE__, __LINE__);
+        exit(1);
+    }
+
+    ParticleHandle ret = m_numParticles;
+    m_numParticles++;
+
+    // The slot may be allocated after the first Integrate() so the cached damping must
+    // match the current time step (SetDamping() does the same)
+    m_dampingPow[ret] = powf(m_damping[ret], m_dampingPowDt);
+
+    return ret;
+}
+
+
+void ParticleStore::SetDamping(ParticleHandle h, float Damping)
+{
+    m_damping[h] = Damping;
+    m_dampingPow[h] = powf(Damping, m_dampingPowDt);
+}
+
+
+void ParticleStore::UpdateDampingPow(float dt)
+{
+    // Most of the particles share the same damping so we only call powf when it changes
+    float LastDamping = 1.0f;
+    float LastPow = 1.0f;
+
+    for (uint i = 0; i < m_numParticles; i++) {
+        if (m_damping[i] != LastDamping) {
+            LastDamping = m_damping[i];
+            LastPow = powf(LastDamping, dt);
+        }
+
+        m_dampingPow[i] = LastPow;
+    }
+
+    m_dampingPowDt = dt;
+}
+
+
+void ParticleStore::Integrate(float dt)
+{
+    if (dt != m_dampingPowDt) {
+        UpdateDampingPow(dt);
+    }
+
+    uint i = 0;
+
+#ifdef PARTICLE_STORE_SSE2
+    __m128 dt4 = _mm_set1_ps(dt);
+    __m128 Zero = _mm_setzero_ps();
+
+    for ( ; i + 4 <= m_numParticles; i += 4) {
+        // Particles with an infinite mass are not moved
+        __m128 ReciprocalMass = _mm_loadu_ps(&m_reciprocalMass[i]);
+        __m128 Mask = _mm_cmpgt_ps(ReciprocalMass, Zero);
+        __m128 DampingPow = _mm_loadu_ps(&m_dampingPow[i]);
+
+        float* pPos[3] = { &m_posX[i], &m_posY[i], &m_posZ[i] };
+        float* pVel[3] = { &m_velX[i], &m_velY[i], &m_velZ[i] };
+        float* pAccel[3] = { &m_accelX[i], &m_accelY[i], &m_accelZ[i] };
+        float* pForce[3] = { &m_forceX[i], &m_forceY[i], &m_forceZ[i] };
+
+        for (int c = 0; c < 3; c++) {
+            __m128 Pos = _mm_loadu_ps(pPos[c]);
+            __m128 Vel = _mm_loadu_ps(pVel[c]);
+            __m128 Accel = _mm_add_ps(_mm_loadu_ps(pAccel[c]), _mm_mul_ps(_mm_loadu_ps(pForce[c]), ReciprocalMass));
+
+            __m128 NewPos = _mm_add_ps(Pos, _mm_mul_ps(Vel, dt4));
+            __m128 NewVel = _mm_mul_ps(_mm_add_ps(Vel, _mm_mul_ps(Accel, dt4)), DampingPow);
+
+            _mm_storeu_ps(pPos[c], _mm_or_ps(_mm_and_ps(Mask, NewPos), _mm_andnot_ps(Mask, Pos)));
+            _mm_storeu_ps(pVel[c], _mm_or_ps(_mm_and_ps(Mask, NewVel), _mm_andnot_ps(Mask, Vel)));
+            _mm_storeu_ps(pForce[c], Zero);
+        }
+    }
+#endif
+
+    for ( ; i < m_numParticles; i++) {
+        if (m_reciprocalMass[i] > 0.0f) {
+            m_posX[i] += m_velX[i] * dt;
+            m_posY[i] += m_velY[i] * dt;
+            m_posZ[i] += m_velZ[i] * dt;
+
+            m_velX[i] = (m_velX[i] + (m_accelX[i] + m_forceX[i] * m_reciprocalMass[i]) * dt) * m_dampingPow[i];
+            m_velY[i] = (m_velY[i] + (m_accelY[i] + m_forceY[i] * m_reciprocalMass[i]) * dt) * m_dampingPow[i];
+            m_velZ[i] = (m_velZ[i] + (m_accelZ[i] + m_forceZ[i] * m_reciprocalMass[i]) * dt) * m_dampingPow[i];
+        }
+
+        ClearForce(i);
+    }
+}
+
+
+void ParticleStore::Integrate(ParticleHandle h, float dt)
+{
+    if (m_reciprocalMass[h] <= 0.0f) {
+        return;
+    }
+
+    float DampingPow = powf(m_damping[h], dt);
+
+    m_posX[h] += m_velX[h] * dt;
+    m_posY[h] += m_velY[h] * dt;
+    m_posZ[h] += m_velZ[h] * dt;
+
+    m_velX[h] = (m_velX[h] + (m_accelX[h] + m_forceX[h] * m_reciprocalMass[h]) * dt) * DampingPow;
+    m_velY[h] = (m_velY[h] + (m_accelY[h] + m_forceY[h] * m_reciprocalMass[h]) * dt) * DampingPow;
+    m_velZ[h] = (m_velZ[h] + (m_accelZ[h] + m_forceZ[h] * m_reciprocalMass[h]) * dt) * DampingPow;
+
+    ClearForce(h);
+}
+
+
+void ParticleStore::IntegrateReference(float dt)
+{
+    for (uint i = 0; i < m_numParticles; i++) {
+        Integrate(i, dt);
+    }
+}
+
+
+void ParticleStore::ClearForces()
+{
+    uint i = 0;
+
+#ifdef PARTICLE_STORE_SSE2
+    __m128 Zero = _mm_setzero_ps();
+
+    for ( ; i + 4 <= m_numParticles; i += 4) {
+        _mm_storeu_ps(&m_forceX[i], Zero);
+        _mm_storeu_ps(&m_forceY[i], Zero);
+        _mm_storeu_ps(&m_forceZ[i], Zero);
+    }
+#endif
+
+    for ( ; i < m_numParticles; i++) {
+        ClearForce(i);
+    }
+}
+
+}
@@ -0,0 +1,231 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "sequential_impulse_solver.h"
+
+#define DEFAULT_ITERATIONS 10
+
+namespace OgldevPhysics
+{
+
+void SequentialImpulseSolver::Init(int Iterations)
+{
+    SetIterations(Iterations);
+}
+
+
+void SequentialImpulseSolver::ResolveContacts(std::vector<ParticleContact>& ContactArray, uint NumContacts, float dt)
+{
+    GatherBodies(ContactArray, NumContacts, dt);
+
+    WarmStart();
+
+    SolveVelocities();
+
+    SolvePositions();
+
+    ScatterBodies();
+}
+
+
+void SequentialImpulseSolver::GatherBodies(std::vector<ParticleContact>& ContactArray, uint NumContacts, float dt)
+{
+    m_bodies.clear();
+    m_bodyIndex.clear();
+    m_contacts.resize(NumContacts);
+
+    for (uint i = 0; i < NumContacts; i++) {
+        const ParticleContact& Contact = ContactArray[i];
+        SolverContact& c = m_contacts[i];
+
+        for (int b = 0; b < 2; b++) {
+            Particle* pParticle = Contact.m_pParticles[b];
+
+            if (!pParticle) {
+                c.Body[b] = -1;
+                continue;
+            }
+
+            std::unordered_map<const Particle*, int>::iterator it = m_bodyIndex.find(pParticle);
+
+            if (it == m_bodyIndex.end()) {
+                SolverBody Body;
+                Body.pParticle = pParticle;
+                Body.Velocity = pParticle->GetVelocity();
+                Body.Move = Vector3f(0.0f, 0.0f, 0.0f);
+                Body.ReciprocalMass = pParticle->GetReciprocalMass();
+
+                c.Body[b] = (int)m_bodies.size();
+                m_bodyIndex[pParticle] = c.Body[b];
+                m_bodies.push_back(Body);
+            } else {
+                c.Body[b] = it->second;
+            }
+        }
+
+        c.Normal = Contact.m_contactNormal;
+        c.Penetration = Contact.m_penetration;
+        c.Impulse = 0.0f;
+
+        float TotalReciprocalMass = m_bodies[c.Body[0]].ReciprocalMass;
+        Vector3f RelVelocity = m_bodies[c.Body[0]].Velocity;
+        Vector3f RelAccel = Contact.m_pParticles[0]->GetAcceleration();
+
+        if (c.Body[1] >= 0) {
+            TotalReciprocalMass += m_bodies[c.Body[1]].ReciprocalMass;
+            RelVelocity -= m_bodies[c.Body[1]].Velocity;
+            RelAccel -= Contact.m_pParticles[1]->GetAcceleration();
+        }
+
+        c.EffectiveMass = (TotalReciprocalMass > 0.0f) ? 1.0f / TotalReciprocalMass : 0.0f;
+
+        // Same target as ParticleContact::ResolveVelocity - bounce the closing velocity
+        // except for the part that was caused by the acceleration of this frame
+        float SeparatingVelocity = RelVelocity.Dot(c.Normal);
+
+        c.TargetVelocity = 0.0f;
+
+        if (SeparatingVelocity < 0.0f) {
+            float Restitution = Contact.GetRestitution();
+            float NewSepVelocity = -SeparatingVelocity * Restitution;
+            float SepVelocityCausedByAccel = RelAccel.Dot(c.Normal) * dt;
+
+            if (SepVelocityCausedByAccel < 0.0f) {
+                NewSepVelocity += Restitution * SepVelocityCausedByAccel;
+                NewSepVelocity = std::max(0.0f, NewSepVelocity);
+            }
+
+            c.TargetVelocity = NewSepVelocity;
+        }
+    }
+}
+
+
+void SequentialImpulseSolver::WarmStart()
+{
+    for (SolverContact& c : m_contacts) {
+        ContactKey Key = { m_bodies[c.Body[0]].pParticle, (c.Body[1] >= 0) ? m_bodies[c.Body[1]].pParticle : NULL };
+
+        std::unordered_map<ContactKey, CachedImpulse, ContactKeyHash>::const_iterator it = m_prevCache.find(Key);
+
+        if (it == m_prevCache.end()) {
+            continue;
+        }
+
+        // Rods can flip their normal between frames
+        float Scale = it->second.Normal.Dot(c.Normal);
+
+        if (Scale <= 0.0f) {
+            continue;
+        }
+
+        c.Impulse = it->second.Impulse * Scale;
+
+        SolverBody& Body0 = m_bodies[c.Body[0]];
+        Body0.Velocity += c.Normal * (c.Impulse * Body0.ReciprocalMass);
+
+        if (c.Body[1] >= 0) {
+            SolverBody& Body1 = m_bodies[c.Body[1]];
+            Body1.Velocity -= c.Normal * (c.Impulse * Body1.ReciprocalMass);
+        }
+    }
+}
+
+
+void SequentialImpulseSolver::SolveVelocities()
+{
+    int Iterations = (m_iterations > 0) ? m_iterations : DEFAULT_ITERATIONS;
+
+    for (int Iter = 0; Iter < Iterations; Iter++) {
+        for (SolverContact& c : m_contacts) {
+            SolverBody& Body0 = m_bodies[c.Body[0]];
+            Vector3f RelVelocity = Body0.Velocity;
+
+            if (c.Body[1] >= 0) {
+                RelVelocity -= m_bodies[c.Body[1]].Velocity;
+            }
+
+            float Delta = (c.TargetVelocity - RelVelocity.Dot(c.Normal)) * c.EffectiveMass;
+
+            // The contacts can only push so the accumulated impulse is clamped (not the delta)
+            float NewImpulse = std::max(c.Impulse + Delta, 0.0f);
+            Delta = NewImpulse - c.Impulse;
+            c.Impulse = NewImpulse;
+
+            Body0.Velocity += c.Normal * (Delta * Body0.ReciprocalMass);
+
+            if (c.Body[1] >= 0) {
+                SolverBody& Body1 = m_bodies[c.Body[1]];
+                Body1.Velocity -= c.Normal * (Delta * Body1.ReciprocalMass);
+            }
+        }
+    }
+}
+
+
+void SequentialImpulseSolver::SolvePositions()
+{
+    int Iterations = (m_iterations > 0) ? m_iterations : DEFAULT_ITERATIONS;
+
+    for (int Iter = 0; Iter < Iterations; Iter++) {
+        for (const SolverContact& c : m_contacts) {
+            SolverBody& Body0 = m_bodies[c.Body[0]];
+            Vector3f RelMove = Body0.Move;
+
+            if (c.Body[1] >= 0) {
+                RelMove -= m_bodies[c.Body[1]].Move;
+            }
+
+            float Penetration = c.Penetration - RelMove.Dot(c.Normal);
+
+            if (Penetration <= 0.0f) {
+                continue;
+            }
+
+            float Move = Penetration * c.EffectiveMass;
+
+            Body0.Move += c.Normal * (Move * Body0.ReciprocalMass);
+
+            if (c.Body[1] >= 0) {
+                SolverBody& Body1 = m_bodies[c.Body[1]];
+                Body1.Move -= c.Normal * (Move * Body1.ReciprocalMass);
+            }
+        }
+    }
+}
+
+
+void SequentialImpulseSolver::ScatterBodies()
+{
+    for (SolverBody& Body : m_bodies) {
+        Body.pParticle->SetVelocity(Body.Velocity);
+        Body.pParticle->SetPosition(Body.pParticle->GetPosition() + Body.Move);
+    }
+
+    // Keep the impulses for the next frame
+    m_prevCache.clear();
+
+    for (const SolverContact& c : m_contacts) {
+        ContactKey Key = { m_bodies[c.Body[0]].pParticle, (c.Body[1] >= 0) ? m_bodies[c.Body[1]].pParticle : NULL };
+        m_prevCache[Key] = { c.Normal, c.Impulse };
+    }
+}
+
+}
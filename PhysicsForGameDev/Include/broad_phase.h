@@ -0,0 +1,67 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class ThreadPool;
+
+namespace Physics {
+
+struct CollisionPair {
+    int First;
+    int Second;
+};
+
+//
+// Broad phase based on a spatial hash of a uniform grid. The cells are large
+// enough for the largest sphere so the pairs can only come from the 27 cells
+// around the cell of each object. The grid is rebuilt on every call.
+//
+class BroadPhase {
+
+public:
+
+    BroadPhase() {}
+
+    // NULL means the default pool
+    void SetThreadPool(ThreadPool* pThreadPool) { m_pThreadPool = pThreadPool; }
+
+    // Finds every pair of objects (First < Second) whose distance is not larger than the
+    // sum of their radii plus Margin. A negative radius excludes the object. The pairs are
+    // sorted by First and then by Second - the order of the brute force double loop - so
+    // the narrow phase handles them exactly like before.
+    void FindPairs(const glm::vec3* pCenters, const float* pRadii, int NumObjects, float Margin,
+                   std::vector<CollisionPair>& Pairs);
+
+private:
+
+    unsigned int HashCell(const glm::ivec3& Cell) const;
+
+    std::vector<glm::ivec3> m_cells;            // per object
+    std::vector<int> m_bucketStart;             // per bucket of the hash table (plus one)
+    std::vector<int> m_sortedObjects;           // by bucket
+    std::vector<std::vector<CollisionPair>> m_batchPairs;
+    unsigned int m_tableMask = 0;
+    ThreadPool* m_pThreadPool = NULL;
+};
+
+}
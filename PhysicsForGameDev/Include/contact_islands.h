@@ -0,0 +1,62 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "broad_phase.h"
+
+namespace Physics {
+
+//
+// Groups the contacts into islands - sets of objects which are connected
+// by contacts. Different islands don't share objects so they can be solved
+// concurrently. The contacts of each island keep their original order and
+// the islands are numbered by their first contact so the result does not
+// depend on the number of threads.
+//
+class ContactIslands {
+
+public:
+
+    ContactIslands() {}
+
+    void Build(int NumObjects, const std::vector<CollisionPair>& Contacts);
+
+    int GetNumIslands() const { return (int)m_islandStart.size() - 1; }
+
+    const CollisionPair* GetContacts(int Island, int& NumContacts) const
+    {
+        NumContacts = m_islandStart[Island + 1] - m_islandStart[Island];
+        return &m_sortedContacts[m_islandStart[Island]];
+    }
+
+private:
+
+    int FindRoot(int Object);
+
+    std::vector<int> m_parent;              // per object
+    std::vector<int> m_rootIsland;          // per object
+    std::vector<int> m_contactIsland;       // per contact
+    std::vector<int> m_islandStart;         // per island (plus one)
+    std::vector<CollisionPair> m_sortedContacts;
+};
+
+}
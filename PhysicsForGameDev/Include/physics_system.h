@@ -22,6 +22,10 @@
 #include <vector>
 #include "point_mass.h"
 #include "rigid_body.h"
+#include "broad_phase.h"
+#include "contact_islands.h"
+
+class ThreadPool;
 
 namespace Physics {
 
@@ -47,6 +51,18 @@ public:
 
     RigidBody* AllocRigidBody();
 
+    PointMass* GetPointMass(int Index) { return &m_pointMasses[Index]; }
+
+    RigidBody* GetRigidBody(int Index) { return &m_rigidBodies[Index]; }
+
+    // The broad phase is enabled by default. Without it every pair of objects
+    // is tested which is only useful as a reference.
+    void SetBroadPhase(bool Enabled) { m_useBroadPhase = Enabled; }
+
+    // The step runs on the default pool unless another one is set here (NULL
+    // means the default pool). The results don't depend on the number of threads.
+    void SetThreadPool(ThreadPool* pThreadPool);
+
 private:
 
     void UpdateInternal(float DeltaTime);
@@ -57,18 +73,39 @@ private:
 
     void HandlePointMassCollisions();
 
+    void HandlePointMassCollisionsReference();
+
     void HandleRigidBodyCollisions(float DeltaTime);
 
+    void HandleRigidBodyCollisionsReference(float DeltaTime);
+
+    void HandleRigidBodyPair(int i, int j, float DeltaTime);
+
     void ApplyGlobalForces();
 
     void ResetAllForces();
 
+    void NotifyListener();
+
+    ThreadPool& GetThreadPool();
+
     std::vector<PointMass> m_pointMasses;
     std::vector<RigidBody> m_rigidBodies;
     UpdateListener m_pUpdateListener = NULL;
     int m_numActivePointMasses = 0;
     int m_numActiveRigidBodies = 0;
     glm::vec3 m_globalForce = glm::vec3(0.0f);
+    double m_accumulator = 0.0;
+
+    BroadPhase m_broadPhase;
+    bool m_useBroadPhase = true;
+    std::vector<glm::vec3> m_centers;
+    std::vector<float> m_radii;
+    std::vector<CollisionPair> m_pairs;
+    std::vector<char> m_isContact;          // per pair
+    std::vector<CollisionPair> m_contacts;
+    ContactIslands m_islands;
+    ThreadPool* m_pThreadPool = NULL;
 };
 
 }
\ No newline at end of file
@@ -67,6 +67,8 @@ public:
 
     void ReverseTorque() { m_torqueAccum *= -1.0f; }
 
+    const glm::quat& GetOrientation() const { return m_orientation; }
+
     void SetOrientation(const glm::quat& Orientation) { m_orientation = Orientation; }
 
 private:    
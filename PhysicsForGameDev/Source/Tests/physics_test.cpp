@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <stdlib.h>
 
+#include "ogldev_thread_pool.h"
 #include "physics_system.h"
 
 static bool ListenerCalled = false;
@@ -30,6 +32,127 @@ TEST(TestCaseName, TestName)
 
 
 
+// Regression scene for the broad phase - a cloud of point masses and rigid bodies
+// which fly into each other. Running it with and without the broad phase must give
+// exactly the same results.
+static void InitCollisionScene(Physics::System& PhysicsSystem, bool UseBroadPhase)
+{
+	const int NumPointMasses = 1000;
+	const int NumRigidBodies = 64;
+
+	PhysicsSystem.Init(NumPointMasses, NumRigidBodies, NULL, glm::vec3(0.0f));
+	PhysicsSystem.SetBroadPhase(UseBroadPhase);
+
+	srand(1);
+
+	for (int i = 0; i < NumPointMasses; i++) {
+		Physics::PointMass* pm = PhysicsSystem.AllocPointMass();
+		glm::vec3 Pos((float)(i % 10), (float)((i / 10) % 10), (float)(i / 100));
+		pm->Init(1.0f + (float)(i % 3), Pos * 1.1f, glm::vec3(0.0f), NULL);
+
+		// A few point masses don't collide at all
+		pm->SetBoundingRadius((i % 7) ? 0.5f : 0.0f);
+
+		glm::vec3 Vel((float)(rand() % 200 - 100), (float)(rand() % 200 - 100), (float)(rand() % 200 - 100));
+		pm->SetLinearVelocity(Vel * 0.02f);
+	}
+
+	for (int i = 0; i < NumRigidBodies; i++) {
+		Physics::RigidBody* rb = PhysicsSystem.AllocRigidBody();
+		glm::vec3 Pos((float)(i % 4), (float)((i / 4) % 4), (float)(i / 16));
+		rb->Init(1.0f, glm::vec3(0.0f), Pos * 1.5f, glm::vec3(0.0f), glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), NULL);
+		rb->SetShapeBox(1.0f, 1.0f, 1.0f);
+		rb->GetLinear().SetBoundingRadius(0.6f);
+		rb->GetLinear().SetLinearVelocity((glm::vec3(2.25f) - Pos) * 0.5f);
+	}
+}
+
+
+TEST(BroadPhase, SameResultsAsBruteForce)
+{
+	Physics::System BruteForce;
+	Physics::System BroadPhase;
+
+	InitCollisionScene(BruteForce, false);
+	InitCollisionScene(BroadPhase, true);
+
+	for (int Frame = 0; Frame < 60; Frame++) {
+		BruteForce.Update(1.0 / 30.0);
+		BroadPhase.Update(1.0 / 30.0);
+	}
+
+	for (int i = 0; i < 1000; i++) {
+		Physics::PointMass* pm1 = BruteForce.GetPointMass(i);
+		Physics::PointMass* pm2 = BroadPhase.GetPointMass(i);
+
+		ASSERT_EQ(pm1->GetPos(), pm2->GetPos()) << "point mass " << i;
+		ASSERT_EQ(pm1->GetLinearVelocity(), pm2->GetLinearVelocity()) << "point mass " << i;
+	}
+
+	for (int i = 0; i < 64; i++) {
+		Physics::PointMass& Linear1 = BruteForce.GetRigidBody(i)->GetLinear();
+		Physics::PointMass& Linear2 = BroadPhase.GetRigidBody(i)->GetLinear();
+
+		ASSERT_EQ(Linear1.GetPos(), Linear2.GetPos()) << "rigid body " << i;
+		ASSERT_EQ(Linear1.GetLinearVelocity(), Linear2.GetLinearVelocity()) << "rigid body " << i;
+	}
+}
+
+
+struct BodyState {
+	glm::vec3 Pos;
+	glm::vec3 Velocity;
+
+	bool operator==(const BodyState& Other) const { return (Pos == Other.Pos) && (Velocity == Other.Velocity); }
+};
+
+
+// Runs the collision scene and records the state of all the objects after every frame
+static void RecordCollisionScene(ThreadPool* pThreadPool, std::vector<std::vector<BodyState>>& Frames)
+{
+	Physics::System PhysicsSystem;
+	InitCollisionScene(PhysicsSystem, true);
+	PhysicsSystem.SetThreadPool(pThreadPool);
+
+	Frames.resize(60);
+
+	for (int Frame = 0; Frame < 60; Frame++) {
+		// A variable frame time exercises the fixed step accumulator
+		PhysicsSystem.Update((Frame % 2) ? 1.0 / 45.0 : 1.0 / 90.0);
+
+		for (int i = 0; i < 1000; i++) {
+			Physics::PointMass* pm = PhysicsSystem.GetPointMass(i);
+			Frames[Frame].push_back({ pm->GetPos(), pm->GetLinearVelocity() });
+		}
+
+		for (int i = 0; i < 64; i++) {
+			Physics::PointMass& Linear = PhysicsSystem.GetRigidBody(i)->GetLinear();
+			Frames[Frame].push_back({ Linear.GetPos(), Linear.GetLinearVelocity() });
+		}
+	}
+}
+
+
+TEST(ParallelStep, DeterministicReplay)
+{
+	std::vector<std::vector<BodyState>> Recording;
+	RecordCollisionScene(NULL, Recording);
+
+	int NumThreads[] = { 1, 2, 4, 7 };
+
+	for (int n : NumThreads) {
+		ThreadPool Pool(n);
+
+		std::vector<std::vector<BodyState>> Replay;
+		RecordCollisionScene(&Pool, Replay);
+
+		for (int Frame = 0; Frame < (int)Recording.size(); Frame++) {
+			ASSERT_TRUE(Recording[Frame] == Replay[Frame]) << n << " threads, frame " << Frame;
+		}
+	}
+}
+
+
 int main(int argc, char** argv) 
 {
 	::testing::InitGoogleTest(&argc, argv);
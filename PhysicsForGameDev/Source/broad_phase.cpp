@@ -0,0 +1,156 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "ogldev_thread_pool.h"
+#include "broad_phase.h"
+
+#define BROAD_PHASE_OBJECTS_PER_BATCH 1024
+
+namespace Physics {
+
+unsigned int BroadPhase::HashCell(const glm::ivec3& Cell) const
+{
+    unsigned int h = ((unsigned int)Cell.x * 73856093u) ^ ((unsigned int)Cell.y * 19349663u) ^ ((unsigned int)Cell.z * 83492791u);
+    return h & m_tableMask;
+}
+
+
+void BroadPhase::FindPairs(const glm::vec3* pCenters, const float* pRadii, int NumObjects, float Margin,
+                           std::vector<CollisionPair>& Pairs)
+{
+    Pairs.clear();
+
+    float MaxRadius = 0.0f;
+    int NumIncluded = 0;
+
+    for (int i = 0; i < NumObjects; i++) {
+        if (pRadii[i] >= 0.0f) {
+            MaxRadius = std::max(MaxRadius, pRadii[i]);
+            NumIncluded++;
+        }
+    }
+
+    if (NumIncluded < 2) {
+        return;
+    }
+
+    float CellSize = 2.0f * MaxRadius + Margin;
+
+    if (CellSize <= 0.0f) {
+        CellSize = 1.0f;
+    }
+
+    float InvCellSize = 1.0f / CellSize;
+
+    // About two buckets per object keeps the chains short
+    unsigned int TableSize = 64;
+
+    while (TableSize < (unsigned int)NumIncluded * 2) {
+        TableSize *= 2;
+    }
+
+    m_tableMask = TableSize - 1;
+
+    // Counting sort of the objects by bucket
+    m_cells.resize(NumObjects);
+    m_bucketStart.assign(TableSize + 1, 0);
+    m_sortedObjects.resize(NumIncluded);
+
+    for (int i = 0; i < NumObjects; i++) {
+        if (pRadii[i] >= 0.0f) {
+            m_cells[i] = glm::ivec3(glm::floor(pCenters[i] * InvCellSize));
+            m_bucketStart[HashCell(m_cells[i]) + 1]++;
+        }
+    }
+
+    for (unsigned int b = 0; b < TableSize; b++) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    std::vector<int> NextSlot(m_bucketStart.begin(), m_bucketStart.end() - 1);
+
+    for (int i = 0; i < NumObjects; i++) {
+        if (pRadii[i] >= 0.0f) {
+            m_sortedObjects[NextSlot[HashCell(m_cells[i])]++] = i;
+        }
+    }
+
+    // Each batch of objects writes its own list so the result doesn't depend on the threads
+    int NumBatches = (NumObjects + BROAD_PHASE_OBJECTS_PER_BATCH - 1) / BROAD_PHASE_OBJECTS_PER_BATCH;
+    m_batchPairs.resize(NumBatches);
+
+    ThreadPool& Pool = m_pThreadPool ? *m_pThreadPool : ThreadPool::GetDefault();
+
+    Pool.ParallelFor(NumObjects, BROAD_PHASE_OBJECTS_PER_BATCH, [&](int Start, int End) {
+        std::vector<CollisionPair>& BatchPairs = m_batchPairs[Start / BROAD_PHASE_OBJECTS_PER_BATCH];
+        BatchPairs.clear();
+
+        for (int i = Start; i < End; i++) {
+            if (pRadii[i] < 0.0f) {
+                continue;
+            }
+
+            // Neighbor cells can share a bucket
+            unsigned int Buckets[27];
+            int NumBuckets = 0;
+
+            for (int z = -1; z <= 1; z++) {
+                for (int y = -1; y <= 1; y++) {
+                    for (int x = -1; x <= 1; x++) {
+                        unsigned int Bucket = HashCell(m_cells[i] + glm::ivec3(x, y, z));
+
+                        if (std::find(Buckets, Buckets + NumBuckets, Bucket) == Buckets + NumBuckets) {
+                            Buckets[NumBuckets++] = Bucket;
+                        }
+                    }
+                }
+            }
+
+            size_t FirstPair = BatchPairs.size();
+
+            for (int b = 0; b < NumBuckets; b++) {
+                for (int k = m_bucketStart[Buckets[b]]; k < m_bucketStart[Buckets[b] + 1]; k++) {
+                    int j = m_sortedObjects[k];
+
+                    if (j <= i) {
+                        continue;
+                    }
+
+                    glm::vec3 Delta = pCenters[j] - pCenters[i];
+                    float MaxDistance = pRadii[i] + pRadii[j] + Margin;
+
+                    if (glm::dot(Delta, Delta) <= MaxDistance * MaxDistance) {
+                        BatchPairs.push_back({ i, j });
+                    }
+                }
+            }
+
+            std::sort(BatchPairs.begin() + FirstPair, BatchPairs.end(),
+                      [](const CollisionPair& a, const CollisionPair& b) { return a.Second < b.Second; });
+        }
+    });
+
+    for (int b = 0; b < NumBatches; b++) {
+        Pairs.insert(Pairs.end(), m_batchPairs[b].begin(), m_batchPairs[b].end());
+    }
+}
+
+}
@@ -0,0 +1,88 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "contact_islands.h"
+
+namespace Physics {
+
+int ContactIslands::FindRoot(int Object)
+{
+    while (m_parent[Object] != Object) {
+        m_parent[Object] = m_parent[m_parent[Object]];
+        Object = m_parent[Object];
+    }
+
+    return Object;
+}
+
+
+void ContactIslands::Build(int NumObjects, const std::vector<CollisionPair>& Contacts)
+{
+    m_parent.resize(NumObjects);
+
+    for (int i = 0; i < NumObjects; i++) {
+        m_parent[i] = i;
+    }
+
+    // The smaller root always wins so the trees don't depend on anything but the contacts
+    for (const CollisionPair& Contact : Contacts) {
+        int Root1 = FindRoot(Contact.First);
+        int Root2 = FindRoot(Contact.Second);
+
+        if (Root1 < Root2) {
+            m_parent[Root2] = Root1;
+        } else if (Root2 < Root1) {
+            m_parent[Root1] = Root2;
+        }
+    }
+
+    int NumContacts = (int)Contacts.size();
+
+    m_rootIsland.assign(NumObjects, -1);
+    m_contactIsland.resize(NumContacts);
+    m_islandStart.assign(1, 0);
+
+    for (int c = 0; c < NumContacts; c++) {
+        int Root = FindRoot(Contacts[c].First);
+
+        if (m_rootIsland[Root] < 0) {
+            m_rootIsland[Root] = (int)m_islandStart.size() - 1;
+            m_islandStart.push_back(0);
+        }
+
+        m_contactIsland[c] = m_rootIsland[Root];
+        m_islandStart[m_contactIsland[c] + 1]++;
+    }
+
+    // Counting sort of the contacts by island (stable)
+    int NumIslands = GetNumIslands();
+
+    for (int i = 0; i < NumIslands; i++) {
+        m_islandStart[i + 1] += m_islandStart[i];
+    }
+
+    std::vector<int> NextSlot(m_islandStart.begin(), m_islandStart.end() - 1);
+
+    m_sortedContacts.resize(NumContacts);
+
+    for (int c = 0; c < NumContacts; c++) {
+        m_sortedContacts[NextSlot[m_contactIsland[c]]++] = Contacts[c];
+    }
+}
+
+}
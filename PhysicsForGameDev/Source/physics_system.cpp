@@ -17,9 +17,18 @@
  */
 
 #include <stdio.h>
+#include <algorithm>
 
+#include "ogldev_thread_pool.h"
 #include "physics_system.h"
 
+// Extra distance for the broad phase so that touching objects are not missed
+#define BROAD_PHASE_MARGIN 0.01f
+
+#define BODIES_PER_BATCH 256
+#define PAIRS_PER_BATCH 1024
+#define ISLANDS_PER_BATCH 16
+
 namespace Physics {
 
 void System::Init(int NumPointMasses, int NumRigidBodies, UpdateListener pUpdateListener, const glm::vec3& GlobalForce)
@@ -31,19 +40,33 @@ void System::Init(int NumPointMasses, int NumRigidBodies, UpdateListener pUpdate
 }
 
 
+void System::SetThreadPool(ThreadPool* pThreadPool)
+{
+    m_pThreadPool = pThreadPool;
+    m_broadPhase.SetThreadPool(pThreadPool);
+}
+
+
+ThreadPool& System::GetThreadPool()
+{
+    return m_pThreadPool ? *m_pThreadPool : ThreadPool::GetDefault();
+}
+
+
 void System::Update(double DeltaTime)
 {
     if (DeltaTime > 0.1f) {
         DeltaTime = 0.1f;
     }
 
-    static double accumulator = 0.0;
-    accumulator += DeltaTime;
+    m_accumulator += DeltaTime;
 
     //printf("DeltaTime = %f\n", DeltaTime);
     const float FixedDT = 1.0f / 60.0f;
 
-    while (accumulator >= 1.0/60.0) {
+    bool Stepped = false;
+
+    while (m_accumulator >= 1.0/60.0) {
 
         ApplyGlobalForces();
 
@@ -55,40 +78,53 @@ void System::Update(double DeltaTime)
 
         ResetAllForces();
 
-        accumulator -= FixedDT;       
+        m_accumulator -= FixedDT;       
+
+        Stepped = true;
+    }
+
+    // The integration runs on the worker threads so the listener is called here
+    if (Stepped) {
+        NotifyListener();
     }
 }
 
 
 void System::ApplyGlobalForces()
 {
-    for (int i = 0; i < m_numActivePointMasses; i++) {
-        if (m_pointMasses[i].IsActive()) {
-            float Mass = m_pointMasses[i].GetMass();
-            glm::vec3 Force = m_globalForce * Mass;
-            m_pointMasses[i].AddForce(Force);
+    GetThreadPool().ParallelFor(m_numActivePointMasses, BODIES_PER_BATCH, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            if (m_pointMasses[i].IsActive()) {
+                float Mass = m_pointMasses[i].GetMass();
+                glm::vec3 Force = m_globalForce * Mass;
+                m_pointMasses[i].AddForce(Force);
+            }
         }
-    }
+    });
 
-    for (int i = 0; i < m_numActiveRigidBodies; i++) {
-        float Mass = m_pointMasses[i].GetMass();
-        glm::vec3 Force = m_globalForce * Mass;
-        m_rigidBodies[i].AddForce(m_globalForce);
-    }
+    GetThreadPool().ParallelFor(m_numActiveRigidBodies, BODIES_PER_BATCH, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            m_rigidBodies[i].AddForce(m_globalForce);
+        }
+    });
 }
 
 
 void System::ResetAllForces()
 {
-    for (int i = 0; i < m_numActivePointMasses; i++) {
-        if (m_pointMasses[i].IsActive()) {
-            m_pointMasses[i].ResetForces();
+    GetThreadPool().ParallelFor(m_numActivePointMasses, BODIES_PER_BATCH, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            if (m_pointMasses[i].IsActive()) {
+                m_pointMasses[i].ResetForces();
+            }
         }
-    }
+    });
 
-    for (int i = 0; i < m_numActiveRigidBodies; i++) {
-        m_rigidBodies[i].ResetForces();
-    }
+    GetThreadPool().ParallelFor(m_numActiveRigidBodies, BODIES_PER_BATCH, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            m_rigidBodies[i].ResetForces();
+        }
+    });
 }
 
 
@@ -101,23 +137,101 @@ void System::UpdateInternal(float DeltaTime)
 
 void System::UpdatePointMasses(float DeltaTime)
 {
-    for (int i = 0; i < m_numActivePointMasses; i++) {
-        if (m_pointMasses[i].IsActive()) {
-            m_pointMasses[i].Update(DeltaTime, m_pUpdateListener);
+    GetThreadPool().ParallelFor(m_numActivePointMasses, BODIES_PER_BATCH, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            if (m_pointMasses[i].IsActive()) {
+                m_pointMasses[i].Update(DeltaTime, NULL);
+            }
         }
-    }
+    });
 }
 
 
 void System::UpdateRigidBodies(float DeltaTime)
 {
+    GetThreadPool().ParallelFor(m_numActiveRigidBodies, BODIES_PER_BATCH, [&](int Start, int End) {
+        for (int i = Start; i < End; i++) {
+            m_rigidBodies[i].Update(DeltaTime, NULL);
+        }
+    });
+}
+
+
+void System::NotifyListener()
+{
+    if (!m_pUpdateListener) {
+        return;
+    }
+
+    for (int i = 0; i < m_numActivePointMasses; i++) {
+        if (m_pointMasses[i].IsActive()) {
+            glm::quat t(0.0f, 0.0f, 0.0f, 0.0f);
+            m_pUpdateListener(m_pointMasses[i].GetTarget(), m_pointMasses[i].GetPos(), t);
+        }
+    }
+
     for (int i = 0; i < m_numActiveRigidBodies; i++) {
-        m_rigidBodies[i].Update(DeltaTime, m_pUpdateListener);
+        PointMass& Linear = m_rigidBodies[i].GetLinear();
+        m_pUpdateListener(Linear.GetTarget(), Linear.GetPos(), m_rigidBodies[i].GetOrientation());
     }
 }
 
 
 void System::HandlePointMassCollisions()
+{
+    if (!m_useBroadPhase) {
+        HandlePointMassCollisionsReference();
+        return;
+    }
+
+    m_centers.resize(m_numActivePointMasses);
+    m_radii.resize(m_numActivePointMasses);
+
+    // Point masses without a radius never collide so they are left out of the broad phase
+    for (int i = 0; i < m_numActivePointMasses; i++) {
+        const PointMass& pm = m_pointMasses[i];
+        m_centers[i] = pm.GetPos();
+        m_radii[i] = (pm.IsActive() && (pm.GetBoundingRadius() > 0.0f)) ? pm.GetBoundingRadius() : -1.0f;
+    }
+
+    m_broadPhase.FindPairs(m_centers.data(), m_radii.data(), m_numActivePointMasses, BROAD_PHASE_MARGIN, m_pairs);
+
+    // The collisions only change the velocities so the contacts can be found up front
+    int NumPairs = (int)m_pairs.size();
+    m_isContact.resize(NumPairs);
+
+    GetThreadPool().ParallelFor(NumPairs, PAIRS_PER_BATCH, [&](int Start, int End) {
+        for (int p = Start; p < End; p++) {
+            const PointMass& pm1 = m_pointMasses[m_pairs[p].First];
+            const PointMass& pm2 = m_pointMasses[m_pairs[p].Second];
+            m_isContact[p] = pm1.GetCollisionStatus(pm2) != COLLISION_STATUS_NONE;
+        }
+    });
+
+    m_contacts.clear();
+
+    for (int p = 0; p < NumPairs; p++) {
+        if (m_isContact[p]) {
+            m_contacts.push_back(m_pairs[p]);
+        }
+    }
+
+    m_islands.Build(m_numActivePointMasses, m_contacts);
+
+    GetThreadPool().ParallelFor(m_islands.GetNumIslands(), ISLANDS_PER_BATCH, [&](int Start, int End) {
+        for (int Island = Start; Island < End; Island++) {
+            int NumContacts = 0;
+            const CollisionPair* pContacts = m_islands.GetContacts(Island, NumContacts);
+
+            for (int c = 0; c < NumContacts; c++) {
+                m_pointMasses[pContacts[c].First].HandleCollision(m_pointMasses[pContacts[c].Second]);
+            }
+        }
+    });
+}
+
+
+void System::HandlePointMassCollisionsReference()
 {
     for (int i = 0; i < m_numActivePointMasses; i++) {
         if (m_pointMasses[i].IsActive()) {
@@ -133,33 +247,81 @@ void System::HandlePointMassCollisions()
 
 
 void System::HandleRigidBodyCollisions(float DeltaTime)
+{
+    if (!m_useBroadPhase) {
+        HandleRigidBodyCollisionsReference(DeltaTime);
+        return;
+    }
+
+    m_centers.resize(m_numActiveRigidBodies);
+    m_radii.resize(m_numActiveRigidBodies);
+
+    float MaxRadius = 0.0f;
+
+    for (int i = 0; i < m_numActiveRigidBodies; i++) {
+        PointMass& Linear = m_rigidBodies[i].GetLinear();
+        m_centers[i] = Linear.GetPos();
+        m_radii[i] = Linear.GetBoundingRadius();
+        MaxRadius = std::max(MaxRadius, m_radii[i]);
+    }
+
+    // Resolving a penetration moves the bodies during the loop. Each body moves by up
+    // to the largest radius so this is added to the margin.
+    float Margin = BROAD_PHASE_MARGIN + MaxRadius;
+
+    m_broadPhase.FindPairs(m_centers.data(), m_radii.data(), m_numActiveRigidBodies, Margin, m_pairs);
+
+    // Resolving a contact can change the status of the next pairs so the islands are
+    // built from all the pairs and the narrow phase runs inside the islands
+    m_islands.Build(m_numActiveRigidBodies, m_pairs);
+
+    GetThreadPool().ParallelFor(m_islands.GetNumIslands(), ISLANDS_PER_BATCH, [&](int Start, int End) {
+        for (int Island = Start; Island < End; Island++) {
+            int NumPairs = 0;
+            const CollisionPair* pPairs = m_islands.GetContacts(Island, NumPairs);
+
+            for (int p = 0; p < NumPairs; p++) {
+                HandleRigidBodyPair(pPairs[p].First, pPairs[p].Second, DeltaTime);
+            }
+        }
+    });
+}
+
+
+void System::HandleRigidBodyCollisionsReference(float DeltaTime)
 {
     for (int i = 0; i < m_numActiveRigidBodies; i++) {
-        RigidBody& CurBody = m_rigidBodies[i];
         for (int j = i + 1; j < m_numActiveRigidBodies; j++) {
-            RigidBody& OtherBody = m_rigidBodies[j];
-            COLLISION_STATUS cs = CurBody.GetLinear().GetCollisionStatus(OtherBody.GetLinear());
-
-            switch (cs) {
-            case COLLISION_STATUS_TOUCHING:
-           //     printf("Collision\n");
-                m_rigidBodies[i].CalcCollisionReactions(OtherBody);
-                break;
-
-            case COLLISION_STATUS_OVERLAPPING:
-           //     printf("Overlapping\n");
-                HandleOverlappingBodies(DeltaTime, CurBody, OtherBody);
-                break;
-
-            case COLLISION_STATUS_NONE:
-                // Nothing here
-                break;
-            }
+            HandleRigidBodyPair(i, j, DeltaTime);
         }
     }
 }
 
 
+void System::HandleRigidBodyPair(int i, int j, float DeltaTime)
+{
+    RigidBody& CurBody = m_rigidBodies[i];
+    RigidBody& OtherBody = m_rigidBodies[j];
+    COLLISION_STATUS cs = CurBody.GetLinear().GetCollisionStatus(OtherBody.GetLinear());
+
+    switch (cs) {
+    case COLLISION_STATUS_TOUCHING:
+   //     printf("Collision\n");
+        CurBody.CalcCollisionReactions(OtherBody);
+        break;
+
+    case COLLISION_STATUS_OVERLAPPING:
+   //     printf("Overlapping\n");
+        HandleOverlappingBodies(DeltaTime, CurBody, OtherBody);
+        break;
+
+    case COLLISION_STATUS_NONE:
+        // Nothing here
+        break;
+    }
+}
+
+
 PointMass* System::AllocPointMass()
 {
     if (m_numActivePointMasses == (int)m_pointMasses.size()) {
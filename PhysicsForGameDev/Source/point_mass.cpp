@@ -78,7 +78,7 @@ void PointMass::HandleCollision(PointMass& OtherParticle)
         bool CollisionOccured = CheckCollision(OtherParticle);
 
         if (CollisionOccured) {
-            printf("Collision\n");
+        //    printf("Collision\n");
 
             float AvgCoeffRest = (m_coeffOfRest + OtherParticle.m_coeffOfRest) * 0.5f;
 
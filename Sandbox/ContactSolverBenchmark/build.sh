@@ -0,0 +1,16 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="contact_solver_benchmark.cpp \
+	$ROOTDIR/Physics/Source/ogldev_physics.cpp \
+	$ROOTDIR/Physics/Source/particle.cpp \
+	$ROOTDIR/Physics/Source/particle_store.cpp \
+	$ROOTDIR/Physics/Source/firework.cpp \
+	$ROOTDIR/Physics/Source/force.cpp \
+	$ROOTDIR/Physics/Source/contact_resolver.cpp \
+	$ROOTDIR/Physics/Source/sequential_impulse_solver.cpp \
+	$ROOTDIR/Common/math_3d.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/Physics/Include $OGL_CPPFLAGS $OGL_LDFLAGS -o contact_solver_benchmark
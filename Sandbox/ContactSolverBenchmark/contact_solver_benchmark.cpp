@@ -0,0 +1,201 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Contact solver benchmark
+
+    Simulates a rope of 10k rods and a 100x100 cloth with the worst first
+    ParticleContactResolver (automatic iterations) and with the sequential
+    impulse solver and compares the time per frame and the largest stretch
+    of the links.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include "ogldev_physics.h"
+
+#define NUM_FRAMES 5
+#define LINK_LENGTH 0.1f
+#define ROPE_LINKS 10000
+#define CLOTH_SIZE 100
+
+using namespace OgldevPhysics;
+
+
+class Scene {
+
+public:
+
+    void InitRope(CONTACT_SOLVER Solver)
+    {
+        Init(ROPE_LINKS + 1, ROPE_LINKS, Solver);
+
+        for (int i = 0; i <= ROPE_LINKS; i++) {
+            AddParticle(Vector3f((float)i * LINK_LENGTH, 0.0f, 0.0f), i == 0);
+        }
+
+        for (int i = 0; i < ROPE_LINKS; i++) {
+            AddRod(i, i + 1);
+        }
+
+        Finalize();
+    }
+
+
+    void InitCloth(CONTACT_SOLVER Solver)
+    {
+        int NumLinks = 2 * CLOTH_SIZE * (CLOTH_SIZE - 1);
+
+        Init(CLOTH_SIZE * CLOTH_SIZE, NumLinks, Solver);
+
+        // Horizontal cloth pinned at two corners
+        for (int z = 0; z < CLOTH_SIZE; z++) {
+            for (int x = 0; x < CLOTH_SIZE; x++) {
+                bool Pinned = (z == 0) && ((x == 0) || (x == CLOTH_SIZE - 1));
+                AddParticle(Vector3f((float)x * LINK_LENGTH, 0.0f, (float)z * LINK_LENGTH), Pinned);
+            }
+        }
+
+        for (int z = 0; z < CLOTH_SIZE; z++) {
+            for (int x = 0; x < CLOTH_SIZE; x++) {
+                int i = z * CLOTH_SIZE + x;
+
+                if (x < CLOTH_SIZE - 1) {
+                    AddRod(i, i + 1);
+                }
+
+                if (z < CLOTH_SIZE - 1) {
+                    AddRod(i, i + CLOTH_SIZE);
+                }
+            }
+        }
+
+        Finalize();
+    }
+
+
+    // Returns the time in milliseconds per frame
+    double Run()
+    {
+        std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < NUM_FRAMES; i++) {
+            m_physicsSystem.Update(1.0 / 60.0);
+        }
+
+        std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double, std::milli>(End - Start).count() / NUM_FRAMES;
+    }
+
+
+    // The largest stretch of a link relative to its length (the rods only
+    // generate contacts when they are stretched so they can be compressed)
+    float GetMaxStretch() const
+    {
+        float MaxStretch = 0.0f;
+
+        for (const ParticleRod& Rod : m_rods) {
+            float Len = (Rod.m_pParticles[0]->GetPosition() - Rod.m_pParticles[1]->GetPosition()).Length();
+            MaxStretch = std::max(MaxStretch, (Len - Rod.m_len) / Rod.m_len);
+        }
+
+        return MaxStretch;
+    }
+
+private:
+
+    void Init(int NumParticles, int NumLinks, CONTACT_SOLVER Solver)
+    {
+        m_physicsSystem.Init(NumParticles, NumLinks, 0, Solver);
+        m_particles.reserve(NumParticles);
+        m_rods.reserve(NumLinks);
+    }
+
+
+    void AddParticle(const Vector3f& Pos, bool Pinned)
+    {
+        Particle* pParticle = m_physicsSystem.AllocParticle();
+        pParticle->SetPosition(Pos);
+        pParticle->SetDamping(0.99f);
+
+        if (Pinned) {
+            pParticle->SetReciprocalMass(0.0f);
+        } else {
+            pParticle->SetMass(1.0f);
+            pParticle->SetAcceleration(GRAVITY);
+        }
+
+        m_particles.push_back(pParticle);
+    }
+
+
+    void AddRod(int i, int j)
+    {
+        ParticleRod Rod;
+        Rod.m_pParticles[0] = m_particles[i];
+        Rod.m_pParticles[1] = m_particles[j];
+        Rod.m_len = LINK_LENGTH;
+        m_rods.push_back(Rod);
+    }
+
+
+    void Finalize()
+    {
+        for (ParticleRod& Rod : m_rods) {
+            m_physicsSystem.AddContactGenerator(&Rod);
+        }
+    }
+
+    PhysicsSystem m_physicsSystem;
+    std::vector<Particle*> m_particles;
+    std::vector<ParticleRod> m_rods;
+};
+
+
+static void Compare(const char* pName, bool IsRope)
+{
+    Scene WorstFirst, SequentialImpulse;
+
+    if (IsRope) {
+        WorstFirst.InitRope(CONTACT_SOLVER_WORST_FIRST);
+        SequentialImpulse.InitRope(CONTACT_SOLVER_SEQUENTIAL_IMPULSE);
+    } else {
+        WorstFirst.InitCloth(CONTACT_SOLVER_WORST_FIRST);
+        SequentialImpulse.InitCloth(CONTACT_SOLVER_SEQUENTIAL_IMPULSE);
+    }
+
+    double WorstFirstTime = WorstFirst.Run();
+    double SequentialImpulseTime = SequentialImpulse.Run();
+
+    printf("%s\n", pName);
+    printf("    Worst first:        %10.2f ms per frame, max stretch %.4f%%\n", WorstFirstTime, WorstFirst.GetMaxStretch() * 100.0f);
+    printf("    Sequential impulse: %10.2f ms per frame, max stretch %.4f%%\n", SequentialImpulseTime, SequentialImpulse.GetMaxStretch() * 100.0f);
+    printf("    Speedup %.1fx\n", WorstFirstTime / SequentialImpulseTime);
+}
+
+
+int main(int argc, char* argv[])
+{
+    Compare("Rope (10k links)", true);
+    Compare("Cloth (100x100)", false);
+
+    return 0;
+}
@@ -25,6 +25,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
 
 #include "ogldev_basic_glfw_camera.h"
 
@@ -191,10 +194,132 @@ static void IsPointInsideClipSpaceTest()
     printf("\nTesting outside bottom: %s\n", IsPointInsideViewFrustum(OutsideBottom, VP) ? "Inside" : "Outside");
 }
 
+static Matrix4f CreateTestViewProj()
+{
+    Vector3f Pos(0.0f, 0.0f, 0.0f);
+    Vector3f Target(0.0f, 0.0f, 1.0f);
+    Vector3f Up(0.0, 1.0f, 0.0f);
+
+    float FOV = 45.0f;
+    float zNear = 1.0f;
+    float zFar = 100.0f;
+    float WindowWidth = 1000.0f;
+    float WindowHeight = 1000.0f;
+    PersProjInfo persProjInfo = { FOV, WindowWidth, WindowHeight, zNear, zFar };
+
+    BasicCamera Camera(persProjInfo, Pos, Target, Up);
+
+    return Camera.GetViewProjMatrix();
+}
+
+
+static AABB CreateBox(const Vector3f& Center, float HalfSize)
+{
+    AABB Box;
+    Box.Add(Center - Vector3f(HalfSize, HalfSize, HalfSize));
+    Box.Add(Center + Vector3f(HalfSize, HalfSize, HalfSize));
+    return Box;
+}
+
+
+static void FrustumCullingClassTest()
+{
+    FrustumCulling fc(CreateTestViewProj());
+
+    printf("\nTesting points using FrustumCulling\n");
+    printf("Inside: %s\n", fc.IsPointInsideViewFrustum(Vector3f(0.0f, 0.0f, 5.0f)) ? "Inside" : "Outside");
+    printf("Outside near Z: %s\n", fc.IsPointInsideViewFrustum(Vector3f(0.0f, 0.0f, 0.5f)) ? "Inside" : "Outside");
+    printf("Outside far Z: %s\n", fc.IsPointInsideViewFrustum(Vector3f(0.0f, 0.0f, 101.0f)) ? "Inside" : "Outside");
+    printf("Outside left: %s\n", fc.IsPointInsideViewFrustum(Vector3f(15.0f, 0.0f, 10.0f)) ? "Inside" : "Outside");
+    printf("Outside right: %s\n", fc.IsPointInsideViewFrustum(Vector3f(-15.0f, 0.0f, 10.0f)) ? "Inside" : "Outside");
+    printf("Outside top (top/bottom planes ignored): %s\n", fc.IsPointInsideViewFrustum(Vector3f(0.0f, 15.0f, 10.0f)) ? "Inside" : "Outside");
+    printf("Outside bottom (top/bottom planes ignored): %s\n", fc.IsPointInsideViewFrustum(Vector3f(0.0f, -15.0f, 10.0f)) ? "Inside" : "Outside");
+    printf("Outside top (all planes): %s\n", fc.IsPointInsideViewFrustumAllPlanes(Vector3f(0.0f, 15.0f, 10.0f)) ? "Inside" : "Outside");
+    printf("Outside bottom (all planes): %s\n", fc.IsPointInsideViewFrustumAllPlanes(Vector3f(0.0f, -15.0f, 10.0f)) ? "Inside" : "Outside");
+
+    printf("\nTesting boxes\n");
+    printf("Inside: %s\n", fc.IsAABBInsideViewFrustum(CreateBox(Vector3f(0.0f, 0.0f, 5.0f), 1.0f)) ? "Inside" : "Outside");
+    printf("Crossing the top plane: %s\n", fc.IsAABBInsideViewFrustum(CreateBox(Vector3f(0.0f, 5.0f, 10.0f), 2.0f)) ? "Inside" : "Outside");
+    printf("Outside top: %s\n", fc.IsAABBInsideViewFrustum(CreateBox(Vector3f(0.0f, 15.0f, 10.0f), 1.0f)) ? "Inside" : "Outside");
+    printf("Outside bottom: %s\n", fc.IsAABBInsideViewFrustum(CreateBox(Vector3f(0.0f, -15.0f, 10.0f), 1.0f)) ? "Inside" : "Outside");
+    printf("Behind the camera: %s\n", fc.IsAABBInsideViewFrustum(CreateBox(Vector3f(0.0f, 0.0f, -5.0f), 1.0f)) ? "Inside" : "Outside");
+
+    printf("\nTesting spheres\n");
+    printf("Inside: %s\n", fc.IsSphereInsideViewFrustum(Vector3f(0.0f, 0.0f, 5.0f), 1.0f) ? "Inside" : "Outside");
+    printf("Crossing the far plane: %s\n", fc.IsSphereInsideViewFrustum(Vector3f(0.0f, 0.0f, 102.0f), 5.0f) ? "Inside" : "Outside");
+    printf("Outside far Z: %s\n", fc.IsSphereInsideViewFrustum(Vector3f(0.0f, 0.0f, 110.0f), 5.0f) ? "Inside" : "Outside");
+    printf("Outside left: %s\n", fc.IsSphereInsideViewFrustum(Vector3f(15.0f, 0.0f, 10.0f), 1.0f) ? "Inside" : "Outside");
+}
+
+
+static float RandomFloat(float Min, float Max)
+{
+    return Min + (Max - Min) * ((float)rand() / (float)RAND_MAX);
+}
+
+
+// Compares the batch (SIMD) box classification against the single box version and reports the throughput
+static void ClassifyAABBsBenchmark()
+{
+    FrustumCulling fc(CreateTestViewProj());
+
+    const int NumBoxes = 100000;
+    const int NumIterations = 200;
+
+    AABBArray Boxes;
+    Boxes.Resize(NumBoxes);
+
+    srand(0);
+
+    for (int i = 0 ; i < NumBoxes ; i++) {
+        Vector3f Center(RandomFloat(-100.0f, 100.0f), RandomFloat(-100.0f, 100.0f), RandomFloat(-10.0f, 120.0f));
+        Boxes.Set(i, CreateBox(Center, RandomFloat(0.1f, 5.0f)));
+    }
+
+    std::vector<unsigned char> Visible(NumBoxes);
+    std::vector<unsigned char> VisibleScalar(NumBoxes);
+
+    fc.ClassifyAABBs(Boxes, Visible.data());
+
+    for (int i = 0 ; i < NumBoxes ; i++) {
+        if (Visible[i] != (fc.IsAABBInsideViewFrustum(Boxes.Get(i)) ? 1 : 0)) {
+            printf("Mismatch in box %d\n", i);
+            exit(1);
+        }
+    }
+
+    int NumVisible = 0;
+
+    std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0 ; i < NumIterations ; i++) {
+        NumVisible = fc.ClassifyAABBsScalar(Boxes, VisibleScalar.data());
+    }
+
+    std::chrono::high_resolution_clock::time_point Mid = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0 ; i < NumIterations ; i++) {
+        NumVisible = fc.ClassifyAABBs(Boxes, Visible.data());
+    }
+
+    std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+    double ScalarMs = std::chrono::duration<double, std::milli>(Mid - Start).count();
+    double BatchMs = std::chrono::duration<double, std::milli>(End - Mid).count();
+    double NumClassified = (double)NumBoxes * NumIterations;
+
+    printf("\n%d of %d boxes are visible\n", NumVisible, NumBoxes);
+    printf("Scalar: %.0f boxes per ms\n", NumClassified / ScalarMs);
+    printf("Batch:  %.0f boxes per ms (%.2fx)\n", NumClassified / BatchMs, ScalarMs / BatchMs);
+}
+
+
 int main(int argc, char* argv[])
 {
     //BasicClipSpaceTest();
     IsPointInsideClipSpaceTest();
+    FrustumCullingClassTest();
+    ClassifyAABBsBenchmark();
     return 0;
 }
     
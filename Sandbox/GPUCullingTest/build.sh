@@ -0,0 +1,15 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="gpu_culling_test.cpp \
+	$ROOTDIR/DemoLITION/Tests/Test1/DemoLITION_gpu_culling_validation.cpp \
+	$ROOTDIR/DemoLITION/Framework/Source/GL/gl_gpu_culling.cpp \
+	$ROOTDIR/DemoLITION/Framework/Source/GL/gl_gpu_culling_technique.cpp \
+	$ROOTDIR/Common/technique.cpp \
+	$ROOTDIR/Common/ogldev_egl.cpp \
+	$ROOTDIR/Common/ogldev_util.cpp \
+	$ROOTDIR/Common/math_3d.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/DemoLITION/Framework/Include -I$ROOTDIR/DemoLITION/Tests/Test1 $OGL_CPPFLAGS $OGL_LDFLAGS -lEGL -o gpu_culling_test
@@ -0,0 +1,48 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    GPU culling test
+
+    Runs the validation of test_gpu_culling (ValidateGPUCulling) which compares
+    the GPU culling compute shader with GPUCulling::CullReference. Only the
+    culling pass is initialized (not the DemoLITION renderer) so it runs on
+    GL 4.5 software drivers such as Mesa llvmpipe:
+
+        LIBGL_ALWAYS_SOFTWARE=1 ./gpu_culling_test
+
+    Linux only (the context is created through EGL without a window).
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "ogldev_egl.h"
+#include "DemoLITION_gpu_culling_validation.h"
+
+
+int main(int argc, char* argv[])
+{
+    // The shader paths of the techniques are relative to the DemoLITION directory
+    if (chdir("../../DemoLITION") != 0) {
+        printf("This test must run from Sandbox/GPUCullingTest\n");
+        return 1;
+    }
+
+    egl_init_headless(4, 5);
+
+    return ValidateGPUCulling() ? 0 : 1;
+}
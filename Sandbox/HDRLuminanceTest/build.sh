@@ -0,0 +1,15 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="hdr_luminance_test.cpp \
+	$ROOTDIR/DemoLITION/Framework/Source/GL/gl_hdr_luminance.cpp \
+	$ROOTDIR/DemoLITION/Framework/Source/GL/gl_hdr_technique.cpp \
+	$ROOTDIR/DemoLITION/Framework/Source/GL/gl_hdr_adapt_technique.cpp \
+	$ROOTDIR/Common/technique.cpp \
+	$ROOTDIR/Common/ogldev_egl.cpp \
+	$ROOTDIR/Common/ogldev_util.cpp \
+	$ROOTDIR/Common/math_3d.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/DemoLITION/Framework/Include $OGL_CPPFLAGS $OGL_LDFLAGS -lEGL -o hdr_luminance_test
@@ -0,0 +1,166 @@
+/*
+
+        Copyright 2026 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    HDR luminance test
+
+    Runs the two luminance passes of HDRLuminance (hdr.cs and hdr_adapt.cs) on
+    random HDR images of a few sizes and compares the average luminance and the
+    adaptation with the CPU reference. Only the luminance passes are initialized
+    (not the DemoLITION renderer) so it runs on GL 4.5 software drivers such as
+    Mesa llvmpipe:
+
+        LIBGL_ALWAYS_SOFTWARE=1 ./hdr_luminance_test
+
+    Linux only (the context is created through EGL without a window).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <vector>
+
+#include "ogldev_egl.h"
+#include "GL/gl_hdr_luminance.h"
+
+#define NUM_IMAGES 5                // per size
+#define NUM_FRAMES 30               // of adaptation per image
+
+#define DELTA_TIME (1.0f / 60.0f)
+#define ADAPTATION_RATE 1.5f
+
+// The GPU sums in single precision in a different order than the CPU
+#define RELATIVE_TOLERANCE 0.001f
+
+// Full HD, a size which is not a multiple of the 16x16 tiles and a size smaller than a tile
+static const int Sizes[][2] = { { 1920, 1080 }, { 1000, 777 }, { 17, 5 } };
+
+
+static bool Compare(int Width, int Height, int Index, const char* pName, float Value, float Reference)
+{
+    float Error = fabsf(Value - Reference) / fmaxf(fabsf(Reference), 1e-6f);
+
+    if (Error > RELATIVE_TOLERANCE) {
+        printf("%dx%d image %d: mismatch in the %s luminance - GPU %f CPU %f\n", Width, Height, Index, pName, Value, Reference);
+        return false;
+    }
+
+    return true;
+}
+
+
+// The brightness of the images spans several orders of magnitude
+static void CreateImage(int Index, std::vector<float>& Image)
+{
+    float Scale = powf(10.0f, (float)Index - 2.0f);
+
+    for (int i = 0; i < (int)Image.size() / 3; i++) {
+        // A few very bright pixels, like the sun or a light source
+        float Boost = (RandomFloat() < 0.001f) ? 1000.0f : 1.0f;
+
+        for (int c = 0; c < 3; c++) {
+            Image[i * 3 + c] = RandomFloat() * Scale * Boost;
+        }
+    }
+}
+
+
+static bool TestSize(int Width, int Height)
+{
+    HDRLuminance Luminance;
+    Luminance.Init(Width, Height);
+
+    GLuint Texture = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &Texture);
+    glTextureStorage2D(Texture, 1, GL_RGB32F, Width, Height);
+    glTextureParameteri(Texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(Texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    std::vector<float> Image(Width * Height * 3);
+    HDRLuminanceState State;
+
+    bool Ok = true;
+
+    for (int i = 0; (i < NUM_IMAGES) && Ok; i++) {
+        CreateImage(i, Image);
+        glTextureSubImage2D(Texture, 0, 0, 0, Width, Height, GL_RGB, GL_FLOAT, Image.data());
+        glBindTextureUnit(0, Texture);
+
+        float Average = HDRLuminance::CalcAverageLuminance(Image.data(), Width * Height);
+
+        // Without adaptation the adapted luminance is the average as is
+        Luminance.Update(DELTA_TIME, 0.0f);
+        Luminance.ReadState(State);
+
+        Ok = Compare(Width, Height, i, "average", State.AverageLuminance, Average) &&
+             Compare(Width, Height, i, "adapted", State.AdaptedLuminance, Average) &&
+             Compare(Width, Height, i, "exposure", State.Exposure, 0.18f / Average);
+
+        // Adapt from a known value which is far from the average
+        float Start = Average * 50.0f;
+        float Adapted = Start;
+        Luminance.UpdateFromCPU(Adapted, DELTA_TIME, 0.0f);
+
+        for (int Frame = 0; (Frame < NUM_FRAMES) && Ok; Frame++) {
+            Luminance.Update(DELTA_TIME, ADAPTATION_RATE);
+            Luminance.ReadState(State);
+
+            Adapted = HDRLuminance::CalcAdaptedLuminance(Adapted, Average, DELTA_TIME, ADAPTATION_RATE);
+
+            Ok = Compare(Width, Height, i, "adapted", State.AdaptedLuminance, Adapted);
+        }
+
+        // The GPU result must be moving towards the average
+        if (Ok && ((State.AdaptedLuminance >= Start) || (State.AdaptedLuminance <= Average))) {
+            printf("%dx%d image %d: the luminance did not adapt (%f, average %f)\n", Width, Height, i, State.AdaptedLuminance, Average);
+            Ok = false;
+        }
+    }
+
+    glDeleteTextures(1, &Texture);
+
+    if (Ok) {
+        printf("%dx%d: the GPU luminance matches the CPU reference\n", Width, Height);
+    }
+
+    return Ok;
+}
+
+
+int main(int argc, char* argv[])
+{
+    // The shader paths of the techniques are relative to the DemoLITION directory
+    if (chdir("../../DemoLITION") != 0) {
+        printf("This test must run from Sandbox/HDRLuminanceTest\n");
+        return 1;
+    }
+
+    egl_init_headless(4, 5);
+
+    srand(0);
+
+    for (int i = 0; i < (int)ARRAY_SIZE_IN_ELEMENTS(Sizes); i++) {
+        if (!TestSize(Sizes[i][0], Sizes[i][1])) {
+            return 1;
+        }
+    }
+
+    printf("The GPU luminance matches the CPU reference - %d sizes, %d images each\n",
+           (int)ARRAY_SIZE_IN_ELEMENTS(Sizes), NUM_IMAGES);
+
+    return 0;
+}
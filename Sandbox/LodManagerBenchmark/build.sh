@@ -0,0 +1,11 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="lod_manager_benchmark.cpp \
+	$ROOTDIR/Terrain12/lod_manager.cpp \
+	$ROOTDIR/Common/ogldev_util.cpp \
+	$ROOTDIR/Common/math_3d.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/Terrain12 $OGL_CPPFLAGS $OGL_LDFLAGS -o lod_manager_benchmark
@@ -0,0 +1,139 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    LodManager benchmark
+
+    Compares the serial, parallel (SIMD + thread pool) and incremental LOD
+    map updates of Terrain12 on patch grids from 64x64 to 1024x1024 while
+    the camera flies over the terrain. The LOD maps of the fast modes are
+    checked against the serial one on every frame.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+
+#include "ogldev_thread_pool.h"
+#include "lod_manager.h"
+
+#define PATCH_SIZE 17
+#define WORLD_SCALE 4.0f
+#define NUM_FRAMES 300
+#define CAMERA_SPEED 2.0f           // world units per frame
+
+
+static Vector3f GetCameraPos(float WorldSize, int Frame)
+{
+    // Teleport half way through to exercise the fallback to a full update
+    float Start = (Frame < NUM_FRAMES / 2) ? 0.25f : 0.6f;
+
+    float x = WorldSize * Start + Frame * CAMERA_SPEED;
+    float z = WorldSize * Start + Frame * CAMERA_SPEED * 0.5f;
+    float y = 50.0f + 20.0f * sinf(Frame * 0.05f);
+
+    return Vector3f(x, y, z);
+}
+
+
+static bool IsSameLod(const LodManager::PatchLod& a, const LodManager::PatchLod& b)
+{
+    return (a.Core == b.Core) && (a.Left == b.Left) && (a.Right == b.Right) && (a.Top == b.Top) && (a.Bottom == b.Bottom);
+}
+
+
+static void Compare(const LodManager& Reference, const LodManager& Lods, int NumPatches, const char* pMode, int Frame)
+{
+    for (int z = 0 ; z < NumPatches ; z++) {
+        for (int x = 0 ; x < NumPatches ; x++) {
+            if (!IsSameLod(Reference.GetPatchLod(x, z), Lods.GetPatchLod(x, z))) {
+                printf("%s: mismatch in patch %d,%d at frame %d\n", pMode, x, z, Frame);
+                exit(1);
+            }
+        }
+    }
+}
+
+
+static double TimeUpdate(LodManager& Lods, const Vector3f& CameraPos)
+{
+    std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+    Lods.Update(CameraPos);
+
+    std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(End - Start).count();
+}
+
+
+static void Benchmark(int NumPatches, double Times[3])
+{
+    LodManager Serial, Parallel, Incremental;
+
+    Serial.InitLodManager(PATCH_SIZE, NumPatches, NumPatches, WORLD_SCALE);
+    Parallel.InitLodManager(PATCH_SIZE, NumPatches, NumPatches, WORLD_SCALE);
+    Incremental.InitLodManager(PATCH_SIZE, NumPatches, NumPatches, WORLD_SCALE);
+
+    Serial.SetUpdateMode(LOD_UPDATE_SERIAL);
+    Parallel.SetUpdateMode(LOD_UPDATE_PARALLEL);
+    Incremental.SetUpdateMode(LOD_UPDATE_INCREMENTAL);
+
+    float WorldSize = NumPatches * (PATCH_SIZE - 1) * WORLD_SCALE;
+
+    Times[0] = Times[1] = Times[2] = 0.0;
+
+    for (int Frame = 0 ; Frame < NUM_FRAMES ; Frame++) {
+        Vector3f CameraPos = GetCameraPos(WorldSize, Frame);
+
+        Times[0] += TimeUpdate(Serial, CameraPos);
+        Times[1] += TimeUpdate(Parallel, CameraPos);
+        Times[2] += TimeUpdate(Incremental, CameraPos);
+
+        Compare(Serial, Parallel, NumPatches, "Parallel", Frame);
+        Compare(Serial, Incremental, NumPatches, "Incremental", Frame);
+    }
+
+    for (int i = 0 ; i < 3 ; i++) {
+        Times[i] /= NUM_FRAMES;
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    const int GridSizes[] = { 64, 128, 256, 512, 1024 };
+    const int NumGrids = sizeof(GridSizes) / sizeof(GridSizes[0]);
+    double Times[NumGrids][3];
+
+    for (int i = 0 ; i < NumGrids ; i++) {
+        Benchmark(GridSizes[i], Times[i]);
+    }
+
+    printf("\nAverage update time per frame (%d frames, patch size %d, %d worker threads)\n",
+           NUM_FRAMES, PATCH_SIZE, ThreadPool::GetDefault().GetNumThreads());
+    printf("Patches      Serial    Parallel          Incremental\n");
+
+    for (int i = 0 ; i < NumGrids ; i++) {
+        printf("%4dx%-4d %8.3f ms %8.3f ms (%5.1fx) %8.3f ms (%6.1fx)\n", GridSizes[i], GridSizes[i],
+               Times[i][0], Times[i][1], Times[i][0] / Times[i][1], Times[i][2], Times[i][0] / Times[i][2]);
+    }
+
+    printf("\nThe LOD maps of all the modes are identical\n");
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="particle_store_benchmark.cpp \
+	$ROOTDIR/Physics/Source/particle_store.cpp \
+	$ROOTDIR/Common/math_3d.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/Physics/Include $OGL_CPPFLAGS $OGL_LDFLAGS -o particle_store_benchmark
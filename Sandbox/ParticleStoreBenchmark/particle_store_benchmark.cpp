@@ -0,0 +1,265 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Particle store benchmark
+
+    Integrates 1M particles with the structure of arrays ParticleStore of
+    OgldevPhysics (SIMD and scalar) and with the array of structures layout
+    and the per particle Integrate() that the PhysicsSystem used before.
+    Checks that all the methods produce exactly the same particles and that a
+    particle allocated in the middle of the simulation is damped.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include "particle_store.h"
+
+#define NUM_PARTICLES 1000000
+#define NUM_FRAMES 20
+#define FRAME_TIME (1.0f / 60.0f)
+
+using namespace OgldevPhysics;
+
+
+// The layout of the original Particle class
+struct ParticleAoS {
+    Vector3f m_position = Vector3f(0.0f, 0.0f, 0.0f);
+    Vector3f m_velocity = Vector3f(0.0f, 0.0f, 0.0f);
+    Vector3f m_acceleration = Vector3f(0.0f, 0.0f, 0.0f);
+    Vector3f m_forceAccum = Vector3f(0.0f, 0.0f, 0.0f);
+    float m_damping = 0.999f;
+    float m_reciprocalMass = 0.0f;
+
+    void Integrate(float dt)
+    {
+        if (m_reciprocalMass <= 0.0f) {
+            return;
+        }
+
+        m_position += m_velocity * dt;
+
+        Vector3f AccTemp = m_acceleration;
+        AccTemp += m_forceAccum * m_reciprocalMass;
+        m_velocity += AccTemp * dt;
+
+        m_velocity *= powf(m_damping, dt);
+
+        m_forceAccum = Vector3f(0.0f, 0.0f, 0.0f);
+    }
+};
+
+
+static void InitParticles(std::vector<ParticleAoS>& AoS, ParticleStore& Store)
+{
+    AoS.resize(NUM_PARTICLES);
+    Store.Init(NUM_PARTICLES);
+
+    Vector3f Gravity(0.0f, -9.81f, 0.0f);
+
+    srand(0);
+
+    for (int i = 0; i < NUM_PARTICLES; i++) {
+        Vector3f Pos(RandomFloat(), RandomFloat(), RandomFloat());
+        Vector3f Vel(RandomFloatRange(-15.0f, 15.0f), RandomFloatRange(10.0f, 15.0f), RandomFloatRange(-5.0f, 5.0f));
+
+        // A few particles have an infinite mass and a few use a different damping
+        float ReciprocalMass = (i % 100) ? 1.0f : 0.0f;
+        float Damping = (i % 1000) ? 0.95f : 0.99f;
+
+        ParticleAoS& p = AoS[i];
+        p.m_position = Pos;
+        p.m_velocity = Vel;
+        p.m_acceleration = Gravity;
+        p.m_reciprocalMass = ReciprocalMass;
+        p.m_damping = Damping;
+
+        ParticleHandle h = Store.Alloc();
+        Store.SetPosition(h, Pos);
+        Store.SetVelocity(h, Vel);
+        Store.SetAcceleration(h, Gravity);
+        Store.SetReciprocalMass(h, ReciprocalMass);
+        Store.SetDamping(h, Damping);
+    }
+}
+
+
+static void AddForces(std::vector<ParticleAoS>& AoS, ParticleStore& Store, int Frame)
+{
+    for (int i = Frame; i < NUM_PARTICLES; i += 97) {
+        Vector3f Force((float)(i % 7), 1.0f, -(float)(i % 5));
+        AoS[i].m_forceAccum += Force;
+        Store.AddForce(i, Force);
+    }
+}
+
+
+static bool Compare(const std::vector<ParticleAoS>& AoS, const ParticleStore& Store)
+{
+    for (int i = 0; i < NUM_PARTICLES; i++) {
+        Vector3f Pos = Store.GetPosition(i);
+        Vector3f Vel = Store.GetVelocity(i);
+
+        if ((memcmp(&Pos, &AoS[i].m_position, sizeof(Vector3f)) != 0) ||
+            (memcmp(&Vel, &AoS[i].m_velocity, sizeof(Vector3f)) != 0)) {
+            printf("Particle %d doesn't match\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static void Validate()
+{
+    std::vector<ParticleAoS> AoS;
+    ParticleStore Store, StoreRef;
+    std::vector<ParticleAoS> Dummy;
+
+    InitParticles(AoS, Store);
+    InitParticles(Dummy, StoreRef);
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        // A variable time step makes sure the cached damping is updated
+        float dt = FRAME_TIME * (1.0f + (float)(Frame % 3) * 0.1f);
+
+        AddForces(AoS, Store, Frame);
+        AddForces(Dummy, StoreRef, Frame);
+
+        for (ParticleAoS& p : AoS) {
+            p.Integrate(dt);
+        }
+
+        Store.Integrate(dt);
+        StoreRef.IntegrateReference(dt);
+    }
+
+    if (!Compare(AoS, Store) || !Compare(AoS, StoreRef)) {
+        printf("The particle store doesn't match the original particles\n");
+        exit(1);
+    }
+
+    printf("The particle store matches the original particles\n");
+}
+
+
+// A particle that is allocated after the first frame and keeps the default damping
+static void ValidateAllocMidSimulation()
+{
+    ParticleStore Store;
+    Store.Init(2);
+
+    ParticleHandle First = Store.Alloc();
+    Store.SetVelocity(First, Vector3f(1.0f, 0.0f, 0.0f));
+    Store.SetReciprocalMass(First, 1.0f);
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        Store.Integrate(FRAME_TIME);
+    }
+
+    ParticleAoS Ref;
+    Ref.m_velocity = Vector3f(10.0f, 5.0f, -2.0f);
+    Ref.m_reciprocalMass = 1.0f;
+
+    ParticleHandle h = Store.Alloc();
+    Store.SetVelocity(h, Ref.m_velocity);
+    Store.SetReciprocalMass(h, Ref.m_reciprocalMass);
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        Vector3f PrevVel = Store.GetVelocity(h);
+
+        Ref.Integrate(FRAME_TIME);
+        Store.Integrate(FRAME_TIME);
+
+        Vector3f Vel = Store.GetVelocity(h);
+
+        if ((Vel.Length() >= PrevVel.Length()) || (memcmp(&Vel, &Ref.m_velocity, sizeof(Vector3f)) != 0)) {
+            printf("The velocity of a particle allocated during the simulation doesn't decay (frame %d: %f instead of %f)\n",
+                   Frame, Vel.Length(), Ref.m_velocity.Length());
+            exit(1);
+        }
+    }
+
+    printf("A particle allocated during the simulation is damped\n");
+}
+
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double ElapsedMS(Clock::time_point Start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - Start).count();
+}
+
+
+int main(int argc, char* argv[])
+{
+    Validate();
+    ValidateAllocMidSimulation();
+
+    std::vector<ParticleAoS> AoS;
+    ParticleStore Store;
+    InitParticles(AoS, Store);
+
+    Clock::time_point Start = Clock::now();
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        for (ParticleAoS& p : AoS) {
+            p.Integrate(FRAME_TIME);
+        }
+    }
+
+    double AoSTime = ElapsedMS(Start) / NUM_FRAMES;
+
+    Start = Clock::now();
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        Store.IntegrateReference(FRAME_TIME);
+    }
+
+    double ScalarTime = ElapsedMS(Start) / NUM_FRAMES;
+
+    Start = Clock::now();
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        Store.Integrate(FRAME_TIME);
+    }
+
+    double SIMDTime = ElapsedMS(Start) / NUM_FRAMES;
+
+    Start = Clock::now();
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        Store.ClearForces();
+    }
+
+    double ClearTime = ElapsedMS(Start) / NUM_FRAMES;
+
+    printf("%d particles\n", NUM_PARTICLES);
+    printf("Array of structures: %7.2f ms, %8.0f particles/ms\n", AoSTime, NUM_PARTICLES / AoSTime);
+    printf("Store (scalar):      %7.2f ms, %8.0f particles/ms\n", ScalarTime, NUM_PARTICLES / ScalarTime);
+    printf("Store (SIMD):        %7.2f ms, %8.0f particles/ms\n", SIMDTime, NUM_PARTICLES / SIMDTime);
+    printf("Clear forces:        %7.2f ms, %8.0f particles/ms\n", ClearTime, NUM_PARTICLES / ClearTime);
+    printf("Speedup %.2fx\n", AoSTime / SIMDTime);
+
+    return 0;
+}
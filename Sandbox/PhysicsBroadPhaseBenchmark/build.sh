@@ -0,0 +1,14 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="physics_broad_phase_benchmark.cpp \
+	$ROOTDIR/PhysicsForGameDev/Source/physics_system.cpp \
+	$ROOTDIR/PhysicsForGameDev/Source/broad_phase.cpp \
+	$ROOTDIR/PhysicsForGameDev/Source/contact_islands.cpp \
+	$ROOTDIR/PhysicsForGameDev/Source/point_mass.cpp \
+	$ROOTDIR/PhysicsForGameDev/Source/rigid_body.cpp \
+	$ROOTDIR/Common/ogldev_util.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/PhysicsForGameDev/Include $OGL_CPPFLAGS $OGL_LDFLAGS -o physics_broad_phase_benchmark
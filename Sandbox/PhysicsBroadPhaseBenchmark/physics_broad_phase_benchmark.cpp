@@ -0,0 +1,123 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Physics broad phase benchmark
+
+    Measures the point mass collision step of Physics::System from 1k to
+    100k point masses with the spatial hash broad phase and with the brute
+    force double loop (which is only measured up to 10k). The density of
+    the point masses is the same in all the runs. Also checks that both
+    methods leave the point masses in exactly the same state.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include "physics_system.h"
+
+#define NUM_STEPS 10
+#define MAX_BRUTE_FORCE_POINT_MASSES 10000
+#define POINT_MASS_RADIUS 0.5f
+#define POINT_MASSES_PER_UNIT 0.2f      // about 10% of the volume
+
+
+static void InitScene(Physics::System& PhysicsSystem, int NumPointMasses, bool UseBroadPhase)
+{
+    PhysicsSystem.Init(NumPointMasses, 0, NULL, glm::vec3(0.0f));
+    PhysicsSystem.SetBroadPhase(UseBroadPhase);
+
+    float BoxSize = cbrtf((float)NumPointMasses / POINT_MASSES_PER_UNIT);
+
+    srand(NumPointMasses);
+
+    for (int i = 0; i < NumPointMasses; i++) {
+        Physics::PointMass* pm = PhysicsSystem.AllocPointMass();
+
+        glm::vec3 Pos((float)rand() / RAND_MAX, (float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
+        glm::vec3 Vel((float)rand() / RAND_MAX, (float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
+
+        pm->Init(1.0f, Pos * BoxSize, glm::vec3(0.0f), NULL);
+        pm->SetBoundingRadius(POINT_MASS_RADIUS);
+        pm->SetLinearVelocity((Vel - glm::vec3(0.5f)) * 4.0f);
+    }
+}
+
+
+// Returns the time in milliseconds per step
+static double Measure(Physics::System& PhysicsSystem)
+{
+    std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < NUM_STEPS; i++) {
+        PhysicsSystem.Update(1.0 / 60.0);
+    }
+
+    std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(End - Start).count() / NUM_STEPS;
+}
+
+
+static bool Compare(Physics::System& System1, Physics::System& System2, int NumPointMasses)
+{
+    for (int i = 0; i < NumPointMasses; i++) {
+        Physics::PointMass* pm1 = System1.GetPointMass(i);
+        Physics::PointMass* pm2 = System2.GetPointMass(i);
+
+        if ((pm1->GetPos() != pm2->GetPos()) || (pm1->GetLinearVelocity() != pm2->GetLinearVelocity())) {
+            printf("Point mass %d doesn't match\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int Counts[] = { 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+
+    printf("Point masses    Broad phase    Brute force    Speedup\n");
+
+    for (int NumPointMasses : Counts) {
+        Physics::System BroadPhase;
+        InitScene(BroadPhase, NumPointMasses, true);
+        double BroadPhaseTime = Measure(BroadPhase);
+
+        if (NumPointMasses > MAX_BRUTE_FORCE_POINT_MASSES) {
+            printf("%12d %11.3f ms\n", NumPointMasses, BroadPhaseTime);
+            continue;
+        }
+
+        Physics::System BruteForce;
+        InitScene(BruteForce, NumPointMasses, false);
+        double BruteForceTime = Measure(BruteForce);
+
+        if (!Compare(BroadPhase, BruteForce, NumPointMasses)) {
+            printf("The broad phase doesn't match the brute force with %d point masses\n", NumPointMasses);
+            exit(1);
+        }
+
+        printf("%12d %11.3f ms %11.3f ms %9.1fx\n", NumPointMasses, BroadPhaseTime, BruteForceTime, BruteForceTime / BroadPhaseTime);
+    }
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Terrain file benchmark
+
+    Creates a TerrainFile from a fractal height map and compares its load
+    time with the raw float files that BaseTerrain used to load. BaseTerrain
+    keeps the file mapped and dequantizes the heights on access so the time
+    to read every height through GetHeight() is measured as well. Checks the
+    quantization, the patch bounds and the LOD errors and that the error
+    driven LOD maps of all the LodManager update modes are identical.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <vector>
+#include <chrono>
+
+#include "ogldev_array_2d.h"
+#include "ogldev_thread_pool.h"
+#include "terrain_file.h"
+#include "lod_manager.h"
+
+#define TERRAIN_SIZE 4097
+#define PATCH_SIZE 33
+#define WORLD_SCALE 4.0f
+#define MAX_HEIGHT 400.0f
+#define MAX_ERROR_PER_DISTANCE 0.0015f
+#define NUM_FRAMES 300
+#define CAMERA_SPEED 4.0f           // world units per frame
+
+#define RAW_FILENAME "terrain_benchmark.raw"
+#define TERRAIN_FILENAME "terrain_benchmark.ogt"
+
+
+static double GetTimeMs()
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+
+static float Hash(int x, int z)
+{
+    unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)z * 19349663u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return (float)(h & 0xffff) / 65535.0f;
+}
+
+
+static float ValueNoise(float x, float z)
+{
+    int x0 = (int)floorf(x);
+    int z0 = (int)floorf(z);
+
+    float fx = x - x0;
+    float fz = z - z0;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fz = fz * fz * (3.0f - 2.0f * fz);
+
+    float Bottom = Hash(x0, z0) + (Hash(x0 + 1, z0) - Hash(x0, z0)) * fx;
+    float Top = Hash(x0, z0 + 1) + (Hash(x0 + 1, z0 + 1) - Hash(x0, z0 + 1)) * fx;
+
+    return Bottom + (Top - Bottom) * fz;
+}
+
+
+// Mountains on one half and a flat plain on the other so that the LOD errors vary
+static void CreateHeights(std::vector<float>& Heights)
+{
+    Heights.resize(TERRAIN_SIZE * TERRAIN_SIZE);
+
+    ThreadPool::GetDefault().ParallelFor(TERRAIN_SIZE, 64, [&](int Start, int End) {
+        for (int z = Start ; z < End ; z++) {
+            for (int x = 0 ; x < TERRAIN_SIZE ; x++) {
+                float Height = 0.0f;
+                float Amplitude = 0.5f;
+                float Frequency = 1.0f / 256.0f;
+
+                for (int i = 0 ; i < 6 ; i++) {
+                    Height += ValueNoise(x * Frequency, z * Frequency) * Amplitude;
+                    Amplitude *= 0.5f;
+                    Frequency *= 2.0f;
+                }
+
+                float Mountains = std::min(std::max((x - TERRAIN_SIZE * 0.4f) / (TERRAIN_SIZE * 0.2f), 0.0f), 1.0f);
+
+                Heights[z * TERRAIN_SIZE + x] = Height * MAX_HEIGHT * Mountains;
+            }
+        }
+    });
+}
+
+
+static void Validate(const TerrainFile& File, const std::vector<float>& Heights)
+{
+    float HeightStep = (File.GetMaxHeight() - File.GetMinHeight()) / 65535.0f;
+
+    std::vector<float> Loaded(Heights.size());
+    File.GetHeights(Loaded.data());
+
+    for (int i = 0 ; i < (int)Heights.size() ; i++) {
+        if (fabsf(Loaded[i] - Heights[i]) > HeightStep * 0.5f + 1e-3f) {
+            printf("Quantization error too large at %d: %f instead of %f\n", i, Loaded[i], Heights[i]);
+            exit(1);
+        }
+    }
+
+    int NumPatches = File.GetNumPatches();
+
+    for (int PatchZ = 0 ; PatchZ < NumPatches ; PatchZ++) {
+        for (int PatchX = 0 ; PatchX < NumPatches ; PatchX++) {
+            float MinHeight = File.GetPatchMinHeight(PatchX, PatchZ);
+            float MaxHeight = File.GetPatchMaxHeight(PatchX, PatchZ);
+
+            for (int z = 0 ; z < PATCH_SIZE ; z++) {
+                for (int x = 0 ; x < PATCH_SIZE ; x++) {
+                    float Height = File.GetHeight(PatchX * (PATCH_SIZE - 1) + x, PatchZ * (PATCH_SIZE - 1) + z);
+
+                    if ((Height < MinHeight) || (Height > MaxHeight)) {
+                        printf("Height %f is outside the bounds of patch %d,%d\n", Height, PatchX, PatchZ);
+                        exit(1);
+                    }
+                }
+            }
+
+            const float* pErrors = File.GetLodErrors(PatchX, PatchZ);
+
+            if (pErrors[0] != 0.0f) {
+                printf("LOD 0 of patch %d,%d has an error of %f\n", PatchX, PatchZ, pErrors[0]);
+                exit(1);
+            }
+
+            for (int Lod = 1 ; Lod < File.GetNumLods() ; Lod++) {
+                if ((pErrors[Lod] < pErrors[Lod - 1]) || (pErrors[Lod] > MaxHeight - MinHeight)) {
+                    printf("Invalid error %f of LOD %d of patch %d,%d\n", pErrors[Lod], Lod, PatchX, PatchZ);
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    printf("The heights, the patch bounds and the LOD errors are valid\n");
+}
+
+
+static void CompareLodMaps(const TerrainFile& File)
+{
+    int NumPatches = File.GetNumPatches();
+    float WorldSize = (TERRAIN_SIZE - 1) * WORLD_SCALE;
+
+    LodManager Lods[3];
+    LOD_UPDATE_MODE Modes[3] = { LOD_UPDATE_SERIAL, LOD_UPDATE_PARALLEL, LOD_UPDATE_INCREMENTAL };
+
+    for (int i = 0 ; i < 3 ; i++) {
+        Lods[i].InitLodManager(PATCH_SIZE, NumPatches, NumPatches, WORLD_SCALE);
+        Lods[i].SetUpdateMode(Modes[i]);
+        Lods[i].SetLodErrors(File.GetLodErrors(), MAX_ERROR_PER_DISTANCE);
+    }
+
+    int NumLods = File.GetNumLods();
+    std::vector<int> Histogram(NumLods, 0);
+
+    for (int Frame = 0 ; Frame < NUM_FRAMES ; Frame++) {
+        Vector3f CameraPos(WorldSize * 0.25f + Frame * CAMERA_SPEED, 100.0f, WorldSize * 0.5f);
+
+        for (int i = 0 ; i < 3 ; i++) {
+            Lods[i].Update(CameraPos);
+        }
+
+        for (int z = 0 ; z < NumPatches ; z++) {
+            for (int x = 0 ; x < NumPatches ; x++) {
+                const LodManager::PatchLod& a = Lods[0].GetPatchLod(x, z);
+
+                for (int i = 1 ; i < 3 ; i++) {
+                    const LodManager::PatchLod& b = Lods[i].GetPatchLod(x, z);
+
+                    if ((a.Core != b.Core) || (a.Left != b.Left) || (a.Right != b.Right) || (a.Top != b.Top) || (a.Bottom != b.Bottom)) {
+                        printf("Mode %d: mismatch in patch %d,%d at frame %d\n", i, x, z, Frame);
+                        exit(1);
+                    }
+                }
+
+                if (Frame == NUM_FRAMES - 1) {
+                    Histogram[a.Core]++;
+                }
+            }
+        }
+    }
+
+    printf("The error driven LOD maps of all the update modes are identical\n");
+    printf("Patches per LOD at the last frame:");
+
+    for (int Lod = 0 ; Lod < NumLods ; Lod++) {
+        printf(" %d", Histogram[Lod]);
+    }
+
+    printf("\n");
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<float> Heights;
+    CreateHeights(Heights);
+
+    // The old format - raw floats
+    FILE* f = fopen(RAW_FILENAME, "wb");
+
+    if (!f || (fwrite(Heights.data(), sizeof(float), Heights.size(), f) != Heights.size())) {
+        printf("Error writing '%s'\n", RAW_FILENAME);
+        exit(1);
+    }
+
+    fclose(f);
+
+    double Start = GetTimeMs();
+
+    if (!TerrainFile::Create(TERRAIN_FILENAME, Heights.data(), TERRAIN_SIZE, PATCH_SIZE, WORLD_SCALE)) {
+        exit(1);
+    }
+
+    double CreateTime = GetTimeMs() - Start;
+
+    // Same steps as the old BaseTerrain::LoadHeightMapFile
+    Start = GetTimeMs();
+
+    int FileSize = 0;
+    char* p = ReadBinaryFile(RAW_FILENAME, FileSize);
+    Array2D<float> RawHeightMap;
+    RawHeightMap.InitArray2D(TERRAIN_SIZE, TERRAIN_SIZE, (float*)p);
+
+    double RawLoadTime = GetTimeMs() - Start;
+
+    Start = GetTimeMs();
+
+    TerrainFile File;
+
+    if (!File.Open(TERRAIN_FILENAME)) {
+        exit(1);
+    }
+
+    double OpenTime = GetTimeMs() - Start;
+
+    // The cost that moved from the load to the users of the heights (e.g. the vertices of GeomipGrid)
+    Start = GetTimeMs();
+
+    double Sum = 0.0;
+
+    for (int z = 0; z < TERRAIN_SIZE; z++) {
+        for (int x = 0; x < TERRAIN_SIZE; x++) {
+            Sum += File.GetHeight(x, z);
+        }
+    }
+
+    double AccessTime = GetTimeMs() - Start;
+
+    // The old LoadFromFile dequantized everything into a float copy
+    Start = GetTimeMs();
+
+    Array2D<float> HeightMap;
+    HeightMap.InitArray2D(TERRAIN_SIZE, TERRAIN_SIZE);
+    File.GetHeights(HeightMap.GetBaseAddr());
+
+    double DequantizeTime = GetTimeMs() - Start;
+
+    Validate(File, Heights);
+    CompareLodMaps(File);
+
+    printf("\nTerrain %dx%d, patch size %d, %d LODs, %d worker threads\n", TERRAIN_SIZE, TERRAIN_SIZE, PATCH_SIZE,
+           File.GetNumLods(), ThreadPool::GetDefault().GetNumThreads());
+    printf("Create:                 %8.2f ms\n", CreateTime);
+    printf("Raw floats:             %8.2f ms (%.1f MB)\n", RawLoadTime, FileSize / 1048576.0);
+    printf("Terrain file (open):    %8.2f ms (%.1f MB)\n", OpenTime, File.GetFileSize() / 1048576.0);
+    printf("Terrain file (access):  %8.2f ms (every height through GetHeight, average %.2f)\n", AccessTime,
+           Sum / ((double)TERRAIN_SIZE * TERRAIN_SIZE));
+    printf("Terrain file (copy):    %8.2f ms (dequantized into a float array)\n", DequantizeTime);
+
+    File.Close();
+
+    remove(RAW_FILENAME);
+    remove(TERRAIN_FILENAME);
+
+    return 0;
+}
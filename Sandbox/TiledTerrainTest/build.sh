@@ -0,0 +1,13 @@
+#!/bin/bash
+
+ROOTDIR="../.."
+source ../../build_base.sh
+
+SOURCES="tiled_terrain_test.cpp \
+	$ROOTDIR/Terrain12/tiled_height_file.cpp \
+	$ROOTDIR/Terrain12/terrain_tile_streamer.cpp \
+	$ROOTDIR/Common/ogldev_normal_baker.cpp \
+	$ROOTDIR/Common/ogldev_util.cpp \
+	$ROOTDIR/Common/math_3d.cpp "
+
+$CC -O2 $SOURCES -I$ROOTDIR/Terrain12 $OGL_CPPFLAGS $OGL_LDFLAGS -o tiled_terrain_test
@@ -0,0 +1,324 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    Tiled terrain streaming test
+
+    Creates a tiled height file, walks a camera across it and reports the
+    number of resident tiles, the memory and the tile load latency.
+
+    Usage: tiled_terrain_test [terrain size] [tile size] [filename]
+    A 65536 x 65536 terrain requires 16GB of disk space.
+*/
+
+#ifdef _WIN64
+#include <Windows.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "tiled_height_file.h"
+#include "terrain_tile_streamer.h"
+
+#define PATCH_SIZE 33
+#define WORLD_SCALE 4.0f
+#define TEXTURE_SCALE 16.0f
+#define TILE_RADIUS 2
+#define NUM_FRAMES 600
+#define FRAME_TIME_MS 16
+
+
+static float TestHeight(int x, int z)
+{
+    unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)z * 19349663u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+
+    return sinf(x * 0.01f) * 100.0f + cosf(z * 0.013f) * 100.0f + (float)(h & 0xff) / 64.0f;
+}
+
+
+static double GetTimeMs()
+{
+    static std::chrono::high_resolution_clock::time_point Start = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+}
+
+
+// Resident set size of the process or zero if it is not available
+static size_t GetResidentBytes()
+{
+#ifdef __linux__
+    FILE* f = fopen("/proc/self/statm", "r");
+
+    if (!f) {
+        return 0;
+    }
+
+    unsigned long Size = 0, Resident = 0;
+    int NumItems = fscanf(f, "%lu %lu", &Size, &Resident);
+    fclose(f);
+
+    return (NumItems == 2) ? Resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+
+static void CheckHeights(const TiledHeightFile& File)
+{
+    int Size = File.GetTerrainSize();
+
+    srand(0);
+
+    for (int i = 0; i < 100000; i++) {
+        int x = rand() % Size;
+        int z = rand() % Size;
+
+        if (File.GetHeight(x, z) != TestHeight(x, z)) {
+            printf("Height mismatch at %d,%d\n", x, z);
+            exit(1);
+        }
+    }
+
+    // Outside the terrain the heights are clamped
+    if ((File.GetHeight(-5, Size + 5) != TestHeight(0, Size - 1)) ||
+        (File.GetHeight(Size, -1) != TestHeight(Size - 1, 0))) {
+        printf("The heights outside the terrain are not clamped\n");
+        exit(1);
+    }
+
+    printf("The heights match the generator\n");
+}
+
+
+static void CheckTile(const TiledHeightFile& File, const TerrainTileStreamer::Tile& Tile)
+{
+    int TileSize = File.GetTileSize();
+    int NumVertices = TileSize + 1;
+
+    if ((int)Tile.Vertices.size() != NumVertices * NumVertices) {
+        printf("Tile %d,%d has %zu vertices\n", Tile.TileX, Tile.TileZ, Tile.Vertices.size());
+        exit(1);
+    }
+
+    for (int z = 0; z < NumVertices; z += 37) {
+        for (int x = 0; x < NumVertices; x += 41) {
+            const TerrainTileVertex& v = Tile.Vertices[z * NumVertices + x];
+
+            int TerrainX = Tile.TileX * TileSize + x;
+            int TerrainZ = Tile.TileZ * TileSize + z;
+
+            if ((v.Pos.x != TerrainX * WORLD_SCALE) || (v.Pos.z != TerrainZ * WORLD_SCALE) ||
+                (v.Pos.y != File.GetHeight(TerrainX, TerrainZ)) || (fabsf(v.Normal.Length() - 1.0f) > 0.001f) ||
+                (v.Normal.y <= 0.0f)) {
+                printf("Bad vertex %d,%d in tile %d,%d\n", x, z, Tile.TileX, Tile.TileZ);
+                exit(1);
+            }
+        }
+    }
+
+    if ((Tile.Bounds.MinY > Tile.Vertices[0].Pos.y) || (Tile.Bounds.MaxY < Tile.Vertices[0].Pos.y)) {
+        printf("The box of tile %d,%d doesn't contain its vertices\n", Tile.TileX, Tile.TileZ);
+        exit(1);
+    }
+}
+
+
+// Every resident tile must be inside the window and appear only once
+static void CheckSlots(const TerrainTileStreamer& Streamer)
+{
+    int WindowX, WindowZ, WindowTiles;
+    Streamer.GetWindow(WindowX, WindowZ, WindowTiles);
+
+    std::vector<int> Count(WindowTiles * WindowTiles, 0);
+
+    for (int Slot = 0; Slot < Streamer.GetNumSlots(); Slot++) {
+        const TerrainTileStreamer::Tile* pTile = Streamer.GetSlot(Slot);
+
+        if (!pTile) {
+            continue;
+        }
+
+        int x = pTile->TileX - WindowX;
+        int z = pTile->TileZ - WindowZ;
+
+        if ((x < 0) || (x >= WindowTiles) || (z < 0) || (z >= WindowTiles) || (++Count[z * WindowTiles + x] > 1)) {
+            printf("Slot %d holds tile %d,%d which is either outside the window or duplicated\n", Slot, pTile->TileX, pTile->TileZ);
+            exit(1);
+        }
+    }
+}
+
+
+// A diagonal across the terrain with a sideways wave
+static Vector3f GetCameraPos(float WorldSize, int Frame)
+{
+    float t = (float)Frame / (float)(NUM_FRAMES - 1);
+
+    float x = WorldSize * (0.1f + 0.8f * t);
+    float z = WorldSize * (0.1f + 0.8f * t + 0.05f * sinf(t * 20.0f));
+
+    return Vector3f(x, 300.0f, z);
+}
+
+
+static void StreamingTest(const TiledHeightFile& File)
+{
+    TerrainTileStreamer Streamer;
+    Streamer.Init(&File, PATCH_SIZE, WORLD_SCALE, TEXTURE_SCALE, TILE_RADIUS);
+
+    float WorldSize = File.GetTerrainSize() * WORLD_SCALE;
+    size_t TileBytes = Streamer.GetVerticesPerTile() * sizeof(TerrainTileVertex);
+
+    printf("\n%d slots, GPU pool %.1f MB\n", Streamer.GetNumSlots(), (double)(Streamer.GetNumSlots() * TileBytes) / (1024.0 * 1024.0));
+    printf("Walking %d frames, %.1f tiles per second\n", NUM_FRAMES,
+           sqrtf(2.0f) * 0.8f * File.GetNumTiles() / (NUM_FRAMES * FRAME_TIME_MS / 1000.0f));
+
+    std::vector<double> Latencies;
+    double TotalUpdateMs = 0.0;
+    double MaxUpdateMs = 0.0;
+    double TotalResident = 0.0;
+    int MaxResident = 0;
+    int NumMissingFrames = 0;
+    size_t MaxCPUBytes = 0;
+    size_t StartRSS = GetResidentBytes();
+    size_t MaxRSS = StartRSS;
+
+    for (int Frame = 0; Frame < NUM_FRAMES; Frame++) {
+        double FrameStart = GetTimeMs();
+
+        bool TilesMissing = Streamer.Update(GetCameraPos(WorldSize, Frame));
+
+        double UpdateMs = GetTimeMs() - FrameStart;
+        TotalUpdateMs += UpdateMs;
+        MaxUpdateMs = std::max(MaxUpdateMs, UpdateMs);
+
+        // This is where the renderer uploads the new tiles
+        for (int Slot : Streamer.GetNewSlots()) {
+            CheckTile(File, *Streamer.GetSlot(Slot));
+            Latencies.push_back(Streamer.GetSlot(Slot)->LatencyMs);
+        }
+
+        CheckSlots(Streamer);
+
+        const TerrainTileStreamer::Stats& Stats = Streamer.GetStats();
+        TotalResident += Stats.NumResident;
+        MaxResident = std::max(MaxResident, Stats.NumResident);
+        MaxCPUBytes = std::max(MaxCPUBytes, Stats.CPUBytes);
+        MaxRSS = std::max(MaxRSS, GetResidentBytes());
+
+        if (TilesMissing) {
+            NumMissingFrames++;
+        }
+
+        if (Frame % 100 == 0) {
+            printf("Frame %d: resident %d loading %d loaded %d evicted %d\n", Frame,
+                   Stats.NumResident, Stats.NumLoading, Stats.NumLoaded, Stats.NumEvicted);
+        }
+
+        double FrameMs = GetTimeMs() - FrameStart;
+
+        if (FrameMs < FRAME_TIME_MS) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(FRAME_TIME_MS - FrameMs));
+        }
+    }
+
+    // Once the camera stops the entire window must become resident
+    Vector3f LastPos = GetCameraPos(WorldSize, NUM_FRAMES - 1);
+    double WaitStart = GetTimeMs();
+
+    while (Streamer.Update(LastPos)) {
+        for (int Slot : Streamer.GetNewSlots()) {
+            CheckTile(File, *Streamer.GetSlot(Slot));
+            Latencies.push_back(Streamer.GetSlot(Slot)->LatencyMs);
+        }
+
+        if (GetTimeMs() - WaitStart > 10000.0) {
+            printf("The window did not become resident\n");
+            exit(1);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(FRAME_TIME_MS));
+    }
+
+    CheckSlots(Streamer);
+
+    const TerrainTileStreamer::Stats& Stats = Streamer.GetStats();
+
+    std::sort(Latencies.begin(), Latencies.end());
+    double Median = Latencies.empty() ? 0.0 : Latencies[Latencies.size() / 2];
+    double P95 = Latencies.empty() ? 0.0 : Latencies[Latencies.size() * 95 / 100];
+
+    printf("\nResident tiles: average %.1f max %d of %d slots\n", TotalResident / NUM_FRAMES, MaxResident, Streamer.GetNumSlots());
+    printf("Frames with missing tiles: %d of %d\n", NumMissingFrames, NUM_FRAMES);
+    printf("Tiles loaded %d evicted %d\n", Stats.NumLoaded, Stats.NumEvicted);
+    printf("Load latency: average %.2f ms median %.2f ms p95 %.2f ms max %.2f ms\n", Stats.AvgLatencyMs, Median, P95, Stats.MaxLatencyMs);
+    printf("Update on the main thread: average %.3f ms max %.3f ms\n", TotalUpdateMs / NUM_FRAMES, MaxUpdateMs);
+    printf("Streamer CPU memory: max %.1f MB\n", (double)MaxCPUBytes / (1024.0 * 1024.0));
+
+    if (StartRSS > 0) {
+        printf("Process resident memory: start %.1f MB max %.1f MB (file size %.1f MB)\n", (double)StartRSS / (1024.0 * 1024.0),
+               (double)MaxRSS / (1024.0 * 1024.0), (double)File.GetFileSize() / (1024.0 * 1024.0));
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    int TerrainSize = (argc > 1) ? atoi(argv[1]) : 8192;
+    int TileSize = (argc > 2) ? atoi(argv[2]) : 256;
+    const char* pFilename = (argc > 3) ? argv[3] : "tiled_terrain_test.bin";
+
+    printf("Creating a %d x %d terrain with tiles of %d\n", TerrainSize, TerrainSize, TileSize);
+
+    double Start = GetTimeMs();
+
+    if (!TiledHeightFile::Create(pFilename, TerrainSize, TileSize, TestHeight)) {
+        return 1;
+    }
+
+    printf("Created '%s' in %.1f seconds\n", pFilename, (GetTimeMs() - Start) / 1000.0);
+
+    TiledHeightFile File;
+
+    if (!File.Open(pFilename)) {
+        return 1;
+    }
+
+    CheckHeights(File);
+
+    // Drop the pages that were touched by the checks so the measurement starts from a cold file
+    for (int z = 0; z < File.GetNumTiles(); z++) {
+        for (int x = 0; x < File.GetNumTiles(); x++) {
+            File.ReleaseTile(x, z);
+        }
+    }
+
+    StreamingTest(File);
+
+    File.Close();
+    remove(pFilename);
+
+    return 0;
+}
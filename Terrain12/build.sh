@@ -8,8 +8,13 @@ SOURCES="terrain_demo12.cpp \
 	midpoint_disp_terrain.cpp \
 	terrain.cpp \
 	lod_manager.cpp \
+	tiled_height_file.cpp \
+	terrain_file.cpp \
+	terrain_tile_streamer.cpp \
+	tiled_geomip_grid.cpp \
 	$ROOTDIR/Common/ogldev_util.cpp \
 	$ROOTDIR/Common/math_3d.cpp \
+	$ROOTDIR/Common/ogldev_normal_baker.cpp \
 	$ROOTDIR/Common/ogldev_basic_glfw_camera.cpp \
 	$ROOTDIR/Common/ogldev_glfw.cpp \
 	$ROOTDIR/Common/ogldev_stb_image.cpp \
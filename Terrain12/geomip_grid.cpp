@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "ogldev_math_3d.h"
+#include "ogldev_normal_baker.h"
 #include "geomip_grid.h"
 #include "terrain.h"
 
@@ -55,6 +56,37 @@ void GeomipGrid::Destroy()
 
 
 void GeomipGrid::CreateGeomipGrid(int Width, int Depth, int PatchSize, const BaseTerrain* pTerrain)
+{
+    ValidateSizes(Width, Depth, PatchSize);
+
+    m_width = Width;
+    m_depth = Depth;
+    m_patchSize = PatchSize;
+    m_pTerrain = pTerrain;
+
+    m_numPatchesX = (Width - 1) / (PatchSize - 1);
+    m_numPatchesZ = (Depth - 1) / (PatchSize - 1);
+
+    m_worldScale = pTerrain->GetWorldScale();
+    m_maxLOD = m_lodManager.InitLodManager(PatchSize, m_numPatchesX, m_numPatchesZ, m_worldScale);
+    m_lodInfo.resize(m_maxLOD + 1);
+
+    m_patchWorldSize = (m_patchSize - 1) * m_worldScale;  // m_patchSize is in vertices and PatchSize is the actual size (2 vertices --> size 1)
+    m_patchWorldHalfSize = m_patchWorldSize / 2.0f;
+
+    CreateGLState();
+
+	PopulateBuffers(pTerrain);
+
+    CalcPatchBounds();
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+
+void GeomipGrid::ValidateSizes(int Width, int Depth, int PatchSize)
 {
     if ((Width - 1) % (PatchSize - 1) != 0) {
         int RecommendedWidth = ((Width - 1 + PatchSize - 1) / (PatchSize - 1)) * (PatchSize - 1) + 1;
@@ -79,25 +111,43 @@ void GeomipGrid::CreateGeomipGrid(int Width, int Depth, int PatchSize, const Bas
         printf("Patch size must be an odd number (%d)\n", PatchSize);
         exit(0);
     }
+}
 
-    m_width = Width;
-    m_depth = Depth;
+
+void GeomipGrid::CreateTilePool(int TileSize, int PatchSize, int NumSlots, float WorldScale)
+{
+    static_assert(sizeof(TerrainTileVertex) == sizeof(Vertex));
+
+    ValidateSizes(TileSize, TileSize, PatchSize);
+
+    m_width = TileSize;
+    m_depth = TileSize;
     m_patchSize = PatchSize;
-    m_pTerrain = pTerrain;
+    m_pTerrain = NULL;
+    m_verticesPerTile = TileSize * TileSize;
 
-    m_numPatchesX = (Width - 1) / (PatchSize - 1);
-    m_numPatchesZ = (Depth - 1) / (PatchSize - 1);
+    m_numPatchesX = (TileSize - 1) / (PatchSize - 1);
+    m_numPatchesZ = m_numPatchesX;
 
-    m_worldScale = pTerrain->GetWorldScale();
+    m_worldScale = WorldScale;
     m_maxLOD = m_lodManager.InitLodManager(PatchSize, m_numPatchesX, m_numPatchesZ, m_worldScale);
     m_lodInfo.resize(m_maxLOD + 1);
 
-    m_patchWorldSize = (m_patchSize - 1) * m_worldScale;  // m_patchSize is in vertices and PatchSize is the actual size (2 vertices --> size 1)
+    m_patchWorldSize = (m_patchSize - 1) * m_worldScale;
     m_patchWorldHalfSize = m_patchWorldSize / 2.0f;
 
     CreateGLState();
 
-	PopulateBuffers(pTerrain);
+    // The tiles are uploaded by UpdateTile() as they are streamed in
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * m_verticesPerTile * NumSlots, NULL, GL_DYNAMIC_DRAW);
+
+    int NumIndices = CalcNumIndices();
+    std::vector<unsigned int> Indices;
+    Indices.resize(NumIndices);
+
+    NumIndices = InitIndices(Indices);
+
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Indices[0]) * NumIndices, &Indices[0], GL_STATIC_DRAW);
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -105,6 +155,41 @@ void GeomipGrid::CreateGeomipGrid(int Width, int Depth, int PatchSize, const Bas
 }
 
 
+void GeomipGrid::UpdateTile(int Slot, const std::vector<TerrainTileVertex>& Vertices)
+{
+    assert((int)Vertices.size() == m_verticesPerTile);
+
+    size_t TileBytes = sizeof(Vertex) * m_verticesPerTile;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vb);
+    glBufferSubData(GL_ARRAY_BUFFER, Slot * TileBytes, TileBytes, Vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void GeomipGrid::RenderTilePatches(const std::vector<TilePatch>& Patches)
+{
+    glBindVertexArray(m_vao);
+
+    for (const TilePatch& Patch : Patches) {
+        const LodManager::PatchLod& plod = Patch.Lod;
+
+        const SingleLodInfo& Info = m_lodInfo[plod.Core].info[plod.Left][plod.Right][plod.Top][plod.Bottom];
+
+        size_t BaseIndex = sizeof(unsigned int) * Info.Start;
+
+        int x = Patch.PatchX * (m_patchSize - 1);
+        int z = Patch.PatchZ * (m_patchSize - 1);
+
+        int BaseVertex = Patch.Slot * m_verticesPerTile + z * m_width + x;
+
+        glDrawElementsBaseVertex(GL_TRIANGLES, Info.Count, GL_UNSIGNED_INT, (void*)BaseIndex, BaseVertex);
+    }
+
+    glBindVertexArray(0);
+}
+
+
 void GeomipGrid::CreateGLState()
 {
     glGenVertexArrays(1, &m_vao);
@@ -152,7 +237,7 @@ void GeomipGrid::PopulateBuffers(const BaseTerrain* pTerrain)
     NumIndices = InitIndices(Indices);
     printf("Final number of indices %d\n", NumIndices);
 
-    CalcNormals(Vertices, Indices);
+    CalcNormals(pTerrain, Vertices);
 
     glBufferData(GL_ARRAY_BUFFER, sizeof(Vertices[0]) * Vertices.size(), &Vertices[0], GL_STATIC_DRAW);
 
@@ -345,35 +430,21 @@ uint GeomipGrid::AddTriangle(uint Index, std::vector<uint>& Indices, uint v1, ui
 }
 
 
-void GeomipGrid::CalcNormals(std::vector<Vertex>& Vertices, std::vector<uint>& Indices)
+void GeomipGrid::CalcNormals(const BaseTerrain* pTerrain, std::vector<Vertex>& Vertices)
 {
-    unsigned int Index = 0;
-
-    // Accumulate each triangle normal into each of the triangle vertices
-    for (int z = 0 ; z < m_depth - 1 ; z += (m_patchSize - 1)) {
-        for (int x = 0 ; x < m_width - 1; x += (m_patchSize - 1)) {
-            int BaseVertex = z * m_width + x;
-            //printf("Base index %d\n", BaseVertex);
-            int NumIndices = m_lodInfo[0].info[0][0][0][0].Count;
-            for (int i = 0 ; i < NumIndices ; i += 3) {
-                unsigned int Index0 = BaseVertex + Indices[i];
-                unsigned int Index1 = BaseVertex + Indices[i + 1];
-                unsigned int Index2 = BaseVertex + Indices[i + 2];
-		        Vector3f v1 = Vertices[Index1].Pos - Vertices[Index0].Pos;
-		        Vector3f v2 = Vertices[Index2].Pos - Vertices[Index0].Pos;
-		        Vector3f Normal = v1.Cross(v2);
-		        Normal.Normalize();
-
-		        Vertices[Index0].Normal += Normal;
-		        Vertices[Index1].Normal += Normal;
-		        Vertices[Index2].Normal += Normal;
-    		}
-        }
+    std::vector<float> Heights(Vertices.size());
+
+    for (unsigned int i = 0 ; i < Vertices.size() ; i++) {
+        Heights[i] = Vertices[i].Pos.y;
     }
 
-    // Normalize all the vertex normals
+    // Central differences on the height field. Unlike the average of the face normals
+    // this does not depend on the triangulation of the patches.
+    std::vector<Vector3f> Normals(Vertices.size());
+    BakeHeightFieldNormals(Heights.data(), m_width, m_depth, pTerrain->GetWorldScale(), 1.0f, Normals.data());
+
     for (unsigned int i = 0 ; i < Vertices.size() ; i++) {
-        Vertices[i].Normal.Normalize();
+        Vertices[i].Normal = Normals[i];
     }
 }
 
@@ -394,6 +465,8 @@ void GeomipGrid::Render(const Vector3f& CameraPos, const Matrix4f& ViewProj)
 
     FrustumCulling fc(ViewProj);
 
+    fc.ClassifyAABBs(m_patchBounds, m_patchVisible.data());
+
     glBindVertexArray(m_vao);
 
     if (gShowPoints > 0) {
@@ -414,7 +487,7 @@ void GeomipGrid::Render(const Vector3f& CameraPos, const Matrix4f& ViewProj)
 
                 if (IsCameraInPatch(CameraPos, x, z)) {
                     // continue to draw call
-                } else if (!IsPatchInsideViewFrustum_WorldSpace(x, z, fc)) {
+                } else if (!m_patchVisible[PatchZ * m_numPatchesX + PatchX]) {
                     if (!IsCameraCloseToPatch(CameraPos, x, z)) {
                         continue;
                     }
@@ -471,40 +544,45 @@ bool GeomipGrid::IsPatchInsideViewFrustum_ViewSpace(int X, int Z, const Matrix4f
 
 bool GeomipGrid::IsPatchInsideViewFrustum_WorldSpace(int X, int Z, const FrustumCulling& fc)
 {
-    int x0 = X;
-    int x1 = X + m_patchSize - 1;
-    int z0 = Z;
-    int z1 = Z + m_patchSize - 1;
+    int PatchX = X / (m_patchSize - 1);
+    int PatchZ = Z / (m_patchSize - 1);
 
-    float h00 = m_pTerrain->GetHeight(x0, z0);
-    float h01 = m_pTerrain->GetHeight(x0, z1);
-    float h10 = m_pTerrain->GetHeight(x1, z0);
-    float h11 = m_pTerrain->GetHeight(x1, z1);
-
-    float MinHeight = std::min(h00, std::min(h01, std::min(h10, h11)));
-    float MaxHeight = std::max(h00, std::max(h01, std::max(h10, h11)));
-
-    Vector3f p00_low((float)x0 * m_worldScale, h00, (float)z0 * m_worldScale);
-    Vector3f p01_low((float)x0 * m_worldScale, h01, (float)z1 * m_worldScale);
-    Vector3f p10_low((float)x1 * m_worldScale, h10, (float)z0 * m_worldScale);
-    Vector3f p11_low((float)x1 * m_worldScale, h11, (float)z1 * m_worldScale);
-
-  /*  Vector3f p00_high((float)x0 * m_worldScale, MaxHeight, (float)z0 * m_worldScale);
-    Vector3f p01_high((float)x0 * m_worldScale, MaxHeight, (float)z1 * m_worldScale);
-    Vector3f p10_high((float)x1 * m_worldScale, MaxHeight, (float)z0 * m_worldScale);
-    Vector3f p11_high((float)x1 * m_worldScale, MaxHeight, (float)z1 * m_worldScale);*/
-
-    bool InsideViewFrustm =
-        fc.IsPointInsideViewFrustum(p00_low) ||
-        fc.IsPointInsideViewFrustum(p01_low) ||
-        fc.IsPointInsideViewFrustum(p10_low) ||
-        fc.IsPointInsideViewFrustum(p11_low);// ||
-     /*   fc.IsPointInsideViewFrustum(p00_high) ||
-        fc.IsPointInsideViewFrustum(p01_high) ||
-        fc.IsPointInsideViewFrustum(p10_high) ||
-        fc.IsPointInsideViewFrustum(p11_high);*/
-
-    return InsideViewFrustm;
+    const AABB Box = m_patchBounds.Get(PatchZ * m_numPatchesX + PatchX);
+
+    return fc.IsAABBInsideViewFrustum(Box);
+}
+
+
+// The box of each patch covers all of its vertices so that a patch is not culled
+// when only its middle (e.g. a mountain peak) is inside the view frustum
+void GeomipGrid::CalcPatchBounds()
+{
+    m_patchBounds.Resize(m_numPatchesX * m_numPatchesZ);
+    m_patchVisible.resize(m_numPatchesX * m_numPatchesZ);
+
+    for (int PatchZ = 0 ; PatchZ < m_numPatchesZ ; PatchZ++) {
+        for (int PatchX = 0 ; PatchX < m_numPatchesX ; PatchX++) {
+            int x0 = PatchX * (m_patchSize - 1);
+            int z0 = PatchZ * (m_patchSize - 1);
+
+            float MinHeight = FLT_MAX;
+            float MaxHeight = -FLT_MAX;
+
+            for (int z = z0 ; z < z0 + m_patchSize ; z++) {
+                for (int x = x0 ; x < x0 + m_patchSize ; x++) {
+                    float Height = m_pTerrain->GetHeight(x, z);
+                    MinHeight = std::min(MinHeight, Height);
+                    MaxHeight = std::max(MaxHeight, Height);
+                }
+            }
+
+            AABB Box;
+            Box.Add(Vector3f((float)x0 * m_worldScale, MinHeight, (float)z0 * m_worldScale));
+            Box.Add(Vector3f((float)(x0 + m_patchSize - 1) * m_worldScale, MaxHeight, (float)(z0 + m_patchSize - 1) * m_worldScale));
+
+            m_patchBounds.Set(PatchZ * m_numPatchesX + PatchX, Box);
+        }
+    }
 }
 
 
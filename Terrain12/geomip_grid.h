@@ -25,6 +25,7 @@
 
 #include "ogldev_math_3d.h"
 #include "lod_manager.h"
+#include "terrain_tile_streamer.h"
 
 // this header is included by terrain.h so we have a forward 
 // declaration for BaseTerrain.
@@ -42,6 +43,24 @@ class GeomipGrid {
 
     void Render(const Vector3f& CameraPos, const Matrix4f& ViewProj);
 
+    // See LodManager::SetLodErrors
+    void SetLodErrors(const float* pErrors, float MaxErrorPerDistance) { m_lodManager.SetLodErrors(pErrors, MaxErrorPerDistance); }
+
+    // Tile pool mode: a single vertex buffer with room for NumSlots tiles of
+    // TileSize x TileSize vertices. All the tiles share the indices of the patches.
+    void CreateTilePool(int TileSize, int PatchSize, int NumSlots, float WorldScale);
+
+    void UpdateTile(int Slot, const std::vector<TerrainTileVertex>& Vertices);
+
+    struct TilePatch {
+        int Slot = 0;
+        int PatchX = 0;
+        int PatchZ = 0;
+        LodManager::PatchLod Lod;
+    };
+
+    void RenderTilePatches(const std::vector<TilePatch>& Patches);
+
  private:
 
     struct Vertex {
@@ -52,6 +71,8 @@ class GeomipGrid {
         void InitVertex(const BaseTerrain* pTerrain, int x, int z);
     };
 
+    void ValidateSizes(int Width, int Depth, int PatchSize);
+
     void CreateGLState();
 	
     void PopulateBuffers(const BaseTerrain* pTerrain);
@@ -64,7 +85,7 @@ class GeomipGrid {
     
     int InitIndicesLODSingle(int Index, std::vector<uint>& Indices, int lodCore, int lodLeft, int lodRight, int lodTop, int lodBottom);
     
-    void CalcNormals(std::vector<Vertex>& Vertices, std::vector<uint>& Indices);
+    void CalcNormals(const BaseTerrain* pTerrain, std::vector<Vertex>& Vertices);
     
     uint AddTriangle(uint Index, std::vector<uint>& Indices, uint v1, uint v2, uint v3);
     
@@ -76,6 +97,8 @@ class GeomipGrid {
 
     bool IsPatchInsideViewFrustum_WorldSpace(int X, int Z, const FrustumCulling& FC);
 
+    void CalcPatchBounds();
+
     bool IsCameraInPatch(const Vector3f& CameraPos, int PatchBaseX, int PatchBaseZ);
 
     bool IsCameraCloseToPatch(const Vector3f& CameraPos, int PatchBaseX, int PatchBaseZ);
@@ -88,6 +111,7 @@ class GeomipGrid {
     GLuint m_vb = 0;
     GLuint m_ib = 0;
     float m_worldScale = 1.0f;
+    int m_verticesPerTile = 0;      // tile pool mode only
 
     struct SingleLodInfo {
         int Start = 0;
@@ -110,6 +134,8 @@ class GeomipGrid {
     const BaseTerrain* m_pTerrain = NULL;
     float m_patchWorldSize = 0.0f;
     float m_patchWorldHalfSize = 0.0f;
+    AABBArray m_patchBounds;                        // world space box of each patch (row major by PatchZ)
+    std::vector<unsigned char> m_patchVisible;      // frustum culling results of the current frame
 };
 
 #endif
@@ -1,7 +1,21 @@
 #include <stdio.h>
+#include <float.h>
+#include <algorithm>
 
 #include "lod_manager.h"
 #include "demo_config.h"
+#include "ogldev_thread_pool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define LOD_MANAGER_SSE
+#include <emmintrin.h>
+#endif
+
+// Fall back to a full update if more than this fraction of the patches need to be evaluated
+#define MAX_INCREMENTAL_FRACTION 8
+
+// Covers the rounding error of the distances
+#define EXPIRY_MARGIN 0.01f
 
 
 int LodManager::InitLodManager(int PatchSize, int NumPatchesX, int NumPatchesZ, float WorldScale)
@@ -20,6 +34,24 @@ int LodManager::InitLodManager(int PatchSize, int NumPatchesX, int NumPatchesZ,
 
     CalcLodRegions();
 
+    int CenterStep = m_patchSize / 2;
+
+    m_patchCenterX.resize(NumPatchesX);
+    m_patchCenterZ.resize(NumPatchesZ);
+
+    for (int LodMapX = 0 ; LodMapX < NumPatchesX ; LodMapX++) {
+        m_patchCenterX[LodMapX] = (LodMapX * (m_patchSize - 1) + CenterStep) * (float)m_worldScale;
+    }
+
+    for (int LodMapZ = 0 ; LodMapZ < NumPatchesZ ; LodMapZ++) {
+        m_patchCenterZ[LodMapZ] = (LodMapZ * (m_patchSize - 1) + CenterStep) * (float)m_worldScale;
+    }
+
+    m_coreLod.resize(NumPatchesX * NumPatchesZ);
+    m_isDirty.resize(NumPatchesX * NumPatchesZ, 0);
+    m_lodBoundaries.clear();
+    m_isMapValid = false;
+
     return m_maxLOD;
 }
 
@@ -41,10 +73,47 @@ void LodManager::CalcMaxLOD()
 }
 
 
+void LodManager::SetLodErrors(const float* pErrors, float MaxErrorPerDistance)
+{
+    m_isMapValid = false;
+
+    if (!pErrors) {
+        m_lodBoundaries.clear();
+        return;
+    }
+
+    int NumPatches = m_numPatchesX * m_numPatchesZ;
+    m_lodBoundaries.resize(NumPatches * m_maxLOD);
+
+    for (int Patch = 0 ; Patch < NumPatches ; Patch++) {
+        const float* pPatchErrors = &pErrors[Patch * (m_maxLOD + 1)];
+        float* pBoundaries = &m_lodBoundaries[Patch * m_maxLOD];
+        float Boundary = 0.0f;
+
+        for (int i = 0 ; i < m_maxLOD ; i++) {
+            Boundary = std::max(Boundary, pPatchErrors[i + 1] / MaxErrorPerDistance);
+            pBoundaries[i] = Boundary;
+        }
+    }
+}
+
+
 void LodManager::Update(const Vector3f& CameraPos)
 {
-    UpdateLodMapPass1(CameraPos);
-    UpdateLodMapPass2(CameraPos);
+    switch (m_updateMode) {
+    case LOD_UPDATE_SERIAL:
+        UpdateLodMapPass1(CameraPos);
+        UpdateLodMapPass2(CameraPos);
+        break;
+
+    case LOD_UPDATE_PARALLEL:
+        UpdateLodMapParallel(CameraPos, false);
+        break;
+
+    case LOD_UPDATE_INCREMENTAL:
+        UpdateLodMapIncremental(CameraPos);
+        break;
+    }
 }
 
 
@@ -61,7 +130,7 @@ void LodManager::UpdateLodMapPass1(const Vector3f& CameraPos)
 
             float DistanceToCamera = CameraPos.Distance(PatchCenter);
 
-            int CoreLod = DistanceToLod(DistanceToCamera);
+            int CoreLod = PatchDistanceToLod(LodMapZ * m_numPatchesX + LodMapX, DistanceToCamera);
 
             PatchLod* pPatchLOD = m_map.GetAddr(LodMapX, LodMapZ);
             pPatchLOD->Core = CoreLod;
@@ -127,6 +196,225 @@ void LodManager::UpdateLodMapPass2(const Vector3f& CameraPos)
 }
 
 
+// Same result as UpdateLodMapPass1 + UpdateLodMapPass2. The first pass must
+// be complete before the second one starts because it reads the neighbors.
+void LodManager::UpdateLodMapParallel(const Vector3f& CameraPos, bool CalcExpiry)
+{
+    int RowsPerBatch = std::max(1, 4096 / m_numPatchesX);
+
+    ThreadPool::GetDefault().ParallelFor(m_numPatchesZ, RowsPerBatch, [&](int Start, int End) {
+        for (int LodMapZ = Start ; LodMapZ < End ; LodMapZ++) {
+            CalcCoreLodRow(LodMapZ, CameraPos);
+        }
+    });
+
+    ThreadPool::GetDefault().ParallelFor(m_numPatchesZ, RowsPerBatch, [&](int Start, int End) {
+        for (int LodMapZ = Start ; LodMapZ < End ; LodMapZ++) {
+            CalcNeighborLodRow(LodMapZ);
+        }
+    });
+
+    if (CalcExpiry) {
+        m_expiryHeap.resize(m_numPatchesX * m_numPatchesZ);
+
+        ThreadPool::GetDefault().ParallelFor(m_numPatchesZ, RowsPerBatch, [&](int Start, int End) {
+            for (int LodMapZ = Start ; LodMapZ < End ; LodMapZ++) {
+                for (int LodMapX = 0 ; LodMapX < m_numPatchesX ; LodMapX++) {
+                    int Patch = LodMapZ * m_numPatchesX + LodMapX;
+                    float Distance = CalcDistance(LodMapX, LodMapZ, CameraPos);
+
+                    m_expiryHeap[Patch].Travel = CalcExpiryTravel(Patch, Distance, m_coreLod[Patch]);
+                    m_expiryHeap[Patch].Patch = Patch;
+                }
+            }
+        });
+    }
+}
+
+
+// The distance is calculated exactly like in UpdateLodMapPass1 so the results are identical
+void LodManager::CalcCoreLodRow(int LodMapZ, const Vector3f& CameraPos)
+{
+    int* pCoreLod = &m_coreLod[LodMapZ * m_numPatchesX];
+
+    float DeltaY = CameraPos.y;
+    float DeltaZ = CameraPos.z - m_patchCenterZ[LodMapZ];
+    float DeltaYSquared = DeltaY * DeltaY;
+    float DeltaZSquared = DeltaZ * DeltaZ;
+
+    int LodMapX = 0;
+
+#ifdef LOD_MANAGER_SSE
+    // The regions are shared by all the patches only when the LOD is based on the distance
+    int NumSimdPatches = m_lodBoundaries.empty() ? m_numPatchesX : 0;
+
+    __m128 CameraX = _mm_set1_ps(CameraPos.x);
+    __m128 DeltaY4 = _mm_set1_ps(DeltaYSquared);
+    __m128 DeltaZ4 = _mm_set1_ps(DeltaZSquared);
+
+    for ( ; LodMapX + 4 <= NumSimdPatches ; LodMapX += 4) {
+        __m128 DeltaX = _mm_sub_ps(CameraX, _mm_loadu_ps(&m_patchCenterX[LodMapX]));
+        __m128 DistSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(DeltaX, DeltaX), DeltaY4), DeltaZ4);
+        __m128 Distance = _mm_sqrt_ps(DistSquared);
+
+        // The LOD is the number of regions that the patch is beyond. The comparison
+        // returns -1 for every such region.
+        __m128i Lod = _mm_setzero_si128();
+
+        for (int i = 0 ; i < m_maxLOD ; i++) {
+            __m128 Beyond = _mm_cmpge_ps(Distance, _mm_set1_ps((float)m_regions[i]));
+            Lod = _mm_sub_epi32(Lod, _mm_castps_si128(Beyond));
+        }
+
+        _mm_storeu_si128((__m128i*)&pCoreLod[LodMapX], Lod);
+    }
+#endif
+
+    // The remainder (or everything if there's no SIMD support)
+    for ( ; LodMapX < m_numPatchesX ; LodMapX++) {
+        pCoreLod[LodMapX] = PatchDistanceToLod(LodMapZ * m_numPatchesX + LodMapX, CalcDistance(LodMapX, LodMapZ, CameraPos));
+    }
+}
+
+
+void LodManager::CalcNeighborLods(int LodMapX, int LodMapZ)
+{
+    const int* pCoreLod = &m_coreLod[LodMapZ * m_numPatchesX + LodMapX];
+    int CoreLod = *pCoreLod;
+
+    PatchLod& Lod = m_map.At(LodMapX, LodMapZ);
+
+    Lod.Core   = CoreLod;
+    Lod.Left   = ((LodMapX > 0) && (pCoreLod[-1] > CoreLod)) ? 1 : 0;
+    Lod.Right  = ((LodMapX < m_numPatchesX - 1) && (pCoreLod[1] > CoreLod)) ? 1 : 0;
+    Lod.Bottom = ((LodMapZ > 0) && (pCoreLod[-m_numPatchesX] > CoreLod)) ? 1 : 0;
+    Lod.Top    = ((LodMapZ < m_numPatchesZ - 1) && (pCoreLod[m_numPatchesX] > CoreLod)) ? 1 : 0;
+}
+
+
+void LodManager::CalcNeighborLodRow(int LodMapZ)
+{
+    const int* pCoreLod = &m_coreLod[LodMapZ * m_numPatchesX];
+    const int* pBottomCoreLod = (LodMapZ > 0) ? pCoreLod - m_numPatchesX : NULL;
+    const int* pTopCoreLod = (LodMapZ < m_numPatchesZ - 1) ? pCoreLod + m_numPatchesX : NULL;
+
+    PatchLod* pLod = m_map.GetAddr(0, LodMapZ);
+
+    for (int LodMapX = 0 ; LodMapX < m_numPatchesX ; LodMapX++) {
+        int CoreLod = pCoreLod[LodMapX];
+
+        pLod[LodMapX].Core   = CoreLod;
+        pLod[LodMapX].Left   = ((LodMapX > 0) && (pCoreLod[LodMapX - 1] > CoreLod)) ? 1 : 0;
+        pLod[LodMapX].Right  = ((LodMapX < m_numPatchesX - 1) && (pCoreLod[LodMapX + 1] > CoreLod)) ? 1 : 0;
+        pLod[LodMapX].Bottom = (pBottomCoreLod && (pBottomCoreLod[LodMapX] > CoreLod)) ? 1 : 0;
+        pLod[LodMapX].Top    = (pTopCoreLod && (pTopCoreLod[LodMapX] > CoreLod)) ? 1 : 0;
+    }
+}
+
+
+float LodManager::CalcDistance(int LodMapX, int LodMapZ, const Vector3f& CameraPos) const
+{
+    Vector3f PatchCenter(m_patchCenterX[LodMapX], 0.0f, m_patchCenterZ[LodMapZ]);
+
+    return CameraPos.Distance(PatchCenter);
+}
+
+
+// Returns the total travel of the camera at which the LOD of the patch may change
+double LodManager::CalcExpiryTravel(int Patch, float Distance, int Lod) const
+{
+    float DistanceToLower = (Lod > 0) ? Distance - GetLodBoundary(Patch, Lod - 1) : FLT_MAX;
+    float DistanceToUpper = (Lod < m_maxLOD) ? GetLodBoundary(Patch, Lod) - Distance : FLT_MAX;
+
+    float Slack = std::min(DistanceToLower, DistanceToUpper) - EXPIRY_MARGIN - Distance * 1e-5f;
+
+    return m_totalTravel + std::max(Slack, 0.0f);
+}
+
+
+void LodManager::MarkDirty(int LodMapX, int LodMapZ)
+{
+    if ((LodMapX < 0) || (LodMapX >= m_numPatchesX) || (LodMapZ < 0) || (LodMapZ >= m_numPatchesZ)) {
+        return;
+    }
+
+    int Patch = LodMapZ * m_numPatchesX + LodMapX;
+
+    if (!m_isDirty[Patch]) {
+        m_isDirty[Patch] = 1;
+        m_dirtyPatches.push_back(Patch);
+    }
+}
+
+
+void LodManager::UpdateLodMapIncremental(const Vector3f& CameraPos)
+{
+    auto IsLaterExpiry = [](const LodExpiry& a, const LodExpiry& b) { return a.Travel > b.Travel; };
+
+    if (m_isMapValid) {
+        m_totalTravel += CameraPos.Distance(m_lastCameraPos);
+    }
+
+    m_lastCameraPos = CameraPos;
+
+    int MaxPatches = (m_numPatchesX * m_numPatchesZ) / MAX_INCREMENTAL_FRACTION;
+    int NumPatches = 0;
+
+    // A patch which was evaluated in this update has an expiry of at least m_totalTravel
+    // so the strict comparison doesn't pick it again
+    while (m_isMapValid && !m_expiryHeap.empty() && (m_expiryHeap.front().Travel < m_totalTravel)) {
+        // The camera has moved too far (e.g. teleport) for the incremental update to pay off
+        if (++NumPatches > MaxPatches) {
+            m_isMapValid = false;
+            break;
+        }
+
+        std::pop_heap(m_expiryHeap.begin(), m_expiryHeap.end(), IsLaterExpiry);
+
+        LodExpiry& Expiry = m_expiryHeap.back();
+        int LodMapX = Expiry.Patch % m_numPatchesX;
+        int LodMapZ = Expiry.Patch / m_numPatchesX;
+
+        float Distance = CalcDistance(LodMapX, LodMapZ, CameraPos);
+        int CoreLod = PatchDistanceToLod(Expiry.Patch, Distance);
+
+        if (CoreLod != m_coreLod[Expiry.Patch]) {
+            m_coreLod[Expiry.Patch] = CoreLod;
+
+            MarkDirty(LodMapX, LodMapZ);
+            MarkDirty(LodMapX - 1, LodMapZ);
+            MarkDirty(LodMapX + 1, LodMapZ);
+            MarkDirty(LodMapX, LodMapZ - 1);
+            MarkDirty(LodMapX, LodMapZ + 1);
+        }
+
+        Expiry.Travel = CalcExpiryTravel(Expiry.Patch, Distance, CoreLod);
+
+        std::push_heap(m_expiryHeap.begin(), m_expiryHeap.end(), IsLaterExpiry);
+    }
+
+    if (!m_isMapValid) {
+        m_totalTravel = 0.0;
+
+        UpdateLodMapParallel(CameraPos, true);
+
+        std::make_heap(m_expiryHeap.begin(), m_expiryHeap.end(), IsLaterExpiry);
+
+        m_isMapValid = true;
+    } else {
+        for (int Patch : m_dirtyPatches) {
+            CalcNeighborLods(Patch % m_numPatchesX, Patch / m_numPatchesX);
+        }
+    }
+
+    for (int Patch : m_dirtyPatches) {
+        m_isDirty[Patch] = 0;
+    }
+
+    m_dirtyPatches.clear();
+}
+
+
 void LodManager::PrintLodMap()
 {
     for (int LodMapZ = m_numPatchesZ - 1 ; LodMapZ >= 0 ; LodMapZ--) {
@@ -154,6 +442,36 @@ int LodManager::DistanceToLod(float Distance)
 }
 
 
+// Same as DistanceToLod with the boundaries of the patch
+int LodManager::PatchDistanceToLod(int Patch, float Distance)
+{
+    if (m_lodBoundaries.empty()) {
+        return DistanceToLod(Distance);
+    }
+
+    const float* pBoundaries = &m_lodBoundaries[Patch * m_maxLOD];
+
+    int Lod = 0;
+
+    while ((Lod < m_maxLOD) && (Distance >= pBoundaries[Lod])) {
+        Lod++;
+    }
+
+    return Lod;
+}
+
+
+// The distance at which the patch switches from Lod to Lod + 1
+float LodManager::GetLodBoundary(int Patch, int Lod) const
+{
+    if (m_lodBoundaries.empty()) {
+        return (float)m_regions[Lod];
+    }
+
+    return m_lodBoundaries[Patch * m_maxLOD + Lod];
+}
+
+
 const LodManager::PatchLod& LodManager::GetPatchLod(int PatchX, int PatchZ) const
 {
     return m_map.Get(PatchX, PatchZ);
@@ -6,11 +6,26 @@
 #include "ogldev_math_3d.h"
 #include "ogldev_array_2d.h"
 
+enum LOD_UPDATE_MODE {
+    LOD_UPDATE_SERIAL,          // the reference - every patch on the calling thread
+    LOD_UPDATE_PARALLEL,        // every patch, SIMD and the thread pool
+    LOD_UPDATE_INCREMENTAL      // only the patches which can cross a LOD region since the last update
+};
+
 class LodManager {
  public:
 
     int InitLodManager(int PatchSize, int NumPatchesX, int NumPatchesZ, float WorldScale);
 
+    void SetUpdateMode(LOD_UPDATE_MODE Mode) { m_updateMode = Mode; m_isMapValid = false; }
+
+    // Switches to error driven LOD selection. pErrors contains the geometric error of
+    // each LOD of each patch (m_maxLOD + 1 values per patch, row major by patch Z, never
+    // decreasing). A patch uses the coarsest LOD whose error is not larger than
+    // MaxErrorPerDistance times its distance from the camera. NULL goes back to the
+    // distance regions.
+    void SetLodErrors(const float* pErrors, float MaxErrorPerDistance);
+
     void Update(const Vector3f& CameraPos);
 
     struct PatchLod {
@@ -31,6 +46,17 @@ class LodManager {
     void UpdateLodMapPass1(const Vector3f& CameraPos);
     void UpdateLodMapPass2(const Vector3f& CameraPos);
 
+    void UpdateLodMapParallel(const Vector3f& CameraPos, bool CalcExpiry);
+    void UpdateLodMapIncremental(const Vector3f& CameraPos);
+    void CalcCoreLodRow(int LodMapZ, const Vector3f& CameraPos);
+    void CalcNeighborLods(int LodMapX, int LodMapZ);
+    void CalcNeighborLodRow(int LodMapZ);
+    float CalcDistance(int LodMapX, int LodMapZ, const Vector3f& CameraPos) const;
+    int PatchDistanceToLod(int Patch, float Distance);
+    float GetLodBoundary(int Patch, int Lod) const;
+    double CalcExpiryTravel(int Patch, float Distance, int Lod) const;
+    void MarkDirty(int LodMapX, int LodMapZ);
+
     int DistanceToLod(float Distance);
 
     int m_maxLOD = 0;
@@ -41,6 +67,32 @@ class LodManager {
 
     Array2D<PatchLod> m_map;
     std::vector<int> m_regions;
+
+    // Error driven mode - the distance at which each patch switches from
+    // LOD i to LOD i + 1 (m_maxLOD values per patch)
+    std::vector<float> m_lodBoundaries;
+    LOD_UPDATE_MODE m_updateMode = LOD_UPDATE_INCREMENTAL;
+
+    // The SIMD path works on the core LOD of all the patches (row major by patch Z)
+    // and on the world position of the center of each column and row of patches
+    std::vector<int> m_coreLod;
+    std::vector<float> m_patchCenterX;
+    std::vector<float> m_patchCenterZ;
+
+    // Incremental mode. The distance between the camera and a patch cannot change
+    // by more than the distance that the camera travelled, so a patch only needs to be
+    // evaluated again when the total travel reaches the nearest LOD region boundary.
+    struct LodExpiry {
+        double Travel;
+        int Patch;
+    };
+
+    std::vector<LodExpiry> m_expiryHeap;        // min heap by travel
+    double m_totalTravel = 0.0;
+    Vector3f m_lastCameraPos;
+    bool m_isMapValid = false;
+    std::vector<int> m_dirtyPatches;            // need new neighbor flags
+    std::vector<unsigned char> m_isDirty;
 };
 
 
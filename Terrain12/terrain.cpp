@@ -40,6 +40,9 @@ void BaseTerrain::Destroy()
 {
     m_heightMap.Destroy();
     m_geomipGrid.Destroy();
+    m_tiledGrid.Destroy();
+    m_tiledHeightMap.Close();
+    m_terrainFile.Close();
 }
 
 
@@ -103,12 +106,23 @@ float BaseTerrain::GetHeightInterpolated(float x, float z) const
 
 void BaseTerrain::LoadFromFile(const char* pFilename)
 {
-    LoadHeightMapFile(pFilename);
+    if (!m_terrainFile.Open(pFilename)) {
+        exit(0);
+    }
 
-    // how do we know the patch size at this point?
-    assert(0);
+    m_terrainSize = m_terrainFile.GetTerrainSize();
+    m_patchSize = m_terrainFile.GetPatchSize();
+    m_worldScale = m_terrainFile.GetWorldScale();
+
+    printf("Terrain size %d patch size %d\n", m_terrainSize, m_patchSize);
+
+    // GetHeight() reads the quantized heights directly from the file
+    m_heightMap.Destroy();
+
+    SetMinMaxHeight(m_terrainFile.GetMinHeight(), m_terrainFile.GetMaxHeight());
 
     m_geomipGrid.CreateGeomipGrid(m_terrainSize, m_terrainSize, m_patchSize, this);
+    m_geomipGrid.SetLodErrors(m_terrainFile.GetLodErrors(), m_lodMaxErrorPerDistance);
 }
 
 
@@ -135,20 +149,55 @@ void BaseTerrain::LoadHeightMapFile(const char* pFilename)
 }
 
 
+void BaseTerrain::LoadTiledFile(const char* pFilename, int PatchSize, int TileRadius)
+{
+    if (!m_tiledHeightMap.Open(pFilename)) {
+        exit(0);
+    }
+
+    m_terrainSize = m_tiledHeightMap.GetTerrainSize();
+    m_patchSize = PatchSize;
+
+    printf("Tiled terrain size %d\n", m_terrainSize);
+
+    SetMinMaxHeight(m_tiledHeightMap.GetMinHeight(), m_tiledHeightMap.GetMaxHeight());
+
+    m_tiledGrid.CreateTiledGeomipGrid(&m_tiledHeightMap, PatchSize, m_worldScale, m_textureScale, TileRadius);
+}
+
+
 void BaseTerrain::SaveToFile(const char* pFilename)
+{
+    const float* pHeights = m_heightMap.GetBaseAddr();
+    std::vector<float> Heights;
+
+    // A terrain that was loaded from a TerrainFile only has the quantized heights
+    if (m_terrainFile.IsOpen()) {
+        Heights.resize(m_terrainSize * m_terrainSize);
+        m_terrainFile.GetHeights(Heights.data());
+        pHeights = Heights.data();
+    }
+
+    if (!TerrainFile::Create(pFilename, pHeights, m_terrainSize, m_patchSize, m_worldScale)) {
+        exit(0);
+    }
+}
+
+
+void BaseTerrain::SaveToImageFile(const char* pFilename)
 {    
     unsigned char* p = (unsigned char*)malloc(m_terrainSize * m_terrainSize);
 
-    float* src = m_heightMap.GetBaseAddr();
-
     float Delta = m_maxHeight - m_minHeight;
 
-    for (int i = 0; i < m_terrainSize * m_terrainSize; i++) {
-        float f = (src[i] - m_minHeight) / Delta;
-        p[i] = (unsigned char)(f * 255.0f);
+    for (int z = 0; z < m_terrainSize; z++) {
+        for (int x = 0; x < m_terrainSize; x++) {
+            float f = (GetHeight(x, z) - m_minHeight) / Delta;
+            p[z * m_terrainSize + x] = (unsigned char)(f * 255.0f);
+        }
     }
 
-    stbi_write_png("heightmap.png", m_terrainSize, m_terrainSize, 1, p, m_terrainSize);
+    stbi_write_png(pFilename, m_terrainSize, m_terrainSize, 1, p, m_terrainSize);
 
     free(p);
 }
@@ -170,7 +219,11 @@ void BaseTerrain::Render(const BasicCamera& Camera)
 	
     m_terrainTech.SetLightDir(m_lightDir);
 
-    m_geomipGrid.Render(Camera.GetPos(), VP);
+    if (IsTiled()) {
+        m_tiledGrid.Render(Camera.GetPos(), VP);
+    } else {
+        m_geomipGrid.Render(Camera.GetPos(), VP);
+    }
 
     m_pSkydome->Render(Camera);
 }
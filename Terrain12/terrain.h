@@ -25,6 +25,9 @@
 #include "ogldev_texture.h"
 
 #include "geomip_grid.h"
+#include "tiled_geomip_grid.h"
+#include "tiled_height_file.h"
+#include "terrain_file.h"
 #include "terrain_technique.h"
 #include "ogldev_skydome.h"
 
@@ -41,11 +44,39 @@ class BaseTerrain
 
     void Render(const BasicCamera& Camera);
 
+    // Loads a TerrainFile. The size, the patch size and the world scale come from the
+    // file and the LOD of the patches is selected by their precomputed geometric error.
+    // The file stays mapped and the heights are dequantized on access.
     void LoadFromFile(const char* pFilename);
 
+    // Writes the current height map as a TerrainFile
     void SaveToFile(const char* pFilename);
 
-	float GetHeight(int x, int z) const { return m_heightMap.Get(x, z); }
+    // An 8 bit grayscale dump of the height map
+    void SaveToImageFile(const char* pFilename);
+
+    // The largest geometric error of a patch per unit of distance from the camera
+    // (the default is about two pixels at 1080p with a 45 degrees field of view)
+    void SetLodMaxErrorPerDistance(float MaxErrorPerDistance) { m_lodMaxErrorPerDistance = MaxErrorPerDistance; }
+
+    // Streams the tiles of a TiledHeightFile around the camera instead of
+    // loading the entire height map. TileRadius is the number of tiles around
+    // the tile of the camera which are kept resident.
+    void LoadTiledFile(const char* pFilename, int PatchSize, int TileRadius);
+
+    bool IsTiled() const { return m_tiledHeightMap.IsOpen(); }
+
+    const TerrainTileStreamer& GetTileStreamer() const { return m_tiledGrid.GetStreamer(); }
+
+	float GetHeight(int x, int z) const
+    {
+        if (IsTiled()) {
+            return m_tiledHeightMap.GetHeight(x, z);
+        }
+
+        // The heights of a TerrainFile stay quantized in the mapping
+        return m_terrainFile.IsOpen() ? m_terrainFile.GetHeight(x, z) : m_heightMap.Get(x, z);
+    }
 	
     float GetHeightInterpolated(float x, float z) const;
 
@@ -86,8 +117,12 @@ class BaseTerrain
 
 private:
     GeomipGrid m_geomipGrid;
+    TiledHeightFile m_tiledHeightMap;
+    TerrainFile m_terrainFile;
+    TiledGeomipGrid m_tiledGrid;
     float m_minHeight = 0.0f;
     float m_maxHeight = 0.0f;
+    float m_lodMaxErrorPerDistance = 0.0015f;
     TerrainTechnique m_terrainTech;
     Vector3f m_lightDir;
     float m_cameraHeight = 2.0f;
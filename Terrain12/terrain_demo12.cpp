@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <sys/stat.h>
 #include <GL/glew.h>
 
 #include "ogldev_util.h"
@@ -48,6 +49,11 @@ static void MouseButtonCallback(GLFWwindow* window, int Button, int Action, int
 
 static int g_seed = 0;
 
+// Command line: terrain_demo12 tiled [filename] - streams a large terrain from a tiled height file
+static bool g_tiledMode = false;
+static const char* g_pTiledFilename = "tiled_terrain.bin";
+static const char* g_pTerrainFilename = NULL;
+
 extern int gShowPoints;
 
 
@@ -105,7 +111,15 @@ public:
                 ImGui::SliderFloat("Height2", &Height2, 128.0f, 192.0f);
                 ImGui::SliderFloat("Height3", &Height3, 192.0f, 256.0f);
 
-                if (ImGui::Button("Generate")) {
+                if (g_tiledMode) {
+                    const TerrainTileStreamer::Stats& Stats = m_terrain.GetTileStreamer().GetStats();
+                    ImGui::Text("Resident tiles %d, loading %d", Stats.NumResident, Stats.NumLoading);
+                    ImGui::Text("Load latency %.1f ms (max %.1f ms)", Stats.AvgLatencyMs, Stats.MaxLatencyMs);
+
+                    if (ImGui::Button("Set texture heights")) {
+                        m_terrain.SetTextureHeights(Height0, Height1, Height2, Height3);
+                    }
+                } else if (ImGui::Button("Generate")) {
                     m_terrain.Destroy();
                     SRANDOM;
                     m_terrain.CreateMidpointDisplacement(m_terrainSize, m_patchSize, m_roughness, m_minHeight, m_maxHeight);
@@ -293,7 +307,13 @@ private:
 
         m_terrain.InitTerrain(WorldScale, TextureScale, TextureFilenames);
 
-        m_terrain.CreateMidpointDisplacement(m_terrainSize, m_patchSize, m_roughness, m_minHeight, m_maxHeight);
+        if (g_tiledMode) {
+            InitTiledTerrain();
+        } else if (g_pTerrainFilename) {
+            InitTerrainFromFile();
+        } else {
+            m_terrain.CreateMidpointDisplacement(m_terrainSize, m_patchSize, m_roughness, m_minHeight, m_maxHeight);
+        }
 
         Vector3f LightDir(0.0f, -1.0f, 0.0f);
 
@@ -301,6 +321,89 @@ private:
     }
 
 
+    void InitTiledTerrain()
+    {
+        struct stat StatBuf;
+
+        if (stat(g_pTiledFilename, &StatBuf) != 0) {
+            int TerrainSize = 16384;
+            int TileSize = 256;
+            float MaxHeight = m_maxHeight;
+
+            printf("Creating '%s' (%d x %d)\n", g_pTiledFilename, TerrainSize, TerrainSize);
+
+            bool Success = TiledHeightFile::Create(g_pTiledFilename, TerrainSize, TileSize,
+                                                   [MaxHeight](int x, int z) { return FractalNoise(x, z) * MaxHeight; });
+
+            if (!Success) {
+                exit(0);
+            }
+        }
+
+        int TileRadius = 2;
+        m_terrain.LoadTiledFile(g_pTiledFilename, m_patchSize, TileRadius);
+    }
+
+
+    // The file is created from a new midpoint displacement terrain on the first run
+    void InitTerrainFromFile()
+    {
+        struct stat StatBuf;
+
+        if (stat(g_pTerrainFilename, &StatBuf) != 0) {
+            printf("Creating '%s'\n", g_pTerrainFilename);
+
+            m_terrain.CreateMidpointDisplacement(m_terrainSize, m_patchSize, m_roughness, m_minHeight, m_maxHeight);
+            m_terrain.SaveToFile(g_pTerrainFilename);
+            m_terrain.Destroy();
+        }
+
+        m_terrain.LoadFromFile(g_pTerrainFilename);
+    }
+
+
+    static float LatticeValue(int x, int z)
+    {
+        unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)z * 19349663u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return (float)(h & 0xffff) / 65535.0f;
+    }
+
+
+    static float ValueNoise(float x, float z)
+    {
+        int x0 = (int)floorf(x);
+        int z0 = (int)floorf(z);
+
+        float fx = x - x0;
+        float fz = z - z0;
+        fx = fx * fx * (3.0f - 2.0f * fx);
+        fz = fz * fz * (3.0f - 2.0f * fz);
+
+        float Bottom = LatticeValue(x0, z0) + (LatticeValue(x0 + 1, z0) - LatticeValue(x0, z0)) * fx;
+        float Top = LatticeValue(x0, z0 + 1) + (LatticeValue(x0 + 1, z0 + 1) - LatticeValue(x0, z0 + 1)) * fx;
+
+        return Bottom + (Top - Bottom) * fz;
+    }
+
+
+    // Returns a height in [0, 1]
+    static float FractalNoise(int x, int z)
+    {
+        float Height = 0.0f;
+        float Amplitude = 0.5f;
+        float Frequency = 1.0f / 512.0f;
+
+        for (int i = 0; i < 6; i++) {
+            Height += ValueNoise(x * Frequency, z * Frequency) * Amplitude;
+            Amplitude *= 0.5f;
+            Frequency *= 2.0f;
+        }
+
+        return Height;
+    }
+
+
     void InitGUI()
     {
         IMGUI_CHECKVERSION();
@@ -373,6 +476,16 @@ int main(int argc, char** argv)
 #endif
     printf("random seed %d\n", g_seed);
 
+    if ((argc > 1) && (strcmp(argv[1], "tiled") == 0)) {
+        g_tiledMode = true;
+
+        if (argc > 2) {
+            g_pTiledFilename = argv[2];
+        }
+    } else if ((argc > 2) && (strcmp(argv[1], "file") == 0)) {
+        g_pTerrainFilename = argv[2];
+    }
+
     SRANDOM;
 
     app = new TerrainDemo12();
@@ -0,0 +1,322 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <vector>
+
+#include "ogldev_thread_pool.h"
+#include "terrain_file.h"
+
+#define TERRAIN_FILE_VERSION 1
+
+// Each section starts on a cache line
+#define TERRAIN_FILE_ALIGNMENT 64
+
+struct TerrainFileHeader {
+    char Magic[4];
+    u32 Version;
+    u32 TerrainSize;
+    u32 PatchSize;
+    u32 NumLods;
+    float WorldScale;
+    float MinHeight;
+    float MaxHeight;
+    u64 HeightsOffset;
+    u64 PatchBoundsOffset;
+    u64 LodErrorsOffset;
+    u64 FileSize;
+};
+
+static const char TerrainFileMagic[4] = { 'O', 'G', 'T', 'F' };
+
+
+static size_t AlignOffset(size_t Offset)
+{
+    return (Offset + TERRAIN_FILE_ALIGNMENT - 1) & ~((size_t)TERRAIN_FILE_ALIGNMENT - 1);
+}
+
+
+// Returns zero if PatchSize minus one is not a power of two
+static int CalcNumLods(int PatchSize)
+{
+    int NumSegments = PatchSize - 1;
+
+    if ((NumSegments < 2) || ((NumSegments & (NumSegments - 1)) != 0)) {
+        return 0;
+    }
+
+    int NumLods = 0;
+
+    while ((1 << (NumLods + 1)) <= NumSegments) {
+        NumLods++;
+    }
+
+    return NumLods;
+}
+
+
+// The largest vertical distance between the heights of the patch and the triangle fans
+// of the LOD. Every fan covers 2 x 2 quads of size Step around its center (see
+// GeomipGrid::CreateTriangleFan) and each of its eight triangles has the center, the
+// middle of a side and a corner as its vertices.
+static float CalcLodError(const float* pHeights, int TerrainSize, int PatchSize, int BaseX, int BaseZ, int Step)
+{
+    auto H = [pHeights, TerrainSize](int x, int z) { return pHeights[z * TerrainSize + x]; };
+
+    float MaxError = 0.0f;
+    float InvStep = 1.0f / (float)Step;
+
+    for (int FanZ = BaseZ; FanZ < BaseZ + PatchSize - 1; FanZ += Step * 2) {
+        for (int FanX = BaseX; FanX < BaseX + PatchSize - 1; FanX += Step * 2) {
+            int CenterX = FanX + Step;
+            int CenterZ = FanZ + Step;
+            float CenterHeight = H(CenterX, CenterZ);
+
+            for (int dz = -Step; dz <= Step; dz++) {
+                for (int dx = -Step; dx <= Step; dx++) {
+                    int AbsX = abs(dx);
+                    int AbsZ = abs(dz);
+
+                    if ((AbsX == 0) && (AbsZ == 0)) {
+                        continue;
+                    }
+
+                    float h1, h2, a, b;
+
+                    if (AbsX >= AbsZ) {
+                        int SideX = (dx > 0) ? Step : -Step;
+                        int CornerZ = (dz >= 0) ? Step : -Step;
+                        h1 = H(CenterX + SideX, CenterZ);
+                        h2 = H(CenterX + SideX, CenterZ + CornerZ);
+                        b = AbsZ * InvStep;
+                        a = AbsX * InvStep - b;
+                    } else {
+                        int SideZ = (dz > 0) ? Step : -Step;
+                        int CornerX = (dx >= 0) ? Step : -Step;
+                        h1 = H(CenterX, CenterZ + SideZ);
+                        h2 = H(CenterX + CornerX, CenterZ + SideZ);
+                        b = AbsX * InvStep;
+                        a = AbsZ * InvStep - b;
+                    }
+
+                    float Interpolated = CenterHeight + a * (h1 - CenterHeight) + b * (h2 - CenterHeight);
+
+                    MaxError = std::max(MaxError, fabsf(H(CenterX + dx, CenterZ + dz) - Interpolated));
+                }
+            }
+        }
+    }
+
+    return MaxError;
+}
+
+
+bool TerrainFile::Create(const char* pFilename, const float* pHeights, int TerrainSize, int PatchSize, float WorldScale)
+{
+    int NumLods = CalcNumLods(PatchSize);
+
+    if (NumLods == 0) {
+        printf("%s:%d - the patch size minus one must be a power of two (%d)\n", __FILE__, __LINE__, PatchSize);
+        return false;
+    }
+
+    if ((TerrainSize < PatchSize) || ((TerrainSize - 1) % (PatchSize - 1) != 0)) {
+        printf("%s:%d - terrain size %d minus one is not a multiple of the patch size %d minus one\n", __FILE__, __LINE__, TerrainSize, PatchSize);
+        return false;
+    }
+
+    int NumPatches = (TerrainSize - 1) / (PatchSize - 1);
+    int NumHeights = TerrainSize * TerrainSize;
+
+    TerrainFileHeader Header;
+    memcpy(Header.Magic, TerrainFileMagic, sizeof(Header.Magic));
+    Header.Version = TERRAIN_FILE_VERSION;
+    Header.TerrainSize = TerrainSize;
+    Header.PatchSize = PatchSize;
+    Header.NumLods = NumLods;
+    Header.WorldScale = WorldScale;
+    Header.MinHeight = *std::min_element(pHeights, pHeights + NumHeights);
+    Header.MaxHeight = *std::max_element(pHeights, pHeights + NumHeights);
+    Header.HeightsOffset = AlignOffset(sizeof(Header));
+    Header.PatchBoundsOffset = AlignOffset(Header.HeightsOffset + (size_t)NumHeights * sizeof(u16));
+    Header.LodErrorsOffset = AlignOffset(Header.PatchBoundsOffset + (size_t)NumPatches * NumPatches * 2 * sizeof(float));
+    Header.FileSize = Header.LodErrorsOffset + (size_t)NumPatches * NumPatches * NumLods * sizeof(float);
+
+    std::vector<char> Data(Header.FileSize, 0);
+    memcpy(Data.data(), &Header, sizeof(Header));
+
+    u16* pQuantized = (u16*)&Data[Header.HeightsOffset];
+    float* pPatchBounds = (float*)&Data[Header.PatchBoundsOffset];
+    float* pLodErrors = (float*)&Data[Header.LodErrorsOffset];
+
+    float Range = Header.MaxHeight - Header.MinHeight;
+    float Scale = (Range > 0.0f) ? 65535.0f / Range : 0.0f;
+    float HeightStep = (Range > 0.0f) ? Range / 65535.0f : 0.0f;
+
+    // The bounds and the errors are calculated on the heights which are actually rendered
+    std::vector<float> Dequantized(NumHeights);
+
+    ThreadPool::GetDefault().ParallelFor(TerrainSize, 64, [&](int Start, int End) {
+        for (int i = Start * TerrainSize; i < End * TerrainSize; i++) {
+            u16 Quantized = (u16)std::min((pHeights[i] - Header.MinHeight) * Scale + 0.5f, 65535.0f);
+            pQuantized[i] = Quantized;
+            Dequantized[i] = Header.MinHeight + Quantized * HeightStep;
+        }
+    });
+
+    ThreadPool::GetDefault().ParallelFor(NumPatches * NumPatches, 1, [&](int Start, int End) {
+        for (int Patch = Start; Patch < End; Patch++) {
+            int BaseX = (Patch % NumPatches) * (PatchSize - 1);
+            int BaseZ = (Patch / NumPatches) * (PatchSize - 1);
+
+            float MinHeight = FLT_MAX;
+            float MaxHeight = -FLT_MAX;
+
+            for (int z = BaseZ; z < BaseZ + PatchSize; z++) {
+                for (int x = BaseX; x < BaseX + PatchSize; x++) {
+                    MinHeight = std::min(MinHeight, Dequantized[z * TerrainSize + x]);
+                    MaxHeight = std::max(MaxHeight, Dequantized[z * TerrainSize + x]);
+                }
+            }
+
+            pPatchBounds[Patch * 2] = MinHeight;
+            pPatchBounds[Patch * 2 + 1] = MaxHeight;
+
+            // LOD 0 uses all the heights
+            float* pErrors = &pLodErrors[Patch * NumLods];
+            float MaxError = 0.0f;
+            pErrors[0] = 0.0f;
+
+            for (int Lod = 1; Lod < NumLods; Lod++) {
+                MaxError = std::max(MaxError, CalcLodError(Dequantized.data(), TerrainSize, PatchSize, BaseX, BaseZ, 1 << Lod));
+                pErrors[Lod] = MaxError;
+            }
+        }
+    });
+
+    FILE* f = fopen(pFilename, "wb");
+
+    if (!f) {
+        printf("%s:%d - error creating '%s'\n", __FILE__, __LINE__, pFilename);
+        return false;
+    }
+
+    bool Success = (fwrite(Data.data(), Data.size(), 1, f) == 1);
+
+    if (fclose(f) != 0) {
+        Success = false;
+    }
+
+    if (!Success) {
+        printf("%s:%d - error writing '%s'\n", __FILE__, __LINE__, pFilename);
+        remove(pFilename);
+    }
+
+    return Success;
+}
+
+
+bool TerrainFile::Open(const char* pFilename)
+{
+    Close();
+
+    if (!m_file.Open(pFilename)) {
+        printf("%s:%d - error opening '%s'\n", __FILE__, __LINE__, pFilename);
+        return false;
+    }
+
+    TerrainFileHeader Header;
+
+    if (m_file.GetSize() < sizeof(Header)) {
+        printf("%s:%d - '%s' is too small for a terrain file\n", __FILE__, __LINE__, pFilename);
+        m_file.Close();
+        return false;
+    }
+
+    memcpy(&Header, m_file.GetData(), sizeof(Header));
+
+    if ((memcmp(Header.Magic, TerrainFileMagic, sizeof(Header.Magic)) != 0) ||
+        (Header.Version != TERRAIN_FILE_VERSION)) {
+        printf("%s:%d - '%s' is not a terrain file (or the version is not supported)\n", __FILE__, __LINE__, pFilename);
+        m_file.Close();
+        return false;
+    }
+
+    int NumLods = CalcNumLods(Header.PatchSize);
+    bool IsValid = (NumLods != 0) && ((int)Header.NumLods == NumLods) &&
+                   (Header.TerrainSize >= Header.PatchSize) && ((Header.TerrainSize - 1) % (Header.PatchSize - 1) == 0);
+
+    if (IsValid) {
+        u64 NumPatches = (Header.TerrainSize - 1) / (Header.PatchSize - 1);
+
+        IsValid = (Header.FileSize == m_file.GetSize()) &&
+                  (Header.HeightsOffset % TERRAIN_FILE_ALIGNMENT == 0) &&
+                  (Header.PatchBoundsOffset % TERRAIN_FILE_ALIGNMENT == 0) &&
+                  (Header.LodErrorsOffset % TERRAIN_FILE_ALIGNMENT == 0) &&
+                  (Header.HeightsOffset + (u64)Header.TerrainSize * Header.TerrainSize * sizeof(u16) <= Header.PatchBoundsOffset) &&
+                  (Header.PatchBoundsOffset + NumPatches * NumPatches * 2 * sizeof(float) <= Header.LodErrorsOffset) &&
+                  (Header.LodErrorsOffset + NumPatches * NumPatches * NumLods * sizeof(float) <= Header.FileSize);
+    }
+
+    if (!IsValid) {
+        printf("%s:%d - '%s' is corrupted: terrain size %u patch size %u file size %zu\n", __FILE__, __LINE__,
+               pFilename, Header.TerrainSize, Header.PatchSize, m_file.GetSize());
+        m_file.Close();
+        return false;
+    }
+
+    m_terrainSize = Header.TerrainSize;
+    m_patchSize = Header.PatchSize;
+    m_numPatches = (m_terrainSize - 1) / (m_patchSize - 1);
+    m_numLods = NumLods;
+    m_worldScale = Header.WorldScale;
+    m_minHeight = Header.MinHeight;
+    m_maxHeight = Header.MaxHeight;
+    m_heightStep = (m_maxHeight - m_minHeight) / 65535.0f;
+    m_pHeights = (const u16*)(m_file.GetData() + Header.HeightsOffset);
+    m_pPatchBounds = (const float*)(m_file.GetData() + Header.PatchBoundsOffset);
+    m_pLodErrors = (const float*)(m_file.GetData() + Header.LodErrorsOffset);
+
+    return true;
+}
+
+
+void TerrainFile::Close()
+{
+    m_file.Close();
+    m_terrainSize = 0;
+    m_patchSize = 0;
+    m_numPatches = 0;
+    m_numLods = 0;
+    m_pHeights = NULL;
+    m_pPatchBounds = NULL;
+    m_pLodErrors = NULL;
+}
+
+
+void TerrainFile::GetHeights(float* pHeights) const
+{
+    ThreadPool::GetDefault().ParallelFor(m_terrainSize, 64, [&](int Start, int End) {
+        for (int i = Start * m_terrainSize; i < End * m_terrainSize; i++) {
+            pHeights[i] = m_minHeight + m_pHeights[i] * m_heightStep;
+        }
+    });
+}
@@ -0,0 +1,102 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TERRAIN_FILE_H
+#define TERRAIN_FILE_H
+
+#include "ogldev_types.h"
+#include "ogldev_util.h"
+
+//
+// The terrain container. Everything that the terrain needs is precomputed when
+// the file is created so loading it is just a memory mapping:
+//
+//  - a header with the terrain size, patch size, world scale and height range
+//  - the heights, quantized to 16 bits over the height range (row major by Z)
+//  - the min/max height of each patch
+//  - the geometric error of each LOD of each patch
+//
+// The patches and the LODs match GeomipGrid and LodManager. The error of a LOD
+// is the largest vertical distance between the heights and the triangle fans
+// of the LOD (without the stitching to the neighbors). It never decreases from
+// one LOD to the next.
+//
+class TerrainFile
+{
+public:
+    TerrainFile() {}
+
+    ~TerrainFile() { Close(); }
+
+    // (TerrainSize - 1) must be a multiple of (PatchSize - 1)
+    static bool Create(const char* pFilename, const float* pHeights, int TerrainSize, int PatchSize, float WorldScale);
+
+    bool Open(const char* pFilename);
+
+    void Close();
+
+    bool IsOpen() const { return m_file.GetData() != NULL; }
+
+    int GetTerrainSize() const { return m_terrainSize; }
+
+    int GetPatchSize() const { return m_patchSize; }
+
+    int GetNumPatches() const { return m_numPatches; }     // along each axis
+
+    int GetNumLods() const { return m_numLods; }
+
+    float GetWorldScale() const { return m_worldScale; }
+
+    float GetMinHeight() const { return m_minHeight; }
+
+    float GetMaxHeight() const { return m_maxHeight; }
+
+    size_t GetFileSize() const { return m_file.GetSize(); }
+
+    const u16* GetQuantizedHeights() const { return m_pHeights; }
+
+    float GetHeight(int x, int z) const { return m_minHeight + m_pHeights[z * m_terrainSize + x] * m_heightStep; }
+
+    // Dequantizes all the heights (TerrainSize x TerrainSize floats)
+    void GetHeights(float* pHeights) const;
+
+    float GetPatchMinHeight(int PatchX, int PatchZ) const { return m_pPatchBounds[(PatchZ * m_numPatches + PatchX) * 2]; }
+
+    float GetPatchMaxHeight(int PatchX, int PatchZ) const { return m_pPatchBounds[(PatchZ * m_numPatches + PatchX) * 2 + 1]; }
+
+    // NumLods errors for each patch (row major by patch Z)
+    const float* GetLodErrors() const { return m_pLodErrors; }
+
+    const float* GetLodErrors(int PatchX, int PatchZ) const { return &m_pLodErrors[(PatchZ * m_numPatches + PatchX) * m_numLods]; }
+
+private:
+
+    MemoryMappedFile m_file;
+    int m_terrainSize = 0;
+    int m_patchSize = 0;
+    int m_numPatches = 0;
+    int m_numLods = 0;
+    float m_worldScale = 1.0f;
+    float m_minHeight = 0.0f;
+    float m_maxHeight = 0.0f;
+    float m_heightStep = 0.0f;
+    const u16* m_pHeights = NULL;
+    const float* m_pPatchBounds = NULL;
+    const float* m_pLodErrors = NULL;
+};
+
+#endif
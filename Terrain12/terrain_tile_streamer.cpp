@@ -0,0 +1,337 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <float.h>
+#include <algorithm>
+
+#include "ogldev_normal_baker.h"
+#include "terrain_tile_streamer.h"
+
+
+void TerrainTileStreamer::Init(const TiledHeightFile* pFile, int PatchSize, float WorldScale, float TextureScale,
+                               int Radius, int NumLoaderThreads)
+{
+    Destroy();
+
+    m_pFile = pFile;
+    m_tileSize = pFile->GetTileSize();
+    m_patchSize = PatchSize;
+    m_worldScale = WorldScale;
+    m_textureScale = TextureScale;
+    m_radius = Radius;
+
+    if (m_tileSize % (PatchSize - 1) != 0) {
+        printf("%s:%d - the tile size (%d) must be a multiple of the patch size minus 1 (%d)\n", __FILE__, __LINE__, m_tileSize, PatchSize - 1);
+        exit(0);
+    }
+
+    if (NumLoaderThreads < 1) {
+        printf("%s:%d - at least one loader thread is required (%d)\n", __FILE__, __LINE__, NumLoaderThreads);
+        exit(0);
+    }
+
+    m_numPatchesPerTile = m_tileSize / (PatchSize - 1);
+    m_windowTiles = std::min(2 * Radius + 1, pFile->GetNumTiles());
+    m_slots.resize(m_windowTiles * m_windowTiles);
+
+    // Keep the loaders busy but don't queue far ahead of the camera
+    m_maxRequests = NumLoaderThreads * 2;
+    m_pLoader = std::make_unique<ThreadPool>(NumLoaderThreads);
+}
+
+
+void TerrainTileStreamer::Destroy()
+{
+    // The loader is still writing to the tiles of the pending requests
+    for (Request& r : m_requests) {
+        r.Done.wait();
+    }
+
+    m_requests.clear();
+    m_pLoader.reset();
+    m_slots.clear();
+    m_newSlots.clear();
+    m_windowX = -1;
+    m_windowZ = -1;
+    m_stats = Stats();
+    m_totalLatencyMs = 0.0;
+}
+
+
+bool TerrainTileStreamer::Update(const Vector3f& CameraPos, int MaxNewTilesPerFrame)
+{
+    // The caller has uploaded the new tiles of the previous frame
+    for (int Slot : m_newSlots) {
+        std::vector<TerrainTileVertex>().swap(m_slots[Slot]->Vertices);
+    }
+
+    m_newSlots.clear();
+
+    UpdateWindow(CameraPos);
+
+    EvictTiles();
+
+    PickUpLoadedTiles(MaxNewTilesPerFrame);
+
+    RequestTiles();
+
+    m_stats.NumResident = 0;
+    m_stats.NumLoading = (int)m_requests.size();
+    m_stats.CPUBytes = 0;
+
+    for (const std::unique_ptr<Tile>& pTile : m_slots) {
+        if (pTile) {
+            m_stats.NumResident++;
+            m_stats.CPUBytes += pTile->Vertices.capacity() * sizeof(TerrainTileVertex) +
+                                pTile->PatchBounds.MinX.size() * sizeof(float) * 6;
+        }
+    }
+
+    m_stats.CPUBytes += m_requests.size() * GetVerticesPerTile() * sizeof(TerrainTileVertex);
+
+    return m_stats.NumResident < (int)m_slots.size();
+}
+
+
+void TerrainTileStreamer::GetWindow(int& TileX, int& TileZ, int& NumTiles) const
+{
+    TileX = m_windowX;
+    TileZ = m_windowZ;
+    NumTiles = m_windowTiles;
+}
+
+
+void TerrainTileStreamer::UpdateWindow(const Vector3f& CameraPos)
+{
+    m_cameraPos = CameraPos;
+
+    float TileWorldSize = m_tileSize * m_worldScale;
+    int CameraTileX = (int)floorf(CameraPos.x / TileWorldSize);
+    int CameraTileZ = (int)floorf(CameraPos.z / TileWorldSize);
+
+    // The window doesn't shrink near the edges of the terrain
+    int MaxWindowPos = m_pFile->GetNumTiles() - m_windowTiles;
+    m_windowX = std::clamp(CameraTileX - m_radius, 0, MaxWindowPos);
+    m_windowZ = std::clamp(CameraTileZ - m_radius, 0, MaxWindowPos);
+}
+
+
+bool TerrainTileStreamer::IsInWindow(int TileX, int TileZ) const
+{
+    return (TileX >= m_windowX) && (TileX < m_windowX + m_windowTiles) &&
+           (TileZ >= m_windowZ) && (TileZ < m_windowZ + m_windowTiles);
+}
+
+
+void TerrainTileStreamer::EvictTiles()
+{
+    for (std::unique_ptr<Tile>& pTile : m_slots) {
+        if (pTile && !IsInWindow(pTile->TileX, pTile->TileZ)) {
+            pTile.reset();
+            m_stats.NumEvicted++;
+        }
+    }
+}
+
+
+void TerrainTileStreamer::PickUpLoadedTiles(int MaxNewTiles)
+{
+    std::chrono::high_resolution_clock::time_point Now = std::chrono::high_resolution_clock::now();
+
+    for (int i = 0; i < (int)m_requests.size(); ) {
+        Request& r = m_requests[i];
+
+        bool IsStale = !IsInWindow(r.pTile->TileX, r.pTile->TileZ);
+
+        if ((!IsStale && ((int)m_newSlots.size() >= MaxNewTiles)) ||
+            (r.Done.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+            i++;
+            continue;
+        }
+
+        r.Done.get();
+
+        // The camera has moved away while the tile was loading
+        if (!IsStale) {
+            // There is always a free slot because the window has as many tiles as slots
+            int Slot = 0;
+
+            while (m_slots[Slot]) {
+                Slot++;
+                assert(Slot < (int)m_slots.size());
+            }
+
+            r.pTile->LatencyMs = std::chrono::duration<double, std::milli>(Now - r.StartTime).count();
+
+            m_stats.NumLoaded++;
+            m_totalLatencyMs += r.pTile->LatencyMs;
+            m_stats.AvgLatencyMs = m_totalLatencyMs / m_stats.NumLoaded;
+            m_stats.MaxLatencyMs = std::max(m_stats.MaxLatencyMs, r.pTile->LatencyMs);
+
+            m_slots[Slot] = std::move(r.pTile);
+            m_newSlots.push_back(Slot);
+        }
+
+        m_requests.erase(m_requests.begin() + i);
+    }
+}
+
+
+void TerrainTileStreamer::RequestTiles()
+{
+    if ((int)m_requests.size() >= m_maxRequests) {
+        return;
+    }
+
+    // Mark the tiles of the window which are either resident or on their way
+    std::vector<bool> IsAvailable(m_windowTiles * m_windowTiles, false);
+
+    for (const std::unique_ptr<Tile>& pTile : m_slots) {
+        if (pTile) {
+            IsAvailable[(pTile->TileZ - m_windowZ) * m_windowTiles + pTile->TileX - m_windowX] = true;
+        }
+    }
+
+    for (const Request& r : m_requests) {
+        if (IsInWindow(r.pTile->TileX, r.pTile->TileZ)) {
+            IsAvailable[(r.pTile->TileZ - m_windowZ) * m_windowTiles + r.pTile->TileX - m_windowX] = true;
+        }
+    }
+
+    // Load the missing tiles which are closest to the camera first
+    struct Candidate {
+        int TileX;
+        int TileZ;
+        float Distance;
+    };
+
+    std::vector<Candidate> Candidates;
+
+    float TileWorldSize = m_tileSize * m_worldScale;
+
+    for (int z = 0; z < m_windowTiles; z++) {
+        for (int x = 0; x < m_windowTiles; x++) {
+            if (!IsAvailable[z * m_windowTiles + x]) {
+                Candidate c;
+                c.TileX = m_windowX + x;
+                c.TileZ = m_windowZ + z;
+
+                Vector3f TileCenter((c.TileX + 0.5f) * TileWorldSize, 0.0f, (c.TileZ + 0.5f) * TileWorldSize);
+                Vector3f CameraPosZeroY(m_cameraPos.x, 0.0f, m_cameraPos.z);
+                c.Distance = CameraPosZeroY.Distance(TileCenter);
+
+                Candidates.push_back(c);
+            }
+        }
+    }
+
+    std::sort(Candidates.begin(), Candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.Distance < b.Distance; });
+
+    for (const Candidate& c : Candidates) {
+        if ((int)m_requests.size() >= m_maxRequests) {
+            break;
+        }
+
+        Request r;
+        r.pTile = std::make_unique<Tile>();
+        r.pTile->TileX = c.TileX;
+        r.pTile->TileZ = c.TileZ;
+        r.StartTime = std::chrono::high_resolution_clock::now();
+
+        Tile* pTile = r.pTile.get();
+        r.Done = m_pLoader->Submit([this, pTile]() { LoadTile(*pTile); });
+
+        m_requests.push_back(std::move(r));
+    }
+}
+
+
+// Runs on the loader thread
+void TerrainTileStreamer::LoadTile(Tile& t) const
+{
+    int NumVertices = m_tileSize + 1;
+    int BaseX = t.TileX * m_tileSize;
+    int BaseZ = t.TileZ * m_tileSize;
+
+    // The heights of the tile with a border of one height for the normals.
+    // The heights beyond the edge of the terrain are clamped.
+    int HeightsSize = NumVertices + 2;
+    std::vector<float> Heights(HeightsSize * HeightsSize);
+
+    for (int z = 0; z < HeightsSize; z++) {
+        for (int x = 0; x < HeightsSize; x++) {
+            Heights[z * HeightsSize + x] = m_pFile->GetHeight(BaseX + x - 1, BaseZ + z - 1);
+        }
+    }
+
+    // Neither the tile nor its neighbors are needed by this tile anymore
+    for (int z = t.TileZ - 1; z <= t.TileZ + 1; z++) {
+        for (int x = t.TileX - 1; x <= t.TileX + 1; x++) {
+            m_pFile->ReleaseTile(x, z);
+        }
+    }
+
+    // The vertices of the tile are in the interior of the bordered heights so they get
+    // central differences and the normals along the edges of the tile are the same as
+    // the normals of the neighbor tiles
+    std::vector<Vector3f> Normals(Heights.size());
+    BakeHeightFieldNormals(Heights.data(), HeightsSize, HeightsSize, m_worldScale, 1.0f, Normals.data());
+
+    auto GetIndex = [HeightsSize](int x, int z) { return (z + 1) * HeightsSize + x + 1; };
+
+    t.Vertices.resize(NumVertices * NumVertices);
+
+    float Size = (float)m_pFile->GetTerrainSize();
+
+    for (int z = 0; z < NumVertices; z++) {
+        for (int x = 0; x < NumVertices; x++) {
+            TerrainTileVertex& v = t.Vertices[z * NumVertices + x];
+
+            int TerrainX = BaseX + x;
+            int TerrainZ = BaseZ + z;
+
+            v.Pos = Vector3f(TerrainX * m_worldScale, Heights[GetIndex(x, z)], TerrainZ * m_worldScale);
+            v.Tex = Vector2f(m_textureScale * (float)TerrainX / Size, m_textureScale * (float)TerrainZ / Size);
+            v.Normal = Normals[GetIndex(x, z)];
+        }
+    }
+
+    t.PatchBounds.Resize(m_numPatchesPerTile * m_numPatchesPerTile);
+
+    for (int PatchZ = 0; PatchZ < m_numPatchesPerTile; PatchZ++) {
+        for (int PatchX = 0; PatchX < m_numPatchesPerTile; PatchX++) {
+            int x0 = PatchX * (m_patchSize - 1);
+            int z0 = PatchZ * (m_patchSize - 1);
+
+            AABB Box;
+
+            for (int z = z0; z < z0 + m_patchSize; z++) {
+                for (int x = x0; x < x0 + m_patchSize; x++) {
+                    Box.Add(t.Vertices[z * NumVertices + x].Pos);
+                }
+            }
+
+            t.PatchBounds.Set(PatchZ * m_numPatchesPerTile + PatchX, Box);
+
+            t.Bounds.Add(Vector3f(Box.MinX, Box.MinY, Box.MinZ));
+            t.Bounds.Add(Vector3f(Box.MaxX, Box.MaxY, Box.MaxZ));
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TERRAIN_TILE_STREAMER_H
+#define TERRAIN_TILE_STREAMER_H
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "ogldev_math_3d.h"
+#include "ogldev_thread_pool.h"
+#include "tiled_height_file.h"
+
+// Same layout as the vertex of GeomipGrid
+struct TerrainTileVertex {
+    Vector3f Pos;
+    Vector2f Tex;
+    Vector3f Normal;
+};
+
+//
+// Keeps the tiles of a TiledHeightFile which surround the camera resident.
+//
+// The resident tiles form a window of (2 * Radius + 1)^2 tiles around the tile
+// of the camera. Every resident tile occupies one of a fixed number of slots so
+// the GPU buffers can be allocated once and recycled. The vertices of the tiles
+// are built by a background loader and Update() only picks up the tiles which
+// are ready so the cost on the main thread does not depend on the load time.
+//
+// This class doesn't make any OpenGL calls. The vertices of the new tiles must
+// be uploaded by the caller before the next call to Update().
+//
+class TerrainTileStreamer
+{
+public:
+
+    struct Tile {
+        int TileX = -1;
+        int TileZ = -1;
+        std::vector<TerrainTileVertex> Vertices;    // (TileSize + 1)^2, only until the tile is uploaded
+        AABB Bounds;
+        AABBArray PatchBounds;                      // row major by patch Z
+        double LatencyMs = 0.0;                     // from the request until the tile was picked up by Update()
+    };
+
+    struct Stats {
+        int NumResident = 0;
+        int NumLoading = 0;
+        int NumLoaded = 0;                          // since Init()
+        int NumEvicted = 0;                         // since Init()
+        double AvgLatencyMs = 0.0;
+        double MaxLatencyMs = 0.0;
+        size_t CPUBytes = 0;                        // vertices that were not uploaded yet and the patch boxes
+    };
+
+    TerrainTileStreamer() {}
+
+    ~TerrainTileStreamer() { Destroy(); }
+
+    // TileSize of the file must be a multiple of PatchSize - 1
+    void Init(const TiledHeightFile* pFile, int PatchSize, float WorldScale, float TextureScale,
+              int Radius, int NumLoaderThreads = 1);
+
+    void Destroy();
+
+    // Returns false once all the tiles of the window are resident
+    bool Update(const Vector3f& CameraPos, int MaxNewTilesPerFrame = 2);
+
+    int GetNumSlots() const { return (int)m_slots.size(); }
+
+    // NULL if the slot is free
+    const Tile* GetSlot(int Slot) const { return m_slots[Slot].get(); }
+
+    // The slots which received a tile in the last call to Update()
+    const std::vector<int>& GetNewSlots() const { return m_newSlots; }
+
+    // The first tile of the window along each axis and the number of tiles along each axis
+    void GetWindow(int& TileX, int& TileZ, int& NumTiles) const;
+
+    int GetVerticesPerTile() const { return (m_tileSize + 1) * (m_tileSize + 1); }
+
+    int GetNumPatchesPerTile() const { return m_numPatchesPerTile; }
+
+    const Stats& GetStats() const { return m_stats; }
+
+private:
+
+    struct Request {
+        std::unique_ptr<Tile> pTile;
+        std::future<void> Done;
+        std::chrono::high_resolution_clock::time_point StartTime;
+    };
+
+    void UpdateWindow(const Vector3f& CameraPos);
+
+    bool IsInWindow(int TileX, int TileZ) const;
+
+    void EvictTiles();
+
+    void PickUpLoadedTiles(int MaxNewTiles);
+
+    void RequestTiles();
+
+    void LoadTile(Tile& t) const;
+
+    const TiledHeightFile* m_pFile = NULL;
+    int m_tileSize = 0;
+    int m_patchSize = 0;
+    int m_numPatchesPerTile = 0;
+    float m_worldScale = 1.0f;
+    float m_textureScale = 1.0f;
+    int m_radius = 0;
+    int m_windowTiles = 0;
+    int m_windowX = -1;
+    int m_windowZ = -1;
+    Vector3f m_cameraPos;
+    int m_maxRequests = 0;
+    std::vector<std::unique_ptr<Tile>> m_slots;
+    std::vector<int> m_newSlots;
+    std::vector<Request> m_requests;
+    std::unique_ptr<ThreadPool> m_pLoader;
+    Stats m_stats;
+    double m_totalLatencyMs = 0.0;
+};
+
+#endif
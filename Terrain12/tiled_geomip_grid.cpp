@@ -0,0 +1,111 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+
+#include "tiled_geomip_grid.h"
+
+// Upload no more than this number of tiles in a single frame to avoid hitches
+#define MAX_NEW_TILES_PER_FRAME 2
+
+
+void TiledGeomipGrid::CreateTiledGeomipGrid(const TiledHeightFile* pFile, int PatchSize, float WorldScale, float TextureScale, int Radius)
+{
+    m_streamer.Init(pFile, PatchSize, WorldScale, TextureScale, Radius);
+
+    int TileSize = pFile->GetTileSize();
+    m_tileWorldSize = TileSize * WorldScale;
+    m_numPatchesPerTile = m_streamer.GetNumPatchesPerTile();
+    m_patchVisible.resize(m_numPatchesPerTile * m_numPatchesPerTile);
+
+    m_tilePool.CreateTilePool(TileSize + 1, PatchSize, m_streamer.GetNumSlots(), WorldScale);
+
+    int WindowX, WindowZ, WindowTiles;
+    m_streamer.GetWindow(WindowX, WindowZ, WindowTiles);
+
+    int NumPatches = WindowTiles * m_numPatchesPerTile;
+    m_lodManager.InitLodManager(PatchSize, NumPatches, NumPatches, WorldScale);
+
+    printf("Tiled terrain: %d tiles of %d, %d slots of %zu bytes\n", pFile->GetNumTiles() * pFile->GetNumTiles(), TileSize,
+           m_streamer.GetNumSlots(), m_streamer.GetVerticesPerTile() * sizeof(TerrainTileVertex));
+}
+
+
+void TiledGeomipGrid::Destroy()
+{
+    m_streamer.Destroy();
+    m_tilePool.Destroy();
+}
+
+
+void TiledGeomipGrid::UploadNewTiles()
+{
+    for (int Slot : m_streamer.GetNewSlots()) {
+        m_tilePool.UpdateTile(Slot, m_streamer.GetSlot(Slot)->Vertices);
+    }
+}
+
+
+void TiledGeomipGrid::Render(const Vector3f& CameraPos, const Matrix4f& ViewProj)
+{
+    m_streamer.Update(CameraPos, MAX_NEW_TILES_PER_FRAME);
+
+    UploadNewTiles();
+
+    int WindowX, WindowZ, WindowTiles;
+    m_streamer.GetWindow(WindowX, WindowZ, WindowTiles);
+
+    // The LOD manager works on the patches of the window
+    Vector3f WindowOrigin(WindowX * m_tileWorldSize, 0.0f, WindowZ * m_tileWorldSize);
+    m_lodManager.Update(CameraPos - WindowOrigin);
+
+    FrustumCulling fc(ViewProj);
+
+    m_patches.clear();
+
+    for (int Slot = 0; Slot < m_streamer.GetNumSlots(); Slot++) {
+        const TerrainTileStreamer::Tile* pTile = m_streamer.GetSlot(Slot);
+
+        if (!pTile || !fc.IsAABBInsideViewFrustum(pTile->Bounds)) {
+            continue;
+        }
+
+        fc.ClassifyAABBs(pTile->PatchBounds, m_patchVisible.data());
+
+        int WindowPatchX = (pTile->TileX - WindowX) * m_numPatchesPerTile;
+        int WindowPatchZ = (pTile->TileZ - WindowZ) * m_numPatchesPerTile;
+
+        for (int PatchZ = 0; PatchZ < m_numPatchesPerTile; PatchZ++) {
+            for (int PatchX = 0; PatchX < m_numPatchesPerTile; PatchX++) {
+                if (!m_patchVisible[PatchZ * m_numPatchesPerTile + PatchX]) {
+                    continue;
+                }
+
+                GeomipGrid::TilePatch Patch;
+                Patch.Slot = Slot;
+                Patch.PatchX = PatchX;
+                Patch.PatchZ = PatchZ;
+                Patch.Lod = m_lodManager.GetPatchLod(WindowPatchX + PatchX, WindowPatchZ + PatchZ);
+
+                m_patches.push_back(Patch);
+            }
+        }
+    }
+
+    m_tilePool.RenderTilePatches(m_patches);
+}
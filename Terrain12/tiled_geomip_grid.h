@@ -0,0 +1,61 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TILED_GEOMIP_GRID_H
+#define TILED_GEOMIP_GRID_H
+
+#include <vector>
+
+#include "geomip_grid.h"
+#include "lod_manager.h"
+#include "terrain_tile_streamer.h"
+
+//
+// Renders a TiledHeightFile using geomipmapping. Only the tiles around the
+// camera are resident and they are stored in a fixed pool of GPU tiles.
+// The LOD of the patches is calculated on the window of resident tiles so
+// the neighbor patches are stitched together across the edges of the tiles.
+//
+class TiledGeomipGrid {
+ public:
+    TiledGeomipGrid() {}
+
+    ~TiledGeomipGrid() { Destroy(); }
+
+    void CreateTiledGeomipGrid(const TiledHeightFile* pFile, int PatchSize, float WorldScale, float TextureScale, int Radius);
+
+    void Destroy();
+
+    void Render(const Vector3f& CameraPos, const Matrix4f& ViewProj);
+
+    const TerrainTileStreamer& GetStreamer() const { return m_streamer; }
+
+ private:
+
+    void UploadNewTiles();
+
+    TerrainTileStreamer m_streamer;
+    GeomipGrid m_tilePool;
+    LodManager m_lodManager;        // covers the window of resident tiles
+    int m_numPatchesPerTile = 0;
+    float m_tileWorldSize = 0.0f;
+    std::vector<GeomipGrid::TilePatch> m_patches;
+    std::vector<unsigned char> m_patchVisible;
+};
+
+#endif
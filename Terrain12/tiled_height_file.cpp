@@ -0,0 +1,218 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <algorithm>
+#include <vector>
+
+#include "ogldev_thread_pool.h"
+#include "tiled_height_file.h"
+
+#define TILED_HEIGHT_FILE_VERSION 1
+
+// The tiles start at an allocation granularity boundary (64KB on Windows)
+#define TILED_HEIGHT_FILE_DATA_OFFSET 65536
+
+struct TiledHeightFileHeader {
+    char Magic[4];
+    u32 Version;
+    u32 TerrainSize;
+    u32 TileSize;
+    float MinHeight;
+    float MaxHeight;
+};
+
+static const char TiledHeightFileMagic[4] = { 'O', 'G', 'T', 'H' };
+
+
+bool TiledHeightFile::Create(const char* pFilename, int TerrainSize, int TileSize,
+                             const std::function<float(int x, int z)>& Generator)
+{
+    if ((TileSize <= 0) || (TerrainSize % TileSize != 0)) {
+        printf("%s:%d - terrain size %d is not a multiple of the tile size %d\n", __FILE__, __LINE__, TerrainSize, TileSize);
+        return false;
+    }
+
+    FILE* f = fopen(pFilename, "wb");
+
+    if (!f) {
+        printf("%s:%d - error creating '%s'\n", __FILE__, __LINE__, pFilename);
+        return false;
+    }
+
+    TiledHeightFileHeader Header;
+    memcpy(Header.Magic, TiledHeightFileMagic, sizeof(Header.Magic));
+    Header.Version = TILED_HEIGHT_FILE_VERSION;
+    Header.TerrainSize = TerrainSize;
+    Header.TileSize = TileSize;
+    Header.MinHeight = FLT_MAX;
+    Header.MaxHeight = -FLT_MAX;
+
+    std::vector<char> Padding(TILED_HEIGHT_FILE_DATA_OFFSET, 0);
+    memcpy(Padding.data(), &Header, sizeof(Header));
+
+    bool Success = (fwrite(Padding.data(), Padding.size(), 1, f) == 1);
+
+    // One row of tiles at a time so that the memory usage does not depend on the terrain size
+    int NumTiles = TerrainSize / TileSize;
+    int HeightsPerTile = TileSize * TileSize;
+    std::vector<float> TileRow((size_t)NumTiles * HeightsPerTile);
+    std::vector<float> TileMin(NumTiles), TileMax(NumTiles);
+
+    for (int TileZ = 0; Success && (TileZ < NumTiles); TileZ++) {
+        ThreadPool::GetDefault().ParallelFor(NumTiles, 1, [&](int Start, int End) {
+            for (int TileX = Start; TileX < End; TileX++) {
+                float* pTile = &TileRow[(size_t)TileX * HeightsPerTile];
+                float MinHeight = FLT_MAX;
+                float MaxHeight = -FLT_MAX;
+
+                for (int z = 0; z < TileSize; z++) {
+                    for (int x = 0; x < TileSize; x++) {
+                        float Height = Generator(TileX * TileSize + x, TileZ * TileSize + z);
+                        pTile[z * TileSize + x] = Height;
+                        MinHeight = std::min(MinHeight, Height);
+                        MaxHeight = std::max(MaxHeight, Height);
+                    }
+                }
+
+                TileMin[TileX] = MinHeight;
+                TileMax[TileX] = MaxHeight;
+            }
+        });
+
+        for (int TileX = 0; TileX < NumTiles; TileX++) {
+            Header.MinHeight = std::min(Header.MinHeight, TileMin[TileX]);
+            Header.MaxHeight = std::max(Header.MaxHeight, TileMax[TileX]);
+        }
+
+        Success = (fwrite(TileRow.data(), sizeof(float), TileRow.size(), f) == TileRow.size());
+    }
+
+    // Now that the height range is known
+    if (Success) {
+        Success = (fseek(f, 0, SEEK_SET) == 0) && (fwrite(&Header, sizeof(Header), 1, f) == 1);
+    }
+
+    if (fclose(f) != 0) {
+        Success = false;
+    }
+
+    if (!Success) {
+        printf("%s:%d - error writing '%s'\n", __FILE__, __LINE__, pFilename);
+        remove(pFilename);
+    }
+
+    return Success;
+}
+
+
+bool TiledHeightFile::Open(const char* pFilename)
+{
+    Close();
+
+    if (!m_file.Open(pFilename)) {
+        printf("%s:%d - error opening '%s'\n", __FILE__, __LINE__, pFilename);
+        return false;
+    }
+
+    TiledHeightFileHeader Header;
+
+    if (m_file.GetSize() < TILED_HEIGHT_FILE_DATA_OFFSET) {
+        printf("%s:%d - '%s' is too small for a tiled height file\n", __FILE__, __LINE__, pFilename);
+        m_file.Close();
+        return false;
+    }
+
+    memcpy(&Header, m_file.GetData(), sizeof(Header));
+
+    if ((memcmp(Header.Magic, TiledHeightFileMagic, sizeof(Header.Magic)) != 0) ||
+        (Header.Version != TILED_HEIGHT_FILE_VERSION)) {
+        printf("%s:%d - '%s' is not a tiled height file (or the version is not supported)\n", __FILE__, __LINE__, pFilename);
+        m_file.Close();
+        return false;
+    }
+
+    size_t ExpectedSize = TILED_HEIGHT_FILE_DATA_OFFSET + (size_t)Header.TerrainSize * Header.TerrainSize * sizeof(float);
+
+    if ((Header.TileSize == 0) || (Header.TerrainSize % Header.TileSize != 0) || (m_file.GetSize() != ExpectedSize)) {
+        printf("%s:%d - '%s' is corrupted: terrain size %u tile size %u file size %zu\n", __FILE__, __LINE__,
+               pFilename, Header.TerrainSize, Header.TileSize, m_file.GetSize());
+        m_file.Close();
+        return false;
+    }
+
+    m_terrainSize = Header.TerrainSize;
+    m_tileSize = Header.TileSize;
+    m_numTiles = m_terrainSize / m_tileSize;
+    m_minHeight = Header.MinHeight;
+    m_maxHeight = Header.MaxHeight;
+
+    return true;
+}
+
+
+void TiledHeightFile::Close()
+{
+    m_file.Close();
+    m_terrainSize = 0;
+    m_tileSize = 0;
+    m_numTiles = 0;
+}
+
+
+size_t TiledHeightFile::GetTileOffset(int TileX, int TileZ) const
+{
+    assert((TileX >= 0) && (TileX < m_numTiles));
+    assert((TileZ >= 0) && (TileZ < m_numTiles));
+
+    size_t TileIndex = (size_t)TileZ * m_numTiles + TileX;
+
+    return TILED_HEIGHT_FILE_DATA_OFFSET + TileIndex * m_tileSize * m_tileSize * sizeof(float);
+}
+
+
+const float* TiledHeightFile::GetTile(int TileX, int TileZ) const
+{
+    return (const float*)(m_file.GetData() + GetTileOffset(TileX, TileZ));
+}
+
+
+float TiledHeightFile::GetHeight(int x, int z) const
+{
+    x = std::clamp(x, 0, m_terrainSize - 1);
+    z = std::clamp(z, 0, m_terrainSize - 1);
+
+    int TileX = x / m_tileSize;
+    int TileZ = z / m_tileSize;
+
+    const float* pTile = GetTile(TileX, TileZ);
+
+    return pTile[(z - TileZ * m_tileSize) * m_tileSize + x - TileX * m_tileSize];
+}
+
+
+void TiledHeightFile::ReleaseTile(int TileX, int TileZ) const
+{
+    if ((TileX < 0) || (TileX >= m_numTiles) || (TileZ < 0) || (TileZ >= m_numTiles)) {
+        return;
+    }
+
+    m_file.Evict(GetTileOffset(TileX, TileZ), m_tileSize * m_tileSize * sizeof(float));
+}
@@ -0,0 +1,83 @@
+/*
+
+        Copyright 2025 Etay Meiri
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TILED_HEIGHT_FILE_H
+#define TILED_HEIGHT_FILE_H
+
+#include <functional>
+
+#include "ogldev_util.h"
+
+//
+// A height map which is too large to be loaded in to memory. The file is
+// split in to square tiles of TileSize x TileSize heights which are stored
+// one after the other (row major by tile Z). The file is memory mapped so
+// only the tiles which are actually accessed become resident and
+// ReleaseTile() drops a tile when it is no longer needed.
+//
+class TiledHeightFile
+{
+public:
+    TiledHeightFile() {}
+
+    ~TiledHeightFile() { Close(); }
+
+    // Writes a TerrainSize x TerrainSize height map. TerrainSize must be a multiple of TileSize.
+    // The generator is called once for every height (from several threads).
+    static bool Create(const char* pFilename, int TerrainSize, int TileSize,
+                       const std::function<float(int x, int z)>& Generator);
+
+    bool Open(const char* pFilename);
+
+    void Close();
+
+    bool IsOpen() const { return m_file.GetData() != NULL; }
+
+    int GetTerrainSize() const { return m_terrainSize; }
+
+    int GetTileSize() const { return m_tileSize; }
+
+    int GetNumTiles() const { return m_numTiles; }     // along each axis
+
+    float GetMinHeight() const { return m_minHeight; }
+
+    float GetMaxHeight() const { return m_maxHeight; }
+
+    size_t GetFileSize() const { return m_file.GetSize(); }
+
+    const float* GetTile(int TileX, int TileZ) const;
+
+    // The coordinates are clamped to the terrain
+    float GetHeight(int x, int z) const;
+
+    // Can be called while other threads are reading the tile (they will fault it in again)
+    void ReleaseTile(int TileX, int TileZ) const;
+
+private:
+
+    size_t GetTileOffset(int TileX, int TileZ) const;
+
+    MemoryMappedFile m_file;
+    int m_terrainSize = 0;
+    int m_tileSize = 0;
+    int m_numTiles = 0;
+    float m_minHeight = 0.0f;
+    float m_maxHeight = 0.0f;
+};
+
+#endif
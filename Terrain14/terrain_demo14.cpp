@@ -27,10 +27,15 @@
 #include "demolition.h"
 #include "demolition_base_gl_app.h"
 #include "Services/perlin.h"
+#include "ogldev_normal_baker.h"
 
 #define WINDOW_WIDTH  2560
 #define WINDOW_HEIGHT 1440
 
+// The heights are in [0,1] so the normal map is baked with steeper slopes to keep the
+// precision of the 8 bit channels. The renderer scales them back.
+#define NORMAL_MAP_HEIGHT_RATIO 256.0f
+
 /*float GetTerrainHeightAt(float WorldX, float WorldZ, const std::vector<float>& HeightMapData, const PerlinConfig& Config)
 {
     // 1. Convert world coordinates back into un-scaled grid coordinates
@@ -90,7 +95,7 @@ public:
 
         CreatePerlinMap(m_terrainConfig, m_heightMap);
 
-        void* pTerrain = m_pRenderingSystem->CreateTerrainGrid(m_terrainConfig.width, m_terrainConfig.height);
+        void* pTerrain = m_pRenderingSystem->CreateTerrainClipmap(m_terrainConfig.width, m_terrainConfig.height);
 
         TextureConfig TexConfig;
         TexConfig.m_wrapMode = WRAP_MODE_CLAMP_TO_EDGE;
@@ -99,6 +104,14 @@ public:
         TexConfig.m_genMipmaps = true;
         m_terrainTexHeightMap = m_pRenderingSystem->LoadTexture2D(m_heightMap.data(), m_terrainConfig.width, m_terrainConfig.height, &TexConfig);
 
+        BakeNormalMap(m_heightMap.data(), m_terrainConfig.width, m_terrainConfig.height, 1.0f, NORMAL_MAP_HEIGHT_RATIO, m_normalMap);
+
+        TextureConfig NormalMapConfig;
+        NormalMapConfig.m_wrapMode = WRAP_MODE_CLAMP_TO_EDGE;
+        NormalMapConfig.m_numChannels = 3;
+        NormalMapConfig.m_genMipmaps = true;
+        m_terrainTexNormalMap = m_pRenderingSystem->LoadTexture2D(m_normalMap.data(), m_terrainConfig.width, m_terrainConfig.height, &NormalMapConfig);
+
       //  int SandTexture = m_pRenderingSystem->LoadTexture2D("../Content/textures/Polyhaven/forrest_sand_01_diff_2k.jpg");
      //   int GrassTexture = m_pRenderingSystem->LoadTexture2D("../Content/textures/Polyhaven/rocky_terrain_02_diff_2k.jpg");
       //  int RockTexture = m_pRenderingSystem->LoadTexture2D("../Content/textures/Polyhaven/aerial_rocks_01_diff_2k.jpg");
@@ -112,6 +125,7 @@ public:
         pConfig->ControlShadowMapping(false);
         pConfig->SetTerrainGrid(pTerrain);
         pConfig->SetTerrainHeightMap(m_terrainTexHeightMap);
+        pConfig->SetTerrainNormalMap(m_terrainTexNormalMap, NORMAL_MAP_HEIGHT_RATIO);
      //   pConfig->SetTerrainHorizontalScale(m_terrainConfig.horizontalScale);
         pConfig->SetTerrainMaxHeight(0.0f);
         pConfig->SetTerrainRenderMode(TERRAIN_RENDER_MODE_HEIGHT);
@@ -197,6 +211,8 @@ private:
             if (IsDirty) {
                 CreatePerlinMap(m_terrainConfig, m_heightMap);
                 m_pRenderingSystem->UpdateTexture2D(m_terrainTexHeightMap, m_heightMap.data());
+                BakeNormalMap(m_heightMap.data(), m_terrainConfig.width, m_terrainConfig.height, 1.0f, NORMAL_MAP_HEIGHT_RATIO, m_normalMap);
+                m_pRenderingSystem->UpdateTexture2D(m_terrainTexNormalMap, m_normalMap.data());
                 //m_isTerrainConfigDirty = true;
             }
 
@@ -239,6 +255,8 @@ private:
     std::vector<float> m_heightMap;
     PerlinConfig m_terrainConfig;
     int m_terrainTexHeightMap = -1;
+    std::vector<unsigned char> m_normalMap;
+    int m_terrainTexNormalMap = -1;
     bool m_cameraOnGround = false;
     bool m_showGui = true;
 };
@@ -29,4 +29,5 @@ $CC tutorial20.cpp \
   ../../Common/3rdparty/stb_image.cpp \
     ../../Common/ogldev_ect_cubemap.cpp \
     ../../DemoLITION/Framework/Source/core_model.cpp \
+    ../../DemoLITION/Framework/Source/core_model_cache.cpp \
     $CPPFLAGS $LDFLAGS -o tutorial20
@@ -5,7 +5,7 @@ fi
 CC=g++
 OGL_CPPFLAGS="$CPPFLAGS -I$ROOTDIR/Include -I$ROOTDIR/Common/FreetypeGL -I$ROOTDIR/Common/3rdparty/ImGui/GLFW/ -std=c++20"
 OGL_LDFLAGS=`pkg-config --libs glew assimp`
-OGL_LDFLAGS="$OGL_LDFLAGS -lglfw -lX11 -lmeshoptimizer -lglut"
+OGL_LDFLAGS="$OGL_LDFLAGS -lglfw -lX11 -lmeshoptimizer -lglut -lpthread"
 
 build_ogldev() {
 	cd $ROOTDIR/Common